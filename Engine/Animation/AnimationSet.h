@@ -2,7 +2,7 @@
 #pragma once
 
 #include <Engine/Animation/Skeleton.h>
-#include <Engine/Utility/Structures/JSON.h>
+#include <Engine/Utility/Structures/JSONDocument.h>
 
 #include <unordered_map>
 #include <string>
@@ -15,24 +15,26 @@ struct AnimationSet
 		if( File.Exists() )
 		{
 			File.Load();
-			const auto& Data = JSON::Tree( File );
-			return Generate( JSON::Find( Data.Tree, "animations" ) );
+
+			JSON::Document Data;
+			Data.Parse( File );
+			return Generate( Data.Root().Find( "animations" ) );
 		}
 
 		return AnimationSet();
 	}
 	
-	static AnimationSet Generate( const JSON::Object* Node )
+	static AnimationSet Generate( const JSON::Node& Node )
 	{
 		AnimationSet Set;		
-		if( !Node )
+		if( !Node.Valid() )
 			return Set;
 
-		Set.Set.reserve( Node->Objects.size() );
+		Set.Set.reserve( Node.Size() );
 		
-		for( const auto& Object : Node->Objects )
+		for( const auto& Object : Node )
 		{
-			Set.Set.insert_or_assign( Object->Key, Object->Value );
+			Set.Set.insert_or_assign( std::string( Object.Key(), Object.KeyLength() ), std::string( Object.Value(), Object.ValueLength() ) );
 		}
 
 		return Set;
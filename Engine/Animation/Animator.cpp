@@ -436,6 +436,28 @@ void Animator::Update( Instance& Data, const double& DeltaTime, const bool& Forc
 }
 
 static const std::string BoneLocationNamePrefix = "Bones[";
+
+// Amount of bone uniform names that are interned up front.
+constexpr size_t BoneLocationNames = 128;
+
+static UniformId GetBoneLocationName( const size_t Index )
+{
+	static const auto Names = [] ()
+	{
+		std::vector<UniformId> Names( BoneLocationNames );
+		for( size_t Bone = 0; Bone < BoneLocationNames; Bone++ )
+		{
+			Names[Bone] = UniformName::Intern( BoneLocationNamePrefix + std::to_string( Bone ) + "]" );
+		}
+
+		return Names;
+	}();
+
+	if( Index < BoneLocationNames )
+		return Names[Index];
+
+	return UniformName::Intern( BoneLocationNamePrefix + std::to_string( Index ) + "]" );
+}
 void Animator::Submit( const Instance& Data, CRenderable* Target )
 {
 	if( !Target )
@@ -453,8 +475,7 @@ void Animator::Submit( const Instance& Data, CRenderable* Target )
 
 	for( size_t MatrixIndex = 0; MatrixIndex < Data.Bones.size(); MatrixIndex++ )
 	{
-		const std::string BoneLocationName = BoneLocationNamePrefix + std::to_string( MatrixIndex ) + "]";
-		Target->SetUniform( BoneLocationName, Data.Bones[MatrixIndex].BoneTransform );
+		Target->SetUniform( GetBoneLocationName( MatrixIndex ), Data.Bones[MatrixIndex].BoneTransform );
 	}
 }
 
@@ -873,8 +894,7 @@ void Animator::Traverse( Instance& Data, const Skeleton& Skeleton, const Bone* P
 			continue; // A mask has been specified, but the mask bone is nowhere in the current hierarchy.
 
 #if defined( DevelopmentBuild )
-		CProfiler& Profiler = CProfiler::Get();
-		Profiler.AddCounterEntry( ProfileTimeEntry( "Animation Stack Evaluation", 1 ), true );
+		ProfileCounter( "Animation Stack Evaluation", 1 );
 #endif
 
 		float Time = Entry.Time;
@@ -24,6 +24,7 @@
 #endif
 
 #include <filesystem>
+#include <sstream>
 #include <stack>
 
 #include <Engine/Profiling/Logging.h>
@@ -31,6 +32,7 @@
 #include <Engine/Audio/SoLoudSound.h>
 #include <Engine/Display/Window.h>
 #include <Engine/Display/UserInterface.h>
+#include <Engine/Display/Rendering/TextureStreaming.h>
 #include <Engine/Configuration/Configuration.h>
 
 #include <Engine/Profiling/Profiling.h>
@@ -41,8 +43,11 @@
 #include <Engine/Utility/File.h>
 #include <Engine/Utility/MeshBuilder.h>
 #include <Engine/Utility/Script/AngelEngine.h>
+#include <Engine/Utility/JobSystem.h>
+#include <Engine/Utility/Test.h>
 #include <Engine/Utility/Thread.h>
 #include <Engine/Utility/ThreadPool.h>
+#include <Engine/World/Entity/LightEntity/LightEntity.h>
 #include <Engine/World/World.h>
 
 #include <Game/Game.h>
@@ -924,8 +929,13 @@ void CApplication::Run()
 	GameLayersInstance->Shutdown();
 	delete GameLayersInstance;
 
+	// Static GPU resources have to be released before the context is destroyed.
+	LightEntity::Shutdown();
+
 	MainWindow.Terminate();
 	SoLoudSound::Shutdown();
+	TextureStreaming::Shutdown();
+	JobSystem::Shutdown();
 	ThreadPool::Shutdown();
 }
 
@@ -1261,6 +1271,16 @@ void CApplication::ProcessCommandLine( int argc, char ** argv )
 				exit( 1337 );
 			}
 		}
+		else if( strcmp( argv[Index], "-test" ) == 0 )
+		{
+			RedirectLogToConsole();
+
+			// Runs the engine tests and benchmarks headless, the next argument filters by name.
+			const std::string Filter = Index + 1 < argc && argv[Index + 1][0] != '-' ? argv[Index + 1] : "all";
+			const bool Success = Tests::Run( Filter );
+
+			exit( Success ? 0 : 1 );
+		}
 		else if( strcmp( argv[Index], "-waitforinput" ) == 0 )
 		{
 			WaitForInput = true;
@@ -1568,11 +1588,14 @@ void CApplication::Initialize()
 	ServiceRegistry.CreateStandardServices();
 
 	// Initialize the symbol pool.
-	NamePool::Get().Pool();
+	NamePool::Get();
 
 	// Configure the thread pool.
 	ThreadPool::Initialize();
 
+	// Spin up the job workers.
+	JobSystem::Initialize();
+
 	// Calling Get creates the instance and initializes the class.
 	CConfiguration& Configuration = CConfiguration::Get();
 
@@ -22,6 +22,8 @@
 
 #include <Game/Game.h>
 
+#include <sstream>
+
 #if defined( IMGUI_ENABLED )
 #include <ThirdParty/imgui-1.70/imgui.h>
 #endif
@@ -1104,10 +1106,12 @@ void StringUI()
 			ImGui::Separator();
 			ImGui::Separator();
 
-			for( const auto& Pair : NamePool::Get().Pool() )
+			const auto& Pool = NamePool::Get();
+			const auto Size = static_cast<NameIndex>( Pool.Size() );
+			for( NameIndex Index = 0; Index < Size; Index++ )
 			{
-				ImGui::Text( Pair.first.c_str() ); ImGui::NextColumn();
-				ImGui::Text( "%i", Pair.second ); ImGui::NextColumn();
+				ImGui::Text( Pool.String( Index )->c_str() ); ImGui::NextColumn();
+				ImGui::Text( "%i", Index ); ImGui::NextColumn();
 				ImGui::Separator();
 			}
 
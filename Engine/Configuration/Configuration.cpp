@@ -276,6 +276,24 @@ void CConfiguration::ReloadIfModified()
 	}
 }
 
+template<typename T>
+void CConfiguration::Store( const std::string& KeyName, const T& Value )
+{
+	std::stringstream Stream;
+	Stream << Value;
+	Store( KeyName, Stream.str() );
+}
+
+template void CConfiguration::Store( const std::string&, const bool& );
+template void CConfiguration::Store( const std::string&, const int& );
+template void CConfiguration::Store( const std::string&, const unsigned int& );
+template void CConfiguration::Store( const std::string&, const long& );
+template void CConfiguration::Store( const std::string&, const unsigned long& );
+template void CConfiguration::Store( const std::string&, const long long& );
+template void CConfiguration::Store( const std::string&, const unsigned long long& );
+template void CConfiguration::Store( const std::string&, const float& );
+template void CConfiguration::Store( const std::string&, const double& );
+
 void CConfiguration::Store( const std::string& KeyName, const std::string& Value )
 {
 	StoredSettings.insert_or_assign( KeyName, Value );
@@ -50,13 +50,9 @@ public:
 
 	void ReloadIfModified();
 
+	// Formats the value in Configuration.cpp, it is instantiated for the arithmetic types.
 	template<typename T>
-	void Store( const std::string& KeyName, const T& Value )
-	{
-		std::stringstream Stream;
-		Stream << Value;
-		Store( KeyName, Stream.str() );
-	}
+	void Store( const std::string& KeyName, const T& Value );
 
 	void Store( const std::string& KeyName, const std::string& Value );
 
@@ -1,11 +1,177 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "Culling.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+
+#include <Engine/Configuration/Configuration.h>
 #include <Engine/Display/Rendering/Camera.h>
 #include <Engine/Display/Rendering/Renderable.h>
+#include <Engine/Utility/JobSystem.h>
+
+ConfigurationVariable<bool> ParallelCulling( "render.ParallelCulling", true );
+
+// Amount of boxes that are tested per job, has to be a multiple of four.
+constexpr size_t CullingBlockSize = 4096;
+
+// Identifier of the last culling pass that was started.
+static std::atomic<uint32_t> LastPass{ 0 };
+
+void CullingBounds::Clear()
+{
+	Count = 0;
+	CenterX.clear();
+	CenterY.clear();
+	CenterZ.clear();
+	SizeX.clear();
+	SizeY.clear();
+	SizeZ.clear();
+	Radius.clear();
+}
+
+void CullingBounds::Add( const BoundingBox& Bounds )
+{
+	// Grow four entries at a time so that the last load stays within the arrays.
+	if( Count % 4 == 0 )
+	{
+		const size_t Padded = Count + 4;
+		CenterX.resize( Padded, 0.0f );
+		CenterY.resize( Padded, 0.0f );
+		CenterZ.resize( Padded, 0.0f );
+		SizeX.resize( Padded, 0.0f );
+		SizeY.resize( Padded, 0.0f );
+		SizeZ.resize( Padded, 0.0f );
+		Radius.resize( Padded, -FLT_MAX );
+	}
+
+	// Calculated the same way as the per-object tests so that both paths agree.
+	const auto Center = Bounds.Center();
+	const auto Size = Bounds.Size();
+	CenterX[Count] = Center.X;
+	CenterY[Count] = Center.Y;
+	CenterZ[Count] = Center.Z;
+	SizeX[Count] = Size.X;
+	SizeY[Count] = Size.Y;
+	SizeZ[Count] = Size.Z;
+	Radius[Count] = Size.Length() * 0.5f;
+	Count++;
+}
 
 namespace Culling
 {
+	// Frustum planes broadcast across all four lanes.
+	struct PlaneLanes
+	{
+		__m128 NormalX[::Frustum::Maximum];
+		__m128 NormalY[::Frustum::Maximum];
+		__m128 NormalZ[::Frustum::Maximum];
+		__m128 AbsoluteX[::Frustum::Maximum];
+		__m128 AbsoluteY[::Frustum::Maximum];
+		__m128 AbsoluteZ[::Frustum::Maximum];
+		__m128 Distance[::Frustum::Maximum];
+	};
+
+	// Writes the visible indices of the given range to the output, returns the amount that was written.
+	size_t CullRange( const PlaneLanes& Planes, const CullingBounds& Bounds, const size_t Start, const size_t End, uint32_t* Output )
+	{
+		size_t Written = 0;
+		for( size_t Index = Start; Index < End; Index += 4 )
+		{
+			const __m128 CenterX = _mm_loadu_ps( Bounds.CenterX.data() + Index );
+			const __m128 CenterY = _mm_loadu_ps( Bounds.CenterY.data() + Index );
+			const __m128 CenterZ = _mm_loadu_ps( Bounds.CenterZ.data() + Index );
+			const __m128 SizeX = _mm_loadu_ps( Bounds.SizeX.data() + Index );
+			const __m128 SizeY = _mm_loadu_ps( Bounds.SizeY.data() + Index );
+			const __m128 SizeZ = _mm_loadu_ps( Bounds.SizeZ.data() + Index );
+			const __m128 Radius = _mm_loadu_ps( Bounds.Radius.data() + Index );
+
+			__m128 Culled = _mm_setzero_ps();
+			for( int Side = 0; Side < ::Frustum::Maximum; Side++ )
+			{
+				// Same order of operations as Vector3D::Dot.
+				__m128 Distance = _mm_mul_ps( Planes.NormalX[Side], CenterX );
+				Distance = _mm_add_ps( Distance, _mm_mul_ps( Planes.NormalY[Side], CenterY ) );
+				Distance = _mm_add_ps( Distance, _mm_mul_ps( Planes.NormalZ[Side], CenterZ ) );
+				Distance = _mm_add_ps( Distance, Planes.Distance[Side] );
+
+				__m128 Extent = _mm_mul_ps( SizeX, Planes.AbsoluteX[Side] );
+				Extent = _mm_add_ps( Extent, _mm_mul_ps( SizeY, Planes.AbsoluteY[Side] ) );
+				Extent = _mm_add_ps( Extent, _mm_mul_ps( SizeZ, Planes.AbsoluteZ[Side] ) );
+
+				// Sphere test followed by the box test.
+				Culled = _mm_or_ps( Culled, _mm_cmpgt_ps( Distance, Radius ) );
+				Culled = _mm_or_ps( Culled, _mm_cmpgt_ps( Distance, Extent ) );
+			}
+
+			const int Visible = ~_mm_movemask_ps( Culled ) & 0xF;
+			if( !Visible )
+				continue;
+
+			const size_t Lanes = End - Index < 4 ? End - Index : 4;
+			for( size_t Lane = 0; Lane < Lanes; Lane++ )
+			{
+				if( Visible & ( 1 << Lane ) )
+				{
+					Output[Written++] = static_cast<uint32_t>( Index + Lane );
+				}
+			}
+		}
+
+		return Written;
+	}
+
+	void Frustum( const ::Frustum& Frustum, const CullingBounds& Bounds, std::vector<uint32_t>& Visible )
+	{
+		const size_t Count = Bounds.Size();
+		Visible.resize( Count );
+		if( Count == 0 )
+			return;
+
+		PlaneLanes Planes;
+		for( int Side = 0; Side < ::Frustum::Maximum; Side++ )
+		{
+			const auto& Plane = Frustum.Plane[Side];
+			Planes.NormalX[Side] = _mm_set1_ps( Plane.Normal.X );
+			Planes.NormalY[Side] = _mm_set1_ps( Plane.Normal.Y );
+			Planes.NormalZ[Side] = _mm_set1_ps( Plane.Normal.Z );
+			Planes.AbsoluteX[Side] = _mm_set1_ps( Math::Abs( Plane.Normal.X ) );
+			Planes.AbsoluteY[Side] = _mm_set1_ps( Math::Abs( Plane.Normal.Y ) );
+			Planes.AbsoluteZ[Side] = _mm_set1_ps( Math::Abs( Plane.Normal.Z ) );
+			Planes.Distance[Side] = _mm_set1_ps( Plane.Distance );
+		}
+
+		const size_t Blocks = ( Count + CullingBlockSize - 1 ) / CullingBlockSize;
+		if( Blocks < 2 || !ParallelCulling || !JobSystem::IsInitialized() )
+		{
+			Visible.resize( CullRange( Planes, Bounds, 0, Count, Visible.data() ) );
+			return;
+		}
+
+		// Each block writes to its own section of the output, the sections are compacted afterwards.
+		std::vector<size_t> Written( Blocks );
+		JobSystem::ParallelFor( Blocks, 1, [&] ( const size_t Start, const size_t End )
+			{
+				for( size_t Block = Start; Block < End; Block++ )
+				{
+					const size_t First = Block * CullingBlockSize;
+					const size_t Last = First + CullingBlockSize < Count ? First + CullingBlockSize : Count;
+					Written[Block] = CullRange( Planes, Bounds, First, Last, Visible.data() + First );
+				}
+			}
+		);
+
+		size_t Total = Written[0];
+		for( size_t Block = 1; Block < Blocks; Block++ )
+		{
+			const auto* Section = Visible.data() + Block * CullingBlockSize;
+			std::copy( Section, Section + Written[Block], Visible.data() + Total );
+			Total += Written[Block];
+		}
+
+		Visible.resize( Total );
+	}
+
 	bool SphereCull( const CCamera& Camera, const BoundingBox& Bounds )
 	{
 		const auto& Frustum = Camera.GetFrustum();
@@ -61,6 +227,11 @@ namespace Culling
 		}
 	}
 
+	bool Frustum( const ::Frustum& Frustum, const BoundingBox& Bounds )
+	{
+		return Frustum.Contains( Bounds.Center(), Bounds.Size().Length() * 0.5f ) && Frustum.Contains( Bounds );
+	}
+
 	bool Frustum( const CCamera& Camera, const BoundingBox& Bounds )
 	{
 		return SphereCull( Camera, Bounds ) && BoxCull( Camera, Bounds );
@@ -71,11 +242,48 @@ namespace Culling
 		CombinedCull( Camera, Renderable );
 	}
 
-	void Frustum( const CCamera& Camera, const std::vector<CRenderable*>& Renderables )
+	void Frustum( const CCamera& Camera, const std::vector<CRenderable*>& Renderables, const uint32_t Pass )
 	{
+		// Re-used every frame to avoid allocations.
+		static thread_local CullingBounds Bounds;
+		static thread_local std::vector<CRenderable*> Candidates;
+		static thread_local std::vector<uint32_t> Visible;
+
+		Bounds.Clear();
+		Candidates.clear();
 		for( auto* Renderable : Renderables )
 		{
-			CombinedCull( Camera, Renderable );
+			auto& RenderData = Renderable->GetRenderData();
+			if( Pass != 0 && RenderData.CullingPass == Pass )
+				continue;
+
+			RenderData.ShouldRender = false;
+
+			if( RenderData.DisableRender )
+				continue;
+
+			Bounds.Add( RenderData.WorldBounds );
+			Candidates.emplace_back( Renderable );
+		}
+
+		Frustum( Camera.GetFrustum(), Bounds, Visible );
+
+		for( const auto Index : Visible )
+		{
+			Candidates[Index]->GetRenderData().ShouldRender = true;
 		}
 	}
+
+	uint32_t BeginPass()
+	{
+		auto Pass = LastPass.fetch_add( 1, std::memory_order_relaxed ) + 1;
+
+		// Skip zero when wrapping around, it is the default value of the render data.
+		if( Pass == 0 )
+		{
+			Pass = LastPass.fetch_add( 1, std::memory_order_relaxed ) + 1;
+		}
+
+		return Pass;
+	}
 }
@@ -1,15 +1,50 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 class CCamera;
 class CRenderable;
 struct BoundingBox;
+struct Frustum;
+
+// World-space bounds stored per component so that four of them can be loaded at once.
+// The arrays are padded to a multiple of four with boxes that are always culled.
+struct CullingBounds
+{
+	void Clear();
+	void Add( const BoundingBox& Bounds );
+
+	size_t Size() const
+	{
+		return Count;
+	}
+
+	std::vector<float> CenterX;
+	std::vector<float> CenterY;
+	std::vector<float> CenterZ;
+	std::vector<float> SizeX;
+	std::vector<float> SizeY;
+	std::vector<float> SizeZ;
+	std::vector<float> Radius;
+
+private:
+	size_t Count = 0;
+};
 
 namespace Culling
 {
+	// Tests four boxes at a time against the frustum and writes the indices of the visible boxes, in order.
+	// Large sets are split across the job workers.
+	void Frustum( const ::Frustum& Frustum, const CullingBounds& Bounds, std::vector<uint32_t>& Visible );
+
+	bool Frustum( const ::Frustum& Frustum, const BoundingBox& Bounds );
 	bool Frustum( const CCamera& Camera, const BoundingBox& Bounds );
 	void Frustum( const CCamera& Camera, CRenderable* Renderable );
-	void Frustum( const CCamera& Camera, const std::vector<CRenderable*>& Renderables );
+	// Skips renderables that have already been culled by a render hierarchy during the given pass, zero tests all of them.
+	void Frustum( const CCamera& Camera, const std::vector<CRenderable*>& Renderables, const uint32_t Pass = 0 );
+
+	// Starts a new culling pass, returns its identifier.
+	uint32_t BeginPass();
 }
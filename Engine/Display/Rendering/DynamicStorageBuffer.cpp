@@ -0,0 +1,253 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "DynamicStorageBuffer.h"
+
+#include <ThirdParty/glad/include/glad/glad.h>
+
+#include <cstring>
+
+static void* CreateGL( unsigned int& Handle, size_t Size, bool Persistent )
+{
+	glGenBuffers( 1, &Handle );
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, Handle );
+
+#if defined( GL_ARB_buffer_storage )
+	if( Persistent )
+	{
+		constexpr GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage( GL_SHADER_STORAGE_BUFFER, Size, nullptr, Flags );
+		return glMapBufferRange( GL_SHADER_STORAGE_BUFFER, 0, Size, Flags );
+	}
+#endif
+
+	glBufferData( GL_SHADER_STORAGE_BUFFER, Size, nullptr, GL_DYNAMIC_DRAW );
+	return nullptr;
+}
+
+static void DestroyGL( unsigned int Handle )
+{
+	glDeleteBuffers( 1, &Handle );
+}
+
+static void UploadGL( unsigned int Handle, size_t Offset, size_t Size, const void* Data )
+{
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, Handle );
+	glBufferSubData( GL_SHADER_STORAGE_BUFFER, Offset, Size, Data );
+}
+
+static void BindGL( unsigned int Handle, uint32_t Binding, size_t Offset, size_t Size )
+{
+	glBindBufferRange( GL_SHADER_STORAGE_BUFFER, Binding, Handle, Offset, Size );
+}
+
+static void* FenceGL()
+{
+	return glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+static bool WaitGL( void* Fence )
+{
+	const auto Sync = static_cast<GLsync>( Fence );
+	bool Waited = false;
+	GLenum Status = glClientWaitSync( Sync, 0, 0 );
+	while( Status == GL_TIMEOUT_EXPIRED )
+	{
+		Waited = true;
+
+		// Flush so that the fence is guaranteed to be signaled eventually.
+		Status = glClientWaitSync( Sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 );
+	}
+
+	glDeleteSync( Sync );
+	return Waited;
+}
+
+static size_t PersistentAlignmentGL()
+{
+#if defined( GL_ARB_buffer_storage )
+	if( !!GLAD_GL_ARB_buffer_storage )
+	{
+		GLint Alignment = 0;
+		glGetIntegerv( GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &Alignment );
+		return Alignment > 0 ? static_cast<size_t>( Alignment ) : 256;
+	}
+#endif
+
+	return 0;
+}
+
+static StorageBufferFunctions Functions = { CreateGL, DestroyGL, UploadGL, BindGL, FenceGL, WaitGL, PersistentAlignmentGL };
+static StorageBufferStatistics Counters;
+
+void StorageBufferDispatch::Override( const StorageBufferFunctions& Replacement )
+{
+	Functions.Create = Replacement.Create ? Replacement.Create : CreateGL;
+	Functions.Destroy = Replacement.Destroy ? Replacement.Destroy : DestroyGL;
+	Functions.Upload = Replacement.Upload ? Replacement.Upload : UploadGL;
+	Functions.Bind = Replacement.Bind ? Replacement.Bind : BindGL;
+	Functions.Fence = Replacement.Fence ? Replacement.Fence : FenceGL;
+	Functions.Wait = Replacement.Wait ? Replacement.Wait : WaitGL;
+	Functions.PersistentAlignment = Replacement.PersistentAlignment ? Replacement.PersistentAlignment : PersistentAlignmentGL;
+}
+
+StorageBufferStatistics& StorageBufferDispatch::Statistics()
+{
+	return Counters;
+}
+
+void StorageBufferDispatch::ResetStatistics()
+{
+	Counters = StorageBufferStatistics();
+}
+
+CDynamicStorageBuffer::~CDynamicStorageBuffer()
+{
+	Release();
+}
+
+void CDynamicStorageBuffer::Initialize( const size_t Count, const size_t ElementSize, const bool Persistent )
+{
+	Release();
+
+	if( Count < 1 || ElementSize < 1 )
+		return;
+
+	ElementCount = Count;
+	Stride = ElementSize;
+
+	const size_t Size = Count * Stride;
+	const size_t Alignment = Persistent ? Functions.PersistentAlignment() : 0;
+	if( Alignment > 0 )
+	{
+		RegionSize = ( ( Size + Alignment - 1 ) / Alignment ) * Alignment;
+		Mapped = static_cast<uint8_t*>( Functions.Create( Handle, RegionSize * RingSize, true ) );
+	}
+
+	if( !Mapped )
+	{
+		if( Handle )
+		{
+			Functions.Destroy( Handle );
+			Handle = 0;
+		}
+
+		RegionSize = Size;
+		Functions.Create( Handle, Size, false );
+	}
+
+	Dirty.resize( Count );
+	MarkDirty();
+}
+
+void CDynamicStorageBuffer::Release()
+{
+	for( auto& Fence : Fences )
+	{
+		if( Fence )
+		{
+			Functions.Wait( Fence );
+			Fence = nullptr;
+		}
+	}
+
+	if( Handle )
+	{
+		Functions.Destroy( Handle );
+	}
+
+	Handle = 0;
+	Mapped = nullptr;
+	ElementCount = 0;
+	RegionSize = 0;
+	Region = 0;
+	Dirty.clear();
+	Pending = false;
+}
+
+void CDynamicStorageBuffer::MarkDirty( const size_t Index )
+{
+	if( Index >= Dirty.size() )
+		return;
+
+	// Every copy in the ring has to be updated eventually.
+	Dirty[Index] = Mapped ? ( 1 << RingSize ) - 1 : 1;
+	Pending = true;
+}
+
+void CDynamicStorageBuffer::MarkDirty()
+{
+	for( size_t Index = 0; Index < Dirty.size(); Index++ )
+	{
+		MarkDirty( Index );
+	}
+}
+
+size_t CDynamicStorageBuffer::Upload( const void* Data )
+{
+	if( !Pending || !Handle || !Data )
+		return 0;
+
+	Pending = false;
+
+	if( Mapped )
+	{
+		// Draws that were issued until now read from the current region, move on to the next one.
+		Fences[Region] = Functions.Fence();
+		Region = ( Region + 1 ) % RingSize;
+
+		if( Fences[Region] )
+		{
+			if( Functions.Wait( Fences[Region] ) )
+			{
+				Counters.Waits++;
+			}
+
+			Fences[Region] = nullptr;
+		}
+	}
+
+	const auto* Source = static_cast<const uint8_t*>( Data );
+	const uint8_t Bit = static_cast<uint8_t>( 1 << Region );
+	size_t Bytes = 0;
+	size_t Index = 0;
+	while( Index < ElementCount )
+	{
+		if( !( Dirty[Index] & Bit ) )
+		{
+			Index++;
+			continue;
+		}
+
+		// Extend the range over the adjacent dirty elements.
+		const size_t First = Index;
+		while( Index < ElementCount && ( Dirty[Index] & Bit ) )
+		{
+			Dirty[Index] &= ~Bit;
+			Index++;
+		}
+
+		const size_t Offset = First * Stride;
+		const size_t Size = ( Index - First ) * Stride;
+		if( Mapped )
+		{
+			std::memcpy( Mapped + Region * RegionSize + Offset, Source + Offset, Size );
+		}
+		else
+		{
+			Functions.Upload( Handle, Offset, Size, Source + Offset );
+		}
+
+		Bytes += Size;
+		Counters.Ranges++;
+	}
+
+	Counters.Bytes += static_cast<int64_t>( Bytes );
+	return Bytes;
+}
+
+void CDynamicStorageBuffer::Bind( const uint32_t Binding ) const
+{
+	if( !Handle )
+		return;
+
+	Functions.Bind( Handle, Binding, Region * RegionSize, ElementCount * Stride );
+}
@@ -0,0 +1,98 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct StorageBufferStatistics
+{
+	// Bytes written to storage buffers.
+	int64_t Bytes = 0;
+
+	// Contiguous ranges that were written.
+	int64_t Ranges = 0;
+
+	// Times a region of a ring had to wait for the GPU before it could be written.
+	int64_t Waits = 0;
+};
+
+// Entry points used to talk to GL, these can be replaced to record buffer traffic without a GPU.
+struct StorageBufferFunctions
+{
+	// Returns the mapped storage when the buffer is persistent, null otherwise.
+	void*( *Create )( unsigned int& Handle, size_t Size, bool Persistent ) = nullptr;
+	void( *Destroy )( unsigned int Handle ) = nullptr;
+	void( *Upload )( unsigned int Handle, size_t Offset, size_t Size, const void* Data ) = nullptr;
+	void( *Bind )( unsigned int Handle, uint32_t Binding, size_t Offset, size_t Size ) = nullptr;
+
+	// Fence that is signaled once the GPU has finished the commands issued before it.
+	void*( *Fence )() = nullptr;
+
+	// Blocks until the fence has been signaled and deletes it, returns false if it was already signaled.
+	bool( *Wait )( void* Fence ) = nullptr;
+
+	// Offset alignment of persistent rings, zero when persistent mapping isn't supported.
+	size_t( *PersistentAlignment )() = nullptr;
+};
+
+namespace StorageBufferDispatch
+{
+	// Replaces the GL entry points, passing empty functions restores the defaults.
+	void Override( const StorageBufferFunctions& Functions );
+
+	// Counters since the last reset, the renderer resets them every frame.
+	StorageBufferStatistics& Statistics();
+	void ResetStatistics();
+}
+
+// Storage buffer that only uploads the elements that have been marked as dirty, adjacent elements are written as one range.
+// When persistent mapping is supported the buffer holds a ring of copies and writes go to a copy that the GPU isn't reading.
+class CDynamicStorageBuffer
+{
+public:
+	static constexpr size_t RingSize = 3;
+
+	CDynamicStorageBuffer() = default;
+	~CDynamicStorageBuffer();
+
+	CDynamicStorageBuffer( const CDynamicStorageBuffer& ) = delete;
+	CDynamicStorageBuffer& operator=( const CDynamicStorageBuffer& ) = delete;
+
+	// Creates storage for the elements and marks all of them as dirty.
+	void Initialize( const size_t Count, const size_t ElementSize, const bool Persistent = true );
+	void Release();
+
+	void MarkDirty( const size_t Index );
+	void MarkDirty();
+
+	// Writes the dirty elements of the given array, returns the amount of bytes written.
+	size_t Upload( const void* Data );
+
+	void Bind( const uint32_t Binding = 0 ) const;
+
+	bool IsPersistent() const
+	{
+		return Mapped != nullptr;
+	}
+
+	size_t Count() const
+	{
+		return ElementCount;
+	}
+
+private:
+	unsigned int Handle = 0;
+	size_t ElementCount = 0;
+	size_t Stride = 0;
+
+	// Persistent ring storage, each region holds a full copy of the elements.
+	uint8_t* Mapped = nullptr;
+	size_t RegionSize = 0;
+	size_t Region = 0;
+	void* Fences[RingSize]{};
+
+	// One bit per region, set when the copy of the element in that region is outdated.
+	std::vector<uint8_t> Dirty;
+	bool Pending = false;
+};
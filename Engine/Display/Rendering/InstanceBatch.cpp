@@ -0,0 +1,176 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "InstanceBatch.h"
+
+#include <Engine/Display/Rendering/Renderable.h>
+#include <Engine/Display/Rendering/Shader.h>
+
+static bool IsFlipped( const FRenderData& RenderData )
+{
+	const auto& Size = RenderData.Transform.GetSize();
+	return Size.X < 0.0f || Size.Y < 0.0f || Size.Z < 0.0f;
+}
+
+static bool IsInstanced( CRenderable* Renderable )
+{
+	auto* Shader = Renderable->GetShader();
+	return Shader && Shader->IsInstanced() && Renderable->GetMesh() && !Renderable->HasSkeleton;
+}
+
+static bool SameUniforms( const UniformMap& A, const UniformMap& B )
+{
+	if( A.Size() != B.Size() )
+		return false;
+
+	auto Iterator = B.begin();
+	for( const auto& Entry : A )
+	{
+		if( Entry.first != Iterator->first || !Entry.second.Equals( Iterator->second ) )
+			return false;
+
+		++Iterator;
+	}
+
+	return true;
+}
+
+bool InstanceBatch::Compatible( CRenderable* First, CRenderable* Renderable )
+{
+	if( !IsInstanced( First ) || !IsInstanced( Renderable ) )
+		return false;
+
+	if( First->GetShader() != Renderable->GetShader() || First->GetMesh() != Renderable->GetMesh() )
+		return false;
+
+	const auto& A = First->GetRenderData();
+	const auto& B = Renderable->GetRenderData();
+	if( !B.ShouldRender || A.DrawMode != B.DrawMode || A.DoubleSided != B.DoubleSided )
+		return false;
+
+	if( A.StencilTest != B.StencilTest || A.StencilValue != B.StencilValue || A.StencilWrite != B.StencilWrite )
+		return false;
+
+	// Mirrored instances need a different winding order.
+	if( IsFlipped( A ) || IsFlipped( B ) )
+		return false;
+
+	// Only the uniforms of the first renderable are bound.
+	return First->SharesTextures( Renderable ) && SameUniforms( First->GetUniforms(), Renderable->GetUniforms() );
+}
+
+static void Pack( CRenderable* Renderable, FInstanceData& Instance )
+{
+	auto& RenderData = Renderable->GetRenderData();
+	Instance.Model = RenderData.Transform.GetTransformationMatrix();
+	Instance.Color = RenderData.Color;
+
+	const auto Position = RenderData.Transform.GetPosition();
+	Instance.Position = Vector4D( Position.X, Position.Y, Position.Z, 1.0f );
+
+	for( size_t Index = 0; Index < 4; Index++ )
+	{
+		Instance.LightIndices[Index] = RenderData.LightIndex.Index[Index];
+	}
+}
+
+void InstanceBatch::Build( const std::vector<CRenderable*>& Renderables, std::vector<FInstanceBatch>& Batches, std::vector<FInstanceData>& Instances )
+{
+	Batches.clear();
+	Instances.clear();
+
+	const auto Count = static_cast<uint32_t>( Renderables.size() );
+	for( uint32_t Index = 0; Index < Count; )
+	{
+		auto* First = Renderables[Index];
+
+		FInstanceBatch Batch;
+		Batch.First = Index++;
+		Batch.Instanced = First->GetRenderData().ShouldRender && IsInstanced( First );
+
+		if( Batch.Instanced )
+		{
+			Batch.InstanceOffset = static_cast<uint32_t>( Instances.size() );
+			Instances.emplace_back();
+			Pack( First, Instances.back() );
+
+			// Skip over culled renderables, they don't break up the batch.
+			while( Index < Count )
+			{
+				auto* Renderable = Renderables[Index];
+				if( Renderable->GetRenderData().ShouldRender )
+				{
+					if( !Compatible( First, Renderable ) )
+						break;
+
+					Instances.emplace_back();
+					Pack( Renderable, Instances.back() );
+				}
+
+				Index++;
+			}
+
+			Batch.Count = static_cast<uint32_t>( Instances.size() ) - Batch.InstanceOffset;
+		}
+
+		Batches.emplace_back( Batch );
+	}
+}
+
+void InstanceBatch::Submit( const std::vector<CRenderable*>& Renderables, const std::vector<FInstanceBatch>& Batches, const bool Instancing, const DrawFunction& Draw )
+{
+	if( !Instancing )
+	{
+		for( auto* Renderable : Renderables )
+		{
+			if( Renderable->GetRenderData().ShouldRender )
+			{
+				Draw( Renderable, 1, -1 );
+			}
+		}
+
+		return;
+	}
+
+	for( const auto& Batch : Batches )
+	{
+		auto* Renderable = Renderables[Batch.First];
+		if( !Renderable->GetRenderData().ShouldRender )
+			continue;
+
+		Draw( Renderable, Batch.Count, Batch.Instanced ? static_cast<int32_t>( Batch.InstanceOffset ) : -1 );
+	}
+}
+
+CInstanceBuffer::~CInstanceBuffer()
+{
+	if( Handle )
+	{
+		glDeleteBuffers( 1, &Handle );
+	}
+}
+
+void CInstanceBuffer::Upload( const std::vector<FInstanceData>& Instances )
+{
+	if( Instances.empty() )
+		return;
+
+	if( !Handle )
+	{
+		glGenBuffers( 1, &Handle );
+	}
+
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, Handle );
+
+	if( Instances.size() > Capacity )
+	{
+		Capacity = Instances.size() + Instances.size() / 2;
+	}
+
+	// Orphan the previous contents, draws that are still in flight keep their own copy.
+	glBufferData( GL_SHADER_STORAGE_BUFFER, Capacity * sizeof( FInstanceData ), nullptr, GL_STREAM_DRAW );
+	glBufferSubData( GL_SHADER_STORAGE_BUFFER, 0, Instances.size() * sizeof( FInstanceData ), Instances.data() );
+}
+
+void CInstanceBuffer::Bind() const
+{
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, InstanceBufferBinding, Handle );
+}
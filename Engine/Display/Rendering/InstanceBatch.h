@@ -0,0 +1,70 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <ThirdParty/glad/include/glad/glad.h>
+
+#include <Engine/Utility/Math.h>
+
+class CRenderable;
+
+// Shader storage binding that instanced shaders read their per-instance data from, see the #instanced directive.
+constexpr uint32_t InstanceBufferBinding = 1;
+
+// Per-object data that would otherwise be uploaded as uniforms, laid out to match std430.
+struct FInstanceData
+{
+	Matrix4D Model;
+	Vector4D Color;
+	Vector4D Position;
+	int32_t LightIndices[4];
+};
+
+static_assert( sizeof( FInstanceData ) == 112, "Instance data has to match the std430 layout of the shader." );
+
+// Consecutive range of renderables that is submitted with a single draw call.
+struct FInstanceBatch
+{
+	uint32_t First = 0;
+	uint32_t Count = 1;
+
+	// Index of the first instance in the instance buffer.
+	uint32_t InstanceOffset = 0;
+
+	// Set when the renderables use an instanced shader, which reads its transforms from the instance buffer.
+	bool Instanced = false;
+};
+
+namespace InstanceBatch
+{
+	// Returns true when the renderable can be drawn as another instance of the batch that starts with First.
+	bool Compatible( CRenderable* First, CRenderable* Renderable );
+
+	// Groups consecutive compatible renderables, the render order is preserved.
+	// Visible renderables that use an instanced shader have their data packed into Instances.
+	void Build( const std::vector<CRenderable*>& Renderables, std::vector<FInstanceBatch>& Batches, std::vector<FInstanceData>& Instances );
+
+	// Calls Draw for every draw call that the renderables are submitted with, culled renderables are skipped.
+	// The instance offset is -1 when the renderable doesn't read from the instance buffer. Batches are ignored without instancing.
+	using DrawFunction = std::function<void( CRenderable* Renderable, const uint32_t Instances, const int32_t InstanceOffset )>;
+	void Submit( const std::vector<CRenderable*>& Renderables, const std::vector<FInstanceBatch>& Batches, const bool Instancing, const DrawFunction& Draw );
+}
+
+// Shader storage buffer that is refilled every time the instances are uploaded.
+class CInstanceBuffer
+{
+public:
+	~CInstanceBuffer();
+
+	void Upload( const std::vector<FInstanceData>& Instances );
+	void Bind() const;
+
+private:
+	GLuint Handle = 0;
+
+	// Amount of instances that fit in the buffer.
+	size_t Capacity = 0;
+};
@@ -0,0 +1,255 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "LightGrid.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Cells are half of the cull distance wide, a light covers at most five cells per axis.
+constexpr float CellScale = 0.5f;
+
+// Limits the size of the grid when lights are spread far apart.
+constexpr int32_t MaximumDimension = 64;
+
+// Widens the binned area to absorb rounding, a light may be stored in a cell it can't reach but never the other way around.
+constexpr float BinningMargin = 1.01f;
+
+struct LightSelection
+{
+	int32_t Closest[4]{ -1, -1, -1, -1 };
+	float Distance = FLT_MAX;
+};
+
+// Shared by the full scan and the grid so that both pick exactly the same lights.
+// The selection depends on the order in which lights are evaluated, they have to be visited in ascending index order.
+static void Evaluate( const Light& Information, const int32_t Index, const Vector3D& Position, LightSelection& Selection )
+{
+	const auto Type = static_cast<int>( Information.Position.w );
+	if( Type < 0 )
+		return;
+
+	const Vector3D LightPosition( Information.Position.x, Information.Position.y, Information.Position.z );
+
+	// Check cone of spot lights.
+	if( Type == 1 )
+	{
+		const Vector3D Direction( Information.Direction.x, Information.Direction.y, Information.Direction.z );
+		const auto Unit = ( Position - LightPosition );
+		const auto Visibility = Unit.Dot( Direction );
+		if( Visibility < 0.5f )
+			return;
+	}
+
+	const auto LightDistance = LightPosition.DistanceSquared( Position );
+	const auto LightFactor = LightDistance - Information.Color.w * 0.1f;
+	const auto LightCullFactor = LightDistance * 0.01f;
+	if( LightCullFactor > 200.0f || Information.Color.w < 0.01f )
+		return;
+
+	if( LightFactor < Selection.Distance )
+	{
+		Selection.Distance = LightDistance;
+
+		Selection.Closest[3] = Selection.Closest[2];
+		Selection.Closest[2] = Selection.Closest[1];
+		Selection.Closest[1] = Selection.Closest[0];
+
+		Selection.Closest[0] = Index;
+	}
+}
+
+static LightIndices ToIndices( const LightSelection& Selection )
+{
+	LightIndices Indices;
+	for( size_t Index = 0; Index < 4; Index++ )
+	{
+		Indices.Index[Index] = Selection.Closest[Index];
+	}
+
+	return Indices;
+}
+
+// Lights that can never be picked don't have to be binned.
+static bool CanBePicked( const Light& Information )
+{
+	if( static_cast<int>( Information.Position.w ) < 0 )
+		return false;
+
+	if( !( Information.Color.w >= 0.01f ) )
+		return false;
+
+	return std::isfinite( Information.Position.x ) && std::isfinite( Information.Position.y ) && std::isfinite( Information.Position.z );
+}
+
+LightIndices LightGrid::Fetch( const Light* Lights, const int32_t Count, const Vector3D& Position )
+{
+	LightSelection Selection;
+	for( int32_t Index = 0; Index < Count; Index++ )
+	{
+		Evaluate( Lights[Index], Index, Position, Selection );
+	}
+
+	return ToIndices( Selection );
+}
+
+void CLightGrid::Build( const Light* Source, const int32_t Count )
+{
+	Lights = Source;
+	CellStart.clear();
+	CellLights.clear();
+	Dimensions[0] = Dimensions[1] = Dimensions[2] = 0;
+
+	const float Radius = std::sqrt( LightGrid::CullDistanceSquared ) * BinningMargin;
+
+	Vector3D Minimum( FLT_MAX );
+	Vector3D Maximum( -FLT_MAX );
+	bool Empty = true;
+	for( int32_t Index = 0; Index < Count; Index++ )
+	{
+		if( !CanBePicked( Lights[Index] ) )
+			continue;
+
+		const Vector3D Position( Lights[Index].Position.x, Lights[Index].Position.y, Lights[Index].Position.z );
+		for( size_t Axis = 0; Axis < 3; Axis++ )
+		{
+			Minimum[Axis] = std::min( Minimum[Axis], Position[Axis] - Radius );
+			Maximum[Axis] = std::max( Maximum[Axis], Position[Axis] + Radius );
+		}
+
+		Empty = false;
+	}
+
+	if( Empty )
+		return;
+
+	float Extent = 0.0f;
+	for( size_t Axis = 0; Axis < 3; Axis++ )
+	{
+		Extent = std::max( Extent, Maximum[Axis] - Minimum[Axis] );
+	}
+
+	Origin = Minimum;
+	CellSize = std::max( Radius * CellScale, Extent / static_cast<float>( MaximumDimension ) );
+	InverseCellSize = 1.0f / CellSize;
+
+	for( size_t Axis = 0; Axis < 3; Axis++ )
+	{
+		Dimensions[Axis] = static_cast<int32_t>( ( Maximum[Axis] - Origin[Axis] ) * InverseCellSize ) + 1;
+	}
+
+	const size_t CellCount = static_cast<size_t>( Dimensions[0] ) * Dimensions[1] * Dimensions[2];
+
+	// Visits every cell that the light can reach, used to count the entries and then to fill them.
+	const auto ForEachCell = [this, Radius] ( const Light& Information, auto Function )
+	{
+		const Vector3D Position( Information.Position.x, Information.Position.y, Information.Position.z );
+
+		int32_t First[3];
+		int32_t Last[3];
+		for( size_t Axis = 0; Axis < 3; Axis++ )
+		{
+			const auto Lower = static_cast<int32_t>( ( Position[Axis] - Radius - Origin[Axis] ) * InverseCellSize );
+			const auto Upper = static_cast<int32_t>( ( Position[Axis] + Radius - Origin[Axis] ) * InverseCellSize );
+			First[Axis] = std::max( 0, std::min( Lower, Dimensions[Axis] - 1 ) );
+			Last[Axis] = std::max( 0, std::min( Upper, Dimensions[Axis] - 1 ) );
+		}
+
+		// Skip the corner cells that are outside of the sphere, the cell bounds are widened by the margin as well.
+		const float Padding = CellSize * ( BinningMargin - 1.0f );
+		const float RadiusSquared = Radius * Radius;
+		for( int32_t Z = First[2]; Z <= Last[2]; Z++ )
+		{
+			for( int32_t Y = First[1]; Y <= Last[1]; Y++ )
+			{
+				for( int32_t X = First[0]; X <= Last[0]; X++ )
+				{
+					const int32_t Cell[3] = { X, Y, Z };
+					float DistanceSquared = 0.0f;
+					for( size_t Axis = 0; Axis < 3; Axis++ )
+					{
+						const float CellMinimum = Origin[Axis] + Cell[Axis] * CellSize - Padding;
+						const float CellMaximum = CellMinimum + CellSize + Padding * 2.0f;
+						const float Closest = std::max( CellMinimum, std::min( Position[Axis], CellMaximum ) );
+						const float Delta = Position[Axis] - Closest;
+						DistanceSquared += Delta * Delta;
+					}
+
+					if( DistanceSquared > RadiusSquared )
+						continue;
+
+					Function( ( static_cast<size_t>( Z ) * Dimensions[1] + Y ) * Dimensions[0] + X );
+				}
+			}
+		}
+	};
+
+	CellStart.assign( CellCount + 1, 0 );
+	for( int32_t Index = 0; Index < Count; Index++ )
+	{
+		if( !CanBePicked( Lights[Index] ) )
+			continue;
+
+		ForEachCell( Lights[Index], [this] ( const size_t Cell )
+			{
+				CellStart[Cell + 1]++;
+			}
+		);
+	}
+
+	for( size_t Cell = 0; Cell < CellCount; Cell++ )
+	{
+		CellStart[Cell + 1] += CellStart[Cell];
+	}
+
+	// Lights are added in index order which keeps the cell lists sorted.
+	CellLights.resize( CellStart[CellCount] );
+	std::vector<int32_t> Cursor( CellStart.begin(), CellStart.end() - 1 );
+	for( int32_t Index = 0; Index < Count; Index++ )
+	{
+		if( !CanBePicked( Lights[Index] ) )
+			continue;
+
+		ForEachCell( Lights[Index], [this, &Cursor, Index] ( const size_t Cell )
+			{
+				CellLights[Cursor[Cell]++] = Index;
+			}
+		);
+	}
+}
+
+LightIndices CLightGrid::Fetch( const Vector3D& Position ) const
+{
+	LightSelection Selection;
+
+	int32_t Cell[3];
+	if( !GetCell( Position, Cell ) )
+		return ToIndices( Selection );
+
+	const size_t Index = ( static_cast<size_t>( Cell[2] ) * Dimensions[1] + Cell[1] ) * Dimensions[0] + Cell[0];
+	const int32_t End = CellStart[Index + 1];
+	for( int32_t Entry = CellStart[Index]; Entry < End; Entry++ )
+	{
+		const int32_t LightIndex = CellLights[Entry];
+		Evaluate( Lights[LightIndex], LightIndex, Position, Selection );
+	}
+
+	return ToIndices( Selection );
+}
+
+bool CLightGrid::GetCell( const Vector3D& Position, int32_t Cell[3] ) const
+{
+	if( CellStart.empty() )
+		return false;
+
+	for( size_t Axis = 0; Axis < 3; Axis++ )
+	{
+		// Positions outside of the grid can't be reached by any of the lights. (also rejects NaN)
+		const float Coordinate = ( Position[Axis] - Origin[Axis] ) * InverseCellSize;
+		if( !( Coordinate >= 0.0f && Coordinate < static_cast<float>( Dimensions[Axis] ) ) )
+			return false;
+
+		Cell[Axis] = static_cast<int32_t>( Coordinate );
+	}
+
+	return true;
+}
@@ -0,0 +1,55 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Engine/Display/Rendering/Light/Light.h>
+#include <Engine/Utility/Math/Vector.h>
+
+namespace LightGrid
+{
+	// Lights that are further away than this are never picked. (squared distance)
+	constexpr float CullDistanceSquared = 20000.0f;
+
+	// Reference selection, scans every light.
+	LightIndices Fetch( const Light* Lights, const int32_t Count, const Vector3D& Position );
+}
+
+// Uniform grid that stores which lights can reach each cell.
+// Fetching only scans the lights of a single cell but returns exactly the same indices as the full scan.
+class CLightGrid
+{
+public:
+	// Bins the lights into cells, the array has to stay alive and unchanged until the next build.
+	void Build( const Light* Lights, const int32_t Count );
+
+	LightIndices Fetch( const Vector3D& Position ) const;
+
+	size_t GetCellCount() const
+	{
+		return CellStart.empty() ? 0 : CellStart.size() - 1;
+	}
+
+	// Total amount of light references stored in the cells.
+	size_t GetEntryCount() const
+	{
+		return CellLights.size();
+	}
+
+private:
+	bool GetCell( const Vector3D& Position, int32_t Cell[3] ) const;
+
+	const Light* Lights = nullptr;
+
+	Vector3D Origin;
+	float CellSize = 1.0f;
+	float InverseCellSize = 1.0f;
+	int32_t Dimensions[3]{ 0, 0, 0 };
+
+	// Offsets into the light list, one per cell plus the end offset.
+	std::vector<int32_t> CellStart;
+
+	// Light indices of each cell, in ascending order.
+	std::vector<int32_t> CellLights;
+};
@@ -6,7 +6,7 @@
 #include <Engine/Display/Window.h>
 #include <Engine/Resource/Assets.h>
 #include <Engine/Utility/File.h>
-#include <Engine/Utility/Structures/JSON.h>
+#include <Engine/Utility/Structures/JSONDocument.h>
 #include <Engine/Utility/TranslationTable.h>
 
 void Material::Apply( CRenderable* Renderable ) const
@@ -336,12 +336,12 @@ std::string PhysicalSurfaceToString( const PhysicalSurface From )
 	return ConvertSurfaceString.From( From );
 }
 
-Material ConfigureMaterial( const JSON::Container& Container )
+Material ConfigureMaterial( const JSON::Node& Root )
 {
 	Material Material;
 
-	JSON::Assign( Container.Tree, "name", Material.Name );
-	JSON::Assign( Container.Tree, "shader", Material.Shader );
+	Root.Assign( "name", Material.Name );
+	Root.Assign( "shader", Material.Shader );
 
 	// Append the defaults of the shader.
 	CShader* ShaderObject = CAssets::Get().Shaders.Find( Material.Shader );
@@ -357,50 +357,44 @@ Material ConfigureMaterial( const JSON::Container& Container )
 	}
 
 	// Check if the material wants to be double sided.
-	JSON::Assign( Container.Tree, "twoside", Material.DoubleSided );
-	JSON::Assign( Container.Tree, "doublesided", Material.DoubleSided );
+	Root.Assign( "twoside", Material.DoubleSided );
+	Root.Assign( "doublesided", Material.DoubleSided );
 
-	if( auto* Object = JSON::Find( Container.Tree, "surface" ) )
+	std::string Surface;
+	if( Root.Assign( "surface", Surface ) )
 	{
-		Material.Surface = StringToPhysicalSurface( Object->Value );
+		Material.Surface = StringToPhysicalSurface( Surface );
 	}
 
-	if( auto* Object = JSON::Find( Container.Tree, "textures" ) )
+	for( const auto& Texture : Root.Find( "textures" ) )
 	{
-		for( auto* Texture : Object->Objects )
-		{
-			Material.Textures.emplace_back();
-			Material.Textures.back() = Texture->Key;
-		}
+		Material.Textures.emplace_back( Texture.Value(), Texture.ValueLength() );
 	}
 
-	if( auto* Object = JSON::Find( Container.Tree, "uniforms" ) )
+	for( const auto& Uniform : Root.Find( "uniforms" ) )
 	{
-		for( auto* Uniform : Object->Objects )
-		{
-			// TODO: Figure out loading uniforms.
-			Vector4D Temporary = {};
-			const auto Count = Extract( Uniform->Value, Temporary );
+		// TODO: Figure out loading uniforms.
+		Vector4D Temporary = {};
+		const auto Count = Extract( Uniform.Value(), Temporary );
 
-			Material.Uniforms.emplace_back();
-			Material.Uniforms.back().first = Uniform->Key;
+		Material.Uniforms.emplace_back();
+		Material.Uniforms.back().first.assign( Uniform.Key(), Uniform.KeyLength() );
 
-			// Pick the uniform constructor based on the amount of components that were retrieved.
-			switch( Count )
-			{
-			case 1: // float
-				Material.Uniforms.back().second.Set( Temporary.X );
-				break;
-			case 2: // vec3 (with zero for Z)
-				Material.Uniforms.back().second.Set( Vector3D( Temporary.X, Temporary.Y, 0.0 ) );
-				break;
-			case 3: // vec3
-				Material.Uniforms.back().second.Set( Vector3D( Temporary.X, Temporary.Y, Temporary.Z ) );
-				break;
-			default: // assume vec4
-				Material.Uniforms.back().second.Set( Temporary );
-				break;
-			}
+		// Pick the uniform constructor based on the amount of components that were retrieved.
+		switch( Count )
+		{
+		case 1: // float
+			Material.Uniforms.back().second.Set( Temporary.X );
+			break;
+		case 2: // vec3 (with zero for Z)
+			Material.Uniforms.back().second.Set( Vector3D( Temporary.X, Temporary.Y, 0.0 ) );
+			break;
+		case 3: // vec3
+			Material.Uniforms.back().second.Set( Vector3D( Temporary.X, Temporary.Y, Temporary.Z ) );
+			break;
+		default: // assume vec4
+			Material.Uniforms.back().second.Set( Temporary );
+			break;
 		}
 	}
 
@@ -418,8 +412,10 @@ Material LoadMaterial( const std::string& Location )
 
 	// Set up the material itself.
 	File.Load();
-	auto Tree = JSON::Tree( File );
-	return ConfigureMaterial( Tree );
+
+	JSON::Document Document;
+	Document.Parse( File );
+	return ConfigureMaterial( Document.Root() );
 }
 
 void MaterialAsset::Reload()
@@ -2,6 +2,7 @@
 #include "Mesh.h"
 
 #include <Engine/Display/Window.h>
+#include <Engine/Physics/TriangleTree.h>
 #include <Engine/Display/Rendering/Vertex.h>
 #include <Engine/Profiling/Logging.h>
 #include <Engine/Profiling/Profiling.h>
@@ -64,6 +65,9 @@ bool CMesh::IsValid() const
 
 bool CMesh::Populate( const FPrimitive& Primitive )
 {
+	// The collision tree has to be rebuilt for the new geometry.
+	CollisionTree = nullptr;
+
 	// Always try to generate the bounding box.
 	ComputeAABB( Primitive );
 
@@ -100,7 +104,7 @@ void CMesh::Prepare( EDrawMode DrawModeOverride )
 	glBindVertexArray( VertexArrayObject );
 }
 
-void CMesh::Draw( EDrawMode DrawModeOverride )
+void CMesh::Draw( EDrawMode DrawModeOverride, const GLsizei Instances )
 {
 	if( !IsValid() )
 		return;
@@ -115,6 +119,20 @@ void CMesh::Draw( EDrawMode DrawModeOverride )
 		return;
 	}
 	
+	if( Instances > 1 )
+	{
+		if( HasIndexBuffer )
+		{
+			glDrawElementsInstanced( DrawMode, VertexBufferData.IndexCount, GL_UNSIGNED_INT, 0, Instances );
+		}
+		else
+		{
+			glDrawArraysInstanced( DrawMode, 0, VertexBufferData.VertexCount, Instances );
+		}
+
+		return;
+	}
+
 	if( HasIndexBuffer )
 	{
 		glDrawElements( DrawMode, VertexBufferData.IndexCount, GL_UNSIGNED_INT, 0 );
@@ -186,6 +204,16 @@ void CMesh::SetAnimationSet( const AnimationSet& Set )
 	this->Set = Set;
 }
 
+const std::shared_ptr<TriangleTree>& CMesh::GetCollisionTree() const
+{
+	return CollisionTree;
+}
+
+void CMesh::SetCollisionTree( const std::shared_ptr<TriangleTree>& Tree )
+{
+	CollisionTree = Tree;
+}
+
 namespace VertexAttribute
 {
 	enum Type
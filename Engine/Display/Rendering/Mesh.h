@@ -4,6 +4,8 @@
 #include <ThirdParty/glad/include/glad/glad.h>
 #include <ThirdParty/glm/glm.hpp>
 
+#include <memory>
+
 #include <Engine/Animation/AnimationSet.h>
 #include <Engine/Animation/Skeleton.h>
 #include <Engine/Display/Rendering/CompactVertex.h>
@@ -74,7 +76,7 @@ public:
 	bool Populate( const FPrimitive& Primitive );
 
 	void Prepare( EDrawMode DrawModeOverride );
-	void Draw( EDrawMode DrawModeOverride = None );
+	void Draw( EDrawMode DrawModeOverride = None, const GLsizei Instances = 1 );
 
 	FVertexBufferData& GetVertexBufferData();
 	const FVertexData& GetVertexData() const;
@@ -90,6 +92,10 @@ public:
 
 	const AnimationSet& GetAnimationSet() const;
 	void SetAnimationSet( const AnimationSet& Set );
+
+	// Triangle tree used for collisions, shared by all of the bodies that use this mesh.
+	const std::shared_ptr<struct TriangleTree>& GetCollisionTree() const;
+	void SetCollisionTree( const std::shared_ptr<struct TriangleTree>& Tree );
 private:
 	bool CreateVertexArrayObject();
 	bool CreateVertexBuffer( const FPrimitive& Primitive );
@@ -114,6 +120,8 @@ private:
 	BoundingBox AABB;
 	AnimationSet Set;
 
+	std::shared_ptr<struct TriangleTree> CollisionTree;
+
 	std::string Location;
 };
 
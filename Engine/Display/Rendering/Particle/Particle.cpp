@@ -44,19 +44,20 @@ void ParticleSystem::Load()
 	}
 }
 
-void ParticleSystem::Configure( const JSON::Vector& Objects )
+void ParticleSystem::Configure( const JSON::Node& Object )
 {
-	JSON::Assign( Objects, "name", Name );
-	JSON::Assign( Objects, "compute", ComputePath );
-	JSON::Assign( Objects, "render", RenderPath );
+	Object.Assign( "name", Name );
+	Object.Assign( "compute", ComputePath );
+	Object.Assign( "render", RenderPath );
 
 	// Check if any textures have been configured.
 	for( uint32_t Index = 0; Index < MaximumParticleTextures; Index++ )
 	{
-		JSON::Assign( Objects, "texture" + std::to_string( Index ), TexturePath[Index] );
+		const auto Key = "texture" + std::to_string( Index );
+		Object.Assign( Key.c_str(), TexturePath[Index] );
 	}
 
-	JSON::Assign( Objects, "count", Count );
+	Object.Assign( "count", Count );
 }
 
 std::vector<ParticleSystem> ParticleSystem::LoadDefinitions( const std::string& Location )
@@ -70,12 +71,14 @@ std::vector<ParticleSystem> ParticleSystem::LoadDefinitions( const std::string&
 	Log::Event( "Parsing particle system \"%s\".\n", Location.c_str() );
 
 	DefinitionFile.Load();
-	const auto Definitions = JSON::Tree( DefinitionFile );
 
-	for( auto& Object : Definitions.Objects )
+	JSON::Document Definitions;
+	Definitions.Parse( DefinitionFile );
+
+	for( const auto& Object : Definitions.Root().Find( "definitions" ) )
 	{
 		ParticleSystem System;
-		System.Configure( Object.Objects );
+		System.Configure( Object );
 		Systems.emplace_back( System );
 	}
 
@@ -98,8 +101,9 @@ Asset* ParticleAssetLoader( AssetParameters& Parameters )
 
 	auto* Asset = new ParticleAsset();
 
-	const auto Particle = JSON::Tree( ParticleFile );
-	Asset->System.Configure( Particle.Tree );
+	JSON::Document Particle;
+	Particle.Parse( ParticleFile );
+	Asset->System.Configure( Particle.Root() );
 
 	return Asset;
 }
@@ -120,29 +124,31 @@ Asset* ParticleDefinitionLoader( AssetParameters& Parameters )
 
 	Log::Event( "Parsing particle definition \"%s\".\n", Location.c_str() );
 
-	const auto Definitions = JSON::Tree( DefinitionFile );
-	const auto* Particles = JSON::Find( Definitions.Tree, "definitions" );
-	if( !Particles )
+	JSON::Document Definitions;
+	Definitions.Parse( DefinitionFile );
+
+	const auto Particles = Definitions.Root().Find( "definitions" );
+	if( !Particles.Valid() )
 		return nullptr;
 
-	for( auto& ParticleDefinition : Particles->Objects )
+	for( const auto& ParticleDefinition : Particles )
 	{
-		const auto* NameObject = JSON::Find( ParticleDefinition->Objects, "name" );
-		if( !NameObject )
+		std::string Name;
+		if( !ParticleDefinition.Assign( "name", Name ) )
 			continue;
 
-		auto* Asset = CAssets::Get().FindAsset<ParticleAsset>( NameObject->Value );
+		auto* Asset = CAssets::Get().FindAsset<ParticleAsset>( Name );
 		bool Exists = Asset != nullptr;
 		if( !Exists )
 		{
 			Asset = new ParticleAsset();
 		}
 
-		Asset->System.Configure( ParticleDefinition->Objects );
+		Asset->System.Configure( ParticleDefinition );
 
 		if( !Exists )
 		{
-			if( !CAssets::Get().RegisterNamedAsset( NameObject->Value, Asset ) )
+			if( !CAssets::Get().RegisterNamedAsset( Name, Asset ) )
 			{
 				// The asset failed to register, clean up after ourselves.
 				delete Asset;
@@ -158,11 +164,11 @@ Asset* ParticleDefinitionLoader( AssetParameters& Parameters )
 		{
 			// The asset has been registered, time to load it.
 			Asset->System.Load();
-			// Log::Event( "Registered particle asset \"%s\".\n", NameObject->Value.c_str() );
+			// Log::Event( "Registered particle asset \"%s\".\n", Name.c_str() );
 		}
 		else
 		{
-			Log::Event( Log::Warning, "Failed to load particle asset \"%s\".\n", NameObject->Value.c_str() );
+			Log::Event( Log::Warning, "Failed to load particle asset \"%s\".\n", Name.c_str() );
 		}
 	}
 
@@ -5,7 +5,7 @@
 #include <vector>
 
 #include <Engine/Resource/Asset.h>
-#include <Engine/Utility/Structures/JSON.h>
+#include <Engine/Utility/Structures/JSONDocument.h>
 
 #include <ThirdParty/glm/glm.hpp>
 
@@ -23,7 +23,7 @@ constexpr uint32_t MaximumParticleTextures = 8;
 struct ParticleSystem
 {
 	void Load();
-	void Configure( const JSON::Vector& Objects );
+	void Configure( const JSON::Node& Object );
 
 	std::string Name;
 	std::string ComputePath;
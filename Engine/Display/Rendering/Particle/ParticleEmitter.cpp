@@ -194,7 +194,29 @@ void ParticleEmitter::Destroy()
 	delete Renderable;
 }
 
-void SetCameraUniform( GLuint Program )
+static const UniformId CameraPositionName = UniformName::Intern( "CameraPosition" );
+static const UniformId MinimumName = UniformName::Intern( "Minimum" );
+static const UniformId MaximumName = UniformName::Intern( "Maximum" );
+static const UniformId ParticleCountName = UniformName::Intern( "ParticleCount" );
+static const UniformId TimeName = UniformName::Intern( "Time" );
+
+static UniformId GetControlPointName( const uint32_t Index )
+{
+	static const auto Names = [] ()
+	{
+		std::vector<UniformId> Names( TotalControlPoints );
+		for( uint32_t Point = 0; Point < TotalControlPoints; Point++ )
+		{
+			Names[Point] = UniformName::Intern( "ControlPoint" + std::to_string( Point ) );
+		}
+
+		return Names;
+	}();
+
+	return Names[Index];
+}
+
+void SetCameraUniform( CUniformCache& Cache )
 {
 	auto* World = CWorld::GetPrimaryWorld();
 	if( !World )
@@ -204,21 +226,17 @@ void SetCameraUniform( GLuint Program )
 	if( !Camera )
 		return;
 
-	auto CameraPosition = Uniform( Camera->GetCameraPosition() );
-	CameraPosition.Bind( Program, "CameraPosition" );
+	Cache.Bind( CameraPositionName, Camera->GetCameraPosition() );
 }
 
-void SetBoundsUniform( GLuint Program, CRenderable* Renderable )
+void SetBoundsUniform( CUniformCache& Cache, CRenderable* Renderable )
 {
 	if( !Renderable )
 		return;
 
 	const auto& Bounds = Renderable->GetRenderData().WorldBounds;
-	auto Minimum = Uniform( Bounds.Minimum );
-	Minimum.Bind( Program, "Minimum" );
-
-	auto Maximum = Uniform( Bounds.Maximum );
-	Maximum.Bind( Program, "Maximum" );
+	Cache.Bind( MinimumName, Bounds.Minimum );
+	Cache.Bind( MaximumName, Bounds.Maximum );
 }
 
 void ParticleEmitter::Tick()
@@ -235,7 +253,8 @@ void ParticleEmitter::Tick()
 
 	RenderData.Color = Vector4D( 1.0f, 1.0f, 1.0f, 1.0f );
 	
-	const auto Program = Compute->Activate();
+	Compute->Activate();
+	auto& Cache = Compute->GetUniformCache();
 
 	const auto* Particle = Cast<ParticleRenderable>( Renderable );
 	Particle->Buffer.Bind();
@@ -250,26 +269,23 @@ void ParticleEmitter::Tick()
 	for( uint32_t Index = 0; Index < TotalControlPoints; Index++ )
 	{
 		const auto Point = Index == 0 ? Location : ControlPoints[Index - 1];
-		auto ControlPoint = Uniform( Point );
-		ControlPoint.Bind( Program, "ControlPoint" + std::to_string( Index ) );
+		Cache.Bind( GetControlPointName( Index ), Point );
 	}
 
-	auto ParticleCount = Uniform( Count );
-	ParticleCount.Bind( Program, "ParticleCount" );
+	Cache.Bind( ParticleCountName, Count );
 
 	Vector4D Time;
 	Time.X = StaticCast<float>( GameLayersInstance->GetCurrentTime() );
 	Time.Y = StaticCast<float>( GameLayersInstance->GetDeltaTime() );
 	Time.Z = StaticCast<float>( GameLayersInstance->GetPreviousTime() );
 	Time.W = StaticCast<float>( GameLayersInstance->GetTimeScale() );
-	auto TimeUniform = Uniform( Time );
-	TimeUniform.Bind( Program, "Time" );
+	Cache.Bind( TimeName, Time );
 
 	// Bind the global uniforms to the compute shader.
-	CWindow::Get().GetRenderer().BindGlobalUniformsToProgram( Program );
+	CWindow::Get().GetRenderer().BindGlobalUniforms( Cache );
 	
-	SetCameraUniform( Program );
-	SetBoundsUniform( Program, Renderable );
+	SetCameraUniform( Cache );
+	SetBoundsUniform( Cache, Renderable );
 	
 	glDispatchCompute( Math::Max( 1, Count / WorkSize ), 1, 1 );
 }
@@ -6,6 +6,12 @@
 #include <Engine/Profiling/Profiling.h>
 #include <Engine/World/World.h>
 
+static const UniformId ModelMatrixName = UniformName::Intern( "Model" );
+static const UniformId UseProjectionViewName = UniformName::Intern( "UseProjectionView" );
+static const UniformId ViewMatrixName = UniformName::Intern( "View" );
+static const UniformId ProjectionMatrixName = UniformName::Intern( "Projection" );
+static const UniformId ProjectionViewMatrixName = UniformName::Intern( "ProjectionView" );
+
 CRenderPassShadow::CRenderPassShadow( int Width, int Height, const CCamera& Camera, const bool AlwaysClear ) : CRenderPass( "Shadow", Width, Height, Camera, AlwaysClear )
 {
 	auto& Assets = CAssets::Get();
@@ -46,23 +52,13 @@ void CRenderPassShadow::Draw( CRenderable* Renderable, CShader* ShadowShader )
 
 	RenderData.ShaderProgram = ShadowShader->GetHandles().Program;
 
-	const auto ModelMatrix = RenderData.Transform.GetTransformationMatrix();
-
-	if( ModelMatrixLocation < 0 || LastProgram != RenderData.ShaderProgram )
-	{
-		ModelMatrixLocation = glGetUniformLocation( RenderData.ShaderProgram, "Model" );
-		LastProgram = RenderData.ShaderProgram;
-	}
-	
-	glUniformMatrix4fv( ModelMatrixLocation, 1, GL_FALSE, &ModelMatrix[0][0] );
+	auto& Cache = ShadowShader->GetUniformCache();
+	Cache.Bind( ModelMatrixName, RenderData.Transform.GetTransformationMatrix() );
 
 	if( Renderable->HasSkeleton )
 	{
 		// Skeletons have to submit bone data.
-		for( auto& UniformBuffer : Renderable->GetUniforms() )
-		{
-			UniformBuffer.second.Bind( RenderData.ShaderProgram, UniformBuffer.first );
-		}
+		Cache.Bind( Renderable->GetUniforms() );
 	}
 
 	auto* Mesh = Renderable->GetMesh();
@@ -197,40 +193,16 @@ void CRenderPassShadow::ConfigureShader( CShader* Shader )
 	ConfigureDepthMask( Shader );
 	ConfigureDepthTest( Shader );
 
-	const auto Program = Shader->GetHandles().Program;
-	UseProjectionViewLocation = glGetUniformLocation( Program, "UseProjectionView" );
-	if( UseProjectionViewLocation > -1 )
-	{
-		glUniform1i( UseProjectionViewLocation, UseProjectionView ? 1 : 0 );
-	}
+	auto& Cache = Shader->GetUniformCache();
+	Cache.Bind( UseProjectionViewName, UseProjectionView ? 1 : 0 );
 
 	if( !UseProjectionView )
 	{
-		const GLint ViewMatrixLocation = glGetUniformLocation( Program, "View" );
-		if( ViewMatrixLocation > -1 )
-		{
-			const auto& ViewMatrix = Camera.GetViewMatrix();
-			glUniformMatrix4fv( ViewMatrixLocation, 1, GL_FALSE, &ViewMatrix[0][0] );
-		}
-
-		const GLint ProjectionMatrixLocation = glGetUniformLocation( Program, "Projection" );
-		if( ProjectionMatrixLocation > -1 )
-		{
-			const auto& ProjectionMatrix = Camera.GetProjectionMatrix();
-			glUniformMatrix4fv( ProjectionMatrixLocation, 1, GL_FALSE, &ProjectionMatrix[0][0] );
-		}
+		Cache.Bind( ViewMatrixName, Math::FromGLM( Camera.GetViewMatrix() ) );
+		Cache.Bind( ProjectionMatrixName, Math::FromGLM( Camera.GetProjectionMatrix() ) );
 	}
 
-	// BUG: For some reason this value isn't updated correctly.
-	if( true || ProjectionViewMatrixLocation < 1 || LastProgram != Program )
-	{
-		ProjectionViewMatrixLocation = glGetUniformLocation( Program, "ProjectionView" );
-	}
-
-	if( ProjectionViewMatrixLocation > -1 )
-	{
-		glUniformMatrix4fv( ProjectionViewMatrixLocation, 1, GL_FALSE, &ProjectionView[0][0] );
-	}
+	Cache.Bind( ProjectionViewMatrixName, Math::FromGLM( ProjectionView ) );
 }
 
 void CRenderPassShadow::DrawShadowMeshes( const std::vector<CRenderable*>& Renderables )
@@ -255,8 +227,6 @@ void CRenderPassShadow::DrawShadowMeshes( const std::vector<CRenderable*>& Rende
 
 		if( CurrentShader != PreviousShader )
 		{
-			LastProgram = PreviousShader->GetHandles().Program;
-
 			CurrentShader->Activate();
 			ConfigureShader( CurrentShader );
 			PreviousShader = CurrentShader;
@@ -35,9 +35,4 @@ public:
 protected:
 	void ConfigureShader( CShader* Shader );
 	void DrawShadowMeshes( const std::vector<CRenderable*>& Renderables );
-
-	int ModelMatrixLocation = -1;
-	int ProjectionViewMatrixLocation = -1;
-	int UseProjectionViewLocation = -1;
-	unsigned int LastProgram = 0;
 };
@@ -0,0 +1,250 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "RenderHierarchy.h"
+
+#include <algorithm>
+
+#include <Engine/Display/Rendering/Camera.h>
+#include <Engine/Display/Rendering/Culling.h>
+#include <Engine/Display/Rendering/Renderable.h>
+#include <Engine/World/Entity/MeshEntity/MeshEntity.h>
+
+// Amount of entities that are stored in a single leaf.
+constexpr size_t LeafSize = 8;
+
+// Maximum depth of the hierarchy that can be traversed.
+constexpr size_t StackSize = 64;
+
+static BoundingBox GetBounds( const CMeshEntity* Entity )
+{
+	if( Entity->Renderable )
+	{
+		return Entity->Renderable->GetRenderData().WorldBounds;
+	}
+
+	return Entity->GetWorldBounds();
+}
+
+static bool Moved( const BoundingBox& A, const BoundingBox& B )
+{
+	return A.Minimum.X != B.Minimum.X || A.Minimum.Y != B.Minimum.Y || A.Minimum.Z != B.Minimum.Z ||
+		A.Maximum.X != B.Maximum.X || A.Maximum.Y != B.Maximum.Y || A.Maximum.Z != B.Maximum.Z;
+}
+
+void CRenderHierarchy::Build( const std::vector<CMeshEntity*>& Source )
+{
+	Nodes.clear();
+	Entities = Source;
+	Bounds.clear();
+
+	if( Entities.empty() )
+		return;
+
+	Nodes.reserve( Entities.size() * 2 / LeafSize + 1 );
+	BuildNode( 0, Entities.size() );
+
+	// Store the bounds in the final order of the entities.
+	Bounds.reserve( Entities.size() );
+	for( const auto* Entity : Entities )
+	{
+		Bounds.emplace_back( GetBounds( Entity ) );
+	}
+
+	UpdateBounds();
+}
+
+void CRenderHierarchy::Clear()
+{
+	Nodes.clear();
+	Entities.clear();
+	Bounds.clear();
+}
+
+int32_t CRenderHierarchy::BuildNode( const size_t Start, const size_t End )
+{
+	const auto Index = static_cast<int32_t>( Nodes.size() );
+	Nodes.emplace_back();
+	Nodes[Index].First = static_cast<int32_t>( Start );
+	Nodes[Index].Count = static_cast<int32_t>( End - Start );
+
+	if( End - Start <= LeafSize )
+		return Index;
+
+	// Split along the longest axis of the centroids.
+	Vector3D Minimum = GetBounds( Entities[Start] ).Center();
+	Vector3D Maximum = Minimum;
+	for( size_t Entity = Start + 1; Entity < End; Entity++ )
+	{
+		const auto Center = GetBounds( Entities[Entity] ).Center();
+		for( int Axis = 0; Axis < 3; Axis++ )
+		{
+			Minimum[Axis] = std::min( Minimum[Axis], Center[Axis] );
+			Maximum[Axis] = std::max( Maximum[Axis], Center[Axis] );
+		}
+	}
+
+	const auto Extent = Maximum - Minimum;
+	int Axis = 0;
+	if( Extent.Y > Extent.X )
+	{
+		Axis = 1;
+	}
+
+	if( Extent.Z > Extent[Axis] )
+	{
+		Axis = 2;
+	}
+
+	const size_t Middle = Start + ( End - Start ) / 2;
+	std::nth_element( Entities.begin() + Start, Entities.begin() + Middle, Entities.begin() + End, [Axis] ( const CMeshEntity* A, const CMeshEntity* B )
+		{
+			return GetBounds( A ).Center()[Axis] < GetBounds( B ).Center()[Axis];
+		}
+	);
+
+	BuildNode( Start, Middle );
+	const auto Second = BuildNode( Middle, End );
+	Nodes[Index].Second = Second;
+
+	return Index;
+}
+
+void CRenderHierarchy::UpdateBounds()
+{
+	for( size_t Index = Nodes.size(); Index-- > 0; )
+	{
+		auto& Node = Nodes[Index];
+		if( Node.Second < 0 )
+		{
+			Node.Bounds = Bounds[Node.First];
+			for( int32_t Entity = Node.First + 1; Entity < Node.First + Node.Count; Entity++ )
+			{
+				Node.Bounds = Node.Bounds.Combine( Bounds[Entity] );
+			}
+		}
+		else
+		{
+			Node.Bounds = Nodes[Index + 1].Bounds.Combine( Nodes[Node.Second].Bounds );
+		}
+	}
+}
+
+bool CRenderHierarchy::Refit()
+{
+	bool Changed = false;
+	for( size_t Index = 0; Index < Entities.size(); Index++ )
+	{
+		const auto Current = GetBounds( Entities[Index] );
+		if( Moved( Current, Bounds[Index] ) )
+		{
+			Bounds[Index] = Current;
+			Changed = true;
+		}
+	}
+
+	if( Changed )
+	{
+		UpdateBounds();
+	}
+
+	return Changed;
+}
+
+enum class Containment
+{
+	Outside,
+	Intersecting,
+	Inside
+};
+
+static Containment Classify( const Frustum& Frustum, const BoundingBox& Box )
+{
+	const auto Center = Box.Center();
+	const auto Extent = Box.Size() * 0.5f;
+
+	bool Inside = true;
+	for( int Side = 0; Side < Frustum::Maximum; Side++ )
+	{
+		const auto& Plane = Frustum.Plane[Side];
+		const float Radius = Extent.Dot( Math::Abs( Plane.Normal ) );
+		const float Distance = Plane.Normal.Dot( Center ) + Plane.Distance;
+
+		// The plane normals point out of the frustum.
+		if( Distance > Radius )
+			return Containment::Outside;
+
+		if( Distance > -Radius )
+		{
+			Inside = false;
+		}
+	}
+
+	return Inside ? Containment::Inside : Containment::Intersecting;
+}
+
+static void Emit( CMeshEntity* Entity, const bool Visible, const uint32_t Pass )
+{
+	auto* Renderable = Entity->Renderable;
+	if( !Renderable )
+		return;
+
+	auto& RenderData = Renderable->GetRenderData();
+	RenderData.ShouldRender = Visible && !RenderData.DisableRender;
+	RenderData.CullingPass = Pass;
+}
+
+void CRenderHierarchy::Cull( const Frustum& Frustum, const uint32_t Pass, RenderHierarchyStatistics& Statistics ) const
+{
+	if( Nodes.empty() )
+		return;
+
+	int32_t Stack[StackSize];
+	size_t Depth = 0;
+	Stack[Depth++] = 0;
+
+	while( Depth > 0 )
+	{
+		const auto& Node = Nodes[Stack[--Depth]];
+		const auto Last = Node.First + Node.Count;
+
+		Statistics.Tested++;
+		const auto Result = Classify( Frustum, Node.Bounds );
+		if( Result == Containment::Outside )
+		{
+			Statistics.Rejected++;
+			for( int32_t Index = Node.First; Index < Last; Index++ )
+			{
+				Emit( Entities[Index], false, Pass );
+			}
+
+			continue;
+		}
+
+		if( Result == Containment::Inside )
+		{
+			Statistics.Accepted++;
+			Statistics.Emitted += Node.Count;
+			for( int32_t Index = Node.First; Index < Last; Index++ )
+			{
+				Emit( Entities[Index], true, Pass );
+			}
+
+			continue;
+		}
+
+		if( Node.Second < 0 || Depth + 2 > StackSize )
+		{
+			// Partially visible leaf, fall back to the per-object test.
+			Statistics.Objects += Node.Count;
+			for( int32_t Index = Node.First; Index < Last; Index++ )
+			{
+				Emit( Entities[Index], Culling::Frustum( Frustum, Bounds[Index] ), Pass );
+			}
+
+			continue;
+		}
+
+		const auto Self = static_cast<int32_t>( &Node - Nodes.data() );
+		Stack[Depth++] = Node.Second;
+		Stack[Depth++] = Self + 1;
+	}
+}
@@ -0,0 +1,77 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Engine/Utility/Math/BoundingBox.h>
+
+class CMeshEntity;
+struct Frustum;
+
+struct RenderHierarchyStatistics
+{
+	// Nodes that were tested against the frustum.
+	int64_t Tested = 0;
+
+	// Nodes that were completely outside of the frustum.
+	int64_t Rejected = 0;
+
+	// Nodes that were completely inside of the frustum.
+	int64_t Accepted = 0;
+
+	// Renderables that were emitted by accepted nodes, without being tested themselves.
+	int64_t Emitted = 0;
+
+	// Renderables in partially visible leaves that had to be tested one by one.
+	int64_t Objects = 0;
+};
+
+// Bounding volume hierarchy over the mesh entities of a level, used to cull their renderables per subtree.
+// The entities of each subtree are stored next to each other, so accepted subtrees can be emitted as a range.
+class CRenderHierarchy
+{
+public:
+	void Build( const std::vector<CMeshEntity*>& Entities );
+
+	// Forgets all of the entities, used when they may be deleted before the next build.
+	void Clear();
+
+	// Updates the node bounds if any of the entities has moved, returns true when something changed.
+	bool Refit();
+
+	// Determines the visibility of the renderables in the hierarchy for the given culling pass.
+	void Cull( const Frustum& Frustum, const uint32_t Pass, RenderHierarchyStatistics& Statistics ) const;
+
+	size_t Size() const
+	{
+		return Entities.size();
+	}
+
+	size_t GetNodeCount() const
+	{
+		return Nodes.size();
+	}
+
+private:
+	struct Node
+	{
+		BoundingBox Bounds;
+
+		// Range of entities covered by this node and all of its children.
+		int32_t First = 0;
+		int32_t Count = 0;
+
+		// The first child is stored right after its parent, leaves don't have a second child.
+		int32_t Second = -1;
+	};
+
+	int32_t BuildNode( const size_t Start, const size_t End );
+
+	// Recalculates the bounds of every node, children are always stored after their parents.
+	void UpdateBounds();
+
+	std::vector<Node> Nodes;
+	std::vector<CMeshEntity*> Entities;
+	std::vector<BoundingBox> Bounds;
+};
@@ -0,0 +1,119 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "RenderKey.h"
+
+#include <cstring>
+#include <utility>
+
+namespace RenderKey
+{
+	constexpr uint64_t DepthBits = 24;
+	constexpr uint64_t MeshBits = 24;
+	constexpr uint64_t ProgramBits = 13;
+	constexpr uint64_t BlendBits = 2;
+
+	constexpr uint64_t MeshShift = DepthBits;
+	constexpr uint64_t ProgramShift = MeshShift + MeshBits;
+	constexpr uint64_t BlendShift = ProgramShift + ProgramBits;
+	constexpr uint64_t PassShift = BlendShift + BlendBits;
+
+	constexpr uint64_t Mask( const uint64_t Bits )
+	{
+		return ( 1ull << Bits ) - 1ull;
+	}
+
+	uint64_t Create( const bool Translucent, const uint32_t BlendMode, const uint32_t Program, const uint32_t IndexBuffer, const uint32_t VertexBuffer, const float DistanceSquared )
+	{
+		// Buffer names are truncated, that only affects how well state changes are grouped.
+		const uint64_t Mesh = ( static_cast<uint64_t>( IndexBuffer & Mask( MeshBits / 2 ) ) << ( MeshBits / 2 ) ) | ( VertexBuffer & Mask( MeshBits / 2 ) );
+
+		uint64_t Key = static_cast<uint64_t>( Translucent ) << PassShift;
+		Key |= ( BlendMode & Mask( BlendBits ) ) << BlendShift;
+		Key |= ( Program & Mask( ProgramBits ) ) << ProgramShift;
+		Key |= Mesh << MeshShift;
+		Key |= Depth( DistanceSquared, Translucent );
+		return Key;
+	}
+
+	uint32_t Depth( const float DistanceSquared, const bool Translucent )
+	{
+		// The bits of a positive float increase along with its value, the top bits work as a logarithmic depth.
+		const float Distance = DistanceSquared > 0.0f ? DistanceSquared : 0.0f;
+		uint32_t Bits;
+		std::memcpy( &Bits, &Distance, sizeof( Bits ) );
+
+		const uint32_t Quantized = ( Bits >> ( 31 - DepthBits ) ) & Mask( DepthBits );
+		return static_cast<uint32_t>( Translucent ? Mask( DepthBits ) - Quantized : Quantized );
+	}
+
+	void Sort( std::vector<uint64_t>& Keys, std::vector<uint32_t>& Indices, std::vector<uint64_t>& ScratchKeys, std::vector<uint32_t>& ScratchIndices )
+	{
+		const size_t Count = Keys.size();
+		Indices.resize( Count );
+		for( size_t Index = 0; Index < Count; Index++ )
+		{
+			Indices[Index] = static_cast<uint32_t>( Index );
+		}
+
+		if( Count < 2 )
+			return;
+
+		ScratchKeys.resize( Count );
+		ScratchIndices.resize( Count );
+
+		// Count all of the digits in one go.
+		constexpr size_t Passes = 8;
+		size_t Histogram[Passes][256] = {};
+		for( const auto Key : Keys )
+		{
+			for( size_t Pass = 0; Pass < Passes; Pass++ )
+			{
+				Histogram[Pass][( Key >> ( Pass * 8 ) ) & 0xFF]++;
+			}
+		}
+
+		auto* Source = &Keys;
+		auto* Target = &ScratchKeys;
+		auto* SourceIndices = &Indices;
+		auto* TargetIndices = &ScratchIndices;
+
+		for( size_t Pass = 0; Pass < Passes; Pass++ )
+		{
+			auto& Offsets = Histogram[Pass];
+			const size_t Shift = Pass * 8;
+
+			// Skip digits that are the same for every key, most of the state bits are.
+			if( Offsets[( Source->front() >> Shift ) & 0xFF] == Count )
+				continue;
+
+			size_t Offset = 0;
+			for( auto& Bucket : Offsets )
+			{
+				const size_t Size = Bucket;
+				Bucket = Offset;
+				Offset += Size;
+			}
+
+			const auto* Input = Source->data();
+			const auto* InputIndices = SourceIndices->data();
+			auto* Output = Target->data();
+			auto* OutputIndices = TargetIndices->data();
+			for( size_t Index = 0; Index < Count; Index++ )
+			{
+				const auto Key = Input[Index];
+				const auto Destination = Offsets[( Key >> Shift ) & 0xFF]++;
+				Output[Destination] = Key;
+				OutputIndices[Destination] = InputIndices[Index];
+			}
+
+			std::swap( Source, Target );
+			std::swap( SourceIndices, TargetIndices );
+		}
+
+		// Make sure the sorted data ends up in the output arrays.
+		if( Source != &Keys )
+		{
+			Keys.swap( ScratchKeys );
+			Indices.swap( ScratchIndices );
+		}
+	}
+}
@@ -0,0 +1,20 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Packed 64-bit sort keys for the render queues, sorting them doesn't have to touch the renderables.
+// Layout, from the most significant bit down:
+// [63] translucent pass | [61-62] blend mode | [48-60] program | [24-47] mesh (IBO, VBO) | [0-23] depth
+namespace RenderKey
+{
+	uint64_t Create( const bool Translucent, const uint32_t BlendMode, const uint32_t Program, const uint32_t IndexBuffer, const uint32_t VertexBuffer, const float DistanceSquared );
+
+	// Quantizes the distance, opaque geometry is drawn front-to-back and translucent geometry back-to-front.
+	uint32_t Depth( const float DistanceSquared, const bool Translucent );
+
+	// Stable LSD radix sort, fills the index array with the positions of the keys in sorted order.
+	// The key array is sorted in-place, the scratch buffers are re-used between calls.
+	void Sort( std::vector<uint64_t>& Keys, std::vector<uint32_t>& Indices, std::vector<uint64_t>& ScratchKeys, std::vector<uint32_t>& ScratchIndices );
+}
@@ -1,10 +1,13 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "RenderPass.h"
 
+#include <Engine/Configuration/Configuration.h>
 #include <Engine/Display/Rendering/Camera.h>
+#include <Engine/Display/Rendering/Culling.h>
 #include <Engine/Display/Rendering/Mesh.h>
 #include <Engine/Display/Rendering/Shader.h>
 #include <Engine/Display/Rendering/Texture.h>
+#include <Engine/Display/Rendering/Renderer.h>
 #include <Engine/Display/Rendering/RenderTexture.h>
 #include <Engine/Profiling/Profiling.h>
 #include <Engine/Resource/Assets.h>
@@ -25,6 +28,20 @@
 
 GLuint ShaderProgramHandle = -1;
 
+static const UniformId ViewMatrixName = UniformName::Intern( "View" );
+static const UniformId ProjectionMatrixName = UniformName::Intern( "Projection" );
+static const UniformId CameraPositionName = UniformName::Intern( "CameraPosition" );
+static const UniformId CameraDirectionName = UniformName::Intern( "CameraDirection" );
+static const UniformId PreviousCameraPositionName = UniformName::Intern( "PreviousCameraPosition" );
+static const UniformId PreviousCameraDirectionName = UniformName::Intern( "PreviousCameraDirection" );
+static const UniformId CameraNearName = UniformName::Intern( "CameraNear" );
+static const UniformId CameraFarName = UniformName::Intern( "CameraFar" );
+static const UniformId ViewportName = UniformName::Intern( "Viewport" );
+static const UniformId InstanceOffsetName = UniformName::Intern( "InstanceOffset" );
+
+// Draws consecutive renderables that share a mesh, textures and an instanced shader in one go.
+ConfigurationVariable<bool> UseInstancing( "render.Instancing", true );
+
 static const GLenum DepthTestToEnum[EDepthTest::Maximum]
 {
 	GL_NEVER,
@@ -137,12 +154,30 @@ uint32_t CRenderPass::Render( const std::vector<CRenderable*>& Renderables, Unif
 
 	Begin();
 
-	for( auto Renderable : Renderables )
+	if( UseInstancing )
 	{
-		Setup( Renderable, Uniforms );
-		Draw( Renderable);
+		InstanceBatch::Build( Renderables, Batches, InstanceData );
+		if( !InstanceData.empty() )
+		{
+			InstanceBuffer.Upload( InstanceData );
+			InstanceBuffer.Bind();
+		}
 	}
 
+	InstanceBatch::Submit( Renderables, Batches, UseInstancing, [this, &Uniforms] ( CRenderable* Renderable, const uint32_t Instances, const int32_t InstanceOffset )
+		{
+			Setup( Renderable, Uniforms );
+
+			if( InstanceOffset >= 0 )
+			{
+				// Point the shader at the instances of this batch instead of the per-object uniforms.
+				Renderable->GetShader()->GetUniformCache().Bind( InstanceOffsetName, InstanceOffset );
+			}
+
+			Draw( Renderable, Instances );
+		}
+	);
+
 	End();
 
 	return Calls;
@@ -247,7 +282,7 @@ void CRenderPass::Setup( CRenderable* Renderable, UniformMap& Uniforms )
 	RenderData.ShaderProgram = ShaderProgramHandle;
 }
 
-void CRenderPass::Draw( CRenderable* Renderable )
+void CRenderPass::Draw( CRenderable* Renderable, const uint32_t Instances )
 {
 	FRenderDataInstanced& RenderData = Renderable->GetRenderData();
 	if( !RenderData.ShouldRender )
@@ -261,7 +296,7 @@ void CRenderPass::Draw( CRenderable* Renderable )
 	ConfigureDepthMask( Shader );
 	ConfigureDepthTest( Shader );
 
-	Renderable->Draw( RenderData, PreviousRenderable );
+	Renderable->Draw( RenderData, PreviousRenderable, None, Instances );
 	PreviousRenderable = Renderable;
 
 	Calls++;
@@ -327,86 +362,35 @@ void CRenderPass::BindUniforms( CRenderable* Renderable, UniformMap& AdditionalU
 
 	Renderable->BindUniforms();
 
-	const FProgramHandles& Handles = Shader->GetHandles();
-	// if( Handles.Program == ShaderProgramHandle )
-	// 	return;
-
-	for( auto& UniformBuffer : AdditionalUniforms )
-	{
-		UniformBuffer.second.Bind( RenderData.ShaderProgram, UniformBuffer.first );
-	}
+	auto& Cache = Shader->GetUniformCache();
+	Cache.Bind( AdditionalUniforms );
 
 	const FCameraSetup& CameraSetup = Camera.GetCameraSetup();
 	const FCameraSetup& PreviousCameraSetup = PreviousCamera.GetCameraSetup();
 
-	const GLint ViewMatrixLocation = glGetUniformLocation( RenderData.ShaderProgram, "View" );
-	if( ViewMatrixLocation > -1 )
-	{
-		const auto& ViewMatrix = Camera.GetViewMatrix();
-		glUniformMatrix4fv( ViewMatrixLocation, 1, GL_FALSE, &ViewMatrix[0][0] );
-	}
-
-	const GLint ProjectionMatrixLocation = glGetUniformLocation( RenderData.ShaderProgram, "Projection" );
-	if( ProjectionMatrixLocation > -1 )
-	{
-		const auto& ProjectionMatrix = Camera.GetProjectionMatrix();
-		glUniformMatrix4fv( ProjectionMatrixLocation, 1, GL_FALSE, &ProjectionMatrix[0][0] );
-	}
-
-	const GLint CameraPositionLocation = glGetUniformLocation( RenderData.ShaderProgram, "CameraPosition" );
-	if( CameraPositionLocation > -1 )
-	{
-		glUniform3fv( CameraPositionLocation, 1, CameraSetup.CameraPosition.Base() );
-	}
-
-	const GLint CameraDirectionLocation = glGetUniformLocation( RenderData.ShaderProgram, "CameraDirection" );
-	if( CameraDirectionLocation > -1 )
-	{
-		glUniform3fv( CameraDirectionLocation, 1, CameraSetup.CameraDirection.Base() );
-	}
-
-	const GLint PreviousCameraPositionLocation = glGetUniformLocation( RenderData.ShaderProgram, "PreviousCameraPosition" );
-	if( PreviousCameraPositionLocation > -1 )
-	{
-		glUniform3fv( PreviousCameraPositionLocation, 1, PreviousCameraSetup.CameraPosition.Base() );
-	}
-
-	const GLint PreviousCameraDirectionLocation = glGetUniformLocation( RenderData.ShaderProgram, "PreviousCameraDirection" );
-	if( PreviousCameraDirectionLocation > -1 )
-	{
-		glUniform3fv( PreviousCameraDirectionLocation, 1, PreviousCameraSetup.CameraDirection.Base() );
-	}
-
-	const GLint CameraNearLocation = glGetUniformLocation( RenderData.ShaderProgram, "CameraNear" );
-	if( CameraNearLocation > -1 )
-	{
-		glUniform1fv( CameraNearLocation, 1, &CameraSetup.NearPlaneDistance );
-	}
-
-	const GLint CameraFarLocation = glGetUniformLocation( RenderData.ShaderProgram, "CameraFar" );
-	if( CameraFarLocation > -1 )
-	{
-		glUniform1fv( CameraFarLocation, 1, &CameraSetup.FarPlaneDistance );
-	}
+	Cache.Bind( ViewMatrixName, Math::FromGLM( Camera.GetViewMatrix() ) );
+	Cache.Bind( ProjectionMatrixName, Math::FromGLM( Camera.GetProjectionMatrix() ) );
+	Cache.Bind( CameraPositionName, CameraSetup.CameraPosition );
+	Cache.Bind( CameraDirectionName, CameraSetup.CameraDirection );
+	Cache.Bind( PreviousCameraPositionName, PreviousCameraSetup.CameraPosition );
+	Cache.Bind( PreviousCameraDirectionName, PreviousCameraSetup.CameraDirection );
+	Cache.Bind( CameraNearName, CameraSetup.NearPlaneDistance );
+	Cache.Bind( CameraFarName, CameraSetup.FarPlaneDistance );
 
 	// Viewport coordinates
-	glm::vec4 Viewport;
+	Vector4D Viewport;
 	if( Target )
 	{
 		const float Width = Target->GetWidth();
 		const float Height = Target->GetHeight();
-		Viewport = glm::vec4( Width, Height, 1.0f / Width, 1.0f / Height );
+		Viewport = Vector4D( Width, Height, 1.0f / Width, 1.0f / Height );
 	}
 	else
 	{
-		Viewport = glm::vec4( ViewportWidth, ViewportHeight, 1.0f / ViewportWidth, 1.0f / ViewportHeight );
+		Viewport = Vector4D( ViewportWidth, ViewportHeight, 1.0f / ViewportWidth, 1.0f / ViewportHeight );
 	}
 
-	const GLint ViewportLocation = glGetUniformLocation( RenderData.ShaderProgram, "Viewport" );
-	if( ViewportLocation > -1 )
-	{
-		glUniform4fv( ViewportLocation, 1, glm::value_ptr( Viewport ) );
-	}
+	Cache.Bind( ViewportName, Viewport );
 }
 
 void CRenderPass::ConfigureBlendMode( CShader* Shader )
@@ -537,7 +521,12 @@ void SphereCull( const CCamera& Camera, const std::vector<CRenderable*>& Rendera
 void CRenderPass::FrustumCull( const CCamera& Camera, const std::vector<CRenderable*>& Renderables )
 {
 	OptickEvent();
-	CRenderable::FrustumCull( Camera, Renderables );
+
+	// Renderables that belong to a level hierarchy are culled per subtree, the others are tested one by one.
+	const auto Pass = Culling::BeginPass();
+	GetRenderer().CullHierarchies( Camera, Pass );
+
+	CRenderable::FrustumCull( Camera, Renderables, Pass );
 }
 
 CRenderTexture* CRenderPass::GetRenderTexture( const std::string& Name )
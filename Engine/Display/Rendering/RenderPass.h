@@ -5,6 +5,7 @@
 #include <unordered_map>
 
 #include <Engine/Display/Rendering/Camera.h>
+#include <Engine/Display/Rendering/InstanceBatch.h>
 #include <Engine/Display/Rendering/Renderable.h>
 
 #include <Engine/Display/Rendering/Shader.h>
@@ -54,7 +55,7 @@ public:
 	virtual void End();
 
 	virtual void Setup( CRenderable* Renderable, UniformMap& Uniforms );
-	virtual void Draw( CRenderable* Renderable );
+	virtual void Draw( CRenderable* Renderable, const uint32_t Instances = 1 );
 	void SetCamera( const CCamera& Camera );
 	void SetPreviousCamera( const CCamera& Camera );
 
@@ -93,6 +94,11 @@ protected:
 	void ConfigureBlendMode( CShader* Shader );
 	void ConfigureDepthMask( CShader* Shader );
 	void ConfigureDepthTest( CShader* Shader );
+
+	// Draw batches of the current render call and the instance data that they refer to.
+	std::vector<FInstanceBatch> Batches;
+	std::vector<FInstanceData> InstanceData;
+	CInstanceBuffer InstanceBuffer;
 };
 
 uint32_t CopyTexture( CRenderTexture* Source, CRenderTexture* Target, UniformMap& Uniforms );
@@ -8,6 +8,32 @@
 
 #include <ThirdParty/glm/gtc/type_ptr.hpp>
 
+#include <array>
+
+static const UniformId ObjectPositionName = UniformName::Intern( "ObjectPosition" );
+static const UniformId LightIndicesName = UniformName::Intern( "LightIndices" );
+static const UniformId ObjectBoundsMinimumName = UniformName::Intern( "ObjectBoundsMinimum" );
+static const UniformId ObjectBoundsMaximumName = UniformName::Intern( "ObjectBoundsMaximum" );
+static const UniformId ModelMatrixName = UniformName::Intern( "Model" );
+static const UniformId ObjectColorName = UniformName::Intern( "ObjectColor" );
+static const UniformId InstanceOffsetName = UniformName::Intern( "InstanceOffset" );
+
+static UniformId GetTextureSlotName( const size_t Index )
+{
+	static const auto Names = [] ()
+	{
+		std::array<UniformId, TextureSlots> Names;
+		for( size_t Slot = 0; Slot < TextureSlots; Slot++ )
+		{
+			Names[Slot] = UniformName::Intern( TextureSlotName[Slot] );
+		}
+
+		return Names;
+	}();
+
+	return Names[Index];
+}
+
 GLuint DummyVAO = 0;
 void BindDummyVAO()
 {
@@ -25,11 +51,6 @@ CRenderable::CRenderable()
 	Shader = nullptr;
 	memset( Textures, 0, 32 * sizeof( CTexture* ) );
 
-	for( int& Index : TextureLocation )
-	{
-		Index = -1;
-	}
-
 	RenderData.ShouldRender = true;
 }
 
@@ -95,7 +116,12 @@ void CRenderable::SetTexture( CTexture* Texture, ETextureSlot Slot )
 
 void CRenderable::SetUniform( const std::string& Name, const Uniform& Uniform )
 {
-	Uniforms.insert_or_assign( Name, Uniform );
+	Uniforms.Set( Name, Uniform );
+}
+
+void CRenderable::SetUniform( const UniformId Id, const Uniform& Uniform )
+{
+	Uniforms.Set( Id, Uniform );
 }
 
 void CRenderable::CheckCachedUniforms()
@@ -103,51 +129,36 @@ void CRenderable::CheckCachedUniforms()
 	if( !Shader )
 		return;
 
-	const auto Handles = Shader->GetHandles();
-	if( RenderData.ShaderProgram == Handles.Program )
-		return;
-
-	RenderData.ShaderProgram = Handles.Program;
-
-	// Cache the texture locations.
-	for( size_t Index = 0; Index < TextureSlots; Index++ )
-	{
-		TextureLocation[Index] = glGetUniformLocation( Handles.Program, TextureSlotName[Index] );
-	}
+	// Locations are cached by the shader itself.
+	RenderData.ShaderProgram = Shader->GetHandles().Program;
 }
 
 void CRenderable::BindUniforms()
 {
-	for( auto& UniformBuffer : Uniforms )
-	{
-		UniformBuffer.second.Bind( RenderData.ShaderProgram, UniformBuffer.first );
-	}
+	if( !Shader )
+		return;
 
-	ObjectPosition.Set( RenderData.Transform.GetPosition() );
-	ObjectPosition.Bind( RenderData.ShaderProgram );
+	auto& Cache = Shader->GetUniformCache();
+	Cache.Bind( Uniforms );
 
-	LightIndices.Set( RenderData.LightIndex.Index );
-	LightIndices.Bind( RenderData.ShaderProgram );
+	Cache.Bind( ObjectPositionName, RenderData.Transform.GetPosition() );
+	Cache.Bind( LightIndicesName, RenderData.LightIndex.Index );
 
 	if( Mesh )
 	{
 		auto& AABB = Mesh->GetBounds();
-
-		ObjectBoundsMinimum.Set( AABB.Minimum );
-		ObjectBoundsMinimum.Bind( RenderData.ShaderProgram );
-
-		ObjectBoundsMaximum.Set( AABB.Maximum );
-		ObjectBoundsMaximum.Bind( RenderData.ShaderProgram );
+		Cache.Bind( ObjectBoundsMinimumName, AABB.Minimum );
+		Cache.Bind( ObjectBoundsMaximumName, AABB.Maximum );
 	}
 
-	ModelMatrix.Set( RenderData.Transform.GetTransformationMatrix() );
-	ModelMatrix.Bind( RenderData.ShaderProgram );
+	Cache.Bind( ModelMatrixName, RenderData.Transform.GetTransformationMatrix() );
+	Cache.Bind( ObjectColorName, RenderData.Color );
 
-	ObjectColor.Set( RenderData.Color );
-	ObjectColor.Bind( RenderData.ShaderProgram );
+	// Instanced shaders use the regular uniforms unless the render pass submits a batch.
+	Cache.Bind( InstanceOffsetName, -1 );
 }
 
-void CRenderable::Draw( FRenderData& RenderData, const CRenderable* PreviousRenderable, EDrawMode DrawModeOverride )
+void CRenderable::Draw( FRenderData& RenderData, const CRenderable* PreviousRenderable, EDrawMode DrawModeOverride, const uint32_t Instances )
 {
 	if( !RenderData.ShouldRender )
 		return;
@@ -202,7 +213,7 @@ void CRenderable::Draw( FRenderData& RenderData, const CRenderable* PreviousRend
 		glCullFace( GL_FRONT );
 	}
 
-	Mesh->Draw( DrawMode );
+	Mesh->Draw( DrawMode, static_cast<GLsizei>( Instances ) );
 
 	if( IsFlipped )
 	{
@@ -225,9 +236,9 @@ void CRenderable::FrustumCull( const CCamera& Camera, CRenderable* Renderable )
 	Culling::Frustum( Camera, Renderable );
 }
 
-void CRenderable::FrustumCull( const CCamera& Camera, const std::vector<CRenderable*>& Renderables )
+void CRenderable::FrustumCull( const CCamera& Camera, const std::vector<CRenderable*>& Renderables, const uint32_t Pass )
 {
-	Culling::Frustum( Camera, Renderables );
+	Culling::Frustum( Camera, Renderables, Pass );
 }
 
 static const GLenum StencilTestToEnum[EStencilTest::Maximum]
@@ -318,11 +329,7 @@ void CRenderable::Prepare( FRenderData& RenderData, const CRenderable* PreviousR
 			Texture->Bind( Slot );
 		}
 
-		const auto Location = TextureLocation[Index];
-		if( Location > -1 )
-		{
-			glUniform1i( Location, Index );
-		}
+		Shader->GetUniformCache().Bind( GetTextureSlotName( Index ), static_cast<int>( Index ) );
 
 		Slot = static_cast<ETextureSlot>( Index + 1 );
 	}
@@ -334,27 +341,19 @@ bool CRenderable::ShouldBindTextures( const CRenderable* PreviousRenderable )
 		return false;
 
 	// Check if the previous renderable was using the same textures.
-	bool TextureMatch = true;
-	if( PreviousRenderable )
-	{
-		for( ETextureSlot Slot = ETextureSlot::Slot0; Slot < ETextureSlot::Maximum; )
-		{
-			const auto Index = static_cast<ETextureSlotType>( Slot );
-			const auto* TextureA = Textures[Index];
-			const auto* TextureB = PreviousRenderable->Textures[Index];
-			if( TextureA != TextureB )
-			{
-				TextureMatch = false;
-				break;
-			}
-
-			Slot = static_cast<ETextureSlot>( Index + 1 );
-		}
-	}
-	else
+	return !PreviousRenderable || !SharesTextures( PreviousRenderable );
+}
+
+bool CRenderable::SharesTextures( const CRenderable* Renderable ) const
+{
+	for( ETextureSlot Slot = ETextureSlot::Slot0; Slot < ETextureSlot::Maximum; )
 	{
-		TextureMatch = false;
+		const auto Index = static_cast<ETextureSlotType>( Slot );
+		if( Textures[Index] != Renderable->Textures[Index] )
+			return false;
+
+		Slot = static_cast<ETextureSlot>( Index + 1 );
 	}
 
-	return !TextureMatch;
+	return true;
 }
@@ -48,6 +48,9 @@ struct FRenderData
 	BoundingBox WorldBounds{};
 	Vector4D Color = Vector4D( 1.0f, 1.0f, 1.0f, 1.0f );
 	LightIndices LightIndex;
+
+	// Culling pass during which a render hierarchy has already determined the visibility.
+	uint32_t CullingPass = 0;
 };
 
 struct FRenderDataInstanced : public FRenderData
@@ -76,10 +79,14 @@ public:
 		return Uniforms;
 	}
 	void SetUniform( const std::string& Name, const Uniform& Uniform );
+	void SetUniform( const UniformId Id, const Uniform& Uniform );
 	void CheckCachedUniforms();
 
 	void BindUniforms();
-	virtual void Draw( FRenderData& RenderData, const CRenderable* PreviousRenderable, EDrawMode DrawModeOverride = None );
+	virtual void Draw( FRenderData& RenderData, const CRenderable* PreviousRenderable, EDrawMode DrawModeOverride = None, const uint32_t Instances = 1 );
+
+	// Checks if the other renderable is using the same textures.
+	bool SharesTextures( const CRenderable* Renderable ) const;
 
 	FRenderDataInstanced& GetRenderData();
 	FRenderDataInstanced GetRenderData() const;
@@ -87,7 +94,7 @@ public:
 	bool HasSkeleton = false;
 
 	static void FrustumCull( const class CCamera& Camera, CRenderable* Renderable );
-	static void FrustumCull( const class CCamera& Camera, const std::vector<CRenderable*>& Renderables );
+	static void FrustumCull( const class CCamera& Camera, const std::vector<CRenderable*>& Renderables, const uint32_t Pass = 0 );
 
 protected:
 	CTexture* Textures[TextureSlots];
@@ -99,17 +106,6 @@ protected:
 	// Checks if the renderable is using the same textures.
 	bool ShouldBindTextures( const CRenderable* PreviousRenderable );
 
-	// Uniform location
-	int TextureLocation[TextureSlots];
-
 	FRenderDataInstanced RenderData;
 	UniformMap Uniforms;
-
-	// Individual uniforms.
-	Uniform ObjectPosition = { "ObjectPosition" };
-	Uniform LightIndices = { "LightIndices" };
-	Uniform ObjectBoundsMinimum = { "ObjectBoundsMinimum" };
-	Uniform ObjectBoundsMaximum = { "ObjectBoundsMaximum" };
-	Uniform ModelMatrix = { "Model" };
-	Uniform ObjectColor = { "ObjectColor" };
 };
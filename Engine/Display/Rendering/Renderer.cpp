@@ -10,13 +10,16 @@
 
 #include <Engine/Configuration/Configuration.h>
 
+#include <Engine/Display/Rendering/DynamicStorageBuffer.h>
 #include <Engine/Display/Rendering/Mesh.h>
 #include <Engine/Display/Rendering/Shader.h>
 #include <Engine/Display/Rendering/Texture.h>
+#include <Engine/Display/Rendering/TextureStreaming.h>
 #include <Engine/Display/Rendering/FramebufferTexture.h>
 #include <Engine/Display/Rendering/Noise.h>
 #include <Engine/Display/Rendering/RenderTexture.h>
 #include <Engine/Display/Rendering/RenderPass.h>
+#include <Engine/Display/Rendering/RenderKey.h>
 #include <Engine/Display/Rendering/Pass/ShadowPass.h>
 #include <Engine/Display/Window.h>
 #include <Engine/Display/UserInterface.h>
@@ -36,7 +39,6 @@
 #include "Renderable.h"
 #include "Camera.h"
 
-#define SORT(A, B, Member) if( A.Member != B.Member ) return ExclusiveComparison(A.Member, B.Member)
 
 constexpr size_t RenderableCapacity = 1 << 12;
 
@@ -118,7 +120,7 @@ CRenderer::~CRenderer()
 {
 	Renderables.clear();
 	DynamicRenderables.clear();
-	GlobalUniformBuffers.clear();
+	GlobalUniformBuffers.Clear();
 }
 
 constexpr int GeneratedSize = 64;
@@ -266,7 +268,7 @@ void CRenderer::Initialize()
 	ResolveShader = Assets.CreateNamedShader( "Resolve", "Shaders/FullScreenTriangle", "Shaders/Resolve" );
 	ImageProcessingShader = Assets.CreateNamedShader( "ImageProcessing", "Shaders/FullScreenTriangle", "Shaders/ImageProcessing" );
 
-	GlobalUniformBuffers.clear();
+	GlobalUniformBuffers.Clear();
 
 	SkipRenderPasses = CConfiguration::Get().GetInteger( "render.SkipPasses", 0 ) > 0;
 	PreviousSuperSampling = SuperSampling.Get();
@@ -331,6 +333,28 @@ void CRenderer::QueueDynamicRenderable( CRenderable* Renderable )
 	DynamicRenderables.emplace_back( Renderable );
 }
 
+void CRenderer::QueueHierarchy( const CRenderHierarchy* Hierarchy )
+{
+	if( CWindow::Get().IsWindowless() )
+		return;
+
+	Hierarchies.emplace_back( Hierarchy );
+}
+
+void CRenderer::CullHierarchies( const CCamera& Camera, const uint32_t Pass )
+{
+	if( Hierarchies.empty() )
+		return;
+
+	OptickEvent();
+
+	const auto Frustum = Camera.GetFrustum();
+	for( const auto* Hierarchy : Hierarchies )
+	{
+		Hierarchy->Cull( Frustum, Pass, HierarchyStatistics );
+	}
+}
+
 void CRenderer::DrawQueuedRenderables()
 {
 	UI::SetCamera( Camera );
@@ -338,6 +362,11 @@ void CRenderer::DrawQueuedRenderables()
 
 	// Make sure memory transactions have occured. (for shader storage buffers)
 	glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT );
+
+	{
+		Profile( "Texture Uploads" );
+		TextureStreaming::Update();
+	}
 	
 	int FramebufferWidth = ViewportWidth;
 	int FramebufferHeight = ViewportHeight;
@@ -612,23 +641,50 @@ void CRenderer::DrawQueuedRenderables()
 		DrawPasses( RenderPassLocation::Standard );
 	}
 
-	CProfiler& Profiler = CProfiler::Get();
-	Profiler.AddCounterEntry( { "Draw Calls", DrawCalls }, true );
+	ProfileCounter( "Draw Calls", DrawCalls );
 
 	const int64_t RenderQueueOpaqueSize = static_cast<int64_t>( RenderQueueOpaque.size() );
-	Profiler.AddCounterEntry( { "Render Queue (Opaque)", RenderQueueOpaqueSize }, true );
+	ProfileCounter( "Render Queue (Opaque)", RenderQueueOpaqueSize );
 
 	const int64_t RenderQueueTranslucentSize = static_cast<int64_t>( RenderQueueTranslucent.size() );
-	Profiler.AddCounterEntry( { "Render Queue (Translucent)", RenderQueueTranslucentSize }, true );
+	ProfileCounter( "Render Queue (Translucent)", RenderQueueTranslucentSize );
 
 	const int64_t RenderablesSize = static_cast<int64_t>( Renderables.size() );
-	Profiler.AddCounterEntry( { "Renderables", RenderablesSize }, true );
+	ProfileCounter( "Renderables", RenderablesSize );
 
 	const int64_t RenderablesPerFrameSize = static_cast<int64_t>( RenderablesPerFrame.size() );
-	Profiler.AddCounterEntry( { "Renderables (Frame)", RenderablesPerFrameSize }, true );
+	ProfileCounter( "Renderables (Frame)", RenderablesPerFrameSize );
 
 	const int64_t DynamicRenderablesSize = static_cast<int64_t>( DynamicRenderables.size() );
-	Profiler.AddCounterEntry( { "Renderables (Dynamic)", DynamicRenderablesSize }, true );
+	ProfileCounter( "Renderables (Dynamic)", DynamicRenderablesSize );
+
+	ProfileCounter( "Hierarchy Nodes Tested", HierarchyStatistics.Tested );
+	ProfileCounter( "Hierarchy Nodes Culled", HierarchyStatistics.Rejected );
+	ProfileCounter( "Hierarchy Nodes Accepted", HierarchyStatistics.Accepted );
+	ProfileCounter( "Hierarchy Renderables Accepted", HierarchyStatistics.Emitted );
+	ProfileCounter( "Hierarchy Renderables Tested", HierarchyStatistics.Objects );
+	HierarchyStatistics = RenderHierarchyStatistics();
+
+	const auto& Uniforms = UniformDispatch::Statistics();
+	ProfileCounter( "Uniform Lookups", Uniforms.Lookups );
+	ProfileCounter( "Uniform Calls", Uniforms.Calls );
+	ProfileCounter( "Uniform Calls Skipped", Uniforms.Skipped );
+	UniformDispatch::ResetStatistics();
+
+	const auto& StorageBuffers = StorageBufferDispatch::Statistics();
+	ProfileCounter( "Storage Buffer Bytes", StorageBuffers.Bytes );
+	ProfileCounter( "Storage Buffer Ranges", StorageBuffers.Ranges );
+	ProfileCounter( "Storage Buffer Waits", StorageBuffers.Waits );
+	StorageBufferDispatch::ResetStatistics();
+
+	const auto Streaming = TextureStreaming::Statistics();
+	ProfileCounter( "Texture Upload Bytes", Streaming.UploadedBytes );
+	ProfileCounter( "Textures Uploaded", Streaming.Uploaded );
+
+	const int64_t TexturesPending = static_cast<int64_t>( TextureStreaming::Pending() );
+	ProfileCounter( "Textures Pending", TexturesPending );
+	TextureStreaming::ResetStatistics();
+	Hierarchies.clear();
 
 	// Clean up render passes.
 	Passes.clear();
@@ -639,15 +695,12 @@ void CRenderer::DrawQueuedRenderables()
 
 void CRenderer::SetUniform( const std::string& Name, const Uniform& Value )
 {
-	GlobalUniformBuffers.insert_or_assign( Name, Value );
+	GlobalUniformBuffers.Set( Name, Value );
 }
 
-void CRenderer::BindGlobalUniformsToProgram( uint32_t Program )
+void CRenderer::BindGlobalUniforms( CUniformCache& Cache )
 {
-	for( auto& UniformBuffer : GlobalUniformBuffers )
-	{
-		UniformBuffer.second.Bind( Program, UniformBuffer.first );
-	}
+	Cache.Bind( GlobalUniformBuffers );
 }
 
 const CCamera& CRenderer::GetCamera() const
@@ -893,36 +946,37 @@ void CRenderer::SortQueue()
 {
 	OptickEvent();
 
-	auto SortRenderables = []( CRenderable* A, CRenderable* B ) {
-		const auto& RenderDataA = A->GetRenderData();
-		const auto& RenderDataB = B->GetRenderData();
-
-		SORT( RenderDataA, RenderDataB, ShaderProgram );
-		SORT( RenderDataA, RenderDataB, IndexBufferObject );
-		SORT( RenderDataA, RenderDataB, VertexBufferObject );
+	SortQueue( RenderQueueOpaque, false );
+	SortQueue( RenderQueueTranslucent, true );
+}
 
-		return false;
-	};
+void CRenderer::SortQueue( std::vector<CRenderable*>& Queue, const bool Translucent )
+{
+	if( Queue.size() < 2 )
+		return;
 
-	auto SortRenderablesTranslucent = [this]( CRenderable* A, CRenderable* B ) {
-		const auto& RenderDataA = A->GetRenderData();
-		const auto& RenderDataB = B->GetRenderData();
+	// Gather everything we need from the renderables up front so that the sort itself only touches the keys.
+	const auto& CameraPosition = Camera.GetCameraPosition();
+	SortKeys.clear();
+	SortKeys.reserve( Queue.size() );
+	for( auto* Renderable : Queue )
+	{
+		const auto& RenderData = Renderable->GetRenderData();
+		const auto* Shader = Renderable->GetShader();
+		const auto BlendMode = Shader ? Shader->GetBlendMode() : EBlendMode::Opaque;
+		const auto DistanceSquared = CameraPosition.DistanceSquared( RenderData.Transform.GetPosition() );
 
-		SORT( RenderDataA, RenderDataB, ShaderProgram );
-		SORT( RenderDataA, RenderDataB, IndexBufferObject );
-		SORT( RenderDataA, RenderDataB, VertexBufferObject );
+		SortKeys.emplace_back( RenderKey::Create( Translucent, BlendMode, RenderData.ShaderProgram,
+			RenderData.IndexBufferObject, RenderData.VertexBufferObject, DistanceSquared ) );
+	}
 
-		// Distance sorting.
-		const auto DistanceA = Camera.GetCameraPosition().DistanceSquared( RenderDataA.Transform.GetPosition() );
-		const auto DistanceB = Camera.GetCameraPosition().DistanceSquared( RenderDataB.Transform.GetPosition() );
-		if( DistanceA != DistanceB )
-		{
-			return ExclusiveComparisonFlipped( DistanceA, DistanceB );
-		}
+	RenderKey::Sort( SortKeys, SortIndices, SortScratchKeys, SortScratchIndices );
 
-		return false;
-	};
+	SortedQueue.resize( Queue.size() );
+	for( size_t Index = 0; Index < SortIndices.size(); Index++ )
+	{
+		SortedQueue[Index] = Queue[SortIndices[Index]];
+	}
 
-	std::sort( RenderQueueOpaque.begin(), RenderQueueOpaque.end(), SortRenderables );
-	std::sort( RenderQueueTranslucent.begin(), RenderQueueTranslucent.end(), SortRenderablesTranslucent );
+	Queue.swap( SortedQueue );
 }
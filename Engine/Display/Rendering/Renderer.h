@@ -4,6 +4,7 @@
 #include <vector>
 #include <unordered_map>
 
+#include <Engine/Display/Rendering/RenderHierarchy.h>
 #include <Engine/Display/Rendering/RenderPass.h>
 #include <Engine/Display/Rendering/RenderTexture.h>
 #include <Engine/Display/Rendering/Uniform.h>
@@ -13,6 +14,7 @@
 class CMesh;
 class CShader;
 class CRenderable;
+class CUniformCache;
 
 namespace RenderPassLocation
 {
@@ -95,10 +97,14 @@ public:
 
 	void QueueRenderable( CRenderable* Renderable );
 	void QueueDynamicRenderable( CRenderable* Renderable );
+
+	// Hierarchies are queued every frame, their renderables are culled per subtree.
+	void QueueHierarchy( const CRenderHierarchy* Hierarchy );
+	void CullHierarchies( const CCamera& Camera, const uint32_t Pass );
 	void DrawQueuedRenderables();
 
 	void SetUniform( const std::string& Name, const Uniform& Value );
-	void BindGlobalUniformsToProgram( uint32_t Program );
+	void BindGlobalUniforms( CUniformCache& Cache );
 
 	const CCamera& GetCamera() const;
 	void SetCamera( const CCamera& CameraIn );
@@ -130,6 +136,7 @@ private:
 
 	// Sorts the render queues.
 	void SortQueue();
+	void SortQueue( std::vector<CRenderable*>& Queue, const bool Translucent );
 
 	int64_t DrawCalls = 0;
 	
@@ -138,6 +145,13 @@ private:
 
 	// Translucent queue for a single frame. Used to concatenate renderable vectors.
 	std::vector<CRenderable*> RenderQueueTranslucent;
+
+	// Sort keys and scratch buffers, kept around to avoid allocating them every frame.
+	std::vector<uint64_t> SortKeys;
+	std::vector<uint64_t> SortScratchKeys;
+	std::vector<uint32_t> SortIndices;
+	std::vector<uint32_t> SortScratchIndices;
+	std::vector<CRenderable*> SortedQueue;
 	
 	// Persistent renderables that are added in tick functions.
 	std::vector<CRenderable*> Renderables;
@@ -147,6 +161,10 @@ private:
 
 	// Dynamic renderables that are deleted by the renderer after they have been rendered.
 	std::vector<CRenderable*> DynamicRenderables;
+
+	// Level hierarchies that have been queued for this frame.
+	std::vector<const CRenderHierarchy*> Hierarchies;
+	RenderHierarchyStatistics HierarchyStatistics;
 	UniformMap GlobalUniformBuffers;
 
 	// The main framebuffer.
@@ -1,7 +1,9 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "Shader.h"
 #include <Engine/Configuration/Configuration.h>
+#include <Engine/Display/Rendering/ShaderCache.h>
 #include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Hash.h>
 #include <Engine/Utility/Math.h>
 
 #include <sstream>
@@ -9,6 +11,12 @@
 // Depth pre-pass.
 ConRef<bool> UsePrePass( "render.PrePass" );
 
+// Skips the preprocessor for stages that haven't changed since they were last processed.
+ConfigurationVariable<bool> UseShaderCache( "render.ShaderCache", true );
+
+// Loads linked programs from disk instead of compiling them.
+ConfigurationVariable<bool> UseProgramBinaryCache( "render.ShaderBinaryCache", true );
+
 #define EnableAutoReload 0
 
 // Compares the input file's modification date to that of the provided reference time.
@@ -24,6 +32,75 @@ bool IsModified( const std::string& Location, const time_t& Time )
 	return false;
 }
 
+static FShaderDefines GetDefines()
+{
+	FShaderDefines Defines;
+	Defines.PrePass = UsePrePass.Get();
+	return Defines;
+}
+
+// Program binaries are only valid for the driver that created them.
+static const std::string& GetDriver()
+{
+	static std::string Driver;
+	if( Driver.empty() )
+	{
+		for( const GLenum Name : { GL_VENDOR, GL_RENDERER, GL_VERSION } )
+		{
+			const auto* String = reinterpret_cast<const char*>( glGetString( Name ) );
+			Driver += String ? String : "";
+			Driver += "|";
+		}
+	}
+
+	return Driver;
+}
+
+static GLuint LoadProgramBinary( const uint64_t Key )
+{
+	GLint Formats = 0;
+	glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &Formats );
+	if( Formats < 1 )
+		return 0;
+
+	std::vector<char> Binary;
+	uint32_t Format = 0;
+	if( !ShaderCache::LoadBinary( Key, GetDriver(), Binary, Format ) )
+		return 0;
+
+	const GLuint Program = glCreateProgram();
+	glProgramBinary( Program, static_cast<GLenum>( Format ), Binary.data(), static_cast<GLsizei>( Binary.size() ) );
+
+	// Drivers can reject binaries for their own reasons, the program will be compiled instead.
+	GLint Status = GL_FALSE;
+	glGetProgramiv( Program, GL_LINK_STATUS, &Status );
+	if( Status != GL_TRUE )
+	{
+		glDeleteProgram( Program );
+		return 0;
+	}
+
+	return Program;
+}
+
+static void SaveProgramBinary( const GLuint Program, const uint64_t Key )
+{
+	GLint Length = 0;
+	glGetProgramiv( Program, GL_PROGRAM_BINARY_LENGTH, &Length );
+	if( Length < 1 )
+		return;
+
+	std::vector<char> Binary( static_cast<size_t>( Length ) );
+	GLenum Format = 0;
+	GLsizei Written = 0;
+	glGetProgramBinary( Program, Length, &Written, &Format, Binary.data() );
+	if( Written < 1 )
+		return;
+
+	Binary.resize( static_cast<size_t>( Written ) );
+	ShaderCache::SaveBinary( Key, GetDriver(), Binary, static_cast<uint32_t>( Format ) );
+}
+
 CShader::CShader()
 {
 	ModificationTime = time( nullptr );
@@ -35,6 +112,10 @@ CShader::CShader()
 
 bool CShader::Load( const bool& ShouldLink )
 {
+	// Set again by the preprocessor if any of the stages still uses the directive.
+	Instanced = false;
+	SourceHash = FNV::Seed64;
+
 	const bool BuildGeometryShader = ShaderType == EShaderType::Geometry;
 	const bool BuildVertexShader = ShaderType == EShaderType::Vertex || ShaderType == EShaderType::Fragment || BuildGeometryShader;
 	const bool BuildFragmentShader = ShaderType == EShaderType::Fragment || BuildGeometryShader;
@@ -118,6 +199,9 @@ bool CShader::Load( const char* VertexLocationIn, const char* FragmentLocationIn
 	FragmentLocation = FragmentLocationIn;
 	FragmentLocation += ".fs";
 
+	Instanced = false;
+	SourceHash = FNV::Seed64;
+
 	bool CanLink = true;
 	if( !Load( VertexLocation, Handles.VertexShader, EShaderType::Vertex ) )
 	{
@@ -144,32 +228,44 @@ bool CShader::Load( const std::string& FileLocation, GLuint& HandleIn, const ESh
 	CFile ShaderSource( FileLocation );
 	if( !ShaderSource.Exists() )
 		return false;
-	
-	const bool Loaded = ShaderSource.Load();
 
 	// Update the modification time in case we want to automatially reload the file when it has been changed.
 	ModificationTime = ShaderSource.ModificationDate() > ModificationTime ? ShaderSource.ModificationDate() : ModificationTime;
 
-	if( Loaded )
+	std::string Data;
+	if( UseShaderCache.Get() )
 	{
-		const std::string Data = Process( ShaderSource );
-		const char* ProcessedCode = Data.c_str();
-		if( ProcessedCode )
-		{
-			// NOTE: If a render pass crashes here, it means it is tring to load a shader before OpenGL and GLAD have been initialized.
-			const auto NativeType = static_cast<GLuint>( Type );
-			HandleIn = glCreateShader( NativeType );
-			if( HandleIn > 0 )
-			{
-				glShaderSource( HandleIn, 1, &ProcessedCode, nullptr );
+		FPreprocessedShader Preprocessed;
+		if( !ShaderCache::Load( FileLocation, GetDefines(), Preprocessed ) )
+			return false;
 
-				return true;
-			}
-			else
-			{
-				Log::Event( Log::Error, "Failed to create shader \"%s\".\n", FileLocation.c_str() );
-			}
-		}
+		Apply( Preprocessed.Directives );
+		Data = std::move( Preprocessed.Code );
+		AddSource( Type, Preprocessed.Hash );
+	}
+	else
+	{
+		if( !ShaderSource.Load() )
+			return false;
+
+		Data = Process( ShaderSource );
+		AddSource( Type, FNV::Bytes64( Data ) );
+	}
+
+	const char* ProcessedCode = Data.c_str();
+
+	// NOTE: If a render pass crashes here, it means it is tring to load a shader before OpenGL and GLAD have been initialized.
+	const auto NativeType = static_cast<GLuint>( Type );
+	HandleIn = glCreateShader( NativeType );
+	if( HandleIn > 0 )
+	{
+		glShaderSource( HandleIn, 1, &ProcessedCode, nullptr );
+
+		return true;
+	}
+	else
+	{
+		Log::Event( Log::Error, "Failed to create shader \"%s\".\n", FileLocation.c_str() );
 	}
 
 	return false;
@@ -178,6 +274,8 @@ bool CShader::Load( const std::string& FileLocation, GLuint& HandleIn, const ESh
 bool CShader::Load( GLuint& HandleIn, const EShaderType& Type, const std::string& Code )
 {
 	const std::string Data = Process( Code );
+	AddSource( Type, FNV::Bytes64( Data ) );
+
 	const char* ProcessedCode = Data.c_str();
 	if( ProcessedCode )
 	{
@@ -296,131 +394,33 @@ std::string CShader::Process( const std::string& Data )
 
 std::string CShader::Process( std::stringstream& Stream )
 {
-	if( UsePrePass )
-	{
-		// Default to equal, if we're running a pre-pass.
-		DepthTest = EDepthTest::LessEqual;
-		DepthMask = EDepthMask::Ignore;
-	}
-	else
-	{
-		DepthTest = EDepthTest::Less;
-		DepthMask = EDepthMask::Write;
-	}
-
-	std::stringstream OutputStream;
-	std::string Line;
-	while( std::getline( Stream, Line ) )
-	{
-		bool bParsed = false;
-		if( Line[0] == '#' )
-		{
-			std::stringstream LineStream( Line );
-			std::string Preprocessor;
-			LineStream >> Preprocessor;
+	FPreprocessedShader Preprocessed;
+	ShaderCache::Preprocess( Stream, GetDefines(), Preprocessed );
+	Apply( Preprocessed.Directives );
 
-			if( Preprocessor == "#include" )
-			{
-				std::string Path;
-				LineStream >> Path;
-
-				Path = Path.substr( 1, Path.length() - 2 );
-				bParsed = true;
-
-				std::stringstream ShaderPath;
-				ShaderPath << "Shaders/" << Path;
-				CFile IncludeSource( ShaderPath.str() );
-				const bool Loaded = IncludeSource.Load();
-
-				if( Loaded )
-				{
-					const char* IncludeData = IncludeSource.Fetch<char>();
-					OutputStream << "\n" << IncludeData << "\n";
-				}
-			}
-			else if( Preprocessor == "#blendmode" )
-			{
-				std::string Mode;
-				LineStream >> Mode;
-
-				BlendMode = EBlendMode::Opaque;
-
-				if( Mode == "alpha" )
-				{
-					BlendMode = EBlendMode::Alpha;
-				}
-				else if( Mode == "additive" )
-				{
-					BlendMode = EBlendMode::Additive;
-				}
-
-				bParsed = true;
-			}
-			else if( Preprocessor == "#depthwrite" )
-			{
-				std::string Mode;
-				LineStream >> Mode;
-
-				DepthMask = EDepthMask::Write;
+	return Preprocessed.Code;
+}
 
-				if( Mode == "0" )
-				{
-					DepthMask = EDepthMask::Ignore;
-				}
+void CShader::Apply( const FShaderDirectives& Directives )
+{
+	DepthTest = Directives.DepthTest;
+	DepthMask = Directives.DepthMask;
 
-				bParsed = true;
-			}
-			else if( Preprocessor == "#depthtest" )
-			{
-				std::string Mode;
-				LineStream >> Mode;
-
-				DepthTest = EDepthTest::Less;
-
-				if( Mode == "0" )
-				{
-					DepthTest = EDepthTest::Never;
-				}
-				else if( Mode == "<" )
-				{
-					DepthTest = EDepthTest::Less;
-				}
-				else if( Mode == "<=" )
-				{
-					DepthTest = EDepthTest::LessEqual;
-				}
-				else if( Mode == "==" )
-				{
-					DepthTest = EDepthTest::Equal;
-				}
-				else if( Mode == ">" )
-				{
-					DepthTest = EDepthTest::Greater;
-				}
-				else if( Mode == "!=" )
-				{
-					DepthTest = EDepthTest::NotEqual;
-				}
-				else if( Mode == ">=" )
-				{
-					DepthTest = EDepthTest::GreaterEqual;
-				}
-				else if( Mode == "1" )
-				{
-					DepthTest = EDepthTest::Always;
-				}
-
-				bParsed = true;
-			}
-		}
+	if( Directives.HasBlendMode )
+	{
+		BlendMode = Directives.BlendMode;
+	}
 
-		if( !bParsed )
-		{
-			OutputStream << Line << "\n";
-		}
+	if( Directives.Instanced )
+	{
+		Instanced = true;
 	}
+}
 
-	return OutputStream.str();
+void CShader::AddSource( const EShaderType& Type, const uint64_t Hash )
+{
+	SourceHash = FNV::Bytes64( &Type, sizeof( Type ), SourceHash );
+	SourceHash = FNV::Bytes64( &Hash, sizeof( Hash ), SourceHash );
 }
 
 GLuint CShader::Link()
@@ -454,6 +454,47 @@ GLuint CShader::Link()
 		return 0;
 	}
 
+	// Programs built from the same expanded stages can be loaded from the binary cache.
+	const bool UseBinary = UseProgramBinaryCache.Get();
+	const uint64_t BinaryKey = FNV::Bytes64( &ShaderType, sizeof( ShaderType ), SourceHash );
+	if( UseBinary )
+	{
+		const GLuint CachedProgram = LoadProgramBinary( BinaryKey );
+		if( CachedProgram != 0 )
+		{
+			ShaderCache::Statistics().BinaryHits++;
+
+			if( NeedsVertexShader )
+			{
+				glDeleteShader( Handles.VertexShader );
+			}
+
+			if( NeedsGeometryShader )
+			{
+				glDeleteShader( Handles.GeometryShader );
+			}
+
+			if( NeedsFragmentShader )
+			{
+				glDeleteShader( Handles.FragmentShader );
+			}
+
+			if( NeedsComputeShader )
+			{
+				glDeleteShader( Handles.ComputeShader );
+			}
+
+			Handles.Program = CachedProgram;
+			UniformCache.Reset( Handles.Program );
+
+			GatherDefaults();
+
+			return Handles.Program;
+		}
+
+		ShaderCache::Statistics().BinaryMisses++;
+	}
+
 	// Compile all shaders
 	bool ShaderCompiled = false;
 	
@@ -544,6 +585,11 @@ GLuint CShader::Link()
 		glAttachShader( ProgramHandle, Handles.ComputeShader );
 	}
 
+	if( UseBinary )
+	{
+		glProgramParameteri( ProgramHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+	}
+
 	// Link and set program to use
 	glLinkProgram( ProgramHandle );
 
@@ -574,7 +620,13 @@ GLuint CShader::Link()
 		return 0;
 	}
 
+	if( UseBinary )
+	{
+		SaveProgramBinary( ProgramHandle, BinaryKey );
+	}
+
 	Handles.Program = ProgramHandle;
+	UniformCache.Reset( Handles.Program );
 
 	GatherDefaults();
 
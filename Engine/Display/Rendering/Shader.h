@@ -2,11 +2,13 @@
 #pragma once
 
 #include "glad/glad.h"
+#include <iosfwd>
 #include <string>
 #include <array>
 
 #include <Engine/Utility/File.h>
 #include <Engine/Display/Rendering/Uniform.h>
+#include <Engine/Display/Rendering/UniformCache.h>
 
 enum class EShaderType : uint16_t
 {
@@ -18,6 +20,8 @@ enum class EShaderType : uint16_t
 	TesselationEvaluation = GL_TESS_EVALUATION_SHADER
 };
 
+struct FShaderDirectives;
+
 namespace EBlendMode
 {
 	enum Type
@@ -91,6 +95,12 @@ public:
 	const EDepthMask::Type& GetDepthMask() const;
 	const EDepthTest::Type& GetDepthTest() const;
 
+	// True when the shader has opted into instanced batching using the #instanced directive.
+	bool IsInstanced() const
+	{
+		return Instanced;
+	}
+
 	void AutoReload( const bool& Enable );
 	bool AutoReload() const
 	{
@@ -100,12 +110,26 @@ public:
 	// Returns the default values of non-sampler uniforms.
 	const std::vector<std::pair<std::string, Uniform>>& GetDefaults() const;
 
+	// Runs the preprocessor directives (#include, #blendmode, #instanced, etc.) over the given code.
+	std::string Process( const std::string& Data );
+
+	// Locations and last uploaded values of the program's uniforms.
+	CUniformCache& GetUniformCache()
+	{
+		return UniformCache;
+	}
+
 private:
 	std::string Process( const CFile& File );
-	std::string Process( const std::string& Data );
 	std::string Process( std::stringstream& Stream );
 	GLuint Link();
 
+	// Applies the render state requested by a stage's directives.
+	void Apply( const FShaderDirectives& Directives );
+
+	// Folds a stage's expanded code into the key of the program binary.
+	void AddSource( const EShaderType& Type, const uint64_t Hash );
+
 	FProgramHandles Handles;
 
 	std::string Location;
@@ -126,11 +150,19 @@ private:
 	time_t ModificationTime;
 	bool ShouldAutoReload = false;
 
+	// Reads the per-object data from the instance buffer.
+	bool Instanced = false;
+
+	// Hash of the expanded stages that were loaded since the last link.
+	uint64_t SourceHash = 0;
+
 	// Stores the default values of non-sampler uniforms.
 	std::vector<std::pair<std::string, Uniform>> Defaults;
 
 	void GatherDefaults();
 
+	CUniformCache UniformCache;
+
 	bool LogErrorsShader( GLuint Handle, const EShaderType Type = EShaderType::TesselationEvaluation, const char* Label = nullptr );
 	bool LogErrorsProgram( GLuint Handle );
 };
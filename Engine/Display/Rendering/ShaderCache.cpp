@@ -0,0 +1,478 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/Hash.h>
+
+// Replaces the #instanced directive. Use InstanceModel( Model ) etc. in the vertex shader.
+// The instance offset is negative when a renderable is drawn on its own, which falls back to the regular uniforms.
+static const char* InstancedHeader = R"(
+#define INSTANCED 1
+struct InstanceData
+{
+	mat4 Model;
+	vec4 Color;
+	vec4 Position;
+	ivec4 LightIndices;
+};
+
+layout( std430, binding = 1 ) readonly buffer InstanceBuffer
+{
+	InstanceData Instances[];
+};
+
+uniform int InstanceOffset = -1;
+
+#define InstanceIndex ( InstanceOffset + gl_InstanceID )
+#define InstanceModel( Fallback ) ( InstanceOffset < 0 ? Fallback : Instances[InstanceIndex].Model )
+#define InstanceColor( Fallback ) ( InstanceOffset < 0 ? Fallback : Instances[InstanceIndex].Color )
+#define InstancePosition( Fallback ) ( InstanceOffset < 0 ? Fallback : Instances[InstanceIndex].Position.xyz )
+#define InstanceLightIndices( Fallback ) ( InstanceOffset < 0 ? Fallback : Instances[InstanceIndex].LightIndices )
+)";
+
+// Bump these when the layout of the cache files changes.
+static const char SourceMagic[4] = { 'S', 'S', 'C', '1' };
+static const char BinaryMagic[4] = { 'S', 'P', 'B', '1' };
+
+static std::string CacheDirectory = "Cache/Shaders/";
+static std::unordered_map<uint64_t, FPreprocessedShader> Entries;
+static ShaderCacheStatistics Counters;
+
+static FShaderDependency Describe( const std::string& Location )
+{
+	FShaderDependency Dependency;
+	Dependency.Location = Location;
+
+	struct stat Information;
+	if( stat( Location.c_str(), &Information ) == 0 )
+	{
+		Dependency.ModificationTime = static_cast<int64_t>( Information.st_mtime );
+		Dependency.Size = static_cast<int64_t>( Information.st_size );
+	}
+
+	return Dependency;
+}
+
+static bool IsCurrent( const FPreprocessedShader& Entry )
+{
+	for( const auto& Dependency : Entry.Dependencies )
+	{
+		const auto Current = Describe( Dependency.Location );
+		if( Current.ModificationTime != Dependency.ModificationTime || Current.Size != Dependency.Size )
+			return false;
+	}
+
+	return !Entry.Dependencies.empty();
+}
+
+static std::string GetLocation( const uint64_t Key, const char* Extension )
+{
+	char Name[32];
+	snprintf( Name, sizeof( Name ), "%016llx.%s", static_cast<unsigned long long>( Key ), Extension );
+	return CacheDirectory + Name;
+}
+
+template<typename T>
+static void Write( std::string& Buffer, const T& Value )
+{
+	static_assert( std::is_trivially_copyable<T>::value, "Only plain values can be written directly." );
+	Buffer.append( reinterpret_cast<const char*>( &Value ), sizeof( T ) );
+}
+
+static void Write( std::string& Buffer, const std::string& Value )
+{
+	Write( Buffer, static_cast<uint32_t>( Value.size() ) );
+	Buffer.append( Value );
+}
+
+// Reads from a file that was loaded into memory, fails instead of reading past the end.
+struct Reader
+{
+	const char* Cursor = nullptr;
+	const char* End = nullptr;
+
+	template<typename T>
+	bool Read( T& Value )
+	{
+		if( static_cast<size_t>( End - Cursor ) < sizeof( T ) )
+			return false;
+
+		std::memcpy( &Value, Cursor, sizeof( T ) );
+		Cursor += sizeof( T );
+		return true;
+	}
+
+	bool Read( std::string& Value )
+	{
+		uint32_t Size = 0;
+		if( !Read( Size ) || static_cast<size_t>( End - Cursor ) < Size )
+			return false;
+
+		Value.assign( Cursor, Size );
+		Cursor += Size;
+		return true;
+	}
+
+	bool Check( const char Magic[4] )
+	{
+		if( End - Cursor < 4 || std::memcmp( Cursor, Magic, 4 ) != 0 )
+			return false;
+
+		Cursor += 4;
+		return true;
+	}
+};
+
+static bool Save( const std::string& Location, const std::string& Buffer )
+{
+	// The file takes ownership of the buffer.
+	char* Data = new char[Buffer.size()];
+	std::memcpy( Data, Buffer.data(), Buffer.size() );
+
+	CFile File( Location );
+	File.Load( Data, Buffer.size() );
+	return File.Save( true );
+}
+
+static bool LoadSource( const std::string& Location, const uint64_t DefinesHash, FPreprocessedShader& Entry )
+{
+	CFile File( GetLocation( FNV::Bytes64( Location, DefinesHash ), "ssc" ) );
+	if( !File.Exists() || !File.Load( true ) )
+		return false;
+
+	Reader Input;
+	Input.Cursor = File.Fetch<char>();
+	Input.End = Input.Cursor + File.Size();
+
+	std::string StoredLocation;
+	uint64_t StoredDefines = 0;
+	if( !Input.Check( SourceMagic ) || !Input.Read( StoredLocation ) || !Input.Read( StoredDefines ) )
+		return false;
+
+	// Guards against hash collisions.
+	if( StoredLocation != Location || StoredDefines != DefinesHash )
+		return false;
+
+	uint32_t Count = 0;
+	if( !Input.Read( Count ) )
+		return false;
+
+	Entry.Dependencies.resize( Count );
+	for( auto& Dependency : Entry.Dependencies )
+	{
+		if( !Input.Read( Dependency.Location ) || !Input.Read( Dependency.ModificationTime ) || !Input.Read( Dependency.Size ) )
+			return false;
+	}
+
+	int32_t BlendMode = 0;
+	int32_t DepthMask = 0;
+	int32_t DepthTest = 0;
+	uint8_t HasBlendMode = 0;
+	uint8_t Instanced = 0;
+	if( !Input.Read( BlendMode ) || !Input.Read( HasBlendMode ) || !Input.Read( DepthMask ) || !Input.Read( DepthTest ) || !Input.Read( Instanced ) )
+		return false;
+
+	Entry.Directives.BlendMode = static_cast<EBlendMode::Type>( BlendMode );
+	Entry.Directives.HasBlendMode = HasBlendMode != 0;
+	Entry.Directives.DepthMask = static_cast<EDepthMask::Type>( DepthMask );
+	Entry.Directives.DepthTest = static_cast<EDepthTest::Type>( DepthTest );
+	Entry.Directives.Instanced = Instanced != 0;
+
+	return Input.Read( Entry.Hash ) && Input.Read( Entry.Code );
+}
+
+static void SaveSource( const std::string& Location, const uint64_t DefinesHash, const FPreprocessedShader& Entry )
+{
+	std::string Buffer;
+	Buffer.reserve( Entry.Code.size() + 256 );
+	Buffer.append( SourceMagic, 4 );
+	Write( Buffer, Location );
+	Write( Buffer, DefinesHash );
+
+	Write( Buffer, static_cast<uint32_t>( Entry.Dependencies.size() ) );
+	for( const auto& Dependency : Entry.Dependencies )
+	{
+		Write( Buffer, Dependency.Location );
+		Write( Buffer, Dependency.ModificationTime );
+		Write( Buffer, Dependency.Size );
+	}
+
+	Write( Buffer, static_cast<int32_t>( Entry.Directives.BlendMode ) );
+	Write( Buffer, static_cast<uint8_t>( Entry.Directives.HasBlendMode ) );
+	Write( Buffer, static_cast<int32_t>( Entry.Directives.DepthMask ) );
+	Write( Buffer, static_cast<int32_t>( Entry.Directives.DepthTest ) );
+	Write( Buffer, static_cast<uint8_t>( Entry.Directives.Instanced ) );
+
+	Write( Buffer, Entry.Hash );
+	Write( Buffer, Entry.Code );
+
+	Save( GetLocation( FNV::Bytes64( Location, DefinesHash ), "ssc" ), Buffer );
+}
+
+uint64_t FShaderDefines::Hash() const
+{
+	const uint8_t Flags = PrePass ? 1 : 0;
+	return FNV::Bytes64( IncludeDirectory, FNV::Bytes64( &Flags, sizeof( Flags ) ) );
+}
+
+void ShaderCache::Preprocess( std::istream& Stream, const FShaderDefines& Defines, FPreprocessedShader& Output )
+{
+	auto& Directives = Output.Directives;
+	Directives = FShaderDirectives();
+
+	if( Defines.PrePass )
+	{
+		// Default to equal, if we're running a pre-pass.
+		Directives.DepthTest = EDepthTest::LessEqual;
+		Directives.DepthMask = EDepthMask::Ignore;
+	}
+	else
+	{
+		Directives.DepthTest = EDepthTest::Less;
+		Directives.DepthMask = EDepthMask::Write;
+	}
+
+	std::stringstream OutputStream;
+	std::string Line;
+	while( std::getline( Stream, Line ) )
+	{
+		bool bParsed = false;
+		if( Line[0] == '#' )
+		{
+			std::stringstream LineStream( Line );
+			std::string Preprocessor;
+			LineStream >> Preprocessor;
+
+			if( Preprocessor == "#include" )
+			{
+				std::string Path;
+				LineStream >> Path;
+
+				Path = Path.substr( 1, Path.length() - 2 );
+				bParsed = true;
+
+				const std::string IncludeLocation = Defines.IncludeDirectory + Path;
+				Output.Dependencies.emplace_back( Describe( IncludeLocation ) );
+
+				CFile IncludeSource( IncludeLocation );
+				const bool Loaded = IncludeSource.Load();
+
+				const char* IncludeData = IncludeSource.Fetch<char>();
+				if( Loaded && IncludeData )
+				{
+					OutputStream << "\n" << IncludeData << "\n";
+				}
+			}
+			else if( Preprocessor == "#blendmode" )
+			{
+				std::string Mode;
+				LineStream >> Mode;
+
+				Directives.BlendMode = EBlendMode::Opaque;
+				Directives.HasBlendMode = true;
+
+				if( Mode == "alpha" )
+				{
+					Directives.BlendMode = EBlendMode::Alpha;
+				}
+				else if( Mode == "additive" )
+				{
+					Directives.BlendMode = EBlendMode::Additive;
+				}
+
+				bParsed = true;
+			}
+			else if( Preprocessor == "#instanced" )
+			{
+				Directives.Instanced = true;
+				OutputStream << InstancedHeader;
+				bParsed = true;
+			}
+			else if( Preprocessor == "#depthwrite" )
+			{
+				std::string Mode;
+				LineStream >> Mode;
+
+				Directives.DepthMask = EDepthMask::Write;
+
+				if( Mode == "0" )
+				{
+					Directives.DepthMask = EDepthMask::Ignore;
+				}
+
+				bParsed = true;
+			}
+			else if( Preprocessor == "#depthtest" )
+			{
+				std::string Mode;
+				LineStream >> Mode;
+
+				Directives.DepthTest = EDepthTest::Less;
+
+				if( Mode == "0" )
+				{
+					Directives.DepthTest = EDepthTest::Never;
+				}
+				else if( Mode == "<" )
+				{
+					Directives.DepthTest = EDepthTest::Less;
+				}
+				else if( Mode == "<=" )
+				{
+					Directives.DepthTest = EDepthTest::LessEqual;
+				}
+				else if( Mode == "==" )
+				{
+					Directives.DepthTest = EDepthTest::Equal;
+				}
+				else if( Mode == ">" )
+				{
+					Directives.DepthTest = EDepthTest::Greater;
+				}
+				else if( Mode == "!=" )
+				{
+					Directives.DepthTest = EDepthTest::NotEqual;
+				}
+				else if( Mode == ">=" )
+				{
+					Directives.DepthTest = EDepthTest::GreaterEqual;
+				}
+				else if( Mode == "1" )
+				{
+					Directives.DepthTest = EDepthTest::Always;
+				}
+
+				bParsed = true;
+			}
+		}
+
+		if( !bParsed )
+		{
+			OutputStream << Line << "\n";
+		}
+	}
+
+	Output.Code = OutputStream.str();
+	Output.Hash = FNV::Bytes64( Output.Code );
+}
+
+bool ShaderCache::Load( const std::string& Location, const FShaderDefines& Defines, FPreprocessedShader& Output )
+{
+	const uint64_t DefinesHash = Defines.Hash();
+	const uint64_t Key = FNV::Bytes64( Location, DefinesHash );
+
+	const auto Iterator = Entries.find( Key );
+	if( Iterator != Entries.end() && Iterator->second.Dependencies.front().Location == Location && IsCurrent( Iterator->second ) )
+	{
+		Output = Iterator->second;
+		Counters.Hits++;
+		return true;
+	}
+
+	FPreprocessedShader Entry;
+	if( LoadSource( Location, DefinesHash, Entry ) && IsCurrent( Entry ) )
+	{
+		Output = Entry;
+		Entries[Key] = std::move( Entry );
+		Counters.Hits++;
+		return true;
+	}
+
+	Counters.Misses++;
+
+	// Describe the file before loading it, a change made while we're processing it will cause another miss instead of going unnoticed.
+	Entry = FPreprocessedShader();
+	Entry.Dependencies.emplace_back( Describe( Location ) );
+
+	CFile File( Location );
+	if( !File.Exists() || !File.Load() )
+		return false;
+
+	const char* Data = File.Fetch<char>();
+	std::stringstream Stream;
+	if( Data )
+	{
+		Stream << Data;
+	}
+
+	Preprocess( Stream, Defines, Entry );
+	SaveSource( Location, DefinesHash, Entry );
+
+	Output = Entry;
+	Entries[Key] = std::move( Entry );
+	return true;
+}
+
+bool ShaderCache::LoadBinary( const uint64_t Key, const std::string& Driver, std::vector<char>& Binary, uint32_t& Format )
+{
+	CFile File( GetLocation( Key, "spb" ) );
+	if( !File.Exists() || !File.Load( true ) )
+		return false;
+
+	Reader Input;
+	Input.Cursor = File.Fetch<char>();
+	Input.End = Input.Cursor + File.Size();
+
+	uint64_t StoredKey = 0;
+	std::string StoredDriver;
+	uint32_t Size = 0;
+	if( !Input.Check( BinaryMagic ) || !Input.Read( StoredKey ) || !Input.Read( StoredDriver ) || !Input.Read( Format ) || !Input.Read( Size ) )
+		return false;
+
+	// Binaries can't be shared between drivers, or even driver versions.
+	if( StoredKey != Key || StoredDriver != Driver )
+		return false;
+
+	if( static_cast<size_t>( Input.End - Input.Cursor ) < Size )
+		return false;
+
+	Binary.assign( Input.Cursor, Input.Cursor + Size );
+	return true;
+}
+
+void ShaderCache::SaveBinary( const uint64_t Key, const std::string& Driver, const std::vector<char>& Binary, const uint32_t Format )
+{
+	std::string Buffer;
+	Buffer.reserve( Binary.size() + Driver.size() + 64 );
+	Buffer.append( BinaryMagic, 4 );
+	Write( Buffer, Key );
+	Write( Buffer, Driver );
+	Write( Buffer, Format );
+	Write( Buffer, static_cast<uint32_t>( Binary.size() ) );
+	Buffer.append( Binary.data(), Binary.size() );
+
+	if( !Save( GetLocation( Key, "spb" ), Buffer ) )
+	{
+		Log::Event( Log::Warning, "Failed to store program binary.\n" );
+	}
+}
+
+void ShaderCache::ClearMemory()
+{
+	Entries.clear();
+}
+
+void ShaderCache::SetDirectory( const std::string& Directory )
+{
+	CacheDirectory = Directory;
+	Entries.clear();
+}
+
+const std::string& ShaderCache::GetDirectory()
+{
+	return CacheDirectory;
+}
+
+ShaderCacheStatistics& ShaderCache::Statistics()
+{
+	return Counters;
+}
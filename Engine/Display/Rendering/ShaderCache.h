@@ -0,0 +1,90 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <Engine/Display/Rendering/Shader.h>
+
+struct FShaderDependency
+{
+	std::string Location;
+	int64_t ModificationTime = 0;
+
+	// Negative when the file couldn't be found.
+	int64_t Size = -1;
+};
+
+// Render state requested by the directives of a single stage.
+struct FShaderDirectives
+{
+	EBlendMode::Type BlendMode = EBlendMode::Opaque;
+
+	// Stages without a #blendmode directive keep the blend mode of the previous stage.
+	bool HasBlendMode = false;
+
+	EDepthMask::Type DepthMask = EDepthMask::Write;
+	EDepthTest::Type DepthTest = EDepthTest::Less;
+	bool Instanced = false;
+};
+
+struct FPreprocessedShader
+{
+	std::string Code;
+	FShaderDirectives Directives;
+
+	// The stage's own file followed by the files it includes.
+	std::vector<FShaderDependency> Dependencies;
+
+	// Hash of the expanded code.
+	uint64_t Hash = 0;
+};
+
+// Everything besides the source files that affects the output of the preprocessor.
+struct FShaderDefines
+{
+	// Depth pre-pass, changes the default depth state.
+	bool PrePass = false;
+
+	// Directory that #include paths are relative to.
+	std::string IncludeDirectory = "Shaders/";
+
+	uint64_t Hash() const;
+};
+
+struct ShaderCacheStatistics
+{
+	// Stages that didn't have to be preprocessed.
+	int64_t Hits = 0;
+	int64_t Misses = 0;
+
+	// Programs that were loaded from a binary instead of being compiled.
+	int64_t BinaryHits = 0;
+	int64_t BinaryMisses = 0;
+};
+
+// Two level cache for shaders, both levels are stored on disk.
+// The first level stores the preprocessed source of each stage along with its dependencies, the second stores linked program binaries.
+namespace ShaderCache
+{
+	// Runs the preprocessor directives (#include, #blendmode, #instanced, etc.) without using the cache.
+	void Preprocess( std::istream& Stream, const FShaderDefines& Defines, FPreprocessedShader& Output );
+
+	// Preprocesses the file, or returns the cached result if neither it nor any of its includes have changed.
+	bool Load( const std::string& Location, const FShaderDefines& Defines, FPreprocessedShader& Output );
+
+	// Program binaries are keyed by the hash of the expanded stages and only valid for the driver they were created with.
+	bool LoadBinary( const uint64_t Key, const std::string& Driver, std::vector<char>& Binary, uint32_t& Format );
+	void SaveBinary( const uint64_t Key, const std::string& Driver, const std::vector<char>& Binary, const uint32_t Format );
+
+	// Forgets the entries that are kept in memory, the files on disk are kept.
+	void ClearMemory();
+
+	// Directory that the cache files are written to.
+	void SetDirectory( const std::string& Directory );
+	const std::string& GetDirectory();
+
+	ShaderCacheStatistics& Statistics();
+}
@@ -1,6 +1,8 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "Texture.h"
 
+#include <mutex>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <ThirdParty/stb/stb_image.h>
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -9,6 +11,7 @@
 #include <glad/glad.h>
 
 #include <Engine/Display/Rendering/TextureEnumeratorsGL.h>
+#include <Engine/Display/Rendering/TextureStreaming.h>
 #include <Engine/Profiling/Logging.h>
 #include <Engine/Utility/Data.h>
 #include <Engine/Utility/File.h>
@@ -35,6 +38,11 @@ CTexture::CTexture( const char* FileLocation ) : CTexture()
 
 CTexture::~CTexture()
 {
+	if( Streaming )
+	{
+		TextureStreaming::Cancel( this );
+	}
+
 	auto ImageData = GetImageData();
 	if( ImageData )
 	{
@@ -47,16 +55,10 @@ CTexture::~CTexture()
 	glDeleteTextures( 1, &Handle );
 }
 
-bool Load( 
-	ImageData& Output, 
-	const std::string& Location, 
-	const EFilteringMode Mode, 
-	const EImageFormat PreferredFormat, 
-	const bool GenerateMipMaps,
-	int* Width,
-	int* Height,
-	int* Channels
-)
+// Flipping is a global setting in STB, it is only written once so that it can't change while the streaming threads are decoding.
+static std::once_flag ConfigureDecoder;
+
+bool DecodeImage( ImageData& Output, const std::string& Location, const EImageFormat PreferredFormat, int* Width, int* Height, int* Channels )
 {
 	CFile Source( Location );
 	const std::string Extension = Source.Extension();
@@ -75,7 +77,11 @@ bool Load(
 		return false;
 	}
 
-	stbi_set_flip_vertically_on_load( 1 );
+	std::call_once( ConfigureDecoder, [] ()
+		{
+			stbi_set_flip_vertically_on_load( 1 );
+		}
+	);
 
 	if( PreferredFormat > EImageFormat::RGBA16 )
 	{
@@ -90,12 +96,18 @@ bool Load(
 		Output.Data8 = stbi_load_from_memory( Source.Fetch<stbi_uc>(), static_cast<int>( Source.Size() ), Width, Height, Channels, 0 );
 	}
 
+	if( !Output.Get() )
+	{
+		Log::Event( Log::Warning, "Invalid image data (\"%s\") (\"%s\").\n", Location.c_str(), stbi_failure_reason() );
+		return false;
+	}
+
 	return true;
 }
 
 bool CTexture::Load( const EFilteringMode Mode, const EImageFormat PreferredFormat, const bool GenerateMipMaps )
 {
-	if( !::Load( Image, Location, Mode, PreferredFormat, GenerateMipMaps, &Width, &Height, &Channels ) )
+	if( !DecodeImage( Image, Location, PreferredFormat, &Width, &Height, &Channels ) )
 		return false;
 
 	FilteringMode = Mode;
@@ -105,6 +117,8 @@ bool CTexture::Load( const EFilteringMode Mode, const EImageFormat PreferredForm
 		Log::Event( Log::Warning, "Invalid image data (\"%s\") (\"%s\").\n", Location.c_str(), stbi_failure_reason() );
 		return false;
 	}
+
+	return true;
 }
 
 struct Cubemap
@@ -112,6 +126,23 @@ struct Cubemap
 	const void* Pixels[6] = {};
 };
 
+static GLenum GetChannelFormat( const int Channels )
+{
+	switch( Channels )
+	{
+	case 1:
+		return GL_RED;
+	case 2:
+		return GL_RG;
+	case 3:
+		return GL_RGB;
+	case 4:
+		return GL_RGBA;
+	default:
+		return 0;
+	}
+}
+
 bool CreateTexture2D( 
 	int DataType,
 	int Target,
@@ -123,8 +154,8 @@ bool CreateTexture2D(
 	const EFilteringMode FilteringMode,
 	const int AnisotropicSamples,
 	const bool GenerateMipMaps,
-	const Cubemap& Cubemap
-
+	const Cubemap& Cubemap,
+	const FDecodedImage* Decoded = nullptr
 )
 {
 	glBindTexture( DataType, Handle );
@@ -152,23 +183,12 @@ bool CreateTexture2D(
 
 	const bool PowerOfTwoWidth = ( Width & ( Width - 1 ) ) == 0;
 	const bool PowerOfTwoHeight = ( Height & ( Height - 1 ) ) == 0;
+	const GLenum ChannelFormat = GetChannelFormat( Channels );
 	if( PowerOfTwoWidth && PowerOfTwoHeight )
 	{
-		if( Channels == 1 )
+		if( ChannelFormat != 0 )
 		{
-			glTexImage2D( Target, 0, InternalFormat, Width, Height, 0, GL_RED, Type, Cubemap.Pixels[0] );
-		}
-		else if( Channels == 2 )
-		{
-			glTexImage2D( Target, 0, InternalFormat, Width, Height, 0, GL_RG, Type, Cubemap.Pixels[0] );
-		}
-		else if( Channels == 3 )
-		{
-			glTexImage2D( Target, 0, InternalFormat, Width, Height, 0, GL_RGB, Type, Cubemap.Pixels[0] );
-		}
-		else if( Channels == 4 )
-		{
-			glTexImage2D( Target, 0, InternalFormat, Width, Height, 0, GL_RGBA, Type, Cubemap.Pixels[0] );
+			glTexImage2D( Target, 0, InternalFormat, Width, Height, 0, ChannelFormat, Type, Cubemap.Pixels[0] );
 		}
 		else
 		{
@@ -184,7 +204,23 @@ bool CreateTexture2D(
 		return false;
 	}
 
-	if( GenerateMipMaps )
+	if( Decoded && Decoded->Levels.size() > 1 )
+	{
+		// The mip levels were generated on the CPU, the rows of the smaller levels aren't aligned to four bytes.
+		GLint Alignment = 4;
+		glGetIntegerv( GL_UNPACK_ALIGNMENT, &Alignment );
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+		for( size_t Level = 1; Level < Decoded->Levels.size(); Level++ )
+		{
+			const auto& Mip = Decoded->Levels[Level];
+			glTexImage2D( Target, static_cast<GLint>( Level ), InternalFormat, Mip.Width, Mip.Height, 0, ChannelFormat, Type, Decoded->GetLevel( Level ) );
+		}
+
+		glPixelStorei( GL_UNPACK_ALIGNMENT, Alignment );
+		glTexParameteri( DataType, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>( Decoded->Levels.size() - 1 ) );
+	}
+	else if( GenerateMipMaps )
 	{
 		glGenerateMipmap( GL_TEXTURE_2D );
 	}
@@ -403,6 +439,67 @@ bool CTexture::Load( unsigned char* Data, const int Width, const int Height, con
 	);
 }
 
+bool CTexture::Load( FDecodedImage& Decoded )
+{
+	const void* Pixels = Decoded.Image.Get();
+	if( !Pixels || Decoded.Width < 1 || Decoded.Height < 1 || Decoded.Channels < 1 )
+		return false;
+
+	Width = Decoded.Width;
+	Height = Decoded.Height;
+	Depth = 0;
+	Channels = Decoded.Channels;
+	Format = Decoded.Format;
+
+	if( Handle == 0 )
+	{
+		glGenTextures( 1, &Handle );
+	}
+
+	if( Handle == 0 )
+	{
+		return false;
+	}
+
+	Cubemap Levels;
+	Levels.Pixels[0] = Pixels;
+
+	const bool Supported = CreateTexture2D(
+		GL_TEXTURE_2D,
+		GL_TEXTURE_2D,
+		Handle,
+		Width,
+		Height,
+		Channels,
+		Format,
+		FilteringMode,
+		AnisotropicSamples,
+		Decoded.Levels.size() > 1,
+		Levels,
+		&Decoded
+	);
+
+	AssignObjectLabelToTexture( Handle, Location.c_str(), GL_TEXTURE_2D );
+
+	// Keep the first level around, like textures that are loaded directly.
+	if( auto* Previous = GetImageData() )
+	{
+		stbi_image_free( Previous );
+	}
+
+	Image = Decoded.Image;
+	Decoded.Image = ImageData();
+	Decoded.Release();
+
+	if( !Supported )
+	{
+		Log::Event( Log::Warning, "Failed to initialize texture (\"%s\").\n", Location.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
 void CTexture::Save( const char* FileLocation )
 {
 	auto Data = GetImageData();
@@ -431,6 +528,10 @@ void CTexture::Bind( ETextureSlot Slot ) const
 			glBindTexture( GL_TEXTURE_2D, Handle );
 		}
 	}
+	else if( Placeholder )
+	{
+		Placeholder->Bind( Slot );
+	}
 }
 
 const std::string& CTexture::GetLocation() const
@@ -440,6 +541,9 @@ const std::string& CTexture::GetLocation() const
 
 GLuint CTexture::GetHandle() const
 {
+	if( Handle == 0 && Placeholder )
+		return Placeholder->GetHandle();
+
 	return Handle;
 }
 
@@ -510,3 +614,14 @@ void CTexture::SetAnisotropicSamples( const uint8_t Samples )
 	}
 #endif
 }
+
+CTexture* CTexture::GetPlaceholder() const
+{
+	return Placeholder;
+}
+
+void CTexture::SetPlaceholder( CTexture* Texture )
+{
+	// Don't allow a texture to stand in for itself.
+	Placeholder = Texture != this ? Texture : nullptr;
+}
@@ -11,6 +11,8 @@
 
 using TextureHandle = GLuint;
 
+struct FDecodedImage;
+
 void AssignObjectLabelToTexture( const GLuint Handle, const char* String, const GLenum Enum );
 
 struct ImageData
@@ -35,6 +37,9 @@ struct ImageData
 	};
 };
 
+// Decodes an image file into the format closest to the preferred format, safe to call from any thread.
+bool DecodeImage( ImageData& Output, const std::string& Location, const EImageFormat PreferredFormat, int* Width, int* Height, int* Channels );
+
 class CTexture
 {
 public:
@@ -67,6 +72,9 @@ public:
 		const bool GenerateMipMaps = true
 	);
 
+	// Load a 2D texture that was decoded by the texture streaming threads, takes ownership of the image data.
+	bool Load( FDecodedImage& Decoded );
+
 	void Save( const char* FileLocation = nullptr );
 	virtual void Bind( ETextureSlot Slot ) const;
 
@@ -81,14 +89,23 @@ public:
 	uint8_t GetAnisotropicSamples() const;
 	void SetAnisotropicSamples( const uint8_t Samples );
 
+	// Texture that is bound in place of this one while it doesn't have a handle.
+	CTexture* GetPlaceholder() const;
+	void SetPlaceholder( CTexture* Texture );
+
 	EFilteringMode FilteringMode;
 	TextureHandle Handle;
+
+	// Set while the texture is waiting to be decoded and uploaded.
+	bool Streaming = false;
 protected:
 	EImageFormat Format;
 
 	// Used to determine how many samples should be used for anisotropic filtering.
 	uint8_t AnisotropicSamples = 1;
 
+	CTexture* Placeholder = nullptr;
+
 	std::string Location;
 
 	int Width;
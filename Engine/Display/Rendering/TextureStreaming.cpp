@@ -0,0 +1,468 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "TextureStreaming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <ThirdParty/stb/stb_image.h>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Thread.h>
+
+// Kilobytes that can be uploaded per frame.
+ConfigurationVariable<int> UploadBudget( "render.TextureUploadBudget", 8192 );
+
+// Upper limit for the amount of decoding threads, they don't share the thread pool so that they can't stall the frame.
+constexpr size_t MaximumDecoders = 4;
+
+struct FTextureRequest
+{
+	// Cleared when the request has been cancelled.
+	CTexture* Texture = nullptr;
+	CTexture* Error = nullptr;
+
+	std::string Location;
+	EFilteringMode Mode = EFilteringMode::Trilinear;
+	EImageFormat Format = EImageFormat::RGB8;
+	bool GenerateMipMaps = true;
+
+	FDecodedImage Image;
+	bool Decoded = false;
+};
+
+static bool UploadGL( CTexture& Texture, FDecodedImage& Image )
+{
+	return Texture.Load( Image );
+}
+
+static TextureStreaming::UploadFunction Upload = UploadGL;
+static TextureStreamingStatistics Counters;
+
+static std::mutex Mutex;
+static std::unordered_map<CTexture*, std::shared_ptr<FTextureRequest>> Requests;
+static std::deque<std::shared_ptr<FTextureRequest>> Finished;
+static std::vector<std::unique_ptr<Worker>> Decoders;
+static size_t NextDecoder = 0;
+
+FDecodedImage::~FDecodedImage()
+{
+	Release();
+}
+
+FDecodedImage::FDecodedImage( FDecodedImage&& Other ) noexcept
+{
+	*this = std::move( Other );
+}
+
+FDecodedImage& FDecodedImage::operator=( FDecodedImage&& Other ) noexcept
+{
+	if( this != &Other )
+	{
+		Release();
+
+		Width = Other.Width;
+		Height = Other.Height;
+		Channels = Other.Channels;
+		Format = Other.Format;
+		Image = Other.Image;
+		MipData = std::move( Other.MipData );
+		Levels = std::move( Other.Levels );
+
+		Other.Image = ImageData();
+		Other.Levels.clear();
+	}
+
+	return *this;
+}
+
+const void* FDecodedImage::GetLevel( const size_t Level ) const
+{
+	if( Level == 0 )
+		return Image.Get();
+
+	if( Level >= Levels.size() )
+		return nullptr;
+
+	return MipData.data() + Levels[Level].Offset;
+}
+
+size_t FDecodedImage::Size() const
+{
+	size_t Bytes = 0;
+	for( const auto& Level : Levels )
+	{
+		Bytes += Level.Size;
+	}
+
+	return Bytes;
+}
+
+void FDecodedImage::Release()
+{
+	if( auto* Data = Image.Get() )
+	{
+		stbi_image_free( Data );
+	}
+
+	Image = ImageData();
+	MipData.clear();
+	Levels.clear();
+}
+
+static size_t GetComponentSize( const ImageData& Image )
+{
+	if( Image.Data32F || Image.Data32 )
+		return 4;
+
+	if( Image.Data16 )
+		return 2;
+
+	return 1;
+}
+
+static float ToLinear( const float Value )
+{
+	return Value <= 0.04045f ? Value / 12.92f : std::pow( ( Value + 0.055f ) / 1.055f, 2.4f );
+}
+
+static float ToSRGB( const float Value )
+{
+	return Value <= 0.0031308f ? Value * 12.92f : 1.055f * std::pow( Value, 1.0f / 2.4f ) - 0.055f;
+}
+
+template<typename T>
+static T Store( const float Value, const float Maximum )
+{
+	return static_cast<T>( std::min( std::max( Value, 0.0f ), Maximum ) + 0.5f );
+}
+
+template<>
+float Store<float>( const float Value, const float Maximum )
+{
+	return Value;
+}
+
+// Averages 2x2 blocks of the source level, the last row or column is repeated for odd sizes.
+template<typename T>
+static void Downsample( const T* Source, const FMipLevel& From, T* Destination, const FMipLevel& To, const int Channels, const bool SRGB, const float Maximum )
+{
+	static float LinearTable[256] = {};
+	static std::once_flag TableFlag;
+	if( SRGB )
+	{
+		std::call_once( TableFlag, [] ()
+			{
+				for( int Index = 0; Index < 256; Index++ )
+				{
+					LinearTable[Index] = ToLinear( static_cast<float>( Index ) / 255.0f );
+				}
+			}
+		);
+	}
+
+	// Only the color channels are stored in sRGB, alpha is linear.
+	const int ColorChannels = Channels == 4 ? 3 : Channels;
+
+	for( int Y = 0; Y < To.Height; Y++ )
+	{
+		const int Y0 = std::min( Y * 2, From.Height - 1 );
+		const int Y1 = std::min( Y * 2 + 1, From.Height - 1 );
+		for( int X = 0; X < To.Width; X++ )
+		{
+			const int X0 = std::min( X * 2, From.Width - 1 );
+			const int X1 = std::min( X * 2 + 1, From.Width - 1 );
+
+			const T* Samples[4] = {
+				Source + ( Y0 * From.Width + X0 ) * Channels,
+				Source + ( Y0 * From.Width + X1 ) * Channels,
+				Source + ( Y1 * From.Width + X0 ) * Channels,
+				Source + ( Y1 * From.Width + X1 ) * Channels
+			};
+
+			T* Output = Destination + ( Y * To.Width + X ) * Channels;
+			for( int Channel = 0; Channel < Channels; Channel++ )
+			{
+				float Sum = 0.0f;
+				if( SRGB && Channel < ColorChannels )
+				{
+					for( const T* Sample : Samples )
+					{
+						Sum += LinearTable[static_cast<uint8_t>( Sample[Channel] )];
+					}
+
+					Output[Channel] = Store<T>( ToSRGB( Sum * 0.25f ) * 255.0f, Maximum );
+				}
+				else
+				{
+					for( const T* Sample : Samples )
+					{
+						Sum += static_cast<float>( Sample[Channel] );
+					}
+
+					Output[Channel] = Store<T>( Sum * 0.25f, Maximum );
+				}
+			}
+		}
+	}
+}
+
+void TextureStreaming::GenerateMipMaps( FDecodedImage& Image )
+{
+	const void* Base = Image.Image.Get();
+	if( !Base || Image.Width < 1 || Image.Height < 1 || Image.Channels < 1 )
+		return;
+
+	const size_t ComponentSize = GetComponentSize( Image.Image );
+	const size_t PixelSize = ComponentSize * static_cast<size_t>( Image.Channels );
+
+	Image.Levels.resize( 1 );
+
+	// Lay out the remaining levels first so that the mip data is only allocated once.
+	size_t Offset = 0;
+	FMipLevel Level = Image.Levels[0];
+	while( Level.Width > 1 || Level.Height > 1 )
+	{
+		Level.Width = std::max( Level.Width / 2, 1 );
+		Level.Height = std::max( Level.Height / 2, 1 );
+		Level.Offset = Offset;
+		Level.Size = static_cast<size_t>( Level.Width ) * static_cast<size_t>( Level.Height ) * PixelSize;
+		Offset += Level.Size;
+
+		Image.Levels.emplace_back( Level );
+	}
+
+	Image.MipData.resize( Offset );
+
+	const bool SRGB = ( Image.Format == EImageFormat::SRGB8 || Image.Format == EImageFormat::SRGBA8 ) && ComponentSize == 1;
+	for( size_t Index = 1; Index < Image.Levels.size(); Index++ )
+	{
+		const auto& From = Image.Levels[Index - 1];
+		const auto& To = Image.Levels[Index];
+		const void* Source = Image.GetLevel( Index - 1 );
+		void* Destination = Image.MipData.data() + To.Offset;
+
+		if( Image.Image.Data32F )
+		{
+			Downsample( static_cast<const float*>( Source ), From, static_cast<float*>( Destination ), To, Image.Channels, false, 0.0f );
+		}
+		else if( Image.Image.Data16 )
+		{
+			Downsample( static_cast<const uint16_t*>( Source ), From, static_cast<uint16_t*>( Destination ), To, Image.Channels, false, 65535.0f );
+		}
+		else
+		{
+			Downsample( static_cast<const uint8_t*>( Source ), From, static_cast<uint8_t*>( Destination ), To, Image.Channels, SRGB, 255.0f );
+		}
+	}
+}
+
+bool TextureStreaming::Decode( const std::string& Location, const EImageFormat PreferredFormat, const bool GenerateMipMaps, FDecodedImage& Output )
+{
+	Output.Release();
+
+	if( !DecodeImage( Output.Image, Location, PreferredFormat, &Output.Width, &Output.Height, &Output.Channels ) )
+		return false;
+
+	Output.Format = PreferredFormat;
+
+	FMipLevel Level;
+	Level.Width = Output.Width;
+	Level.Height = Output.Height;
+	Level.Size = static_cast<size_t>( Output.Width ) * static_cast<size_t>( Output.Height ) * static_cast<size_t>( Output.Channels ) * GetComponentSize( Output.Image );
+	Output.Levels.emplace_back( Level );
+
+	if( GenerateMipMaps )
+	{
+		TextureStreaming::GenerateMipMaps( Output );
+	}
+
+	return true;
+}
+
+static void DecodeRequest( const std::shared_ptr<FTextureRequest>& Request )
+{
+	FDecodedImage Image;
+	const bool Decoded = TextureStreaming::Decode( Request->Location, Request->Format, Request->GenerateMipMaps, Image );
+
+	std::unique_lock<std::mutex> Lock( Mutex );
+	if( !Request->Texture )
+		return; // Cancelled while we were decoding.
+
+	Request->Image = std::move( Image );
+	Request->Decoded = Decoded;
+	Finished.emplace_back( Request );
+
+	if( Decoded )
+	{
+		Counters.Decoded++;
+	}
+}
+
+void TextureStreaming::Request( CTexture* Texture, CTexture* Placeholder, CTexture* Error, const EFilteringMode Mode, const EImageFormat Format, const bool GenerateMipMaps )
+{
+	if( !Texture )
+		return;
+
+	auto Request = std::make_shared<FTextureRequest>();
+	Request->Texture = Texture;
+	Request->Error = Error;
+	Request->Location = Texture->GetLocation();
+	Request->Mode = Mode;
+	Request->Format = Format;
+	Request->GenerateMipMaps = GenerateMipMaps;
+
+	Texture->SetPlaceholder( Placeholder );
+	Texture->Streaming = true;
+
+	Worker* Decoder = nullptr;
+	{
+		std::unique_lock<std::mutex> Lock( Mutex );
+		Requests[Texture] = Request;
+
+		if( Decoders.empty() )
+		{
+			const size_t Threads = std::max( std::thread::hardware_concurrency() / 2, 1u );
+			const size_t Count = std::min( Threads, MaximumDecoders );
+			for( size_t Index = 0; Index < Count; Index++ )
+			{
+				Decoders.emplace_back( new Worker() );
+				Decoders.back()->SetName( "TextureDecoder" );
+				Decoders.back()->SetPriority( ThreadPriority::BelowNormal );
+			}
+		}
+
+		Decoder = Decoders[NextDecoder++ % Decoders.size()].get();
+	}
+
+	Decoder->Add( std::make_shared<LambdaTask>( [Request] ()
+		{
+			DecodeRequest( Request );
+		}
+	) );
+}
+
+void TextureStreaming::Cancel( CTexture* Texture )
+{
+	std::unique_lock<std::mutex> Lock( Mutex );
+	const auto Iterator = Requests.find( Texture );
+	if( Iterator == Requests.end() )
+		return;
+
+	Iterator->second->Texture = nullptr;
+	Requests.erase( Iterator );
+}
+
+size_t TextureStreaming::Update( const size_t Budget )
+{
+	size_t Bytes = 0;
+	int64_t Uploaded = 0;
+	int64_t Failed = 0;
+	while( true )
+	{
+		std::shared_ptr<FTextureRequest> Request;
+		{
+			std::unique_lock<std::mutex> Lock( Mutex );
+			if( Finished.empty() )
+				break;
+
+			Request = Finished.front();
+			if( Request->Texture )
+			{
+				const size_t Size = Request->Image.Size();
+				if( Bytes > 0 && Bytes + Size > Budget )
+					break;
+
+				Requests.erase( Request->Texture );
+			}
+
+			Finished.pop_front();
+		}
+
+		// Cancelled after it was decoded.
+		CTexture* Texture = Request->Texture;
+		if( !Texture )
+			continue;
+
+		const size_t Size = Request->Image.Size();
+		Texture->Streaming = false;
+		Texture->FilteringMode = Request->Mode;
+		if( Request->Decoded && Upload( *Texture, Request->Image ) )
+		{
+			Texture->SetPlaceholder( nullptr );
+			Bytes += Size;
+			Uploaded++;
+		}
+		else
+		{
+			Log::Event( Log::Warning, "Failed to stream texture (\"%s\").\n", Request->Location.c_str() );
+			Texture->SetPlaceholder( Request->Error );
+			Failed++;
+		}
+	}
+
+	// The decoders count on their own threads.
+	std::unique_lock<std::mutex> Lock( Mutex );
+	Counters.Uploaded += Uploaded;
+	Counters.Failed += Failed;
+	Counters.UploadedBytes += static_cast<int64_t>( Bytes );
+
+	return Bytes;
+}
+
+size_t TextureStreaming::Update()
+{
+	const int Kilobytes = std::max( UploadBudget.Get(), 1 );
+	return Update( static_cast<size_t>( Kilobytes ) * 1024 );
+}
+
+size_t TextureStreaming::Pending()
+{
+	std::unique_lock<std::mutex> Lock( Mutex );
+	return Requests.size();
+}
+
+void TextureStreaming::Shutdown()
+{
+	std::vector<std::unique_ptr<Worker>> Stopping;
+	{
+		std::unique_lock<std::mutex> Lock( Mutex );
+		Stopping.swap( Decoders );
+
+		// Textures can outlive the streaming system, they shouldn't try to cancel their requests after this.
+		for( auto& Request : Requests )
+		{
+			Request.second->Texture->Streaming = false;
+			Request.second->Texture = nullptr;
+		}
+
+		Requests.clear();
+		Finished.clear();
+	}
+
+	// Joins the threads, requests that are still decoding will find that they've been cancelled.
+	Stopping.clear();
+}
+
+void TextureStreaming::Override( UploadFunction Function )
+{
+	Upload = Function ? Function : UploadGL;
+}
+
+TextureStreamingStatistics TextureStreaming::Statistics()
+{
+	std::unique_lock<std::mutex> Lock( Mutex );
+	return Counters;
+}
+
+void TextureStreaming::ResetStatistics()
+{
+	std::unique_lock<std::mutex> Lock( Mutex );
+	Counters = TextureStreamingStatistics();
+}
@@ -0,0 +1,103 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Engine/Display/Rendering/Texture.h>
+
+struct FMipLevel
+{
+	int Width = 0;
+	int Height = 0;
+
+	// Offset into the mip data, unused for the first level.
+	size_t Offset = 0;
+	size_t Size = 0;
+};
+
+// Decoded image along with the mip levels that were generated for it on the CPU.
+struct FDecodedImage
+{
+	FDecodedImage() = default;
+	~FDecodedImage();
+
+	FDecodedImage( FDecodedImage&& Other ) noexcept;
+	FDecodedImage& operator=( FDecodedImage&& Other ) noexcept;
+
+	FDecodedImage( const FDecodedImage& ) = delete;
+	FDecodedImage& operator=( const FDecodedImage& ) = delete;
+
+	// Pixels of the given level.
+	const void* GetLevel( const size_t Level ) const;
+
+	// Amount of bytes that have to be uploaded, including the mip levels.
+	size_t Size() const;
+
+	void Release();
+
+	int Width = 0;
+	int Height = 0;
+	int Channels = 0;
+	EImageFormat Format = EImageFormat::Unknown;
+
+	// First level, allocated by the image decoder. The texture takes ownership of it when it is uploaded.
+	ImageData Image;
+
+	// The remaining levels, stored back to back.
+	std::vector<uint8_t> MipData;
+
+	// Every level, starting with the full resolution image.
+	std::vector<FMipLevel> Levels;
+};
+
+struct TextureStreamingStatistics
+{
+	int64_t Decoded = 0;
+	int64_t Uploaded = 0;
+	int64_t UploadedBytes = 0;
+	int64_t Failed = 0;
+};
+
+// Decodes textures on background threads, the main thread uploads the finished images within a budget each frame.
+// Textures that are waiting to be uploaded are drawn with a placeholder.
+namespace TextureStreaming
+{
+	typedef bool( *UploadFunction )( CTexture& Texture, FDecodedImage& Image );
+
+	// Decodes the file and generates its mip levels, safe to call from any thread.
+	bool Decode( const std::string& Location, const EImageFormat PreferredFormat, const bool GenerateMipMaps, FDecodedImage& Output );
+
+	// Generates the mip chain of the first level using a box filter, sRGB formats are filtered in linear space.
+	void GenerateMipMaps( FDecodedImage& Image );
+
+	// Queues the texture for decoding, it will use the placeholder until it has been uploaded.
+	// Textures that fail to decode use the error texture instead.
+	void Request( CTexture* Texture, CTexture* Placeholder, CTexture* Error, const EFilteringMode Mode, const EImageFormat Format, const bool GenerateMipMaps );
+
+	// Forgets about a texture that hasn't been uploaded yet.
+	void Cancel( CTexture* Texture );
+
+	// Uploads decoded images until the amount of bytes exceeds the budget, at least one image is uploaded per call.
+	// Returns the amount of bytes that were uploaded.
+	size_t Update( const size_t Budget );
+
+	// Uses the budget from the configuration. (render.TextureUploadBudget, in kilobytes)
+	size_t Update();
+
+	// Amount of textures that haven't been uploaded yet.
+	size_t Pending();
+
+	// Stops the decoding threads, textures that are still pending keep their placeholder.
+	void Shutdown();
+
+	// Replaces the upload to GL, passing null restores the default.
+	void Override( UploadFunction Function );
+
+	// Counters since the last reset, the renderer resets them every frame.
+	// The decoders count on their own threads, the counters are guarded by the queue mutex and returned as a copy.
+	TextureStreamingStatistics Statistics();
+	void ResetStatistics();
+}
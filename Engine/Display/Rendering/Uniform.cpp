@@ -3,55 +3,162 @@
 
 #include <ThirdParty/glad/include/glad/glad.h>
 
-void Uniform::Bind( const unsigned int& Program, const std::string& Location )
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+struct UniformNameRegistry
 {
-	if( Type == Undefined )
-		return;
+	std::mutex Mutex;
+	std::unordered_map<std::string, UniformId> Identifiers;
+
+	// Deque so that references to the names remain valid while new ones are added.
+	std::deque<std::string> Names;
+
+	static UniformNameRegistry& Get()
+	{
+		static UniformNameRegistry Registry;
+		return Registry;
+	}
+};
+
+UniformId UniformName::Intern( const std::string& Name )
+{
+	auto& Registry = UniformNameRegistry::Get();
+	std::unique_lock<std::mutex> Lock( Registry.Mutex );
+
+	const auto Iterator = Registry.Identifiers.find( Name );
+	if( Iterator != Registry.Identifiers.end() )
+		return Iterator->second;
+
+	const auto Id = static_cast<UniformId>( Registry.Names.size() );
+	Registry.Names.emplace_back( Name );
+	Registry.Identifiers.insert_or_assign( Name, Id );
+	return Id;
+}
+
+const std::string& UniformName::Get( const UniformId Id )
+{
+	auto& Registry = UniformNameRegistry::Get();
+	std::unique_lock<std::mutex> Lock( Registry.Mutex );
+	return Registry.Names[Id];
+}
 
-	Name = Location;
-	Bind( Program );
+size_t UniformName::Count()
+{
+	auto& Registry = UniformNameRegistry::Get();
+	std::unique_lock<std::mutex> Lock( Registry.Mutex );
+	return Registry.Names.size();
 }
 
-void Uniform::Bind( const unsigned int& Program )
+static int GetLocationGL( unsigned int Program, const char* Name )
 {
-	// Cache the program location.
-	if( Program != LastProgram )
+	return glGetUniformLocation( Program, Name );
+}
+
+static void UploadGL( int Location, const Uniform& Value )
+{
+	switch( Value.Type )
 	{
-		BufferLocation = glGetUniformLocation( Program, Name.c_str() );
-		LastProgram = Program;
+	case Uniform::Component4:
+		glUniform4fv( Location, 1, Value.Uniform4.Base() );
+		break;
+	case Uniform::Component3:
+		glUniform3fv( Location, 1, Value.Uniform3.Base() );
+		break;
+	case Uniform::Component2:
+		glUniform2fv( Location, 1, Value.Uniform2.Base() );
+		break;
+	case Uniform::Component4x4:
+		glUniformMatrix4fv( Location, 1, GL_FALSE, &Value.Uniform4x4[0][0] );
+		break;
+	case Uniform::Unsigned:
+		glUniform1ui( Location, Value.UniformUnsigned );
+		break;
+	case Uniform::Signed:
+		glUniform1i( Location, Value.UniformSigned4[0] );
+		break;
+	case Uniform::Signed4:
+		glUniform4iv( Location, 1, Value.UniformSigned4 );
+		break;
+	case Uniform::Float:
+		glUniform1f( Location, Value.UniformFloat );
+		break;
+	default:
+		break;
 	}
+}
+
+static UniformFunctions Functions = { GetLocationGL, UploadGL };
+static UniformStatistics Counters;
+
+void UniformDispatch::Override( const UniformFunctions& Replacement )
+{
+	Functions.GetLocation = Replacement.GetLocation ? Replacement.GetLocation : GetLocationGL;
+	Functions.Upload = Replacement.Upload ? Replacement.Upload : UploadGL;
+}
+
+int UniformDispatch::GetLocation( const unsigned int Program, const char* Name )
+{
+	Counters.Lookups++;
+	return Functions.GetLocation( Program, Name );
+}
+
+void UniformDispatch::Upload( const int Location, const Uniform& Value )
+{
+	Counters.Calls++;
+	Functions.Upload( Location, Value );
+}
+
+UniformStatistics& UniformDispatch::Statistics()
+{
+	return Counters;
+}
 
+void UniformDispatch::ResetStatistics()
+{
+	Counters = UniformStatistics();
+}
+
+void Uniform::Bind( const unsigned int& Program, const std::string& Location ) const
+{
+	if( Type == Undefined )
+		return;
+
+	const int BufferLocation = UniformDispatch::GetLocation( Program, Location.c_str() );
 	if( BufferLocation > -1 )
 	{
-		switch( Type )
-		{
-		case Component4:
-			glUniform4fv( BufferLocation, 1, Uniform4.Base() );
-			break;
-		case Component3:
-			glUniform3fv( BufferLocation, 1, Uniform3.Base() );
-			break;
-		case Component2:
-			glUniform2fv( BufferLocation, 1, Uniform2.Base() );
-			break;
-		case Component4x4:
-			glUniformMatrix4fv( BufferLocation, 1, GL_FALSE, &Uniform4x4[0][0] );
-			break;
-		case Unsigned:
-			glUniform1ui( BufferLocation, UniformUnsigned );
-			break;
-		case Signed:
-			glUniform1i( BufferLocation, UniformSigned4[0] );
-			break;
-		case Signed4:
-			glUniform4iv( BufferLocation, 1, UniformSigned4 );
-			break;
-		case Float:
-			glUniform1f( BufferLocation, UniformFloat );
-			break;
-		default:
-			break;
-		}
+		UniformDispatch::Upload( BufferLocation, *this );
+	}
+}
+
+bool Uniform::Equals( const Uniform& B ) const
+{
+	if( Type != B.Type )
+		return false;
+
+	switch( Type )
+	{
+	case Component4:
+		return std::memcmp( &Uniform4, &B.Uniform4, sizeof( Uniform4 ) ) == 0;
+	case Component3:
+		return std::memcmp( &Uniform3, &B.Uniform3, sizeof( Uniform3 ) ) == 0;
+	case Component2:
+		return std::memcmp( &Uniform2, &B.Uniform2, sizeof( Uniform2 ) ) == 0;
+	case Component4x4:
+		return std::memcmp( &Uniform4x4, &B.Uniform4x4, sizeof( Uniform4x4 ) ) == 0;
+	case Unsigned:
+		return UniformUnsigned == B.UniformUnsigned;
+	case Signed:
+		return UniformSigned4[0] == B.UniformSigned4[0];
+	case Signed4:
+		return std::memcmp( UniformSigned4, B.UniformSigned4, sizeof( UniformSigned4 ) ) == 0;
+	case Float:
+		return std::memcmp( &UniformFloat, &B.UniformFloat, sizeof( UniformFloat ) ) == 0;
+	default:
+		return true;
 	}
 }
 
@@ -88,3 +195,34 @@ void Uniform::Reset()
 		break;
 	}
 }
+
+void UniformMap::Set( const UniformId Id, const Uniform& Value )
+{
+	const auto Iterator = std::lower_bound( Entries.begin(), Entries.end(), Id, [] ( const Entry& A, const UniformId B )
+		{
+			return A.first < B;
+		}
+	);
+
+	if( Iterator != Entries.end() && Iterator->first == Id )
+	{
+		Iterator->second = Value;
+		return;
+	}
+
+	Entries.insert( Iterator, { Id, Value } );
+}
+
+const Uniform* UniformMap::Find( const UniformId Id ) const
+{
+	const auto Iterator = std::lower_bound( Entries.begin(), Entries.end(), Id, [] ( const Entry& A, const UniformId B )
+		{
+			return A.first < B;
+		}
+	);
+
+	if( Iterator != Entries.end() && Iterator->first == Id )
+		return &Iterator->second;
+
+	return nullptr;
+}
@@ -3,8 +3,22 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <Engine/Utility/Math.h>
 
+// Interned uniform name, names are resolved to an id once so that binding doesn't have to touch strings.
+typedef uint32_t UniformId;
+
+namespace UniformName
+{
+	// Returns the id of the name, registering it if it hasn't been seen before.
+	UniformId Intern( const std::string& Name );
+	const std::string& Get( const UniformId Id );
+
+	// Amount of names that have been registered so far.
+	size_t Count();
+}
+
 struct Uniform
 {
 	enum
@@ -27,21 +41,12 @@ struct Uniform
 	unsigned int UniformUnsigned;
 	int32_t UniformSigned4[4];
 	float UniformFloat;
-	unsigned int LastProgram = 0;
-	int BufferLocation = -1;
-	std::string Name;
 
 	Uniform()
 	{
 		Type = Undefined;
 	}
 
-	Uniform( const std::string& Name )
-	{
-		Type = Undefined;
-		this->Name = Name;
-	}
-
 	Uniform( const Vector4D& Vector )
 	{
 		Type = Component4;
@@ -93,33 +98,13 @@ struct Uniform
 		UniformFloat = Value;
 	}
 
-	Uniform& operator=( const Uniform& B )
-	{
-		if( this == &B )
-			return *this;
-
-		Uniform2 = B.Uniform2;
-		Uniform3 = B.Uniform3;
-		Uniform4 = B.Uniform4;
-		Uniform4x4 = B.Uniform4x4;
-		UniformUnsigned = B.UniformUnsigned;
-		UniformSigned4[0] = B.UniformSigned4[0];
-		UniformSigned4[1] = B.UniformSigned4[1];
-		UniformSigned4[2] = B.UniformSigned4[2];
-		UniformSigned4[3] = B.UniformSigned4[3];
-		UniformFloat = B.UniformFloat;
-
-		LastProgram = 0;
-		BufferLocation = -1;
-		Type = B.Type;
-
-		return *this;
-	}
-
-	void Bind( const unsigned int& Program, const std::string& Location );
-	void Bind( const unsigned int& Program );
+	// Looks up the location and uploads the value to the active program, prefer binding through CShader::GetUniformCache.
+	void Bind( const unsigned int& Program, const std::string& Location ) const;
 	void Reset();
 
+	// Returns true when both uniforms have the same type and value.
+	bool Equals( const Uniform& B ) const;
+
 	void Set( const Vector4D& Vector )
 	{
 		Type = Component4;
@@ -173,4 +158,87 @@ struct Uniform
 	}
 };
 
-typedef std::unordered_map<std::string, Uniform> UniformMap;
+// Small map of uniforms that is kept sorted by id, binding it is a linear walk without any hashing.
+class UniformMap
+{
+public:
+	typedef std::pair<UniformId, Uniform> Entry;
+
+	void Set( const UniformId Id, const Uniform& Value );
+	void Set( const std::string& Name, const Uniform& Value )
+	{
+		Set( UniformName::Intern( Name ), Value );
+	}
+
+	const Uniform* Find( const UniformId Id ) const;
+
+	void Clear()
+	{
+		Entries.clear();
+	}
+
+	size_t Size() const
+	{
+		return Entries.size();
+	}
+
+	bool Empty() const
+	{
+		return Entries.empty();
+	}
+
+	std::vector<Entry>::iterator begin()
+	{
+		return Entries.begin();
+	}
+
+	std::vector<Entry>::iterator end()
+	{
+		return Entries.end();
+	}
+
+	std::vector<Entry>::const_iterator begin() const
+	{
+		return Entries.begin();
+	}
+
+	std::vector<Entry>::const_iterator end() const
+	{
+		return Entries.end();
+	}
+
+private:
+	std::vector<Entry> Entries;
+};
+
+struct UniformStatistics
+{
+	// Locations that had to be resolved by name.
+	int64_t Lookups = 0;
+
+	// Values that were uploaded to a program.
+	int64_t Calls = 0;
+
+	// Uploads that were skipped because the program already had the value.
+	int64_t Skipped = 0;
+};
+
+// Entry points used to talk to GL, these can be replaced to record uniform traffic without a GPU.
+struct UniformFunctions
+{
+	int( *GetLocation )( unsigned int Program, const char* Name ) = nullptr;
+	void( *Upload )( int Location, const Uniform& Value ) = nullptr;
+};
+
+namespace UniformDispatch
+{
+	// Replaces the GL entry points, passing empty functions restores the defaults.
+	void Override( const UniformFunctions& Functions );
+
+	int GetLocation( const unsigned int Program, const char* Name );
+	void Upload( const int Location, const Uniform& Value );
+
+	// Counters since the last reset, the renderer resets them every frame.
+	UniformStatistics& Statistics();
+	void ResetStatistics();
+}
@@ -0,0 +1,66 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "UniformCache.h"
+
+void CUniformCache::Reset( const unsigned int ProgramIn )
+{
+	Program = ProgramIn;
+	Entries.clear();
+}
+
+int CUniformCache::GetLocation( const UniformId Id )
+{
+	auto& Entry = Fetch( Id );
+	if( Entry.Location == Unresolved )
+	{
+		Entry.Location = Program != 0 ? UniformDispatch::GetLocation( Program, UniformName::Get( Id ).c_str() ) : -1;
+	}
+
+	return Entry.Location;
+}
+
+void CUniformCache::Bind( const UniformId Id, const Uniform& Value )
+{
+	if( Value.Type == Uniform::Undefined )
+		return;
+
+	const int Location = GetLocation( Id );
+	if( Location < 0 )
+		return;
+
+	auto& Entry = Entries[Id];
+	if( Entry.Uploaded && Entry.Value.Equals( Value ) )
+	{
+		UniformDispatch::Statistics().Skipped++;
+		return;
+	}
+
+	Entry.Value = Value;
+	Entry.Uploaded = true;
+	UniformDispatch::Upload( Location, Value );
+}
+
+void CUniformCache::Bind( const UniformMap& Uniforms )
+{
+	for( const auto& Uniform : Uniforms )
+	{
+		Bind( Uniform.first, Uniform.second );
+	}
+}
+
+void CUniformCache::Invalidate( const UniformId Id )
+{
+	if( Id < Entries.size() )
+	{
+		Entries[Id].Uploaded = false;
+	}
+}
+
+CUniformCache::Entry& CUniformCache::Fetch( const UniformId Id )
+{
+	if( Id >= Entries.size() )
+	{
+		Entries.resize( Id + 1 );
+	}
+
+	return Entries[Id];
+}
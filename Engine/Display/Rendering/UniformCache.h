@@ -0,0 +1,48 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <vector>
+
+#include <Engine/Display/Rendering/Uniform.h>
+
+// Caches the uniform locations of a single program and keeps a copy of the values that were last uploaded to it.
+class CUniformCache
+{
+public:
+	// Forgets all of the locations and values, has to be called whenever the program is linked.
+	void Reset( const unsigned int Program );
+
+	// Returns the location of the uniform, -1 when the program doesn't use it.
+	int GetLocation( const UniformId Id );
+
+	// Uploads the value unless the program already holds it, the program has to be active.
+	void Bind( const UniformId Id, const Uniform& Value );
+	void Bind( const UniformMap& Uniforms );
+
+	// Makes sure the next bind is uploaded, for values that were changed without going through the cache.
+	void Invalidate( const UniformId Id );
+
+	unsigned int GetProgram() const
+	{
+		return Program;
+	}
+
+private:
+	static constexpr int Unresolved = -2;
+
+	struct Entry
+	{
+		int Location = Unresolved;
+
+		// True when Value matches what the program holds.
+		bool Uploaded = false;
+		Uniform Value;
+	};
+
+	Entry& Fetch( const UniformId Id );
+
+	unsigned int Program = 0;
+
+	// Indexed by uniform id.
+	std::vector<Entry> Entries;
+};
@@ -868,7 +868,7 @@ namespace UI
 
 		}
 
-		virtual void Draw( CRenderable* Renderable ) override
+		virtual void Draw( CRenderable* Renderable, const uint32_t Instances ) override
 		{
 
 		}
@@ -997,8 +997,8 @@ namespace UI
 				EndIndex = StartIndex + Math::Min( Points - StartIndex, BatchSize );
 			}
 
-			CProfiler::Get().AddCounterEntry( ProfileTimeEntry( "Debug Lines", static_cast<int64_t>( Lines.size() ) ), true );
-			CProfiler::Get().AddCounterEntry( ProfileTimeEntry( "Debug Line Batches", static_cast<int64_t>( EndIndex / BatchSize ) ), true );
+			ProfileCounter( "Debug Lines", static_cast<int64_t>( Lines.size() ) );
+			ProfileCounter( "Debug Line Batches", static_cast<int64_t>( EndIndex / BatchSize ) );
 
 			End();
 
@@ -1,6 +1,7 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #pragma once
 
+#include <memory>
 #include <set>
 
 #include <Engine/Physics/Body/Shared.h>
@@ -37,6 +38,25 @@ public:
 	virtual void Tick();
 	void Destroy();
 
+	// The tick is split into three steps so that the physics scene can integrate many bodies at once.
+	// Resolves the contacts and returns the depenetrated position that has to be integrated.
+	Vector3D PreIntegrate();
+
+	// Advances the velocity and position of a kinetic body.
+	void Integrate( Vector3D& Position, const Vector3D& Previous, const float DeltaTime );
+
+	// Applies the integrated position and clears the values that only last a single tick.
+	virtual void PostIntegrate( const Vector3D& Position );
+
+	// Bodies with a custom tick can't be integrated by the body store.
+	virtual bool CanBatchIntegrate() const
+	{
+		return IsKinetic();
+	}
+
+	// Slot of this body in the body store of the physics scene, only valid during the body update.
+	int32_t StoreIndex = -1;
+
 	virtual void CalculateBounds();
 	BoundingBoxSIMD GetBounds() const;
 	BoundingBox GetWorldBounds() const;
@@ -101,6 +121,24 @@ public:
 	bool Sleeping = false;
 	double LastActivity = -1.0;
 
+	// Time spent moving slower than the sleep velocity.
+	float RestTime = 0.0f;
+
+	// Used by the physics scene when grouping touching bodies into islands.
+	int32_t IslandIndex = -1;
+
+	// Non-kinetic body that was moved during the last update, wakes up the bodies resting on it.
+	bool Moved = false;
+
+	// Covers both the previous and the current position of a body that was moved.
+	BoundingBox MovedBounds;
+
+	// Re-activates a sleeping body.
+	void Wake();
+
+	// Stops simulating the body until something wakes it up.
+	void Sleep();
+
 	bool Contact = true;
 	FTransform PreviousTransform;
 	BoundingBox LocalBounds;
@@ -147,7 +185,8 @@ public:
 	// The surface material of this body.
 	PhysicalSurface Surface = PhysicalSurface::None;
 
-	struct TriangleTree* Tree = nullptr;
+	// Shared with the other bodies that use the same mesh.
+	std::shared_ptr<struct TriangleTree> Tree;
 
 	std::vector<CMeshEntity*> IgnoredBodies;
 	class CPhysics* Physics = nullptr;
@@ -0,0 +1,134 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "BodyStore.h"
+
+#include <cmath>
+
+#include <Engine/Physics/Body/Body.h>
+#include <Engine/Utility/JobSystem.h>
+
+// Amount of blocks (of four bodies) per integration job.
+constexpr size_t IntegrationGrain = 256;
+
+void CBodyStore::Clear()
+{
+	Count = 0;
+}
+
+void CBodyStore::Add( CBody* Body, const Vector3D& Previous, const Vector3D& Position, const float DeltaTime )
+{
+	const auto Index = Count++;
+	const auto Blocks = ( Count + 3 ) / 4;
+	if( Blocks > PositionX.size() )
+	{
+		// Grow all of the arrays at once.
+		const auto Capacity = Blocks * 2;
+		for( auto* Array : { &PositionX, &PositionY, &PositionZ, &PreviousX, &PreviousY, &PreviousZ,
+			&VelocityX, &VelocityY, &VelocityZ, &AccelerationX, &AccelerationY, &AccelerationZ,
+			&InverseMass, &Damping, &Verlet } )
+		{
+			Resize( *Array, Capacity );
+		}
+	}
+
+	Body->StoreIndex = static_cast<int32_t>( Index );
+
+	At( PositionX, Index ) = Position.X;
+	At( PositionY, Index ) = Position.Y;
+	At( PositionZ, Index ) = Position.Z;
+
+	At( PreviousX, Index ) = Previous.X;
+	At( PreviousY, Index ) = Previous.Y;
+	At( PreviousZ, Index ) = Previous.Z;
+
+	At( VelocityX, Index ) = Body->Velocity.X;
+	At( VelocityY, Index ) = Body->Velocity.Y;
+	At( VelocityZ, Index ) = Body->Velocity.Z;
+
+	At( AccelerationX, Index ) = Body->Acceleration.X;
+	At( AccelerationY, Index ) = Body->Acceleration.Y;
+	At( AccelerationZ, Index ) = Body->Acceleration.Z;
+
+	At( InverseMass, Index ) = Body->InverseMass;
+	At( Damping, Index ) = powf( Body->Damping, DeltaTime );
+	At( Verlet, Index ) = Body->Integrator == Integrator::Verlet ? 1.0f : 0.0f;
+}
+
+void CBodyStore::Integrate( const float DeltaTime )
+{
+	const auto Blocks = ( Count + 3 ) / 4;
+	JobSystem::ParallelFor( Blocks, IntegrationGrain, [this, DeltaTime] ( const size_t Start, const size_t End )
+		{
+			IntegrateBlocks( Start, End, DeltaTime );
+		}
+	);
+}
+
+Vector3D CBodyStore::Fetch( CBody* Body ) const
+{
+	const auto Index = static_cast<size_t>( Body->StoreIndex );
+	Body->Velocity = Vector3D( At( VelocityX, Index ), At( VelocityY, Index ), At( VelocityZ, Index ) );
+	return Vector3D( At( PositionX, Index ), At( PositionY, Index ), At( PositionZ, Index ) );
+}
+
+void CBodyStore::IntegrateBlocks( const size_t Start, const size_t End, const float DeltaTime )
+{
+	const auto Step = _mm_set1_ps( DeltaTime );
+	const auto StepSquared = _mm_set1_ps( DeltaTime * DeltaTime );
+	const auto One = _mm_set1_ps( 1.0f );
+
+	for( size_t Block = Start; Block < End; Block++ )
+	{
+		auto X = PositionX[Block];
+		auto Y = PositionY[Block];
+		auto Z = PositionZ[Block];
+
+		// Semi-implicit Euler integration.
+		const auto Scale = _mm_mul_ps( InverseMass[Block], Step );
+		const auto EulerVelocityX = _mm_add_ps( VelocityX[Block], _mm_mul_ps( AccelerationX[Block], Scale ) );
+		const auto EulerVelocityY = _mm_add_ps( VelocityY[Block], _mm_mul_ps( AccelerationY[Block], Scale ) );
+		const auto EulerVelocityZ = _mm_add_ps( VelocityZ[Block], _mm_mul_ps( AccelerationZ[Block], Scale ) );
+
+		// Verlet integration, calculates the velocity using historic data.
+		const auto VerletVelocityX = _mm_sub_ps( X, PreviousX[Block] );
+		const auto VerletVelocityY = _mm_sub_ps( Y, PreviousY[Block] );
+		const auto VerletVelocityZ = _mm_sub_ps( Z, PreviousZ[Block] );
+
+		// Pick the integrator of each body.
+		const auto Mask = _mm_cmpgt_ps( Verlet[Block], _mm_setzero_ps() );
+		const auto NewVelocityX = _mm_or_ps( _mm_and_ps( Mask, VerletVelocityX ), _mm_andnot_ps( Mask, EulerVelocityX ) );
+		const auto NewVelocityY = _mm_or_ps( _mm_and_ps( Mask, VerletVelocityY ), _mm_andnot_ps( Mask, EulerVelocityY ) );
+		const auto NewVelocityZ = _mm_or_ps( _mm_and_ps( Mask, VerletVelocityZ ), _mm_andnot_ps( Mask, EulerVelocityZ ) );
+
+		// Verlet applies the full velocity, Euler scales it by the time step.
+		const auto VelocityStep = _mm_or_ps( _mm_and_ps( Mask, One ), _mm_andnot_ps( Mask, Step ) );
+		const auto AccelerationStep = _mm_and_ps( Mask, StepSquared );
+
+		X = _mm_add_ps( X, _mm_add_ps( _mm_mul_ps( NewVelocityX, VelocityStep ), _mm_mul_ps( AccelerationX[Block], AccelerationStep ) ) );
+		Y = _mm_add_ps( Y, _mm_add_ps( _mm_mul_ps( NewVelocityY, VelocityStep ), _mm_mul_ps( AccelerationY[Block], AccelerationStep ) ) );
+		Z = _mm_add_ps( Z, _mm_add_ps( _mm_mul_ps( NewVelocityZ, VelocityStep ), _mm_mul_ps( AccelerationZ[Block], AccelerationStep ) ) );
+
+		PositionX[Block] = X;
+		PositionY[Block] = Y;
+		PositionZ[Block] = Z;
+
+		// Damping is used to simulate drag.
+		VelocityX[Block] = _mm_mul_ps( NewVelocityX, Damping[Block] );
+		VelocityY[Block] = _mm_mul_ps( NewVelocityY, Damping[Block] );
+		VelocityZ[Block] = _mm_mul_ps( NewVelocityZ, Damping[Block] );
+	}
+}
+
+void CBodyStore::Resize( Lane& Array, const size_t Blocks )
+{
+	Array.resize( Blocks, _mm_setzero_ps() );
+}
+
+float& CBodyStore::At( Lane& Array, const size_t Index )
+{
+	return reinterpret_cast<float*>( Array.data() )[Index];
+}
+
+float CBodyStore::At( const Lane& Array, const size_t Index )
+{
+	return reinterpret_cast<const float*>( Array.data() )[Index];
+}
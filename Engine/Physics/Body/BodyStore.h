@@ -0,0 +1,69 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <vector>
+
+#include <Engine/Utility/Math/Vector.h>
+
+class CBody;
+
+// Structure-of-arrays copy of the kinetic state of the bodies that are integrated during a tick.
+// Every component is stored in its own aligned array so that four bodies can be integrated at once.
+class CBodyStore
+{
+public:
+	// Removes all of the bodies from the store.
+	void Clear();
+
+	// Copies the kinetic state of the body into the store and assigns its store index.
+	// Previous is the position of the body at the start of the tick, Position is the position that will be integrated.
+	void Add( CBody* Body, const Vector3D& Previous, const Vector3D& Position, const float DeltaTime );
+
+	// Integrates all of the bodies in the store, large stores are split across the job system.
+	void Integrate( const float DeltaTime );
+
+	// Copies the integrated velocity back into the body and returns its new position.
+	Vector3D Fetch( CBody* Body ) const;
+
+	size_t Size() const
+	{
+		return Count;
+	}
+
+private:
+	// Four floats per block, the blocks keep the arrays 16-byte aligned.
+	typedef std::vector<__m128> Lane;
+
+	void IntegrateBlocks( const size_t Start, const size_t End, const float DeltaTime );
+
+	static void Resize( Lane& Array, const size_t Blocks );
+	static float& At( Lane& Array, const size_t Index );
+	static float At( const Lane& Array, const size_t Index );
+
+	Lane PositionX;
+	Lane PositionY;
+	Lane PositionZ;
+
+	// Only used by the Verlet integrator.
+	Lane PreviousX;
+	Lane PreviousY;
+	Lane PreviousZ;
+
+	Lane VelocityX;
+	Lane VelocityY;
+	Lane VelocityZ;
+
+	Lane AccelerationX;
+	Lane AccelerationY;
+	Lane AccelerationZ;
+
+	Lane InverseMass;
+
+	// Damping raised to the power of the time step.
+	Lane Damping;
+
+	// One for bodies that use the Verlet integrator, zero for Euler.
+	Lane Verlet;
+
+	size_t Count = 0;
+};
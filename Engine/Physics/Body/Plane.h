@@ -14,6 +14,11 @@ public:
 	virtual void Tick() override;
 	virtual void Debug() const override;
 
+	virtual bool CanBatchIntegrate() const override
+	{
+		return false;
+	}
+
 	// A point on the plane.
 	Vector3D PlaneOrigin = Vector3D::Zero;
 
@@ -129,6 +129,11 @@ public:
 		Latched = Entities;
 	}
 
+	bool CanBatchIntegrate() const override
+	{
+		return false;
+	}
+
 	const FTransform& GetTransform() const override
 	{
 		return TriggerTransform;
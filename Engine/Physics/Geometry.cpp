@@ -87,7 +87,7 @@ Geometry::Result Geometry::LineInBoundingBox( const Vector3D& Start, const Vecto
 	}
 
 #ifdef PerformanceCounter
-	CProfiler::Get().AddCounterEntry( ProfileTimeEntry( "LineInBoundingBox", 1 ), true, false );
+	ProfileCounter( "LineInBoundingBox", 1 );
 #endif
 
 	return Result;
@@ -131,7 +131,7 @@ Geometry::Result Geometry::LineInSphere( const Vector3D& Start, const Vector3D&
 	Result.Normal.Normalize();
 
 #ifdef PerformanceCounter
-	CProfiler::Get().AddCounterEntry( ProfileTimeEntry( "LineInSphere", 1 ), true, false );
+	ProfileCounter( "LineInSphere", 1 );
 #endif
 
 	return Result;
@@ -171,7 +171,7 @@ Geometry::Result Geometry::LineInPlane( const Vector3D& Start, const Vector3D& E
 	Result.Normal = Plane.Normal;
 
 #ifdef PerformanceCounter
-	CProfiler::Get().AddCounterEntry( ProfileTimeEntry( "LineInPlane", 1 ), true, false );
+	ProfileCounter( "LineInPlane", 1 );
 #endif
 
 	return Result;
@@ -1,17 +1,27 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "Physics.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cmath>
 #include <deque>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include <Engine/Configuration/Configuration.h>
+#include <Engine/Physics/PhysicsSnapshot.h>
+#include <Engine/Physics/Body/BodyStore.h>
 #include <Engine/World/Interactable.h>
 #include <Engine/Profiling/Profiling.h>
+#include <Engine/Utility/JobSystem.h>
 #include <Engine/Utility/Math.h>
 #include <Engine/Utility/Thread.h>
 #include <Engine/Utility/ThreadPool.h>
+#include <Engine/Utility/Timer.h>
 #include <Engine/Utility/Structures/BoundingVolumeHierarchy.h>
+#include <Engine/Utility/Structures/FlatBoundingVolumeHierarchy.h>
 #include <Engine/Utility/Structures/SpatialHash.h>
 
 #include <Engine/Display/UserInterface.h>
@@ -27,6 +37,22 @@ ConfigurationVariable<bool> DrawDebugStaticQueries( "debug.Physics.DrawDebugStat
 ConfigurationVariable<bool> DrawDebugDynamicQueries( "debug.Physics.DrawDebugDynamicQueries", false );
 
 ConfigurationVariable<bool> UpdateDynamicScene( "physics.UpdateDynamicScene", true ); // Set to true because the other solution tends to crash.
+ConfigurationVariable<bool> RefitDynamicScene( "physics.RefitDynamicScene", true );
+ConfigurationVariable<float> DynamicSceneRebuildThreshold( "physics.DynamicSceneRebuildThreshold", 1.5f );
+ConfigurationVariable<bool> FlatStaticScene( "physics.FlatStaticScene", true );
+ConfigurationVariable<bool> QuerySnapshots( "physics.QuerySnapshots", true );
+ConfigurationVariable<bool> SleepingBodies( "physics.Sleeping", true );
+ConfigurationVariable<float> SleepTime( "physics.SleepTime", 0.5f );
+ConfigurationVariable<bool> BatchIntegration( "physics.BatchIntegration", true );
+
+// Fast bodies are simulated using multiple steps per tick so that they don't move through thin bodies.
+ConfigurationVariable<int> MaximumSubSteps( "physics.MaximumSubSteps", 8 );
+
+// Fraction of the smallest body extent that the fastest body is allowed to travel per step.
+ConfigurationVariable<float> SubStepTravel( "physics.SubStepTravel", 0.5f );
+
+// Amount of time (in milliseconds) that can be spent on substeps each tick.
+ConfigurationVariable<float> SubStepBudget( "physics.SubStepBudget", 4.0f );
 ConfigurationVariable<bool> SynchronousBodyUpdate( "physics.SynchronousBodyUpdate", false );
 ConfigurationVariable<bool> SynchronousQuery( "physics.SynchronousQuery", false );
 
@@ -60,13 +86,25 @@ struct QueryTask : public Task
 
 		OptickCategory( "Asynchronous Physics Queries", Optick::Category::Physics );
 
+		Timer QueryTimer;
+		QueryTimer.Start();
+
 		auto* Testable = Scene.get();
+		auto* Sleeping = SleepingScene.get();
 		for( auto& Request : *Requests )
 		{
 			const auto& Bounds = Request.Body->Continuous ? Request.Body->WorldBoundsSweptSIMD : Request.Body->InflatedBoundsSIMD;
 			Testable->Query( Bounds, Request.Result );
+
+			if( Sleeping )
+			{
+				Sleeping->Query( Bounds, Request.Result );
+			}
 		}
 
+		QueryTimer.Stop();
+		Time += QueryTimer.GetElapsedTimeMicroseconds();
+
 		if( !SynchronousQuery && !Synchronous )
 		{
 			Mutex.unlock();
@@ -74,9 +112,16 @@ struct QueryTask : public Task
 	}
 
 	std::shared_ptr<Testable> Scene = nullptr;
+
+	// Bodies that are asleep, awake bodies can still collide with them. (can be null)
+	std::shared_ptr<Testable> SleepingScene = nullptr;
+
 	std::shared_ptr<std::vector<QueryRequest>> Requests = nullptr;
 	std::mutex Mutex;
 	bool Synchronous = false;
+
+	// Accumulated time spent querying, reset at the start of each tick.
+	int64_t Time = 0;
 };
 
 bool UsesStaticQuery( const CBody* Body )
@@ -94,6 +139,55 @@ bool UsesDynamicQuery( const CBody* Body )
 
 constexpr double DefaultTimeStep = 1 / 60.0;
 
+// Limits the amount of jobs a single query batch is split into.
+constexpr size_t MaximumBatchChunks = 64;
+constexpr size_t MinimumBatchChunkSize = 256;
+
+struct QueryBatch
+{
+	void Execute( const size_t Start, const size_t End )
+	{
+		std::vector<Testable*> Ignore;
+		for( size_t Index = Start; Index < End; Index++ )
+		{
+			if( Rays.empty() )
+			{
+				Snapshot->Query( Boxes[Index], Result.Overlaps[Index], Type );
+				continue;
+			}
+
+			const auto& Ray = Rays[Index];
+			Ignore.clear();
+			if( Ray.Ignore )
+			{
+				Ignore.emplace_back( Ray.Ignore );
+			}
+
+			Result.Casts[Index] = Snapshot->Cast( Ray.Start, Ray.End, Ignore, Type );
+		}
+	}
+
+	size_t Size() const
+	{
+		return Rays.empty() ? Boxes.size() : Rays.size();
+	}
+
+	std::shared_ptr<const CPhysicsSnapshot> Snapshot;
+	PollType Type = PollType::All;
+
+	std::vector<PhysicsRay> Rays;
+	std::vector<BoundingBoxSIMD> Boxes;
+	QueryBatchResult Result;
+
+	JobSystem::Job* Root = nullptr;
+
+	// Amount of chunks that haven't been processed yet.
+	std::atomic<size_t> Remaining{ 0 };
+
+	// Waiting for the next tick to publish an up-to-date snapshot, guarded by the batch mutex.
+	bool Deferred = false;
+};
+
 class CPhysicsScene
 {
 public:
@@ -121,6 +215,7 @@ public:
 
 		// Insert the body into the acceleration structure.
 		Insert( Body );
+		MarkDirty( Body );
 
 		// Add the body to the query list so it can be checked before the next physics body update.
 		AddToQueryList( Body );
@@ -137,6 +232,7 @@ public:
 			{
 				// Remove the body from the acceleration structure.
 				Remove( Body );
+				MarkDirty( Body );
 
 				Bodies.erase( Iterator );
 				break;
@@ -144,11 +240,31 @@ public:
 		}
 	}
 
+	// Flags the scenes that have to be rebuilt because bodies were added or removed.
+	void MarkDirty( CBody* Body )
+	{
+		if( Body->Static )
+		{
+			StaticGeneration++;
+			return;
+		}
+
+		DynamicSceneDirty = true;
+		SleepingSceneDirty = true;
+	}
+
 	void InsertStatic( CBody* Body )
 	{
 		if( !StaticScene )
 			return;
 
+		if( dynamic_cast<FlatBoundingVolumeHierarchy*>( StaticScene.get() ) )
+		{
+			// The flat hierarchy can't grow, rebuild it before the next tick.
+			StaticSceneDirty = true;
+			return;
+		}
+
 		auto* Node = dynamic_cast<AccelerationStructure::Node*>( StaticScene.get() );
 		if( !Node )
 			return;
@@ -185,6 +301,12 @@ public:
 		if( !StaticScene )
 			return;
 
+		if( auto* Flat = dynamic_cast<FlatBoundingVolumeHierarchy*>( StaticScene.get() ) )
+		{
+			Flat->Remove( Body );
+			return;
+		}
+
 		auto* Node = dynamic_cast<AccelerationStructure::Node*>( StaticScene.get() );
 		if( !Node )
 			return;
@@ -194,6 +316,11 @@ public:
 
 	void RemoveDynamic( CBody* Body )
 	{
+		if( auto* Flat = dynamic_cast<FlatBoundingVolumeHierarchy*>( SleepingScene.get() ) )
+		{
+			Flat->Remove( Body );
+		}
+
 		if( !DynamicScene )
 			return;
 
@@ -241,9 +368,17 @@ public:
 	void Destroy()
 	{
 		Guard();
+		WaitForBatches();
+
+		{
+			std::unique_lock<std::mutex> Lock( SnapshotMutex );
+			Snapshot = nullptr;
+			SnapshotBack = nullptr;
+		}
 
 		AccelerationStructure::Destroy( StaticScene );
 		AccelerationStructure::Destroy( DynamicScene );
+		SleepingScene = nullptr;
 		
 		// Delete all of the bodies in the array.
 		for( auto* Body : Bodies )
@@ -286,6 +421,10 @@ public:
 		if( !Body )
 			return;
 
+		// Sleeping bodies don't look for contacts, awake bodies will find them instead.
+		if( Body->Sleeping )
+			return;
+
 		if( UsesStaticQuery( Body ) )
 		{
 			StaticQueryRequests->emplace_back( Body );
@@ -304,7 +443,7 @@ public:
 
 		CreateQueryContainers();
 
-		if( !StaticScene )
+		if( !StaticScene || StaticSceneDirty )
 		{
 			BuildStaticScene();
 		}
@@ -322,8 +461,16 @@ public:
 		if( DrawDebugDynamicQueries )
 		{
 			DynamicScene->Debug();
+
+			if( SleepingScene )
+			{
+				SleepingScene->Debug();
+			}
 		}
 		
+		Timer PreCollisionTimer;
+		PreCollisionTimer.Start();
+
 		for( auto* BodyA : Bodies )
 		{
 			if( !BodyA )
@@ -332,24 +479,85 @@ public:
 			BodyA->PreCollision();
 		}
 
+		PreCollisionTimer.Stop();
+		Timings.PreCollision += PreCollisionTimer.GetElapsedTimeMicroseconds();
+
 		ScheduleBodyUpdate();
 	}
 
 	void Tick( const double& Time )
 	{
-		double DeltaTime = Time - CurrentTime;
-		constexpr int SubSteps = 1;
+		Timer StepTimer;
+		StepTimer.Start();
 
-		double TotalTimeStep = TimeStep;
-		TimeStep = TimeStep / SubSteps;
+		// The step size can't change while the previous step is still running.
+		Guard();
+
+		Timings = PhysicsTimings();
+		StaticQuery->Time = 0;
+		DynamicQuery->Time = 0;
+
+		const int SubSteps = CalculateSubSteps();
+		StepSize = TimeStep / SubSteps;
 
 		for( int SubStep = 0; SubStep < SubSteps; SubStep++ )
 		{
 			SubTick();
-			CurrentTime += TimeStep;
+			CurrentTime += StepSize;
 		};
 
-		TimeStep = TotalTimeStep;
+		StepTimer.Stop();
+
+		// The last step finishes asynchronously, its cost is included in the guard of the next tick.
+		const auto StepCost = static_cast<float>( StepTimer.GetElapsedTimeSeconds() * 1000.0 / SubSteps );
+		SubStepCost = SubStepCost > 0.0f ? Math::Lerp( SubStepCost, StepCost, 0.25f ) : StepCost;
+
+		ProfileCounter( "Physics Substeps", SubSteps );
+		ProfileCounter( "Physics Substep Time (us)", StepTimer.GetElapsedTimeMicroseconds() );
+	}
+
+	// Picks the amount of steps needed to stop the fastest body from travelling further than a fraction of the smallest body.
+	int CalculateSubSteps() const
+	{
+		const int Maximum = MaximumSubSteps.Get();
+		if( Maximum <= 1 )
+			return 1;
+
+		float SpeedSquared = 0.0f;
+		float SmallestExtent = FLT_MAX;
+		for( auto* Body : Bodies )
+		{
+			if( !Body || !Body->Block )
+				continue;
+
+			// Planes don't have any thickness.
+			const auto Extent = Math::Min( Body->WorldBounds.Size() );
+			if( Extent > 0.0f )
+			{
+				SmallestExtent = std::min( SmallestExtent, Extent );
+			}
+
+			if( Body->IsKinetic() && !Body->Sleeping )
+			{
+				SpeedSquared = std::max( SpeedSquared, ( Body->Velocity + Body->LinearVelocity ).LengthSquared() );
+			}
+		}
+
+		if( SpeedSquared <= 0.0f || SmallestExtent == FLT_MAX )
+			return 1;
+
+		const auto Travel = std::sqrt( SpeedSquared ) * static_cast<float>( TimeStep * GameLayersInstance->GetTimeScale() );
+		const auto Allowed = std::max( SmallestExtent * SubStepTravel.Get(), 0.0001f );
+		int SubSteps = std::min( Maximum, static_cast<int>( std::ceil( Travel / Allowed ) ) );
+
+		// Don't exceed the time budget, based on the cost of the steps that were taken during the previous ticks.
+		if( SubStepCost > 0.0f )
+		{
+			const auto Affordable = static_cast<int>( SubStepBudget.Get() / SubStepCost );
+			SubSteps = std::min( SubSteps, Affordable );
+		}
+
+		return std::max( 1, SubSteps );
 	}
 
 	static void ResolveCollisions( CBody* A, const QueryResult& Query )
@@ -411,7 +619,18 @@ public:
 				continue;
 
 			if( BodyA->Sleeping )
-				continue;
+			{
+				// Velocity or forces applied from outside of the simulation wake the body up.
+				const bool Moved = !Math::Equal( BodyA->Velocity, Vector3D::Zero ) || !Math::Equal( BodyA->Acceleration, Vector3D::Zero );
+				if( Moved || !SleepingBodies )
+				{
+					Wake( BodyA );
+				}
+				else
+				{
+					continue;
+				}
+			}
 
 			// Simulate environmental factors. (gravity etc.)
 			BodyA->Simulate();
@@ -419,19 +638,208 @@ public:
 
 		ResolveCollisions();
 
+		size_t ActiveBodies = 0;
+		Integrating.clear();
 		for( auto* BodyA : Bodies )
 		{
 			if( !BodyA )
 				continue;
 
+			if( BodyA->Sleeping )
+				continue;
+
+			ActiveBodies++;
+
+			if( BatchIntegration && BodyA->CanBatchIntegrate() )
+			{
+				Integrating.emplace_back( BodyA );
+				continue;
+			}
+
 			BodyA->Tick();
+			Reinsert( BodyA );
+		}
+
+		IntegrateBodies();
 
-			// Check if the body moved.
-			if( !UpdateDynamicScene && BodyA->LastActivity == CurrentTime )
+		if( SleepingBodies )
+		{
+			BuildIslands();
+		}
+
+		if( SleepingSceneDirty )
+		{
+			BuildSleepingScene();
+
+			// Make sure bodies don't end up in both scenes when the queries are scheduled.
+			if( DynamicSceneDirty )
 			{
-				// Re-insert the body.
-				Remove( BodyA );
-				Insert( BodyA );
+				BuildDynamicScene();
+			}
+		}
+
+		ProfileCounter( "Physics Active Bodies", static_cast<int64_t>( ActiveBodies ) );
+		ProfileCounter( "Physics Sleeping Bodies", static_cast<int64_t>( SleepingBodyCount ) );
+	}
+
+	// Integrates the kinetic bodies in the structure-of-arrays store instead of one at a time.
+	void IntegrateBodies()
+	{
+		if( Integrating.empty() )
+			return;
+
+		OptickEvent();
+
+		const auto DeltaTime = static_cast<float>( StepSize * GameLayersInstance->GetTimeScale() );
+
+		Store.Clear();
+		for( auto* Body : Integrating )
+		{
+			const auto Previous = Body->GetTransform().GetPosition();
+			const auto Position = Body->PreIntegrate();
+			Store.Add( Body, Previous, Position, DeltaTime );
+		}
+
+		Store.Integrate( DeltaTime );
+
+		for( auto* Body : Integrating )
+		{
+			Body->PostIntegrate( Store.Fetch( Body ) );
+			Reinsert( Body );
+		}
+	}
+
+	// Check if the body moved.
+	void Reinsert( CBody* Body )
+	{
+		if( !UpdateDynamicScene && Body->LastActivity == CurrentTime )
+		{
+			// Re-insert the body.
+			Remove( Body );
+			Insert( Body );
+		}
+	}
+
+	void Wake( CBody* Body )
+	{
+		Body->Wake();
+		DynamicSceneDirty = true;
+		SleepingSceneDirty = true;
+	}
+
+	static int32_t FindIsland( std::vector<int32_t>& Parents, int32_t Index )
+	{
+		while( Parents[Index] != Index )
+		{
+			// Path halving, keeps the trees shallow.
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+
+		return Index;
+	}
+
+	// Groups kinetic bodies that touch each other into islands, islands that have come to rest are put to sleep.
+	// A single awake body that keeps moving will keep the whole island awake, or wake it up when it touches it.
+	void BuildIslands()
+	{
+		OptickEvent();
+
+		IslandBodies.clear();
+		for( auto* Body : Bodies )
+		{
+			if( !Body )
+				continue;
+
+			if( Body->IsKinetic() )
+			{
+				Body->IslandIndex = static_cast<int32_t>( IslandBodies.size() );
+				IslandBodies.emplace_back( Body );
+			}
+			else
+			{
+				Body->IslandIndex = -1;
+			}
+		}
+
+		const auto Count = IslandBodies.size();
+		IslandParents.resize( Count );
+		for( size_t Index = 0; Index < Count; Index++ )
+		{
+			IslandParents[Index] = static_cast<int32_t>( Index );
+		}
+
+		// Sleeping bodies don't have contacts, awake bodies touching them will link them instead.
+		for( auto* Body : IslandBodies )
+		{
+			for( const auto& Contact : Body->Contacts )
+			{
+				if( !Contact.Other || Contact.Other->IslandIndex < 0 )
+					continue;
+
+				const auto A = FindIsland( IslandParents, Body->IslandIndex );
+				const auto B = FindIsland( IslandParents, Contact.Other->IslandIndex );
+				if( A != B )
+				{
+					IslandParents[B] = A;
+				}
+			}
+		}
+
+		// An island stays awake as long as one of its bodies is still moving.
+		const float RestTime = SleepTime.Get();
+		IslandAwake.assign( Count, 0 );
+		for( auto* Body : IslandBodies )
+		{
+			if( !Body->Sleeping && Body->RestTime < RestTime )
+			{
+				IslandAwake[FindIsland( IslandParents, Body->IslandIndex )] = 1;
+			}
+		}
+
+		// Sleeping bodies don't have contacts, wake the islands that rest on non-kinetic bodies that were moved this tick.
+		if( SleepingScene )
+		{
+			QueryResult Query;
+			for( auto* Body : Bodies )
+			{
+				if( !Body || Body->IsKinetic() || !Body->Moved )
+					continue;
+
+				Query.Objects.clear();
+				auto Bounds = Body->MovedBounds;
+				Bounds.Minimum -= { 0.02f, 0.02f, 0.02f };
+				Bounds.Maximum += { 0.02f, 0.02f, 0.02f };
+				SleepingScene->Query( BoundingBoxSIMD( Bounds ), Query );
+				for( auto* Object : Query.Objects )
+				{
+					auto* Other = ::Cast<CBody>( Object );
+					if( Other && Other->IslandIndex >= 0 )
+					{
+						IslandAwake[FindIsland( IslandParents, Other->IslandIndex )] = 1;
+					}
+				}
+			}
+		}
+
+		SleepingBodyCount = 0;
+		for( auto* Body : IslandBodies )
+		{
+			const bool Awake = IslandAwake[FindIsland( IslandParents, Body->IslandIndex )] != 0;
+			if( Awake && Body->Sleeping )
+			{
+				Wake( Body );
+			}
+			else if( !Awake && !Body->Sleeping )
+			{
+				Body->Sleep();
+				DynamicSceneDirty = true;
+				SleepingSceneDirty = true;
+			}
+
+			if( Body->Sleeping )
+			{
+				SleepingBodyCount++;
 			}
 		}
 	}
@@ -439,6 +847,25 @@ public:
 	double CurrentTime = -1.0;
 	double TimeStep = DefaultTimeStep;
 
+	// Size of the current substep.
+	double StepSize = DefaultTimeStep;
+
+	// Average time (in milliseconds) that a single substep takes.
+	float SubStepCost = 0.0f;
+
+	// Written by the body worker, only read it after guarding.
+	PhysicsTimings Timings;
+
+	PhysicsTimings GetTimings() const
+	{
+		Guard();
+
+		auto Result = Timings;
+		Result.StaticQueries = StaticQuery->Time;
+		Result.DynamicQueries = DynamicQuery->Time;
+		return Result;
+	}
+
 	void ScheduleBodyUpdate()
 	{
 		const auto BodyUpdate = std::make_shared<LambdaTask>( [this] ()
@@ -454,10 +881,18 @@ public:
 
 				if( UpdateDynamicScene )
 				{
-					BuildDynamicScene();
+					RefreshDynamicScene();
 				}
 
+				Timer UpdateTimer;
+				UpdateTimer.Start();
+
 				UpdateBodies();
+
+				UpdateTimer.Stop();
+				Timings.UpdateBodies += UpdateTimer.GetElapsedTimeMicroseconds();
+
+				PublishSnapshot();
 				ScheduleQueries();
 			}
 		);
@@ -511,6 +946,7 @@ public:
 		StaticQuery->Synchronous = IsSynchronous();
 
 		DynamicQuery->Scene = DynamicScene;
+		DynamicQuery->SleepingScene = SleepingScene;
 		DynamicQuery->Requests = DynamicQueryRequests;
 		DynamicQuery->Synchronous = IsSynchronous();
 
@@ -579,6 +1015,15 @@ public:
 				DynamicResult = DynamicScene->Cast( Start, End, IgnoreList );
 			}
 
+			if( PollDynamicScene && SleepingScene )
+			{
+				const auto SleepingResult = SleepingScene->Cast( Start, End, IgnoreList );
+				if( SleepingResult.Hit && SleepingResult.Body && ( !DynamicResult.Hit || SleepingResult.Distance < DynamicResult.Distance ) )
+				{
+					DynamicResult = SleepingResult;
+				}
+			}
+
 			if( StaticResult.Hit && DynamicResult.Hit && StaticResult.Body && DynamicResult.Body )
 			{
 				if( DynamicResult.Distance < StaticResult.Distance )
@@ -701,6 +1146,11 @@ public:
 				return Result;
 
 			DynamicScene->Query( AABB, Query );
+
+			if( SleepingScene )
+			{
+				SleepingScene->Query( AABB, Query );
+			}
 		}
 
 		Result.reserve( Query.Objects.size() );
@@ -749,12 +1199,44 @@ public:
 			}
 		}
 
-		StaticScene = AccelerationStructure::Build( StaticVector );
+		if( FlatStaticScene )
+		{
+			StaticScene = FlatBoundingVolumeHierarchy::Build( StaticVector );
+		}
+		else
+		{
+			StaticScene = AccelerationStructure::Build( StaticVector );
+		}
+
+		StaticSceneDirty = false;
+	}
+
+	// Refits the dynamic scene to the new body bounds, the scene is rebuilt when its quality has degraded too much.
+	void RefreshDynamicScene()
+	{
+		if( !DynamicScene || DynamicSceneDirty || !RefitDynamicScene )
+		{
+			BuildDynamicScene();
+			return;
+		}
+
+		OptickEvent();
+
+		const float Cost = AccelerationStructure::Refit( DynamicScene );
+		if( Cost > DynamicSceneBuildCost * DynamicSceneRebuildThreshold.Get() )
+		{
+			BuildDynamicScene();
+			return;
+		}
+
+		ProfileCounter( "Physics Dynamic Scene Refits", 1 );
 	}
 
 	void BuildDynamicScene()
 	{
+		OptickEvent();
 		ProfileMemoryClear( "Physics Dynamic Scene" );
+		ProfileCounter( "Physics Dynamic Scene Builds", 1 );
 
 		if( DynamicScene )
 			AccelerationStructure::Destroy( DynamicScene );
@@ -764,13 +1246,190 @@ public:
 
 		for( auto* Body : Bodies )
 		{
-			if( !Body->Static )
+			// Sleeping bodies are stored in their own scene.
+			if( !Body->Static && !Body->Sleeping )
 			{
 				DynamicVector.emplace_back( Body );
 			}
 		}
 
 		DynamicScene = AccelerationStructure::Build( DynamicVector );
+		DynamicSceneBuildCost = AccelerationStructure::Cost( DynamicScene );
+		DynamicSceneDirty = false;
+	}
+
+	// Sleeping bodies don't move, they are stored in a flat hierarchy like the static scene.
+	void BuildSleepingScene()
+	{
+		OptickEvent();
+
+		FlatBoundingVolumeHierarchy::RawObjectList SleepingVector;
+		for( auto* Body : Bodies )
+		{
+			if( !Body->Static && Body->Sleeping )
+			{
+				SleepingVector.emplace_back( Body );
+			}
+		}
+
+		SleepingScene = SleepingVector.empty() ? nullptr : FlatBoundingVolumeHierarchy::Build( SleepingVector );
+		SleepingSceneDirty = false;
+	}
+
+	// Copies the bodies into the back buffer and swaps it with the snapshot that is used by new query batches.
+	// Most ticks don't run any batches, so the copy is only made when batches were submitted or are still pending.
+	void PublishSnapshot()
+	{
+		if( !QuerySnapshots )
+			return;
+
+		bool Pending = false;
+		{
+			std::unique_lock<std::mutex> Lock( BatchMutex );
+			Pending = !Batches.empty();
+		}
+
+		if( !SnapshotRequested.exchange( false ) && !Pending )
+		{
+			SnapshotCurrent = false;
+			return;
+		}
+
+		OptickEvent();
+
+		// Re-use the back buffer unless a batch is still reading from it.
+		if( !SnapshotBack || SnapshotBack.use_count() > 1 )
+		{
+			SnapshotBack = std::make_shared<CPhysicsSnapshot>();
+		}
+
+		SnapshotBack->Build( Bodies, Snapshot.get(), StaticGeneration );
+
+		{
+			std::unique_lock<std::mutex> Lock( SnapshotMutex );
+			std::swap( Snapshot, SnapshotBack );
+		}
+
+		SnapshotCurrent = true;
+
+		// Run the batches that were waiting for this snapshot.
+		std::unique_lock<std::mutex> Lock( BatchMutex );
+		for( auto& Batch : Batches )
+		{
+			if( !Batch.second->Deferred )
+				continue;
+
+			Batch.second->Deferred = false;
+			Batch.second->Snapshot = Snapshot;
+			Launch( *Batch.second );
+		}
+	}
+
+	QueryTicket Submit( std::unique_ptr<QueryBatch> Batch )
+	{
+		{
+			std::unique_lock<std::mutex> Lock( SnapshotMutex );
+			Batch->Snapshot = Snapshot;
+		}
+
+		SnapshotRequested = true;
+
+		Batch->Result.Casts.resize( Batch->Rays.size() );
+		Batch->Result.Overlaps.resize( Batch->Boxes.size() );
+
+		auto* Pending = Batch.get();
+		QueryTicket Ticket;
+		bool Deferred = false;
+		{
+			std::unique_lock<std::mutex> Lock( BatchMutex );
+			Ticket = NextTicket++;
+
+			// The snapshot wasn't refreshed during the last tick, wait for the next one.
+			Deferred = QuerySnapshots && !SnapshotCurrent;
+			Pending->Deferred = Deferred;
+			Batches.insert_or_assign( Ticket, std::move( Batch ) );
+		}
+
+		if( !Deferred )
+		{
+			Launch( *Pending );
+		}
+
+		return Ticket;
+	}
+
+	static void Launch( QueryBatch& Batch )
+	{
+		// Nothing to query against until the first tick has completed.
+		const auto Count = Batch.Size();
+		if( !Batch.Snapshot || Count == 0 )
+			return;
+
+		auto* Pending = &Batch;
+		const auto Chunks = std::max( static_cast<size_t>( 1 ), std::min( MaximumBatchChunks, Count / MinimumBatchChunkSize ) );
+		const auto Grain = ( Count + Chunks - 1 ) / Chunks;
+
+		Pending->Remaining = ( Count + Grain - 1 ) / Grain;
+		Pending->Root = JobSystem::Create();
+		for( size_t Start = 0; Start < Count; Start += Grain )
+		{
+			const auto End = std::min( Start + Grain, Count );
+			JobSystem::Run( JobSystem::Create( Pending->Root, [Pending, Start, End] ()
+				{
+					Pending->Execute( Start, End );
+					Pending->Remaining.fetch_sub( 1, std::memory_order_release );
+				}
+			) );
+		}
+
+		JobSystem::Run( Pending->Root );
+	}
+
+	QueryBatchResult Collect( const QueryTicket& Ticket )
+	{
+		std::unique_ptr<QueryBatch> Batch;
+		{
+			std::unique_lock<std::mutex> Lock( BatchMutex );
+			const auto Iterator = Batches.find( Ticket );
+			if( Iterator == Batches.end() )
+			{
+				Log::Event( Log::Warning, "Physics query batch %u does not exist.\n", Ticket );
+				return {};
+			}
+
+			Batch = std::move( Iterator->second );
+			Batches.erase( Iterator );
+		}
+
+		// The simulation hasn't published a new snapshot yet, query the previous one instead of waiting for it.
+		if( Batch->Deferred )
+		{
+			Batch->Deferred = false;
+			Launch( *Batch );
+		}
+
+		Wait( *Batch );
+		return std::move( Batch->Result );
+	}
+
+	static void Wait( const QueryBatch& Batch )
+	{
+		// Don't touch the root job once the batch is done, it may have been recycled.
+		if( Batch.Remaining.load( std::memory_order_acquire ) > 0 )
+		{
+			JobSystem::Wait( Batch.Root );
+		}
+	}
+
+	void WaitForBatches()
+	{
+		std::unique_lock<std::mutex> Lock( BatchMutex );
+		for( const auto& Batch : Batches )
+		{
+			Wait( *Batch.second );
+		}
+
+		Batches.clear();
 	}
 
 	bool IsSynchronous() const
@@ -789,6 +1448,47 @@ private:
 	std::shared_ptr<Testable> StaticScene;
 	std::shared_ptr<Testable> DynamicScene;
 
+	// Cost of the dynamic scene right after it was built, used to determine when refitting is no longer viable.
+	float DynamicSceneBuildCost = 0.0f;
+
+	// Bodies were added or removed, the dynamic scene has to be rebuilt.
+	bool DynamicSceneDirty = true;
+
+	// Kinetic bodies that have come to rest.
+	std::shared_ptr<Testable> SleepingScene;
+	bool SleepingSceneDirty = true;
+	size_t SleepingBodyCount = 0;
+
+	// Kinetic bodies that are integrated by the body store this tick.
+	std::vector<CBody*> Integrating;
+	CBodyStore Store;
+
+	// Union-find storage used to build the simulation islands.
+	std::vector<CBody*> IslandBodies;
+	std::vector<int32_t> IslandParents;
+	std::vector<uint8_t> IslandAwake;
+
+	// Static bodies were added to a scene that doesn't support insertion.
+	bool StaticSceneDirty = false;
+
+	// Incremented whenever static bodies are added or removed.
+	size_t StaticGeneration = 0;
+
+	// Double-buffered copies of the scene for the batched queries.
+	std::shared_ptr<CPhysicsSnapshot> Snapshot;
+	std::shared_ptr<CPhysicsSnapshot> SnapshotBack;
+	std::mutex SnapshotMutex;
+
+	// Set by new batches, tells the next tick to publish a snapshot.
+	std::atomic<bool> SnapshotRequested{ false };
+
+	// The last tick published a snapshot.
+	std::atomic<bool> SnapshotCurrent{ false };
+
+	std::unordered_map<QueryTicket, std::unique_ptr<QueryBatch>> Batches;
+	std::mutex BatchMutex;
+	QueryTicket NextTicket = 0;
+
 	std::future<void> StaticQueryWork;
 	std::future<void> DynamicQueryWork;
 	std::future<void> BodyWork;
@@ -866,6 +1566,47 @@ std::vector<CBody*> CPhysics::Query( const BoundingBox& AABB, const PollType& Ty
 	return Scene->Query( AABB, Type );
 }
 
+QueryTicket CPhysics::SubmitRays( const PhysicsRay* Rays, const size_t Count, const PollType& Type )
+{
+	auto Batch = std::make_unique<QueryBatch>();
+	Batch->Rays.assign( Rays, Rays + Count );
+	Batch->Type = Type;
+	return Scene->Submit( std::move( Batch ) );
+}
+
+QueryTicket CPhysics::SubmitRays( const std::vector<PhysicsRay>& Rays, const PollType& Type )
+{
+	return SubmitRays( Rays.data(), Rays.size(), Type );
+}
+
+QueryTicket CPhysics::SubmitOverlaps( const BoundingBox* Boxes, const size_t Count, const PollType& Type )
+{
+	auto Batch = std::make_unique<QueryBatch>();
+	Batch->Boxes.reserve( Count );
+	for( size_t Index = 0; Index < Count; Index++ )
+	{
+		Batch->Boxes.emplace_back( Boxes[Index] );
+	}
+
+	Batch->Type = Type;
+	return Scene->Submit( std::move( Batch ) );
+}
+
+QueryTicket CPhysics::SubmitOverlaps( const std::vector<BoundingBox>& Boxes, const PollType& Type )
+{
+	return SubmitOverlaps( Boxes.data(), Boxes.size(), Type );
+}
+
+QueryBatchResult CPhysics::Collect( const QueryTicket& Ticket )
+{
+	return Scene->Collect( Ticket );
+}
+
+PhysicsTimings CPhysics::GetTimings() const
+{
+	return Scene->GetTimings();
+}
+
 bool CPhysics::IsSynchronous() const
 {
 	return Scene->IsSynchronous();
@@ -881,5 +1622,5 @@ double CPhysics::GetTimeStep() const
 	if( !Scene )
 		return 0.0;
 
-	return Scene->TimeStep * GameLayersInstance->GetTimeScale();
+	return Scene->StepSize * GameLayersInstance->GetTimeScale();
 }
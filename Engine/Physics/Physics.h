@@ -1,9 +1,11 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include <Engine/Physics/Geometry.h>
+#include <Engine/Utility/Structures/QueryResult.h>
 
 class CBody;
 class CPhysicsScene;
@@ -22,6 +24,36 @@ enum class PollType : int8_t
 	Dynamic
 };
 
+struct PhysicsRay
+{
+	Vector3D Start;
+	Vector3D End;
+
+	// Body that should be ignored by this ray. (can be null)
+	CBody* Ignore = nullptr;
+};
+
+// Identifies a batch of queries that has been submitted to the physics engine.
+typedef uint32_t QueryTicket;
+
+struct QueryBatchResult
+{
+	// Closest hit for each submitted ray.
+	std::vector<Geometry::Result> Casts;
+
+	// Overlapping bodies for each submitted box.
+	std::vector<QueryResult> Overlaps;
+};
+
+// Time spent in each phase of the last tick, in microseconds. Includes all of its substeps.
+struct PhysicsTimings
+{
+	int64_t PreCollision = 0;
+	int64_t UpdateBodies = 0;
+	int64_t StaticQueries = 0;
+	int64_t DynamicQueries = 0;
+};
+
 class CPhysics
 {
 public:
@@ -43,6 +75,23 @@ public:
 	Geometry::Result Cast( const Vector3D& Start, const Vector3D& End, const std::vector<CBody*>& Ignore, const PollType& Type = PollType::All ) const;
 	std::vector<CBody*> Query( const BoundingBox& AABB, const PollType& Type = PollType::All ) const;
 
+	// Batched queries run on the job system against a snapshot of the last completed tick, they don't wait for the physics workers.
+	// Snapshots are only taken while batches are in use. A batch submitted after a quiet period runs after the next tick,
+	// or against the last snapshot that was taken if it is collected before that.
+	// Bodies that have been unregistered since the snapshot was taken may still show up in the results.
+	// The results point at the original bodies, don't dereference them once those bodies may have been destroyed.
+	// Collect a batch in the same frame it was submitted in, or look the bodies up in the world again before using them.
+	QueryTicket SubmitRays( const PhysicsRay* Rays, const size_t Count, const PollType& Type = PollType::All );
+	QueryTicket SubmitRays( const std::vector<PhysicsRay>& Rays, const PollType& Type = PollType::All );
+	QueryTicket SubmitOverlaps( const BoundingBox* Boxes, const size_t Count, const PollType& Type = PollType::All );
+	QueryTicket SubmitOverlaps( const std::vector<BoundingBox>& Boxes, const PollType& Type = PollType::All );
+
+	// Waits for the batch to finish and returns its results, each ticket can only be collected once.
+	QueryBatchResult Collect( const QueryTicket& Ticket );
+
+	// Waits for the workers so that the query timings of the last tick are included.
+	PhysicsTimings GetTimings() const;
+
 	bool IsSynchronous() const;
 	void SetSynchronous( const bool Synchrohous );
 
@@ -10,6 +10,7 @@
 
 #include <Engine/Physics/Geometry.h>
 #include <Engine/Physics/Response.h>
+#include <Engine/Physics/TriangleTree.h>
 
 #include <Engine/World/Entity/Entity.h>
 #include <Engine/World/Entity/MeshEntity/MeshEntity.h>
@@ -22,6 +23,8 @@ ConfigurationVariable<bool> DisplayBodyInfo( "debug.Physics.DisplayBodyInfo", fa
 ConfigurationVariable<bool> DisplayTriangleTree( "debug.Physics.DisplayTriangleTree", false );
 ConfigurationVariable<bool> DisplaySphereBounds( "debug.Physics.DisplaySphereBounds", false );
 ConVar<bool> DisableGravity( "debug.Physics.DisableGravity", false );
+ConfigurationVariable<float> SleepVelocity( "physics.SleepVelocity", 0.1f );
+ConfigurationVariable<bool> TriangleCollisions( "physics.TriangleCollisions", false );
 
 ConCommand ToggleGravity( "ToggleGravity", []( const std::string& Parameters ) {
 	DisableGravity.Set( !DisableGravity.Get() );
@@ -39,34 +42,6 @@ ConCommand ToggleGravity( "ToggleGravity", []( const std::string& Parameters ) {
 
 size_t TextPosition = 0;
 
-struct TriangleTree
-{
-	TriangleTree() = default;
-	~TriangleTree()
-	{
-		delete Upper;
-		delete Lower;
-		Source = nullptr;
-	}
-
-	BoundingBox Bounds;
-
-	TriangleTree* Upper = nullptr;
-	TriangleTree* Lower = nullptr;
-
-	std::vector<glm::uint> Indices;
-
-	// Fetches the vertex data of a given index.
-	const VertexFormat& Get( const glm::uint Index ) const
-	{
-		return Source->GetVertexData().Vertices[Index];
-	}
-
-	CMesh* Source = nullptr;
-};
-
-void CreateTriangleTree( CMesh* Mesh, FTransform& Transform, const BoundingBox& WorldBounds, TriangleTree*& Tree, CBody* Body );
-
 void EnsureVolume( BoundingBox& Bounds )
 {
 	if( Math::Equal( Bounds.Minimum.Y, Bounds.Maximum.Y ) )
@@ -88,8 +63,6 @@ void EnsureVolume( BoundingBox& Bounds )
 	}
 }
 
-void VisualizeBounds( TriangleTree* Tree, const FTransform* Transform = nullptr, const Color& BoundsColor = Color::Blue );
-
 bool SweptIntersection( const BoundingBox& ContinuousBounds, Vector3D& ContinuousVelocity, const BoundingBox& B, Geometry::Result& Result )
 {
 	const bool Intersecting = Math::BoundingBoxIntersection( ContinuousBounds.Minimum, ContinuousBounds.Maximum, B.Minimum, B.Maximum );
@@ -381,157 +354,51 @@ bool PointInTriangle(
 	return true;
 }
 
-CollisionResponse CollisionResponseTreeAABB( TriangleTree* Tree, const BoundingBox& WorldBounds, FTransform& Transform, FTransform& OtherTransform, const int Depth = 0 );
-
-void ProcessTreeLeaf( 
-	TriangleTree* Leaf, 
-	const BoundingBox& WorldBounds, 
-	FTransform& Transform, 
-	FTransform& OtherTransform, 
-	CollisionResponse& Response,
-	const int Depth = 0
-)
+// Converts a response from the local space of a triangle mesh to world space.
+void ResponseToWorld( const FTransform& Transform, CollisionResponse& Response )
 {
-	if( !Leaf )
-		return;
-
-	CollisionResponse LeafResponse = CollisionResponseTreeAABB( Leaf, WorldBounds, Transform, OtherTransform, Depth );
-	if( LeafResponse.Distance > Response.Distance )
-	{
-		Response.Normal = LeafResponse.Normal;
-		Response.Distance = LeafResponse.Distance;
-	}
-
-	// Old statement.
-	// if( Math::Abs( ResponseA.Distance ) < Math::Abs( Response.Distance ) || Response.Distance < 0.0001f )
-}
-
-void ProcessLeafTriangles(
-	TriangleTree* Leaf,
-	FTransform& Transform,
-	const Vector3D& Center,
-	const Vector3D& Extent,
-	CollisionResponse& Response
-)
-{
-	// VertexFormat ResponseA;
-	// VertexFormat ResponseB;
-	// VertexFormat ResponseC;
-
-	for( unsigned int Index = 0; Index < Leaf->Indices.size(); )
+	// Normals are transformed by the inverse-transpose, for a rotation and scale that is the rotation of the inverse scale.
+	const auto& Scale = Transform.GetSize();
+	if( !Math::Equal( Scale.X, 0.0f ) && !Math::Equal( Scale.Y, 0.0f ) && !Math::Equal( Scale.Z, 0.0f ) )
 	{
-		const VertexFormat& VertexA = Leaf->Get( Leaf->Indices[Index] );
-		const VertexFormat& VertexB = Leaf->Get( Leaf->Indices[Index + 1] );
-		const VertexFormat& VertexC = Leaf->Get( Leaf->Indices[Index + 2] );
-
-		CollisionResponse TriangleResponse = Response::TriangleAABB( VertexA, VertexB, VertexC, Center, Extent );
-		if( TriangleResponse.Distance < Response.Distance )
-		{
-			Response.Normal = TriangleResponse.Normal;
-			Response.Distance = TriangleResponse.Distance;
-
-			// ResponseA = VertexA;
-			// ResponseB = VertexB;
-			// ResponseC = VertexC;
-
-#if DrawDebugTriangleCollisions == 1
-			DrawTriangle( Transform, VertexA, VertexB, VertexC, TriangleResponse, Color::White );
-			DrawTriangleResponse( Transform, VertexA, VertexB, VertexC, TriangleResponse );
-		}
-		else
-		{
-			DrawTriangle( Transform, VertexA, VertexB, VertexC, TriangleResponse, Color::Red );
-#endif
-		}
-#if 0
-		else
+		auto Normal = Transform.GetRotationMatrix().Transform( Response.Normal / Scale );
+		const float Length = Normal.Length();
+		if( Length > 0.0f )
 		{
-			DrawVertex( Transform, VertexA, TriangleResponse, Color( 127, 0, 0 ) );
-			DrawVertex( Transform, VertexB, TriangleResponse, Color( 0, 127, 0 ) );
-			DrawVertex( Transform, VertexC, TriangleResponse, Color( 0, 0, 127 ) );
+			// The depth along the world space normal shrinks by the same factor.
+			Response.Normal = Normal / Length;
+			Response.Distance /= Length;
 		}
-
-		const auto TriangleCenter = ( VertexA.Position + VertexB.Position + VertexC.Position ) / 3.0f;
-		const auto WorldSpacePosition = Transform.Transform( TriangleCenter );
-		const auto WorldSpaceNormal = Transform.Rotate( TriangleResponse.Normal );
-		UI::AddLine(
-			WorldSpacePosition,
-			WorldSpacePosition + WorldSpaceNormal * TriangleResponse.Distance,
-			Color::Purple,
-			0.5f
-		);
-#endif
-
-		Index += 3;
 	}
 
-	// DrawTriangle( Transform, ResponseA, ResponseB, ResponseC, Response, Color::White );
-	// DrawTriangleResponse( Transform, ResponseA, ResponseB, ResponseC, Response );
+	Response.Point = Transform.Transform( Response.Point );
 }
 
-CollisionResponse CollisionResponseTreeAABB( TriangleTree* Tree, const BoundingBox& WorldBounds, FTransform& Transform, FTransform& OtherTransform, const int Depth )
+CollisionResponse CollisionResponseTreeAABB( const TriangleTree* Tree, const BoundingBox& WorldBounds, FTransform& Transform )
 {
 	CollisionResponse Response;
-
 	if( !Tree )
 		return Response;
 
-	BoundingBox LocalBounds = Math::AABB( WorldBounds, Transform.GetTransformationMatrixInverse() );
-
-	const Vector3D Center = LocalBounds.Center();
-	const Vector3D Extent = LocalBounds.Size();
-
-	/*FBounds TreeRelativeBounds = Math::AABB( LocalBounds, Transform );
-	UI::AddAABB( TreeRelativeBounds.Minimum, TreeRelativeBounds.Maximum );
-
-	FBounds TreeBounds = Math::AABB( Tree->Bounds, Transform );
-	UI::AddAABB( TreeBounds.Minimum, TreeBounds.Maximum, Color( 255, 255, 0 ) );*/
-
-	if( !Math::BoundingBoxIntersection( LocalBounds.Minimum, LocalBounds.Maximum, Tree->Bounds.Minimum, Tree->Bounds.Maximum ) )
-		return Response;
+	// Transform the bounds into the triangle mesh's local space.
+	const BoundingBox LocalBounds = Math::AABB( WorldBounds, Transform.GetTransformationMatrixInverse() );
+	if( !Tree->CollideAABB( LocalBounds, Response ) )
+		return {};
 
 #if DrawDebugTriangleCollisions == 1
-	// UI::AddAABB( WorldBounds.Minimum, WorldBounds.Maximum, Color::Cyan );
+	Tree->Debug( Transform, Color::Blue );
 #endif
 
-#if 0
-	if( Depth > 0 )
-	{
-		VisualizeBounds( Tree, &Transform, GetHeat( Depth ) );
-	}
-#endif
-	
-	// Prime the response's starting distance.
-	Response.Distance = INFINITY;
-
-	ProcessTreeLeaf( Tree->Upper, WorldBounds, Transform, OtherTransform, Response, Depth + 1 );
-	ProcessTreeLeaf( Tree->Lower, WorldBounds, Transform, OtherTransform, Response, Depth + 1 );
-
-	if( !Tree->Upper || !Tree->Lower )
-	{
-		ProcessLeafTriangles( Tree, Transform, Center, Extent, Response );
-	}
-
+	ResponseToWorld( Transform, Response );
 	return Response;
 }
 
 CollisionResponse CollisionResponseTreeSphere( CBody* TriangleMesh, CBody* Sphere )
 {
-	TriangleTree* Tree = TriangleMesh->Tree;
+	const auto* Tree = TriangleMesh->Tree.get();
 	if( !Tree )
 		return {}; // Triangle mesh does not have a tree to traverse.
 
-	if( Tree->Upper || Tree->Lower )
-		return {}; // Only support single layer trees for now.
-
-	// Transform the sphere's bounds into the triangle mesh's local space.
-	BoundingBox WorldBounds = Sphere->GetWorldBounds();
-	BoundingBox LocalBounds = Math::AABB( WorldBounds, TriangleMesh->PreviousTransform.GetTransformationMatrixInverse() );
-
-	// UI::AddAABB( LocalBounds.Minimum, LocalBounds.Maximum );
-	if( !Math::BoundingBoxIntersection( LocalBounds.Minimum, LocalBounds.Maximum, Tree->Bounds.Minimum, Tree->Bounds.Maximum ) )
-		return {}; // The sphere is not in contact with this leaf's bounds.
-
 	auto WorldSpaceInnerSphere = Sphere->InnerSphere();
 
 	// Construct the local space sphere.
@@ -541,58 +408,17 @@ CollisionResponse CollisionResponseTreeSphere( CBody* TriangleMesh, CBody* Spher
 	auto InnerSphere = BoundingSphere( SphereOrigin, SphereRadius );
 
 	CollisionResponse Response;
+	if( !Tree->CollideSphere( InnerSphere, Response ) )
+		return {};
 
-	// Prime the response's starting distance.
-	Response.Distance = -INFINITY;
-
-	bool Collided = false;
-
-	// Iterate over the triangles within the leaf and perform the triangle-sphere test.
-	auto* Leaf = Tree;
-	for( unsigned int Index = 0; Index < Leaf->Indices.size(); )
-	{
-		const VertexFormat& VertexA = Leaf->Get( Leaf->Indices[Index] );
-		const VertexFormat& VertexB = Leaf->Get( Leaf->Indices[Index + 1] );
-		const VertexFormat& VertexC = Leaf->Get( Leaf->Indices[Index + 2] );
-
-		CollisionResponse TriangleResponse = Response::TriangleSphere( VertexA, VertexB, VertexC, InnerSphere );
-		if( TriangleResponse.Distance != 0.0f && TriangleResponse.Distance > Response.Distance )
-		{
-			Response.Normal = TriangleResponse.Normal;
-			Response.Distance = TriangleResponse.Distance;
-
-			Collided = true;
-
-#if DrawDebugTriangleCollisions == 1
-			DrawTriangle( FTransform(), VertexA, VertexB, VertexC, TriangleResponse, Color::Blue );
-			DrawTriangle( TriangleMesh->PreviousTransform, VertexA, VertexB, VertexC, TriangleResponse, Color::White );
-			DrawTriangleResponse( TriangleMesh->PreviousTransform, VertexA, VertexB, VertexC, TriangleResponse );
-		}
-		else
-		{
-			DrawTriangle( FTransform(), VertexA, VertexB, VertexC, TriangleResponse, Color::Black );
-			DrawTriangle( TriangleMesh->PreviousTransform, VertexA, VertexB, VertexC, TriangleResponse, Color::Red );
-#endif
-		}
-
-		Index += 3;
-	}
-
-	if( Collided )
-	{
-		// UI::AddSphere( InnerSphere.Origin(), InnerSphere.GetRadius() );
-	}
-	else
-	{
-		// UI::AddSphere( InnerSphere.Origin(), InnerSphere.GetRadius(), Color::Red );
-	}
-
+	auto& Transform = TriangleMesh->PreviousTransform;
+	ResponseToWorld( Transform, Response );
 	return Response;
 }
 
 CBody::~CBody()
 {
-	delete Tree;
+
 }
 
 void CBody::Construct()
@@ -642,8 +468,10 @@ void CBody::Construct( CPhysics* Physics )
 	{
 		auto* Mesh = Owner->CollisionMesh ? Owner->CollisionMesh : Owner->Mesh;
 
-		// TODO: Fix triangle tree and triangle collisions.
-		// CreateTriangleTree( Mesh, Transform, LocalBounds, Tree, this );
+		if( TriangleCollisions )
+		{
+			Tree = TriangleTree::Get( Mesh );
+		}
 	}
 
 	Physics->Register( this );
@@ -675,6 +503,12 @@ void ApplyLinearVelocity( CBody* Body )
 
 void CBody::PreCollision()
 {
+	// Something wants to move us.
+	if( Sleeping && !Math::Equal( LinearVelocity, Vector3D::Zero ) )
+	{
+		Wake();
+	}
+
 	// Don't reset the values if we're sleeping.
 	if( Sleeping )
 		return;
@@ -795,8 +629,7 @@ CollisionResponse CalculateResponseAABB( CBody* A, CBody* B, const Geometry::Res
 		// else
 		{
 			CollisionResponse Response;
-			Response = CollisionResponseTreeAABB( B->Tree, A->WorldBounds, B->PreviousTransform, A->PreviousTransform );
-			Response.Normal = B->PreviousTransform.GetRotationMatrix().Transform( B->PreviousTransform.GetScaleMatrix().Transform( Response.Normal ) );
+			Response = CollisionResponseTreeAABB( B->Tree.get(), A->WorldBounds, B->PreviousTransform );
 			return Response;
 			// return Response::AABBAABB( A->WorldBounds, B->WorldBounds );
 		}
@@ -840,8 +673,7 @@ CollisionResponse CalculateResponseTriangleMesh( CBody* A, CBody* B, const Geome
 	case BodyType::AABB:
 	{
 		CollisionResponse Response;
-		Response = CollisionResponseTreeAABB( A->Tree, B->WorldBounds, A->PreviousTransform, B->PreviousTransform );
-		Response.Normal = A->PreviousTransform.GetRotationMatrix().Transform( A->PreviousTransform.GetScaleMatrix().Transform( Response.Normal ) );
+		Response = CollisionResponseTreeAABB( A->Tree.get(), B->WorldBounds, A->PreviousTransform );
 		return Response;
 	}
 	case BodyType::Sphere:
@@ -1111,294 +943,6 @@ void CBody::Collision( CBody* Body )
 	}
 }
 
-std::vector<glm::uint> GatherVertices( const TriangleTree* Tree, const std::vector<glm::uint>& Indices, const Vector3D& Median, const bool Direction, const size_t Axis )
-{
-	static std::vector<glm::uint> GatheredIndices;
-	GatheredIndices.clear();
-	GatheredIndices.reserve( Indices.size() );
-
-	for( unsigned int Index = 0; Index < Indices.size(); )
-	{
-		bool InsideBounds = false;
-
-		// Vector3D TriangleCenter = Tree->Get( Indices[Index] ).Position + Tree->Get( Indices[Index + 1] ).Position + Tree->Get( Indices[Index + 2] ).Position;
-		// TriangleCenter /= 3.0f;
-
-		for( unsigned int TriangleIndex = 0; TriangleIndex < 3; TriangleIndex++ )
-		{
-			const VertexFormat& Vertex = Tree->Get( Indices[Index + TriangleIndex] );
-			if( Direction )
-			{
-				if( Axis == 0 && Vertex.Position.X >= Median.X )
-				{
-					InsideBounds = true;
-				}
-				else if( Axis == 1 && Vertex.Position.Y >= Median.Y )
-				{
-					InsideBounds = true;
-				}
-				else if( Axis == 2 && Vertex.Position.Z >= Median.Z )
-				{
-					InsideBounds = true;
-				}
-			}
-			else
-			{
-				if( Axis == 0 && Vertex.Position.X <= Median.X )
-				{
-					InsideBounds = true;
-				}
-				else if( Axis == 1 && Vertex.Position.Y <= Median.Y )
-				{
-					InsideBounds = true;
-				}
-				else if( Axis == 2 && Vertex.Position.Z <= Median.Z )
-				{
-					InsideBounds = true;
-				}
-			}
-
-			if( InsideBounds )
-				break;
-		}
-		
-		if( InsideBounds )
-		{
-			GatheredIndices.emplace_back( Indices[Index] );
-			GatheredIndices.emplace_back( Indices[Index + 1] );
-			GatheredIndices.emplace_back( Indices[Index + 2] );
-		}
-
-		Index += 3;
-	}
-
-	return GatheredIndices;
-}
-
-bool VectorCompare( const Vector3D& A, const Vector3D& B )
-{
-	return A.X < B.X
-		&& A.Y < B.Y
-		&& A.Z < B.Z;
-}
-
-void BuildMedian( TriangleTree*& Tree, const BoundingBox& Bounds, const size_t Depth )
-{
-	if( !Tree )
-	{
-		Tree = new TriangleTree();
-	}
-
-	// Median = ( WorldBounds.Minimum + WorldBounds.Maximum ) * 0.5f;
-	Tree->Bounds = Bounds;
-
-	// Ensure we have at least some volume.
-	EnsureVolume( Tree->Bounds );
-
-	if( Depth < 1 || Tree->Indices.size() < 24 )
-		return;
-
-	std::vector<glm::uint>& Indices = Tree->Indices;
-	BoundingBox UpperBounds = Bounds;
-	BoundingBox LowerBounds = UpperBounds;
-
-	size_t Axis = 0;
-	Vector3D Size = Bounds.Size();
-
-	if( Size.X > Size.Y && Size.X > Size.Z )
-	{
-		Axis = 0;
-	}
-	else if( Size.Y > Size.X && Size.Y > Size.Z )
-	{
-		Axis = 1;
-	}
-	else
-	{
-		Axis = 2;
-	}
-
-	static std::vector<glm::uint> SortedIndices;
-	SortedIndices = Indices; // Copy index data.
-
-	Vector3D Median;
-	size_t Index;
-	switch( Axis )
-	{
-	case 0:
-		std::sort( SortedIndices.begin(), SortedIndices.end(), [&Tree]( const glm::uint& A, const glm::uint& B ) {
-			return Tree->Get( A ).Position.X < Tree->Get( B ).Position.X;
-		} );
-
-		Index = SortedIndices.size() / 2;
-		Median = Tree->Get( SortedIndices[Index] ).Position;
-		UpperBounds.Minimum.X = Math::Max( Median.X, UpperBounds.Minimum.X );
-		UpperBounds.Maximum.X = Math::Max( Median.X, UpperBounds.Maximum.X );
-		LowerBounds.Minimum.X = Math::Min( Median.X, LowerBounds.Minimum.X );
-		LowerBounds.Maximum.X = Math::Min( Median.X, LowerBounds.Maximum.X );
-		break;
-	case 1:
-		std::sort( SortedIndices.begin(), SortedIndices.end(), [&Tree]( const glm::uint& A, const glm::uint& B ) {
-			return Tree->Get( A ).Position.Y < Tree->Get( B ).Position.Y;
-		} );
-
-		Index = SortedIndices.size() / 2;
-		Median = Tree->Get( SortedIndices[Index] ).Position;
-		UpperBounds.Minimum.Y = Math::Max( Median.Y, UpperBounds.Minimum.Y );
-		UpperBounds.Maximum.Y = Math::Max( Median.Y, UpperBounds.Maximum.Y );
-		LowerBounds.Minimum.Y = Math::Min( Median.Y, LowerBounds.Minimum.Y );
-		LowerBounds.Maximum.Y = Math::Min( Median.Y, LowerBounds.Maximum.Y );
-		break;
-	default:
-		std::sort( SortedIndices.begin(), SortedIndices.end(), [&Tree]( const glm::uint& A, const glm::uint& B ) {
-			return Tree->Get( A ).Position.Z < Tree->Get( B ).Position.Z;
-		} );
-
-		Index = SortedIndices.size() / 2;
-		Median = Tree->Get( SortedIndices[Index] ).Position;
-		UpperBounds.Minimum.Z = Math::Max( Median.Z, UpperBounds.Minimum.Z );
-		UpperBounds.Maximum.Z = Math::Max( Median.Z, UpperBounds.Maximum.Z );
-		LowerBounds.Minimum.Z = Math::Min( Median.Z, LowerBounds.Minimum.Z );
-		LowerBounds.Maximum.Z = Math::Min( Median.Z, LowerBounds.Maximum.Z );
-		break;
-	}
-	
-	if( !Tree->Upper )
-	{
-		Tree->Upper = new TriangleTree();
-		Tree->Upper->Source = Tree->Source;
-	}
-
-	if( !Tree->Lower )
-	{
-		Tree->Lower = new TriangleTree();
-		Tree->Lower->Source = Tree->Source;
-	}
-
-	Tree->Upper->Indices = GatherVertices( Tree, Indices, Median, true, Axis );
-	if( Tree->Upper->Indices.size() == 0 )
-	{
-		delete Tree->Upper;
-		Tree->Upper = nullptr;
-	}
-	else
-	{
-		BuildMedian( Tree->Upper, UpperBounds, Depth - 1 );
-	}
-
-	Tree->Lower->Indices = GatherVertices( Tree, Indices, Median, false, Axis );
-	if( Tree->Lower->Indices.size() == 0 )
-	{
-		delete Tree->Lower;
-		Tree->Lower = nullptr;
-	}
-	else
-	{
-		BuildMedian( Tree->Lower, LowerBounds, Depth - 1 );
-	}
-}
-
-void VisualizeBounds( TriangleTree* Tree, const FTransform* Transform, const Color& BoundsColor )
-{
-	if( !Tree )
-		return;
-
-	if( !Tree->Upper && !Tree->Lower )
-	{
-		if( !Tree->Indices.empty() )
-		{
-			Vector3D Median = ( Tree->Bounds.Maximum + Tree->Bounds.Minimum ) * 0.5f;
-
-			if( Transform )
-			{
-				Median = Transform->Transform( Median );
-			}
-
-			// UI::AddText( Median, "Median" );
-
-			if( Transform )
-			{
-				const auto& Minimum = Tree->Bounds.Minimum;
-				const auto& Maximum = Tree->Bounds.Maximum;
-
-				Vector3D Positions[8];
-				Positions[0] = Vector3D( Minimum.X, Maximum.Y, Minimum.Z );
-				Positions[1] = Vector3D( Maximum.X, Maximum.Y, Minimum.Z );
-				Positions[2] = Vector3D( Maximum.X, Minimum.Y, Minimum.Z );
-				Positions[3] = Vector3D( Minimum.X, Minimum.Y, Minimum.Z );
-
-				Positions[4] = Vector3D( Minimum.X, Maximum.Y, Maximum.Z );
-				Positions[5] = Vector3D( Maximum.X, Maximum.Y, Maximum.Z );
-				Positions[6] = Vector3D( Maximum.X, Minimum.Y, Maximum.Z );
-				Positions[7] = Vector3D( Minimum.X, Minimum.Y, Maximum.Z );
-
-				for( size_t PositionIndex = 0; PositionIndex < 8; PositionIndex++ )
-				{
-					Positions[PositionIndex] = Transform->Transform( Positions[PositionIndex] );
-				}
-
-				BoundingBox TransformedAABB = Math::AABB( Positions, 8 );
-
-				UI::AddAABB( TransformedAABB.Minimum, TransformedAABB.Maximum, BoundsColor );
-			}
-			else
-			{
-				UI::AddAABB( Tree->Bounds.Minimum, Tree->Bounds.Maximum, BoundsColor );
-			}
-				
-
-			//for( size_t Index = 0; Index < Tree->Vertices.size(); )
-			//{
-			//	VertexFormat VertexA = Tree->Vertices[Index];
-			//	VertexFormat VertexB = Tree->Vertices[Index + 1];
-			//	VertexFormat VertexC = Tree->Vertices[Index + 2];
-
-			//	if( Transform )
-			//	{
-			//		VertexA.Position = Transform->Transform( VertexA.Position );
-			//	}
-
-			//	// UI::AddText( VertexA, std::to_string( Index ).c_str() );
-
-			//	Index += 3;
-			//}
-		}
-	}
-
-	VisualizeBounds( Tree->Upper, Transform, BoundsColor );
-	VisualizeBounds( Tree->Lower, Transform, BoundsColor );
-}
-
-void CreateTriangleTree( CMesh* Mesh, FTransform& Transform, const BoundingBox& WorldBounds, TriangleTree*& Tree, CBody* Body )
-{
-	if( Tree )
-		return;
-	
-	ProfileMemory( "Physics Triangle Trees" );
-
-	Tree = new TriangleTree();
-	Tree->Source = Mesh;
-
-	const auto& IndexData = Mesh->GetIndexData();
-	const auto& VertexBufferData = Mesh->GetVertexBufferData();
-
-	std::vector<glm::uint>& Indices = Tree->Indices;
-	Indices.reserve( VertexBufferData.IndexCount );
-
-	for( unsigned int Index = 0; Index < VertexBufferData.IndexCount; )
-	{
-		Indices.emplace_back( IndexData.Indices[Index] );
-		Indices.emplace_back( IndexData.Indices[Index + 1] );
-		Indices.emplace_back( IndexData.Indices[Index + 2] );
-		Index += 3;
-	}
-
-	// TODO: Fix transformation issues with a depth greater than 0.
-	const uint16_t Depth = Math::Min( 9, WorldBounds.Size().Length() * 10.0f );
-	Tree->Bounds = Mesh->GetBounds();
-	// BuildMedian( Tree, Mesh->GetBounds(), 1 );
-}
-
 // Constraint that stops a body from moving below the specified value, on the Z-axis.
 void ConstrainZ( CBody* Body, Vector3D& Position, float Height )
 {
@@ -1561,63 +1105,97 @@ void EvaluateContacts( CBody* A )
 
 void CBody::Tick()
 {
-	auto Transform = GetTransform();	
 	if( Static )
 		return;
 
-	CalculateBounds();
-	auto NewPosition = Transform.GetPosition();
+	const auto Previous = GetTransform().GetPosition();
+	auto NewPosition = PreIntegrate();
 
-	bool TriedToMove = false;
+	if( IsKinetic() )
+	{
+		const auto DeltaTime = static_cast<float>( Physics->GetTimeStep() );
+		Integrate( NewPosition, Previous, DeltaTime );
+	}
+
+	PostIntegrate( NewPosition );
+}
+
+Vector3D CBody::PreIntegrate()
+{
+	CalculateBounds();
+	auto NewPosition = GetTransform().GetPosition();
 
 	Contact = !Contacts.empty();
 
-	if( IsKinetic() )
-	{
-		// Resolve contact manifolds.
-		Resolve( this );
+	if( !IsKinetic() )
+		return NewPosition;
 
-		const auto DeltaTime = static_cast<float>( Physics->GetTimeStep() );
+	// Resolve contact manifolds.
+	Resolve( this );
 
-		// Apply depenetration.
-		NewPosition -= Depenetration;
-		Normal = -Depenetration;
+	// Apply depenetration.
+	NewPosition -= Depenetration;
+	Normal = -Depenetration;
 
-		if( Contact )
+	if( Contact )
+	{
+		float Distance = Contacts[0].Response.Distance;
+		Normal = -Contacts[0].Response.Normal;
+		for( const auto& Contact : Contacts )
 		{
-			float Distance = Contacts[0].Response.Distance;
-			Normal = -Contacts[0].Response.Normal;
-			for( const auto& Contact : Contacts )
+			if( Contact.Response.Distance > Distance )
 			{
-				if( Contact.Response.Distance > Distance )
-				{
-					Distance = Contact.Response.Distance;
-					Normal = -Contact.Response.Normal;
-				}
+				Distance = Contact.Response.Distance;
+				Normal = -Contact.Response.Normal;
 			}
 		}
+	}
 
-		Depenetration = { 0.0f, 0.0f, 0.0f };
+	Depenetration = { 0.0f, 0.0f, 0.0f };
 
-		switch( Integrator )
-		{
-		case Integrator::Verlet:
-			// Calculate the velocity using historic data.
-			Velocity = NewPosition - Transform.GetPosition();
-			NewPosition += Velocity + Acceleration * DeltaTime * DeltaTime;
-			break;
-		default:
-			// Semi-implicit Euler integration.
-			Velocity += InverseMass * Acceleration * DeltaTime;
-			NewPosition += Velocity * DeltaTime;
-			break;
-		}
+	return NewPosition;
+}
 
-		// Subtract the linear velocity that was applied during this tick.
-		// Velocity -= LinearVelocity;
+void CBody::Integrate( Vector3D& Position, const Vector3D& Previous, const float DeltaTime )
+{
+	switch( Integrator )
+	{
+	case Integrator::Verlet:
+		// Calculate the velocity using historic data.
+		Velocity = Position - Previous;
+		Position += Velocity + Acceleration * DeltaTime * DeltaTime;
+		break;
+	default:
+		// Semi-implicit Euler integration.
+		Velocity += InverseMass * Acceleration * DeltaTime;
+		Position += Velocity * DeltaTime;
+		break;
+	}
+
+	// Subtract the linear velocity that was applied during this tick.
+	// Velocity -= LinearVelocity;
+
+	// Damping is used to simulate drag.
+	Velocity *= powf( Damping, DeltaTime );
+}
+
+void CBody::PostIntegrate( const Vector3D& NewPosition )
+{
+	auto Transform = GetTransform();
+	bool TriedToMove = false;
 
-		// Damping is used to simulate drag.
-		Velocity *= powf( Damping, DeltaTime );
+	if( IsKinetic() )
+	{
+		const auto DeltaTime = static_cast<float>( Physics->GetTimeStep() );
+		const auto Threshold = SleepVelocity.Get();
+		if( Velocity.LengthSquared() < Threshold * Threshold )
+		{
+			RestTime += DeltaTime;
+		}
+		else
+		{
+			RestTime = 0.0f;
+		}
 
 		TriedToMove = !Math::Equal( Transform.GetPosition(), NewPosition, 0.001f );
 
@@ -1646,16 +1224,20 @@ void CBody::Tick()
 
 	const auto Difference = NewPosition - PreviousTransform.GetPosition();
 	const auto DifferenceLengthSquared = Difference.LengthSquared();
-	if( LastActivity < 0.0 || TriedToMove )
+
+	// Non-kinetic bodies are moved by their owner.
+	if( !IsKinetic() )
 	{
-		LastActivity = Physics->CurrentTime;
+		Moved = DifferenceLengthSquared > 0.001f * 0.001f;
+		if( Moved )
+		{
+			MovedBounds = Math::AABB( LocalBounds, PreviousTransform ).Combine( WorldBounds );
+		}
 	}
 
-	const auto TimeSinceActivity = Physics->CurrentTime - LastActivity;
-	Sleeping = TimeSinceActivity > 10.0;
-	if( Static || Stationary )
+	if( LastActivity < 0.0 || TriedToMove )
 	{
-		Sleeping = false;
+		LastActivity = Physics->CurrentTime;
 	}
 
 	Normal.Normalize();
@@ -1676,6 +1258,24 @@ void CBody::Tick()
 	TextPosition = 0;
 }
 
+void CBody::Wake()
+{
+	Sleeping = false;
+	RestTime = 0.0f;
+	LastActivity = Physics ? Physics->CurrentTime : -1.0;
+}
+
+void CBody::Sleep()
+{
+	Sleeping = true;
+	Velocity = Vector3D::Zero;
+	Acceleration = Vector3D::Zero;
+	LinearVelocity = Vector3D::Zero;
+
+	// Contacts aren't refreshed while sleeping, the other bodies may go away in the meantime.
+	Contacts.clear();
+}
+
 void CBody::Destroy()
 {
 	if( !Physics )
@@ -1814,8 +1414,8 @@ void CBody::Debug() const
 		UI::AddSphere( Sphere.Origin(), Sphere.GetRadius(), Color::Cyan );
 	}
 
-	if( DisplayTriangleTree )
-		VisualizeBounds( Tree, &PreviousTransform );
+	if( DisplayTriangleTree && Tree )
+		Tree->Debug( PreviousTransform, Color::Blue );
 
 	if( Static || Sleeping || !DisplayBodyInfo )
 		return;
@@ -0,0 +1,159 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PhysicsSnapshot.h"
+
+#include <Engine/Physics/Body/Body.h>
+#include <Engine/Utility/Structures/FlatBoundingVolumeHierarchy.h>
+
+CBodyProxy::CBodyProxy( CBody* Body )
+{
+	this->Body = Body;
+	Type = Body->Type;
+	Castable = Body->Block && Body->Type != BodyType::TriangleMesh && Body->Surface != PhysicalSurface::Water;
+
+	WorldBounds = Body->WorldBounds;
+	Bounds = Body->GetBounds();
+	QueryBounds = Body->Continuous ? BoundingBoxSIMD( Body->WorldBoundsSwept ) : Body->InflatedBoundsSIMD;
+	Sphere = Body->InnerSphere();
+
+	if( Type == BodyType::Plane )
+	{
+		const auto& Transform = Body->PreviousTransform;
+		PlaneSurface = Plane( Transform.GetPosition(), Transform.GetRotationMatrix().Transform( WorldUp ) );
+	}
+}
+
+BoundingBoxSIMD CBodyProxy::GetBounds() const
+{
+	return Bounds;
+}
+
+void CBodyProxy::Query( const BoundingBoxSIMD& Box, QueryResult& Result )
+{
+	if( !Box.Intersects( QueryBounds ) )
+		return;
+
+	Result.Hit = true;
+	Result.Objects.push_back( Body );
+}
+
+Geometry::Result CBodyProxy::Cast( const Vector3D& Start, const Vector3D& End, const std::vector<Testable*>& Ignore ) const
+{
+	// Mirrors CBody::Cast, using the copied shape.
+	Geometry::Result Empty;
+	if( !Castable )
+		return Empty;
+
+	for( auto* Ignored : Ignore )
+	{
+		if( Body == Ignored )
+		{
+			return Empty;
+		}
+	}
+
+	Geometry::Result Result;
+	switch( Type )
+	{
+	case BodyType::Sphere:
+		Result = Geometry::LineInSphere( Start, End, Sphere );
+		break;
+	case BodyType::Plane:
+	{
+		const auto Box = Geometry::LineInBoundingBox( Start, End, WorldBounds );
+		if( Box.Hit )
+		{
+			Result = Geometry::LineInPlane( Start, End, PlaneSurface );
+		}
+		break;
+	}
+	default:
+		Result = Geometry::LineInBoundingBox( Start, End, WorldBounds );
+		break;
+	}
+
+	Result.Body = Body;
+	return Result;
+}
+
+void CPhysicsSnapshot::Layer::Build( const std::vector<CBody*>& Bodies, const bool Static )
+{
+	Proxies.clear();
+	for( auto* Body : Bodies )
+	{
+		if( !Body )
+			continue;
+
+		// Same selection as the static and dynamic scenes of the physics engine.
+		const bool Include = Static ? Body->Static && !Body->Stationary : !Body->Static;
+		if( Include )
+		{
+			Proxies.emplace_back( Body );
+		}
+	}
+
+	// The proxies have to stay put now that the tree points to them.
+	FlatBoundingVolumeHierarchy::RawObjectList Objects;
+	Objects.reserve( Proxies.size() );
+	for( auto& Proxy : Proxies )
+	{
+		Objects.emplace_back( &Proxy );
+	}
+
+	Tree = FlatBoundingVolumeHierarchy::Build( Objects );
+}
+
+void CPhysicsSnapshot::Build( const std::vector<CBody*>& Bodies, const CPhysicsSnapshot* Previous, const size_t StaticGeneration )
+{
+	if( Previous && Previous->StaticLayer && Previous->StaticGeneration == StaticGeneration )
+	{
+		StaticLayer = Previous->StaticLayer;
+	}
+	else if( !StaticLayer || this->StaticGeneration != StaticGeneration )
+	{
+		auto Static = std::make_shared<Layer>();
+		Static->Build( Bodies, true );
+		StaticLayer = Static;
+	}
+
+	this->StaticGeneration = StaticGeneration;
+
+	if( !DynamicLayer )
+	{
+		DynamicLayer = std::make_shared<Layer>();
+	}
+
+	DynamicLayer->Build( Bodies, false );
+}
+
+Geometry::Result CPhysicsSnapshot::Cast( const Vector3D& Start, const Vector3D& End, const std::vector<Testable*>& Ignore, const PollType& Type ) const
+{
+	Geometry::Result Closest;
+	if( StaticLayer && Type != PollType::Dynamic )
+	{
+		Closest = StaticLayer->Tree->Cast( Start, End, Ignore );
+	}
+
+	if( DynamicLayer && Type != PollType::Static )
+	{
+		const auto Result = DynamicLayer->Tree->Cast( Start, End, Ignore );
+		if( Result.Hit && ( !Closest.Hit || Result.Distance < Closest.Distance ) )
+		{
+			Closest = Result;
+		}
+	}
+
+	return Closest;
+}
+
+void CPhysicsSnapshot::Query( const BoundingBoxSIMD& Box, QueryResult& Result, const PollType& Type ) const
+{
+	if( StaticLayer && Type != PollType::Dynamic )
+	{
+		StaticLayer->Tree->Query( Box, Result );
+	}
+
+	if( DynamicLayer && Type != PollType::Static )
+	{
+		DynamicLayer->Tree->Query( Box, Result );
+	}
+}
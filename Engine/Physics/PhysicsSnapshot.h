@@ -0,0 +1,63 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Engine/Physics/Geometry.h>
+#include <Engine/Physics/Physics.h>
+#include <Engine/Utility/Structures/Testable.h>
+
+// Copy of the collision shape of a body at the time the snapshot was taken.
+class CBodyProxy : public Testable
+{
+public:
+	CBodyProxy() = default;
+	CBodyProxy( CBody* Body );
+
+	BoundingBoxSIMD GetBounds() const override;
+
+	// Adds the original body to the result.
+	void Query( const BoundingBoxSIMD& Box, QueryResult& Result ) override;
+	Geometry::Result Cast( const Vector3D& Start, const Vector3D& End, const std::vector<Testable*>& Ignore ) const override;
+
+	// Not owned, the body may be destroyed while the snapshot is still being queried.
+	// The proxy never dereferences it after it was built, it's only compared and handed out in the results.
+	CBody* Body = nullptr;
+
+private:
+	BodyType Type = BodyType::AABB;
+
+	// False for bodies that CBody::Cast never reports.
+	bool Castable = true;
+
+	BoundingBox WorldBounds;
+	BoundingBoxSIMD Bounds;
+	BoundingBoxSIMD QueryBounds;
+	BoundingSphere Sphere;
+	Plane PlaneSurface;
+};
+
+// Read-only copy of the physics scene that can be queried while the simulation is running.
+class CPhysicsSnapshot
+{
+public:
+	// Takes a copy of the bodies. The static layer of the previous snapshot is shared when the static bodies haven't changed.
+	void Build( const std::vector<CBody*>& Bodies, const CPhysicsSnapshot* Previous, const size_t StaticGeneration );
+
+	Geometry::Result Cast( const Vector3D& Start, const Vector3D& End, const std::vector<Testable*>& Ignore, const PollType& Type ) const;
+	void Query( const BoundingBoxSIMD& Box, QueryResult& Result, const PollType& Type ) const;
+
+private:
+	struct Layer
+	{
+		void Build( const std::vector<CBody*>& Bodies, const bool Static );
+
+		std::vector<CBodyProxy> Proxies;
+		std::shared_ptr<Testable> Tree;
+	};
+
+	std::shared_ptr<const Layer> StaticLayer;
+	std::shared_ptr<Layer> DynamicLayer;
+	size_t StaticGeneration = 0;
+};
@@ -0,0 +1,502 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "TriangleTree.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <mutex>
+
+#include <Engine/Display/Rendering/Mesh.h>
+#include <Engine/Display/UserInterface.h>
+#include <Engine/Profiling/Profiling.h>
+
+// Deep enough for meshes with billions of triangles.
+constexpr size_t TraversalStackSize = 64;
+
+struct FlatTriangleEntry
+{
+	Vector3D A;
+	Vector3D B;
+	Vector3D C;
+	Vector3D Normal;
+	Vector3D Centroid;
+};
+
+static std::mutex TreeMutex;
+
+std::shared_ptr<TriangleTree> TriangleTree::Get( CMesh* Mesh )
+{
+	if( !Mesh )
+		return nullptr;
+
+	std::unique_lock<std::mutex> Lock( TreeMutex );
+	if( auto Tree = Mesh->GetCollisionTree() )
+		return Tree;
+
+	ProfileMemory( "Physics Triangle Trees" );
+
+	const auto& BufferData = Mesh->GetVertexBufferData();
+	auto Tree = Build( Mesh->GetVertexData().Vertices, BufferData.VertexCount, Mesh->GetIndexData().Indices, BufferData.IndexCount );
+	Mesh->SetCollisionTree( Tree );
+	return Tree;
+}
+
+std::shared_ptr<TriangleTree> TriangleTree::Build( const VertexFormat* Vertices, const size_t VertexCount, const glm::uint* Indices, const size_t IndexCount )
+{
+	auto Tree = std::make_shared<TriangleTree>();
+	if( !Vertices || VertexCount == 0 )
+		return Tree;
+
+	const bool Indexed = Indices && IndexCount > 0;
+	const size_t Count = Indexed ? IndexCount : VertexCount;
+
+	std::vector<FlatTriangleEntry> Entries;
+	Entries.reserve( Count / 3 );
+	for( size_t Index = 0; Index + 2 < Count; Index += 3 )
+	{
+		const size_t A = Indexed ? Indices[Index] : Index;
+		const size_t B = Indexed ? Indices[Index + 1] : Index + 1;
+		const size_t C = Indexed ? Indices[Index + 2] : Index + 2;
+		if( A >= VertexCount || B >= VertexCount || C >= VertexCount )
+			continue;
+
+		FlatTriangleEntry Entry;
+		Entry.A = Vertices[A].Position;
+		Entry.B = Vertices[B].Position;
+		Entry.C = Vertices[C].Position;
+
+		// Triangles without an area can't be collided with.
+		Entry.Normal = ( Entry.B - Entry.A ).Cross( Entry.C - Entry.A );
+		const float Length = Entry.Normal.Length();
+		if( Length < FLT_EPSILON )
+			continue;
+
+		Entry.Normal /= Length;
+		Entry.Centroid = ( Entry.A + Entry.B + Entry.C ) / 3.0f;
+		Entries.emplace_back( Entry );
+	}
+
+	Tree->TriangleCount = Entries.size();
+	if( Entries.empty() )
+		return Tree;
+
+	Tree->Nodes.reserve( Entries.size() / LeafSize * 2 + 1 );
+	Tree->Leaves.reserve( Entries.size() / LeafSize + 1 );
+	Tree->BuildNode( Entries, 0, Entries.size() );
+	Tree->Bounds = Tree->Nodes[0].Bounds;
+
+	return Tree;
+}
+
+std::shared_ptr<TriangleTree> TriangleTree::Restore( const BoundingBox& Bounds, std::vector<Node>&& Nodes, std::vector<Leaf>&& Leaves )
+{
+	auto Tree = std::make_shared<TriangleTree>();
+	Tree->Bounds = Bounds;
+	Tree->Nodes = std::move( Nodes );
+	Tree->Leaves = std::move( Leaves );
+
+	for( const auto& Leaf : Tree->Leaves )
+	{
+		Tree->TriangleCount += static_cast<size_t>( Leaf.Count );
+	}
+
+	return Tree;
+}
+
+int32_t TriangleTree::BuildNode( std::vector<FlatTriangleEntry>& Entries, const size_t Start, const size_t End )
+{
+	const auto NodeIndex = static_cast<int32_t>( Nodes.size() );
+	Nodes.emplace_back();
+
+	BoundingBox NodeBounds( Vector3D( FLT_MAX ), Vector3D( -FLT_MAX ) );
+	BoundingBox CentroidBounds = NodeBounds;
+	for( size_t Index = Start; Index < End; Index++ )
+	{
+		const auto& Entry = Entries[Index];
+		for( const auto* Position : { &Entry.A, &Entry.B, &Entry.C } )
+		{
+			NodeBounds.Minimum = Math::Min( NodeBounds.Minimum, *Position );
+			NodeBounds.Maximum = Math::Max( NodeBounds.Maximum, *Position );
+		}
+
+		CentroidBounds.Minimum = Math::Min( CentroidBounds.Minimum, Entry.Centroid );
+		CentroidBounds.Maximum = Math::Max( CentroidBounds.Maximum, Entry.Centroid );
+	}
+
+	Nodes[NodeIndex].Bounds = NodeBounds;
+
+	if( End - Start <= LeafSize )
+	{
+		Leaf NewLeaf;
+		NewLeaf.Count = static_cast<int32_t>( End - Start );
+		for( size_t Lane = 0; Lane < LeafSize; Lane++ )
+		{
+			// Unused lanes repeat the last triangle, they are masked out during the tests.
+			const auto& Entry = Entries[std::min( Start + Lane, End - 1 )];
+			NewLeaf.AX[Lane] = Entry.A.X;
+			NewLeaf.AY[Lane] = Entry.A.Y;
+			NewLeaf.AZ[Lane] = Entry.A.Z;
+			NewLeaf.BX[Lane] = Entry.B.X;
+			NewLeaf.BY[Lane] = Entry.B.Y;
+			NewLeaf.BZ[Lane] = Entry.B.Z;
+			NewLeaf.CX[Lane] = Entry.C.X;
+			NewLeaf.CY[Lane] = Entry.C.Y;
+			NewLeaf.CZ[Lane] = Entry.C.Z;
+			NewLeaf.NormalX[Lane] = Entry.Normal.X;
+			NewLeaf.NormalY[Lane] = Entry.Normal.Y;
+			NewLeaf.NormalZ[Lane] = Entry.Normal.Z;
+		}
+
+		Nodes[NodeIndex].Leaf = static_cast<int32_t>( Leaves.size() );
+		Leaves.emplace_back( NewLeaf );
+		return NodeIndex;
+	}
+
+	// Median split along the axis with the largest centroid spread.
+	const auto Size = CentroidBounds.Size();
+	size_t Axis = 0;
+	if( Size.Y > Size.X && Size.Y >= Size.Z )
+	{
+		Axis = 1;
+	}
+	else if( Size.Z > Size.X && Size.Z > Size.Y )
+	{
+		Axis = 2;
+	}
+
+	const size_t Middle = ( Start + End ) / 2;
+	std::nth_element( Entries.begin() + Start, Entries.begin() + Middle, Entries.begin() + End,
+		[Axis] ( const FlatTriangleEntry& A, const FlatTriangleEntry& B )
+		{
+			return A.Centroid[Axis] < B.Centroid[Axis];
+		}
+	);
+
+	BuildNode( Entries, Start, Middle );
+	const auto Second = BuildNode( Entries, Middle, End );
+	Nodes[NodeIndex].Second = Second;
+
+	return NodeIndex;
+}
+
+static inline __m128 Minimum3( const __m128& A, const __m128& B, const __m128& C )
+{
+	return _mm_min_ps( A, _mm_min_ps( B, C ) );
+}
+
+static inline __m128 Maximum3( const __m128& A, const __m128& B, const __m128& C )
+{
+	return _mm_max_ps( A, _mm_max_ps( B, C ) );
+}
+
+static inline __m128 Absolute( const __m128& Value )
+{
+	return _mm_andnot_ps( _mm_set1_ps( -0.0f ), Value );
+}
+
+// Lanes where the projected triangle lies outside of the [-Radius, Radius] interval.
+static inline __m128 Separated( const __m128& A, const __m128& B, const __m128& C, const __m128& Radius )
+{
+	const auto Outside = _mm_cmpgt_ps( Minimum3( A, B, C ), Radius );
+	const auto Inside = _mm_cmplt_ps( Maximum3( A, B, C ), _mm_sub_ps( _mm_setzero_ps(), Radius ) );
+	return _mm_or_ps( Outside, Inside );
+}
+
+static inline __m128 ValidLanes( const int32_t Count )
+{
+	return _mm_castsi128_ps( _mm_cmplt_epi32( _mm_set_epi32( 3, 2, 1, 0 ), _mm_set1_epi32( Count ) ) );
+}
+
+// Edge axis tests of the triangles against the box, the edge is crossed with each of the box axes.
+static inline __m128 SeparatedEdge(
+	const __m128& EdgeX, const __m128& EdgeY, const __m128& EdgeZ,
+	const __m128* VertexX, const __m128* VertexY, const __m128* VertexZ,
+	const __m128& ExtentX, const __m128& ExtentY, const __m128& ExtentZ
+)
+{
+	const auto AbsoluteX = Absolute( EdgeX );
+	const auto AbsoluteY = Absolute( EdgeY );
+	const auto AbsoluteZ = Absolute( EdgeZ );
+
+	__m128 Projection[3];
+
+	// X x Edge
+	for( size_t Index = 0; Index < 3; Index++ )
+	{
+		Projection[Index] = _mm_sub_ps( _mm_mul_ps( VertexZ[Index], EdgeY ), _mm_mul_ps( VertexY[Index], EdgeZ ) );
+	}
+
+	auto Result = Separated( Projection[0], Projection[1], Projection[2], _mm_add_ps( _mm_mul_ps( ExtentY, AbsoluteZ ), _mm_mul_ps( ExtentZ, AbsoluteY ) ) );
+
+	// Y x Edge
+	for( size_t Index = 0; Index < 3; Index++ )
+	{
+		Projection[Index] = _mm_sub_ps( _mm_mul_ps( VertexX[Index], EdgeZ ), _mm_mul_ps( VertexZ[Index], EdgeX ) );
+	}
+
+	Result = _mm_or_ps( Result, Separated( Projection[0], Projection[1], Projection[2], _mm_add_ps( _mm_mul_ps( ExtentX, AbsoluteZ ), _mm_mul_ps( ExtentZ, AbsoluteX ) ) ) );
+
+	// Z x Edge
+	for( size_t Index = 0; Index < 3; Index++ )
+	{
+		Projection[Index] = _mm_sub_ps( _mm_mul_ps( VertexY[Index], EdgeX ), _mm_mul_ps( VertexX[Index], EdgeY ) );
+	}
+
+	Result = _mm_or_ps( Result, Separated( Projection[0], Projection[1], Projection[2], _mm_add_ps( _mm_mul_ps( ExtentX, AbsoluteY ), _mm_mul_ps( ExtentY, AbsoluteX ) ) ) );
+	return Result;
+}
+
+static bool Overlaps( const BoundingBox& A, const BoundingBox& B )
+{
+	return A.Minimum.X <= B.Maximum.X && A.Maximum.X >= B.Minimum.X
+		&& A.Minimum.Y <= B.Maximum.Y && A.Maximum.Y >= B.Minimum.Y
+		&& A.Minimum.Z <= B.Maximum.Z && A.Maximum.Z >= B.Minimum.Z;
+}
+
+// Calls the function for every leaf that overlaps with the box.
+template<typename Callable>
+static void Traverse( const std::vector<TriangleTree::Node>& Nodes, const BoundingBox& Box, const Callable& Function )
+{
+	if( Nodes.empty() )
+		return;
+
+	int32_t Stack[TraversalStackSize];
+	size_t StackSize = 0;
+	Stack[StackSize++] = 0;
+
+	while( StackSize > 0 )
+	{
+		const auto Index = Stack[--StackSize];
+		const auto& Node = Nodes[Index];
+		if( !Overlaps( Node.Bounds, Box ) )
+			continue;
+
+		if( Node.Leaf >= 0 )
+		{
+			Function( Node.Leaf );
+			continue;
+		}
+
+		Stack[StackSize++] = Node.Second;
+		Stack[StackSize++] = Index + 1;
+	}
+}
+
+size_t TriangleTree::CollideAABB( const BoundingBox& Box, CollisionResponse& Response ) const
+{
+	const auto Center = Box.Center();
+	const auto Extent = Box.Size() * 0.5f;
+
+	const auto CenterX = _mm_set1_ps( Center.X );
+	const auto CenterY = _mm_set1_ps( Center.Y );
+	const auto CenterZ = _mm_set1_ps( Center.Z );
+	const auto ExtentX = _mm_set1_ps( Extent.X );
+	const auto ExtentY = _mm_set1_ps( Extent.Y );
+	const auto ExtentZ = _mm_set1_ps( Extent.Z );
+
+	size_t Contacts = 0;
+	float Deepest = -FLT_MAX;
+	Traverse( Nodes, Box, [&] ( const int32_t LeafIndex )
+		{
+			const auto& Leaf = Leaves[LeafIndex];
+
+			// Move the box to the origin.
+			const __m128 VertexX[3] = { _mm_sub_ps( _mm_load_ps( Leaf.AX ), CenterX ), _mm_sub_ps( _mm_load_ps( Leaf.BX ), CenterX ), _mm_sub_ps( _mm_load_ps( Leaf.CX ), CenterX ) };
+			const __m128 VertexY[3] = { _mm_sub_ps( _mm_load_ps( Leaf.AY ), CenterY ), _mm_sub_ps( _mm_load_ps( Leaf.BY ), CenterY ), _mm_sub_ps( _mm_load_ps( Leaf.CY ), CenterY ) };
+			const __m128 VertexZ[3] = { _mm_sub_ps( _mm_load_ps( Leaf.AZ ), CenterZ ), _mm_sub_ps( _mm_load_ps( Leaf.BZ ), CenterZ ), _mm_sub_ps( _mm_load_ps( Leaf.CZ ), CenterZ ) };
+
+			// Class I: The bounds of the triangle against the box.
+			auto Separation = Separated( VertexX[0], VertexX[1], VertexX[2], ExtentX );
+			Separation = _mm_or_ps( Separation, Separated( VertexY[0], VertexY[1], VertexY[2], ExtentY ) );
+			Separation = _mm_or_ps( Separation, Separated( VertexZ[0], VertexZ[1], VertexZ[2], ExtentZ ) );
+
+			// Class II: The plane of the triangle against the box.
+			const auto NormalX = _mm_load_ps( Leaf.NormalX );
+			const auto NormalY = _mm_load_ps( Leaf.NormalY );
+			const auto NormalZ = _mm_load_ps( Leaf.NormalZ );
+			const auto Distance = _mm_add_ps( _mm_add_ps( _mm_mul_ps( NormalX, VertexX[0] ), _mm_mul_ps( NormalY, VertexY[0] ) ), _mm_mul_ps( NormalZ, VertexZ[0] ) );
+			const auto Radius = _mm_add_ps( _mm_add_ps( _mm_mul_ps( ExtentX, Absolute( NormalX ) ), _mm_mul_ps( ExtentY, Absolute( NormalY ) ) ), _mm_mul_ps( ExtentZ, Absolute( NormalZ ) ) );
+			Separation = _mm_or_ps( Separation, _mm_cmpgt_ps( Absolute( Distance ), Radius ) );
+
+			auto Overlap = _mm_andnot_ps( Separation, ValidLanes( Leaf.Count ) );
+			if( !_mm_movemask_ps( Overlap ) )
+				return;
+
+			// Class III: The edges of the triangle crossed with the box axes.
+			for( size_t Edge = 0; Edge < 3; Edge++ )
+			{
+				const auto Next = ( Edge + 1 ) % 3;
+				Separation = _mm_or_ps( Separation, SeparatedEdge(
+					_mm_sub_ps( VertexX[Next], VertexX[Edge] ), _mm_sub_ps( VertexY[Next], VertexY[Edge] ), _mm_sub_ps( VertexZ[Next], VertexZ[Edge] ),
+					VertexX, VertexY, VertexZ, ExtentX, ExtentY, ExtentZ
+				) );
+			}
+
+			Overlap = _mm_andnot_ps( Separation, Overlap );
+			const auto Mask = _mm_movemask_ps( Overlap );
+			if( !Mask )
+				return;
+
+			alignas( 16 ) float Distances[LeafSize];
+			alignas( 16 ) float Depths[LeafSize];
+			_mm_store_ps( Distances, Distance );
+			_mm_store_ps( Depths, _mm_sub_ps( Radius, Absolute( Distance ) ) );
+
+			for( size_t Lane = 0; Lane < LeafSize; Lane++ )
+			{
+				if( !( Mask & ( 1 << Lane ) ) )
+					continue;
+
+				Contacts++;
+				if( Depths[Lane] > Deepest )
+				{
+					Deepest = Depths[Lane];
+
+					// Point the normal towards the plane of the triangle.
+					const float Sign = Distances[Lane] < 0.0f ? -1.0f : 1.0f;
+					Response.Normal = Vector3D( Leaf.NormalX[Lane], Leaf.NormalY[Lane], Leaf.NormalZ[Lane] ) * Sign;
+					Response.Distance = Depths[Lane];
+					Response.Point = Center + Response.Normal * ( Distances[Lane] * Sign );
+				}
+			}
+		}
+	);
+
+	return Contacts;
+}
+
+static Vector3D ClosestPointOnTriangle( const Vector3D& Point, const Vector3D& A, const Vector3D& B, const Vector3D& C )
+{
+	const auto AB = B - A;
+	const auto AC = C - A;
+	const auto AP = Point - A;
+
+	const float D1 = AB.Dot( AP );
+	const float D2 = AC.Dot( AP );
+	if( D1 <= 0.0f && D2 <= 0.0f )
+		return A;
+
+	const auto BP = Point - B;
+	const float D3 = AB.Dot( BP );
+	const float D4 = AC.Dot( BP );
+	if( D3 >= 0.0f && D4 <= D3 )
+		return B;
+
+	const float VC = D1 * D4 - D3 * D2;
+	if( VC <= 0.0f && D1 >= 0.0f && D3 <= 0.0f )
+		return A + AB * ( D1 / ( D1 - D3 ) );
+
+	const auto CP = Point - C;
+	const float D5 = AB.Dot( CP );
+	const float D6 = AC.Dot( CP );
+	if( D6 >= 0.0f && D5 <= D6 )
+		return C;
+
+	const float VB = D5 * D2 - D1 * D6;
+	if( VB <= 0.0f && D2 >= 0.0f && D6 <= 0.0f )
+		return A + AC * ( D2 / ( D2 - D6 ) );
+
+	const float VA = D3 * D6 - D5 * D4;
+	if( VA <= 0.0f && ( D4 - D3 ) >= 0.0f && ( D5 - D6 ) >= 0.0f )
+		return B + ( C - B ) * ( ( D4 - D3 ) / ( ( D4 - D3 ) + ( D5 - D6 ) ) );
+
+	// The point projects onto the face of the triangle.
+	const float Denominator = 1.0f / ( VA + VB + VC );
+	return A + AB * ( VB * Denominator ) + AC * ( VC * Denominator );
+}
+
+size_t TriangleTree::CollideSphere( const BoundingSphere& Sphere, CollisionResponse& Response ) const
+{
+	const auto Origin = Sphere.Origin();
+	const auto SphereRadius = Sphere.GetRadius();
+	const auto SphereBounds = BoundingBox( Origin - Vector3D( SphereRadius ), Origin + Vector3D( SphereRadius ) );
+
+	const auto OriginX = _mm_set1_ps( Origin.X );
+	const auto OriginY = _mm_set1_ps( Origin.Y );
+	const auto OriginZ = _mm_set1_ps( Origin.Z );
+	const auto Radius = _mm_set1_ps( SphereRadius );
+
+	size_t Contacts = 0;
+	float Deepest = -FLT_MAX;
+	Traverse( Nodes, SphereBounds, [&] ( const int32_t LeafIndex )
+		{
+			const auto& Leaf = Leaves[LeafIndex];
+
+			const auto AX = _mm_sub_ps( _mm_load_ps( Leaf.AX ), OriginX );
+			const auto AY = _mm_sub_ps( _mm_load_ps( Leaf.AY ), OriginY );
+			const auto AZ = _mm_sub_ps( _mm_load_ps( Leaf.AZ ), OriginZ );
+			const auto BX = _mm_sub_ps( _mm_load_ps( Leaf.BX ), OriginX );
+			const auto BY = _mm_sub_ps( _mm_load_ps( Leaf.BY ), OriginY );
+			const auto BZ = _mm_sub_ps( _mm_load_ps( Leaf.BZ ), OriginZ );
+			const auto CX = _mm_sub_ps( _mm_load_ps( Leaf.CX ), OriginX );
+			const auto CY = _mm_sub_ps( _mm_load_ps( Leaf.CY ), OriginY );
+			const auto CZ = _mm_sub_ps( _mm_load_ps( Leaf.CZ ), OriginZ );
+
+			// The bounds of the triangle against the bounds of the sphere.
+			auto Separation = Separated( AX, BX, CX, Radius );
+			Separation = _mm_or_ps( Separation, Separated( AY, BY, CY, Radius ) );
+			Separation = _mm_or_ps( Separation, Separated( AZ, BZ, CZ, Radius ) );
+
+			// The plane of the triangle against the sphere.
+			const auto Distance = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_load_ps( Leaf.NormalX ), AX ), _mm_mul_ps( _mm_load_ps( Leaf.NormalY ), AY ) ), _mm_mul_ps( _mm_load_ps( Leaf.NormalZ ), AZ ) );
+			Separation = _mm_or_ps( Separation, _mm_cmpgt_ps( Absolute( Distance ), Radius ) );
+
+			const auto Mask = _mm_movemask_ps( _mm_andnot_ps( Separation, ValidLanes( Leaf.Count ) ) );
+			if( !Mask )
+				return;
+
+			// Find the closest point for the remaining triangles.
+			for( size_t Lane = 0; Lane < LeafSize; Lane++ )
+			{
+				if( !( Mask & ( 1 << Lane ) ) )
+					continue;
+
+				const auto Closest = ClosestPointOnTriangle( Origin,
+					Vector3D( Leaf.AX[Lane], Leaf.AY[Lane], Leaf.AZ[Lane] ),
+					Vector3D( Leaf.BX[Lane], Leaf.BY[Lane], Leaf.BZ[Lane] ),
+					Vector3D( Leaf.CX[Lane], Leaf.CY[Lane], Leaf.CZ[Lane] )
+				);
+
+				auto Direction = Closest - Origin;
+				const float DistanceSquared = Direction.LengthSquared();
+				if( DistanceSquared >= SphereRadius * SphereRadius )
+					continue;
+
+				Contacts++;
+
+				const float Length = std::sqrt( DistanceSquared );
+				const float Depth = SphereRadius - Length;
+				if( Depth <= Deepest )
+					continue;
+
+				Deepest = Depth;
+				if( Length > FLT_EPSILON )
+				{
+					Direction /= Length;
+				}
+				else
+				{
+					// The origin lies on the triangle, push it out along the face normal.
+					Direction = Vector3D( Leaf.NormalX[Lane], Leaf.NormalY[Lane], Leaf.NormalZ[Lane] ) * -1.0f;
+				}
+
+				Response.Normal = Direction;
+				Response.Distance = Depth;
+				Response.Point = Closest;
+			}
+		}
+	);
+
+	return Contacts;
+}
+
+void TriangleTree::Debug( const FTransform& Transform, const Color& BoundsColor ) const
+{
+	for( const auto& Node : Nodes )
+	{
+		if( Node.Leaf < 0 )
+			continue;
+
+		const auto Bounds = Math::AABB( Node.Bounds, Transform );
+		UI::AddAABB( Bounds.Minimum, Bounds.Maximum, BoundsColor );
+	}
+}
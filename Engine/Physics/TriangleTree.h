@@ -0,0 +1,85 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Engine/Display/Rendering/Vertex.h>
+#include <Engine/Physics/CollisionResponse.h>
+#include <Engine/Utility/Math.h>
+
+class CMesh;
+struct FlatTriangleEntry;
+
+// Bounding volume hierarchy over the triangles of a mesh, used for triangle mesh collisions.
+// The nodes are stored depth-first in a single array, the leaves store their triangles per component so that four triangles are tested at once.
+// Triangles are stored in the local space of the mesh.
+struct TriangleTree
+{
+	static constexpr size_t LeafSize = 4;
+
+	struct Node
+	{
+		BoundingBox Bounds;
+
+		// Index of the second child, the first child is stored right after its parent.
+		int32_t Second = -1;
+
+		// Index of the leaf, -1 for nodes that have children.
+		int32_t Leaf = -1;
+	};
+
+	struct alignas( 16 ) Leaf
+	{
+		float AX[LeafSize];
+		float AY[LeafSize];
+		float AZ[LeafSize];
+		float BX[LeafSize];
+		float BY[LeafSize];
+		float BZ[LeafSize];
+		float CX[LeafSize];
+		float CY[LeafSize];
+		float CZ[LeafSize];
+
+		// Unit length face normals.
+		float NormalX[LeafSize];
+		float NormalY[LeafSize];
+		float NormalZ[LeafSize];
+
+		// Amount of lanes that contain a triangle.
+		int32_t Count = 0;
+	};
+
+	// Returns the tree of the mesh, it is built the first time it is requested.
+	static std::shared_ptr<TriangleTree> Get( CMesh* Mesh );
+
+	// Builds a tree from a triangle list, degenerate triangles are skipped.
+	// Meshes without indices use every three consecutive vertices as a triangle.
+	static std::shared_ptr<TriangleTree> Build( const VertexFormat* Vertices, const size_t VertexCount, const glm::uint* Indices, const size_t IndexCount );
+
+	// Restores a tree that was built earlier, the triangle count is derived from the leaves.
+	static std::shared_ptr<TriangleTree> Restore( const BoundingBox& Bounds, std::vector<Node>&& Nodes, std::vector<Leaf>&& Leaves );
+
+	// Separating axis test of the box against the triangles, returns the amount of overlapping triangles.
+	// The response describes the deepest contact, its normal points from the box towards the triangle.
+	size_t CollideAABB( const BoundingBox& Box, CollisionResponse& Response ) const;
+
+	// Returns the amount of triangles that touch the sphere, the response normal points from the sphere towards the triangle.
+	size_t CollideSphere( const BoundingSphere& Sphere, CollisionResponse& Response ) const;
+
+	void Debug( const FTransform& Transform, const Color& BoundsColor ) const;
+
+	size_t GetTriangleCount() const
+	{
+		return TriangleCount;
+	}
+
+	BoundingBox Bounds;
+	std::vector<Node> Nodes;
+	std::vector<Leaf> Leaves;
+
+private:
+	int32_t BuildNode( std::vector<FlatTriangleEntry>& Entries, const size_t Start, const size_t End );
+
+	size_t TriangleCount = 0;
+};
@@ -134,6 +134,9 @@ private:
 
 #define _PROFILEMEMORY_( Name, Clear ) static NameSymbol MacroName(ScopeName_)( Name ); ProfileMemory MacroName(Scope_)( Name, Clear )
 
+// Per-frame counter with a fixed name, the symbol of the name is only looked up the first time.
+#define ProfileCounter( Name, Value ) static const NameSymbol MacroName(CounterName_)( NameLiteral( Name ) ); CProfiler::Get().AddCounterEntry( ProfileTimeEntry( MacroName(CounterName_), Value ), true )
+
 #define ProfileAlways( Name ) _PROFILE_( Name, false )
 
 #ifdef OptickBuild
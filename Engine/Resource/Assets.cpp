@@ -11,11 +11,15 @@
 #include <Engine/Display/Rendering/Mesh.h>
 #include <Engine/Display/Rendering/Shader.h>
 #include <Engine/Display/Rendering/Texture.h>
+#include <Engine/Display/Rendering/TextureStreaming.h>
 #include <Engine/Display/Window.h>
 
+#include <Engine/Physics/TriangleTree.h>
+
 #include <Engine/Sequencer/Sequencer.h>
 #include <Engine/Profiling/Logging.h>
 
+#include <Engine/Utility/CookedMesh.h>
 #include <Engine/Utility/File.h>
 #include <Engine/Utility/MeshBuilder.h>
 #include <Engine/Utility/ThreadPool.h>
@@ -23,20 +27,26 @@
 
 ConfigurationVariable<bool> LogAssetCreation( "debug.Assets.LogCreation", false );
 
-void LoadAnimationMetaData( AnimationSet& Set, const JSON::Container& SetData )
+// Decodes the textures of asset lists in the background instead of blocking the main thread.
+ConfigurationVariable<bool> StreamTextures( "render.StreamTextures", true );
+
+// Stores loaded meshes in the cooked format so that the next load doesn't have to parse the source.
+ConfigurationVariable<bool> CookMeshes( "render.CookMeshes", true );
+
+void LoadAnimationMetaData( AnimationSet& Set, const JSON::Document& SetData )
 {
-	const auto* MetaData = JSON::Find( SetData.Tree, "meta" );
-	if( !MetaData )
+	const auto MetaData = SetData.Root().Find( "meta" );
+	if( !MetaData.Valid() )
 		return; // This set doesn't contain additional metadata.
 
-	for( const auto* Entry : MetaData->Objects )
+	for( const auto& Entry : MetaData )
 	{
-		const auto& Name = JSON::Find( Entry->Objects, "name" );
-		if( !Name )
+		std::string Name;
+		if( !Entry.Assign( "name", Name ) )
 			continue; // Invalid entry, a name is required.
 
 		// Lookup the actual name of the animation.
-		const auto& RealName = Set.Lookup( Name->Value );
+		const auto& RealName = Set.Lookup( Name );
 		const auto Iterator = Set.Skeleton.Animations.find( RealName );
 		if( Iterator == Set.Skeleton.Animations.end() )
 			continue; // The animation could not be found.
@@ -44,13 +54,14 @@ void LoadAnimationMetaData( AnimationSet& Set, const JSON::Container& SetData )
 		Animation& Animation = Iterator->second;
 
 		// Check for root motion requests.
-		if( const auto* RootMotion = JSON::Find( Entry->Objects, "rootmotion" ) )
+		std::string RootMotion;
+		if( Entry.Assign( "rootmotion", RootMotion ) )
 		{
-			if( RootMotion->Value == "xy" )
+			if( RootMotion == "xy" )
 			{
 				Animation.RootMotion = Animation::XY;
 			}
-			else if( RootMotion->Value == "xyz" )
+			else if( RootMotion == "xyz" )
 			{
 				Animation.RootMotion = Animation::XYZ;
 			}
@@ -59,18 +70,20 @@ void LoadAnimationMetaData( AnimationSet& Set, const JSON::Container& SetData )
 		if( Set.Skeleton.Animations.empty() )
 			continue;
 
-		if( const auto* RootMotion = JSON::Find( Entry->Objects, "type" ) )
+		std::string Type;
+		if( Entry.Assign( "type", Type ) )
 		{
-			if( RootMotion->Value == "additive" )
+			if( Type == "additive" )
 			{
 				// Grab the first animation in the list.
 				auto Bind = Set.Skeleton.Animations.begin()->second;
 
 				// Check if another base was specified.
-				if( const auto* Base = JSON::Find( Entry->Objects, "base" ) )
+				std::string Base;
+				if( Entry.Assign( "base", Base ) )
 				{
 					// Lookup the specified base pose.
-					const auto& RealName = Set.Lookup( Base->Value );
+					const auto& RealName = Set.Lookup( Base );
 					const auto Iterator = Set.Skeleton.Animations.find( RealName );
 					if( Iterator != Set.Skeleton.Animations.end() )
 					{
@@ -208,28 +221,30 @@ void LoadAnimationMetaData( AnimationSet& Set, const JSON::Container& SetData )
 	}
 }
 
-void LoadAnimationSet( AnimationSet& Set, CFile& File, JSON::Container& SetData )
+void LoadAnimationSet( AnimationSet& Set, CFile& File, JSON::Document& SetData )
 {
 	File.Load();
-	SetData = JSON::Tree( File );
-	const auto& MeshLocation = JSON::Find( SetData.Tree, "path" );
-	if( MeshLocation && CFile::Exists( MeshLocation->Value ) )
+	SetData.Parse( File );
+
+	std::string MeshLocation;
+	if( SetData.Root().Assign( "path", MeshLocation ) && CFile::Exists( MeshLocation ) )
 	{
 		// Update the accessed file so that we can load it.
-		File = CFile( MeshLocation->Value );
+		File = CFile( MeshLocation );
 
 		// Load the animation set lookup table.
-		Set = AnimationSet::Generate( JSON::Find( SetData.Tree, "animations" ) );
+		Set = AnimationSet::Generate( SetData.Root().Find( "animations" ) );
 	}
 }
 
 static std::string ExtensionLoftyModel = "lm";
 static std::string ExtensionLoftyMeshInterface = "lmi";
+static std::string ExtensionCookedMesh = "lmc";
 static std::string ExtensionAnimationSet = "ses";
 void LoadMeshAsset( FPrimitive& Primitive, AnimationSet& Set, CFile& File )
 {
 	// Animation set data, if loaded.
-	JSON::Container SetData;
+	JSON::Document SetData;
 
 	const auto IsAnimationSet = File.Extension() == ExtensionAnimationSet;
 	if( IsAnimationSet ) // Animation set
@@ -239,7 +254,7 @@ void LoadMeshAsset( FPrimitive& Primitive, AnimationSet& Set, CFile& File )
 	
 	if( File.Extension() == ExtensionLoftyMeshInterface )
 	{
-		File.Load( true );
+		File.Map();
 		MeshBuilder::LMI( Primitive, Set, File );
 	}
 	else if( File.Extension() == ExtensionLoftyModel )
@@ -258,10 +273,47 @@ void LoadMeshAsset( FPrimitive& Primitive, AnimationSet& Set, CFile& File )
 	}
 }
 
+// Loads the cooked version of the mesh if it is still up to date, otherwise the source is loaded and cooked.
+void LoadCookedMeshAsset( const std::string& Name, FPrimitive& Primitive, AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree, CFile& File, const bool ForceLoad )
+{
+	if( File.Extension() == ExtensionCookedMesh )
+	{
+		CookedMesh::Load( File.Location(), std::string(), Primitive, Set, Tree );
+		return;
+	}
+
+	if( !CookMeshes.Get() )
+	{
+		LoadMeshAsset( Primitive, Set, File );
+		return;
+	}
+
+	// Cooked files are looked up by the file that was requested, for animation sets that is the set file.
+	const std::string Source = File.Location();
+	const auto Location = CookedMesh::GetLocation( Name );
+	if( !ForceLoad && CookedMesh::Load( Location, Source, Primitive, Set, Tree ) )
+		return;
+
+	LoadMeshAsset( Primitive, Set, File );
+
+	if( Primitive.Vertices && Primitive.VertexCount > 0 )
+	{
+		// Animation sets redirect the file to the mesh they point to, it has to be tracked as well.
+		std::vector<std::string> Sources = { Source };
+		if( File.Location() != Source )
+		{
+			Sources.emplace_back( File.Location() );
+		}
+
+		CookedMesh::Cook( Location, Sources, Primitive, Set, Tree );
+	}
+}
+
 struct CompoundPayload
 {
 	PrimitivePayload* Payload = nullptr;
 	AnimationSet Set;
+	std::shared_ptr<TriangleTree> Tree;
 };
 
 void LoadPrimitive( CompoundPayload* CompoundPayload )
@@ -271,26 +323,12 @@ void LoadPrimitive( CompoundPayload* CompoundPayload )
 	auto* Payload = CompoundPayload->Payload;
 
 	CFile File( Payload->Location );
-	if( File.Extension() != "lm" )
-	{
-		std::stringstream ExportLocation;
-		ExportLocation << "Models/" << Payload->Name << ".lm";
-		std::string ExportPath = ExportLocation.str();
-
-		File = CFile( ExportPath );
-	}
-
-	if( !File.Exists() )
-	{
-		File = CFile( Payload->Location );
-	}
-
 	if( File.Exists() )
 	{
 		// We're asynchronously loading these meshes.
 		Payload->Asynchronous = true;
 
-		LoadMeshAsset( Payload->Primitive, CompoundPayload->Set, File );	
+		LoadCookedMeshAsset( Payload->Name, Payload->Primitive, CompoundPayload->Set, CompoundPayload->Tree, File, false );
 	}
 }
 
@@ -481,7 +519,7 @@ void CAssets::CreateNamedAssets( std::vector<PrimitivePayload>& MeshPayloads, st
 				AnisotropicSamples = Math::Clamp( Samples, 1, 16 );
 			}
 
-			CreateNamedTexture( Payload.Name.c_str(), Payload.Data[0].c_str(), FilteringMode, ImageFormat, true, AnisotropicSamples );
+			CreateNamedTexture( Payload.Name.c_str(), Payload.Data[0].c_str(), FilteringMode, ImageFormat, true, AnisotropicSamples, true );
 		}
 		else if( Payload.Type == EAsset::Sound )
 		{
@@ -541,6 +579,7 @@ void CAssets::CreateNamedAssets( std::vector<PrimitivePayload>& MeshPayloads, st
 			{
 				Mesh->SetLocation( Payload.Location );
 				Mesh->SetAnimationSet( CompoundPayload.Set );
+				Mesh->SetCollisionTree( CompoundPayload.Tree );
 			}
 		}
 		else if( !Payload.Asynchronous )
@@ -597,33 +636,17 @@ CMesh* CAssets::CreateNamedMesh( const char* Name, const char* FileLocation, con
 	CMesh* Mesh = Meshes.Find( NameString );
 	const bool ShouldLoad = Mesh == nullptr || ForceLoad;
 
-	std::string ExportPath;
-
 	CFile File( FileLocation );
-	if( File.Extension() != "lm" )
-	{
-		std::stringstream ExportLocation;
-		ExportLocation << "Models/" << Name << ".lm";
-		ExportPath = ExportLocation.str();
-
-		File = CFile( ExportPath );
-	}
-
-	
-	if( !File.Exists() || ForceLoad )
-	{
-		File = CFile( FileLocation );
-	}
-
 	if( File.Exists() )
 	{
 		std::string Extension = File.Extension();
 		FPrimitive Primitive;
 		AnimationSet Set;
+		std::shared_ptr<TriangleTree> Tree;
 
 		if( ShouldLoad )
 		{
-			LoadMeshAsset( Primitive, Set, File );
+			LoadCookedMeshAsset( NameString, Primitive, Set, Tree, File, ForceLoad );
 
 			if( Primitive.VertexCount == 0 )
 			{
@@ -649,6 +672,11 @@ CMesh* CAssets::CreateNamedMesh( const char* Name, const char* FileLocation, con
 			if( Mesh )
 			{
 				Mesh->SetLocation( FileLocation );
+
+				if( Tree )
+				{
+					Mesh->SetCollisionTree( Tree );
+				}
 			}
 
 			if( !Set.Skeleton.Bones.empty() )
@@ -780,7 +808,7 @@ CShader* CAssets::CreateNamedShader( const char* Name, const char* VertexLocatio
 	return nullptr;
 }
 
-CTexture* CAssets::CreateNamedTexture( const char* Name, const char* FileLocation, const EFilteringMode Mode, const EImageFormat Format, const bool& GenerateMipMaps, const uint8_t AnisotropicSamples )
+CTexture* CAssets::CreateNamedTexture( const char* Name, const char* FileLocation, const EFilteringMode Mode, const EImageFormat Format, const bool& GenerateMipMaps, const uint8_t AnisotropicSamples, const bool Stream )
 {
 	if( CWindow::Get().IsWindowless() )
 		return nullptr;
@@ -800,7 +828,20 @@ CTexture* CAssets::CreateNamedTexture( const char* Name, const char* FileLocatio
 	CTexture* NewTexture = new CTexture( FileLocation );
 	NewTexture->SetAnisotropicSamples( AnisotropicSamples );
 
-	const bool bSuccessfulCreation = NewTexture->Load( Mode, Format, GenerateMipMaps );
+	bool bSuccessfulCreation = false;
+	if( Stream && StreamTextures )
+	{
+		// Missing files are caught here, files that fail to decode will show the error texture later on.
+		bSuccessfulCreation = CFile::Exists( FileLocation );
+		if( bSuccessfulCreation )
+		{
+			TextureStreaming::Request( NewTexture, FindTexture( "black" ), FindTexture( "error" ), Mode, Format, GenerateMipMaps );
+		}
+	}
+	else
+	{
+		bSuccessfulCreation = NewTexture->Load( Mode, Format, GenerateMipMaps );
+	}
 
 	if( bSuccessfulCreation )
 	{
@@ -1334,260 +1375,314 @@ void AssignType( AssetType& Type, const bool& Condition, const AssetType& Assign
 	}
 }
 
-void CAssets::Load( const JSON::Object& AssetsIn )
+// Properties of a single entry in an asset list.
+struct FAssetEntry
 {
-	OptickEvent();
-
-	if( AssetsIn.Objects.empty() )
-		return;
-
-	auto& Assets = Get();
-	
-	std::vector<PrimitivePayload> MeshList;
-	std::vector<FGenericAssetPayload> GenericAssets;
-	for( const auto* Asset : AssetsIn.Objects )
+	void Set( const std::string& Key, const std::string& Value )
 	{
-		auto Type = AssetType::Unknown;
-		std::string Name;
-		std::vector<std::string> Paths;
-		Paths.reserve( 10 );
-		ESoundPlayMode::Type PlayMode = ESoundPlayMode::Sequential;
-		bool ShouldLoop = false;
+		if( Key == "type" )
+		{
+			AssignType( Type, 
+				Value == "mesh", 
+				AssetType::Mesh );
+			AssignType( Type, 
+				Value == "animation", 
+				AssetType::Animation );
+			AssignType( Type, 
+				Value == "shader", 
+				AssetType::Shader );
+			AssignType( Type, 
+				Value == "texture", 
+				AssetType::Texture );
+			AssignType( Type, 
+				Value == "sound", 
+				AssetType::Sound );
+			AssignType( Type, 
+				Value == "music", 
+				AssetType::Stream );
+			AssignType( Type, 
+				Value == "stream", 
+				AssetType::Stream );
+			AssignType( Type, 
+				Value == "sequence", 
+				AssetType::Sequence );
+			AssignType( Type, 
+				Value == "asset" || Value == "generic", 
+				AssetType::Generic );
+		}
+		else if( Key == "name" )
+		{
+			Name = Value;
+		}
+		else if( Key == "path" && Value.length() > 0 )
+		{
+			Paths.emplace_back( Value );
+		}
+		else if( Key == "mode" )
+		{
+			if( Value == "random" )
+			{
+				PlayMode = ESoundPlayMode::Random;
+			}
+		}
+		else if( Key == "loop" )
+		{
+			if( Value == "1" )
+			{
+				ShouldLoop = true;
+			}
+		}
+		else if( Key == "vertex" )
+		{
+			VertexPath = Value;
+		}
+		else if( Key == "fragment" )
+		{
+			FragmentPath = Value;
+		}
+		else if( Key == "format" )
+		{
+			ImageFormat = Value;
+		}
+		else if( Key == "filter" )
+		{
+			FilteringMode = Value;
+		}
+		else if( Key == "samples" )
+		{
+			AnisotropicSamples = Value;
+		}
+		else if( Key == "set" )
+		{
+			// Path to animation set.
+			UserData = Value;
+		}
+		else if( Key == "skeleton" )
+		{
+			// Name of mesh that has the skeleton, for appending animations.
+			UserData = Value;
+			Name = UserData;
+		}
+		else if( Key == "stype" || Key == "subtype" )
+		{
+			// String designation of a sub/shader type.
+			UserData = Value;
+		}
+	}
 
-		// Shader-specific path storage.
-		std::string VertexPath;
-		std::string FragmentPath;
+	AssetType Type = AssetType::Unknown;
+	std::string Name;
+	std::vector<std::string> Paths;
+	ESoundPlayMode::Type PlayMode = ESoundPlayMode::Sequential;
+	bool ShouldLoop = false;
 
-		// Texture format storage.
-		std::string ImageFormat;
+	// Shader-specific path storage.
+	std::string VertexPath;
+	std::string FragmentPath;
 
-		// Texture filtering mode.
-		std::string FilteringMode;
+	// Texture format storage.
+	std::string ImageFormat;
 
-		// Texture anisotropic sample count.
-		std::string AnisotropicSamples;
+	// Texture filtering mode.
+	std::string FilteringMode;
 
-		// TODO: Give this a better name.
-		std::string UserData;
+	// Texture anisotropic sample count.
+	std::string AnisotropicSamples;
 
-		for( const auto* Property : Asset->Objects )
+	// TODO: Give this a better name.
+	std::string UserData;
+};
+
+// Turns the entry into payloads for the asset loaders.
+void CreateAsset( const FAssetEntry& Entry, CAssets& Assets, std::vector<PrimitivePayload>& MeshList, std::vector<FGenericAssetPayload>& GenericAssets )
+{
+	if( Entry.Name.length() > 0 && ( !Entry.Paths.empty() || ( !Entry.VertexPath.empty() && !Entry.FragmentPath.empty() ) ) )
+	{
+		if( Entry.Type == AssetType::Mesh )
 		{
-			if( Property->Key == "type" )
-			{
-				AssignType( Type, 
-					Property->Value == "mesh", 
-					AssetType::Mesh );
-				AssignType( Type, 
-					Property->Value == "animation", 
-					AssetType::Animation );
-				AssignType( Type, 
-					Property->Value == "shader", 
-					AssetType::Shader );
-				AssignType( Type, 
-					Property->Value == "texture", 
-					AssetType::Texture );
-				AssignType( Type, 
-					Property->Value == "sound", 
-					AssetType::Sound );
-				AssignType( Type, 
-					Property->Value == "music", 
-					AssetType::Stream );
-				AssignType( Type, 
-					Property->Value == "stream", 
-					AssetType::Stream );
-				AssignType( Type, 
-					Property->Value == "sequence", 
-					AssetType::Sequence );
-				AssignType( Type, 
-					Property->Value == "asset" || Property->Value == "generic", 
-					AssetType::Generic );
-			}
-			else if( Property->Key == "name" )
-			{
-				Name = Property->Value;
-			}
-			else if( Property->Key == "path" && Property->Value.length() > 0 )
-			{
-				Paths.emplace_back( Property->Value );
-			}
-			else if( Property->Key == "paths" )
-			{
-				for( auto Path : Property->Objects )
-				{
-					Paths.emplace_back( Path->Key );
-				}
-			}
-			else if( Property->Key == "mode" )
-			{
-				if( Property->Value == "random" )
-				{
-					PlayMode = ESoundPlayMode::Random;
-				}
-			}
-			else if( Property->Key == "loop" )
-			{
-				if( Property->Value == "1" )
-				{
-					ShouldLoop = true;
-				}
-			}
-			else if( Property->Key == "vertex" )
-			{
-				VertexPath = Property->Value;
-			}
-			else if( Property->Key == "fragment" )
-			{
-				FragmentPath = Property->Value;
-			}
-			else if( Property->Key == "format" )
-			{
-				ImageFormat = Property->Value;
-			}
-			else if( Property->Key == "filter" )
+			for( const auto& Path : Entry.Paths )
 			{
-				FilteringMode = Property->Value;
+				PrimitivePayload Payload;
+				Payload.Name = Entry.Name;
+				Payload.Location = Path;
+				Payload.UserData = Entry.UserData;
+				MeshList.emplace_back( Payload );
 			}
-			else if( Property->Key == "samples" )
-			{
-				AnisotropicSamples = Property->Value;
-			}
-			else if( Property->Key == "set" )
-			{
-				// Path to animation set.
-				UserData = Property->Value;
-			}
-			else if( Property->Key == "skeleton" )
-			{
-				// Name of mesh that has the skeleton, for appending animations.
-				UserData = Property->Value;
-				Name = UserData;
-			}
-			else if( Property->Key == "stype" || Property->Key == "subtype" )
+		}
+		else if( Entry.Type == AssetType::Animation )
+		{
+			for( const auto& Path : Entry.Paths )
 			{
-				// String designation of a sub/shader type.
-				UserData = Property->Value;
+				FGenericAssetPayload Payload;
+				Payload.Type = EAsset::Animation;
+				Payload.Name = Entry.UserData; // Name of the mesh that has the relevant skeleton.
+				Payload.Data.emplace_back( Path ); // Path of the animation that should be appended.
+				GenericAssets.emplace_back( Payload );
 			}
 		}
-
-		if( Name.length() > 0 && ( !Paths.empty() || ( !VertexPath.empty() && !FragmentPath.empty() ) ) )
+		else if( Entry.Type == AssetType::Shader )
 		{
-			if( Type == AssetType::Mesh )
+			if( Entry.VertexPath.length() > 0 && Entry.FragmentPath.length() > 0 )
 			{
-				for( const auto& Path : Paths )
-				{
-					PrimitivePayload Payload;
-					Payload.Name = Name;
-					Payload.Location = Path;
-					Payload.UserData = UserData;
-					MeshList.emplace_back( Payload );
-				}
+				FGenericAssetPayload Payload;
+				Payload.Type = EAsset::Shader;
+				Payload.Name = Entry.Name;
+				Payload.Data.emplace_back( "fragment" ); // Shader Type
+				Payload.Data.emplace_back( Entry.VertexPath );
+				Payload.Data.emplace_back( Entry.FragmentPath );
+				GenericAssets.emplace_back( Payload );
 			}
-			else if( Type == AssetType::Animation )
+			else
 			{
-				for( const auto& Path : Paths )
+				FGenericAssetPayload Payload;
+				Payload.Type = EAsset::Shader;
+				Payload.Name = Entry.Name;
+				Payload.Data.emplace_back( Entry.UserData ); // Shader Type
+				
+				for( const auto& Path : Entry.Paths )
 				{
-					FGenericAssetPayload Payload;
-					Payload.Type = EAsset::Animation;
-					Payload.Name = UserData; // Name of the mesh that has the relevant skeleton.
-					Payload.Data.emplace_back( Path ); // Path of the animation that should be appended.
+					Payload.Data.emplace_back( Path );
 					GenericAssets.emplace_back( Payload );
 				}
 			}
-			else if( Type == AssetType::Shader )
+		}
+		else if( Entry.Type == AssetType::Texture )
+		{
+			for( const auto& Path : Entry.Paths )
 			{
-				if( VertexPath.length() > 0 && FragmentPath.length() > 0 )
-				{
-					FGenericAssetPayload Payload;
-					Payload.Type = EAsset::Shader;
-					Payload.Name = Name;
-					Payload.Data.emplace_back( "fragment" ); // Shader Type
-					Payload.Data.emplace_back( VertexPath );
-					Payload.Data.emplace_back( FragmentPath );
-					GenericAssets.emplace_back( Payload );
-				}
-				else
-				{
-					FGenericAssetPayload Payload;
-					Payload.Type = EAsset::Shader;
-					Payload.Name = Name;
-					Payload.Data.emplace_back( UserData ); // Shader Type
-					
-					for( const auto& Path : Paths )
-					{
-						Payload.Data.emplace_back( Path );
-						GenericAssets.emplace_back( Payload );
-					}
-				}
+				FGenericAssetPayload Payload;
+				Payload.Type = EAsset::Texture;
+				Payload.Name = Entry.Name;
+				Payload.Data.emplace_back( Path );
+				Payload.Data.emplace_back( Entry.ImageFormat );
+				Payload.Data.emplace_back( Entry.FilteringMode );
+				Payload.Data.emplace_back( Entry.AnisotropicSamples );
+				GenericAssets.emplace_back( Payload );
 			}
-			else if( Type == AssetType::Texture )
+		}
+		else if( Entry.Type == AssetType::Sound || Entry.Type == AssetType::Stream )
+		{
+			CSound* NewSound = Entry.Type == AssetType::Stream ? Assets.CreateNamedStream( Entry.Name.c_str() ) : Assets.CreateNamedSound( Entry.Name.c_str() );
+			if( NewSound )
 			{
-				for( const auto& Path : Paths )
+				NewSound->Clear();
+				NewSound->SetPlayMode( Entry.PlayMode );
+				NewSound->Loop( Entry.ShouldLoop );
+
+				FGenericAssetPayload Payload;
+				Payload.Type = EAsset::Sound;
+				Payload.Name = Entry.Name;
+
+				for( const auto& Path : Entry.Paths )
 				{
-					FGenericAssetPayload Payload;
-					Payload.Type = EAsset::Texture;
-					Payload.Name = Name;
 					Payload.Data.emplace_back( Path );
-					Payload.Data.emplace_back( ImageFormat );
-					Payload.Data.emplace_back( FilteringMode );
-					Payload.Data.emplace_back( AnisotropicSamples );
-					GenericAssets.emplace_back( Payload );
 				}
+
+				GenericAssets.emplace_back( Payload );
 			}
-			else if( Type == AssetType::Sound || Type == AssetType::Stream )
-			{
-				CSound* NewSound = Type == AssetType::Stream ? Assets.CreateNamedStream( Name.c_str() ) : Assets.CreateNamedSound( Name.c_str() );
-				if( NewSound )
-				{
-					NewSound->Clear();
-					NewSound->SetPlayMode( PlayMode );
-					NewSound->Loop( ShouldLoop );
+		}
+		else if( Entry.Type == AssetType::Sequence )
+		{
+			Assets.CreateNamedSequence( Entry.Name.c_str() );
+			FGenericAssetPayload Payload;
+			Payload.Type = EAsset::Sequence;
+			Payload.Name = Entry.Name;
 
-					FGenericAssetPayload Payload;
-					Payload.Type = EAsset::Sound;
-					Payload.Name = Name;
+			Payload.Data.emplace_back( Entry.Paths[0] );
 
-					for( const auto& Path : Paths )
-					{
-						Payload.Data.emplace_back( Path );
-					}
+			GenericAssets.emplace_back( Payload );
+		}
+		else if ( Entry.Type == AssetType::Generic )
+		{
+			FGenericAssetPayload Payload;
+			Payload.Type = EAsset::Generic;
+			Payload.Name = Entry.Name;
 
-					GenericAssets.emplace_back( Payload );
+			// Add the sub-type.
+			Payload.Data.emplace_back( Entry.UserData );
+
+			// Add the first path, expected to be a definition file for the loader to use.
+			Payload.Data.emplace_back( Entry.Paths[0] );
+
+			GenericAssets.emplace_back( Payload );
+		}
+		else
+		{
+			Log::Event( Log::Error, "Missing asset type for asset \"%s\".\n", Entry.Name.c_str() );
+		}
+	}
+	else
+	{
+		Log::Event( Log::Error, "Invalid asset entry in level file.\n" );
+	}
+}
+
+void CAssets::Load( const JSON::Object& AssetsIn )
+{
+	OptickEvent();
+
+	if( AssetsIn.Objects.empty() )
+		return;
+
+	auto& Assets = Get();
+	
+	std::vector<PrimitivePayload> MeshList;
+	std::vector<FGenericAssetPayload> GenericAssets;
+	for( const auto* Asset : AssetsIn.Objects )
+	{
+		FAssetEntry Entry;
+		for( const auto* Property : Asset->Objects )
+		{
+			if( Property->Key == "paths" )
+			{
+				for( auto Path : Property->Objects )
+				{
+					Entry.Paths.emplace_back( Path->Key );
 				}
 			}
-			else if( Type == AssetType::Sequence )
+			else
 			{
-				Assets.CreateNamedSequence( Name.c_str() );
-				FGenericAssetPayload Payload;
-				Payload.Type = EAsset::Sequence;
-				Payload.Name = Name;
+				Entry.Set( Property->Key, Property->Value );
+			}
+		}
 
-				Payload.Data.emplace_back( Paths[0] );
+		CreateAsset( Entry, Assets, MeshList, GenericAssets );
+	}
 
-				GenericAssets.emplace_back( Payload );
-			}
-			else if ( Type == AssetType::Generic )
-			{
-				FGenericAssetPayload Payload;
-				Payload.Type = EAsset::Generic;
-				Payload.Name = Name;
+	Assets.CreateNamedAssets( MeshList, GenericAssets );
+}
 
-				// Add the sub-type.
-				Payload.Data.emplace_back( UserData );
+void CAssets::Load( const JSON::Node& AssetsIn )
+{
+	OptickEvent();
 
-				// Add the first path, expected to be a definition file for the loader to use.
-				Payload.Data.emplace_back( Paths[0] );
+	if( AssetsIn.Size() == 0 )
+		return;
 
-				GenericAssets.emplace_back( Payload );
+	auto& Assets = Get();
+
+	std::vector<PrimitivePayload> MeshList;
+	std::vector<FGenericAssetPayload> GenericAssets;
+	for( const auto& Asset : AssetsIn )
+	{
+		FAssetEntry Entry;
+		for( const auto& Property : Asset )
+		{
+			const std::string Key( Property.Key(), Property.KeyLength() );
+			if( Key == "paths" )
+			{
+				for( const auto& Path : Property )
+				{
+					Entry.Paths.emplace_back( Path.Value(), Path.ValueLength() );
+				}
 			}
 			else
 			{
-				Log::Event( Log::Error, "Missing asset type for asset \"%s\".\n", Name.c_str() );
+				Entry.Set( Key, std::string( Property.Value(), Property.ValueLength() ) );
 			}
 		}
-		else
-		{
-			Log::Event( Log::Error, "Invalid asset entry in level file.\n" );
-		}
+
+		CreateAsset( Entry, Assets, MeshList, GenericAssets );
 	}
 
 	Assets.CreateNamedAssets( MeshList, GenericAssets );
@@ -1615,8 +1710,14 @@ void CAssets::Load( CFile& File )
 	if( !Loaded )
 		return;
 
-	const auto Container = JSON::Tree( File );
-	Load( Container );
+	JSON::Document Document;
+	if( !Document.Parse( File ) )
+	{
+		Log::Event( Log::Warning, "Failed to parse assets \"%s\", line %zu (offset %zu).\n", File.Location().c_str(), Document.ErrorLine(), Document.ErrorOffset() );
+		return;
+	}
+
+	Load( Document.Root().Find( "assets" ) );
 
 	Log::Event( "Loaded assets from file \"%s\".\n", File.Location( true ).c_str() );
 }
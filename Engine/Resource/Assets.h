@@ -9,6 +9,7 @@
 #include <Engine/Resource/AssetPool.h>
 #include <Engine/Utility/Primitive.h>
 #include <Engine/Utility/Structures/JSON.h>
+#include <Engine/Utility/Structures/JSONDocument.h>
 #include <Engine/Utility/Singleton.h>
 
 class CMesh;
@@ -77,7 +78,8 @@ public:
 	CShader* CreateNamedShader( const char* Name, const char* FileLocation, const EShaderType& Type = EShaderType::Fragment );
 	CShader* CreateNamedShader( const char* Name, const char* VertexLocation, const char* FragmentLocation );
 
-	CTexture* CreateNamedTexture( const char* Name, const char* FileLocation, const EFilteringMode Mode = EFilteringMode::Trilinear, const EImageFormat Format = EImageFormat::RGB8, const bool& GenerateMipMaps = true, const uint8_t AnisotropicSamples = 0 );
+	// Streamed textures are decoded in the background and use a placeholder until they have been uploaded.
+	CTexture* CreateNamedTexture( const char* Name, const char* FileLocation, const EFilteringMode Mode = EFilteringMode::Trilinear, const EImageFormat Format = EImageFormat::RGB8, const bool& GenerateMipMaps = true, const uint8_t AnisotropicSamples = 0, const bool Stream = false );
 	CTexture* CreateNamedTexture( const char* Name, unsigned char* Data, const int Width, const int Height, const int Channels, const EFilteringMode Mode = EFilteringMode::Trilinear, const EImageFormat Format = EImageFormat::RGB8, const bool& GenerateMipMaps = true, const uint8_t AnisotropicSamples = 0 );
 	CTexture* CreateNamedTexture( const char* Name, CTexture* Texture );
 	CTexture* CreateNamedTexture( const TextureContext& Context );
@@ -177,6 +179,9 @@ public:
 	// Loads any assets specified in the object.
 	static void Load( const JSON::Object& Assets );
 
+	// Loads any assets specified in the node.
+	static void Load( const JSON::Node& Assets );
+
 	// Checks a tree for an "assets" entry and loads any assets specified in it.
 	static void Load( const JSON::Vector& Tree );
 
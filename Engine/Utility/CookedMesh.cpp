@@ -0,0 +1,500 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "CookedMesh.h"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <Engine/Animation/AnimationSet.h>
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Display/Rendering/Vertex.h>
+#include <Engine/Physics/TriangleTree.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/Primitive.h>
+
+constexpr size_t SectionAlignment = 16;
+
+static const char Identifier[4] = { 'L', 'M', 'C', 'K' };
+
+// Triangle trees are only used by triangle collisions, without them the tree is left out.
+static bool UsesTriangleCollisions()
+{
+	return CConfiguration::Get().IsEnabled( "physics.TriangleCollisions" );
+}
+
+// Size of a single element of each section.
+static const size_t ElementSize[ECookedSection::Maximum] = {
+	sizeof( ComplexVertex ),
+	sizeof( uint32_t ),
+	sizeof( TriangleTree::Node ),
+	sizeof( TriangleTree::Leaf ),
+	sizeof( FCookedSkeleton ),
+	sizeof( FCookedBone ),
+	sizeof( int32_t ),
+	sizeof( FCookedString ),
+	sizeof( VertexWeight ),
+	sizeof( FCookedAnimation ),
+	sizeof( Key ),
+	sizeof( FCookedString ),
+	sizeof( FCookedDependency ),
+	sizeof( char )
+};
+
+static std::string CacheDirectory = "Cache/Meshes/";
+static FCookedMeshStatistics Counters;
+
+static bool Describe( const std::string& Location, int64_t& Time, int64_t& Size )
+{
+	struct stat Information;
+	if( stat( Location.c_str(), &Information ) != 0 )
+		return false;
+
+	Time = static_cast<int64_t>( Information.st_mtime );
+	Size = static_cast<int64_t>( Information.st_size );
+	return true;
+}
+
+template<typename T>
+static void AddSection( std::string& Buffer, FCookedMeshHeader& Header, const ECookedSection::Type Section, const T* Data, const size_t Count )
+{
+	// The math types define their own assignment operators, which only copy their members.
+	static_assert( std::is_standard_layout<T>::value && !std::is_pointer<T>::value, "Only plain values can be stored in a cooked mesh." );
+
+	const size_t Offset = ( Buffer.size() + SectionAlignment - 1 ) / SectionAlignment * SectionAlignment;
+	Buffer.resize( Offset );
+
+	Header.Sections[Section].Offset = Offset;
+	Header.Sections[Section].Count = Count;
+
+	if( Data && Count > 0 )
+	{
+		Buffer.append( reinterpret_cast<const char*>( Data ), Count * sizeof( T ) );
+	}
+}
+
+static FCookedString AddString( std::string& Strings, const std::string& String )
+{
+	FCookedString Result;
+	Result.Offset = static_cast<uint32_t>( Strings.size() );
+	Result.Length = static_cast<uint32_t>( String.size() );
+	Strings.append( String );
+	return Result;
+}
+
+// Copies a section out of the file, the file buffer may not be aligned for the stored type.
+template<typename T>
+static void CopySection( T* Destination, const char* Data, const FCookedMeshHeader& Header, const ECookedSection::Type Section )
+{
+	const auto& Entry = Header.Sections[Section];
+	if( Entry.Count > 0 )
+	{
+		std::memcpy( Destination, Data + Entry.Offset, Entry.Count * sizeof( T ) );
+	}
+}
+
+template<typename T>
+static std::vector<T> CopySection( const char* Data, const FCookedMeshHeader& Header, const ECookedSection::Type Section )
+{
+	std::vector<T> Result( Header.Sections[Section].Count );
+	CopySection( Result.data(), Data, Header, Section );
+	return Result;
+}
+
+std::string CookedMesh::GetLocation( const std::string& Name )
+{
+	return CacheDirectory + Name + ".lmc";
+}
+
+bool CookedMesh::Cook( const std::string& Location, const std::vector<std::string>& Sources, const FPrimitive& Primitive, const AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree )
+{
+	if( !Primitive.Vertices || Primitive.VertexCount == 0 )
+		return false;
+
+	if( !Tree && UsesTriangleCollisions() )
+	{
+		// The tree is built from the positions only.
+		std::vector<VertexFormat> Vertices( Primitive.VertexCount );
+		for( size_t Index = 0; Index < Primitive.VertexCount; Index++ )
+		{
+			Vertices[Index].Position = Primitive.Vertices[Index].Position;
+		}
+
+		Tree = TriangleTree::Build( Vertices.data(), Vertices.size(), Primitive.Indices, Primitive.IndexCount );
+	}
+
+	FCookedMeshHeader Header;
+	Header.Version = Version;
+	Header.VertexSize = sizeof( ComplexVertex );
+	Header.LeafSize = sizeof( TriangleTree::Leaf );
+
+	Header.Bounds = BoundingBox( Primitive.Vertices[0].Position, Primitive.Vertices[0].Position );
+	for( size_t Index = 1; Index < Primitive.VertexCount; Index++ )
+	{
+		Header.Bounds.Minimum = Math::Min( Header.Bounds.Minimum, Primitive.Vertices[Index].Position );
+		Header.Bounds.Maximum = Math::Max( Header.Bounds.Maximum, Primitive.Vertices[Index].Position );
+	}
+
+	Header.HasNormals = Primitive.HasNormals ? 1 : 0;
+	if( Tree )
+	{
+		Header.TreeBounds = Tree->Bounds;
+		Header.TriangleCount = static_cast<uint32_t>( Tree->GetTriangleCount() );
+	}
+
+	// Flatten the skeleton and the animations into tables.
+	const auto& Skeleton = Set.Skeleton;
+	std::string Strings;
+	std::vector<FCookedSkeleton> Skeletons;
+	std::vector<FCookedBone> Bones;
+	std::vector<int32_t> Children;
+	std::vector<FCookedString> Names;
+	std::vector<FCookedAnimation> Animations;
+	std::vector<Key> Keys;
+	std::vector<FCookedString> Lookup;
+	std::vector<FCookedDependency> Dependencies;
+
+	Dependencies.reserve( Sources.size() );
+	for( const auto& Source : Sources )
+	{
+		FCookedDependency Dependency;
+		Dependency.Location = AddString( Strings, Source );
+		Describe( Source, Dependency.Time, Dependency.Size );
+		Dependencies.emplace_back( Dependency );
+	}
+
+	if( !Skeleton.Bones.empty() || !Skeleton.Animations.empty() )
+	{
+		FCookedSkeleton Cooked;
+		Cooked.RootIndex = Skeleton.RootIndex;
+		Cooked.GlobalMatrix = Skeleton.GlobalMatrix;
+		Cooked.GlobalMatrixInverse = Skeleton.GlobalMatrixInverse;
+		Skeletons.emplace_back( Cooked );
+	}
+
+	Bones.reserve( Skeleton.Bones.size() );
+	for( const auto& Bone : Skeleton.Bones )
+	{
+		FCookedBone Cooked;
+		Cooked.Index = Bone.Index;
+		Cooked.ParentIndex = Bone.ParentIndex;
+		Cooked.FirstChild = static_cast<uint32_t>( Children.size() );
+		Cooked.ChildCount = static_cast<uint32_t>( Bone.Children.size() );
+		Cooked.ModelToBone = Bone.ModelToBone;
+		Cooked.BoneToModel = Bone.BoneToModel;
+		Cooked.BoneTransform = Bone.BoneTransform;
+		Cooked.ModelMatrix = Bone.ModelMatrix;
+		Cooked.InverseModelMatrix = Bone.InverseModelMatrix;
+		Cooked.LocalTransform = Bone.LocalTransform;
+		Cooked.GlobalTransform = Bone.GlobalTransform;
+		Bones.emplace_back( Cooked );
+
+		Children.insert( Children.end(), Bone.Children.begin(), Bone.Children.end() );
+	}
+
+	Names.reserve( Skeleton.MatrixNames.size() );
+	for( const auto& Name : Skeleton.MatrixNames )
+	{
+		Names.emplace_back( AddString( Strings, Name ) );
+	}
+
+	Animations.reserve( Skeleton.Animations.size() );
+	for( const auto& Pair : Skeleton.Animations )
+	{
+		const auto& Animation = Pair.second;
+
+		FCookedAnimation Cooked;
+		Cooked.Name = AddString( Strings, Pair.first );
+		Cooked.Duration = Animation.Duration;
+		Cooked.RootMotion = static_cast<int32_t>( Animation.RootMotion );
+		Cooked.Type = static_cast<int32_t>( Animation.Type );
+		Cooked.FirstKey = static_cast<uint32_t>( Keys.size() );
+		Cooked.PositionKeys = static_cast<uint32_t>( Animation.PositionKeys.size() );
+		Cooked.RotationKeys = static_cast<uint32_t>( Animation.RotationKeys.size() );
+		Cooked.ScalingKeys = static_cast<uint32_t>( Animation.ScalingKeys.size() );
+		Animations.emplace_back( Cooked );
+
+		for( const auto* Track : { &Animation.PositionKeys, &Animation.RotationKeys, &Animation.ScalingKeys } )
+		{
+			for( size_t Index = 0; Index < Track->size(); Index++ )
+			{
+				Keys.emplace_back( ( *Track )[Index] );
+			}
+		}
+	}
+
+	Lookup.reserve( Set.Set.size() * 2 );
+	for( const auto& Pair : Set.Set )
+	{
+		Lookup.emplace_back( AddString( Strings, Pair.first ) );
+		Lookup.emplace_back( AddString( Strings, Pair.second ) );
+	}
+
+	std::string Buffer( sizeof( FCookedMeshHeader ), '\0' );
+	AddSection( Buffer, Header, ECookedSection::Vertices, Primitive.Vertices, Primitive.VertexCount );
+	AddSection( Buffer, Header, ECookedSection::Indices, Primitive.Indices, Primitive.IndexCount );
+	AddSection( Buffer, Header, ECookedSection::Nodes, Tree ? Tree->Nodes.data() : nullptr, Tree ? Tree->Nodes.size() : 0 );
+	AddSection( Buffer, Header, ECookedSection::Leaves, Tree ? Tree->Leaves.data() : nullptr, Tree ? Tree->Leaves.size() : 0 );
+	AddSection( Buffer, Header, ECookedSection::Skeleton, Skeletons.data(), Skeletons.size() );
+	AddSection( Buffer, Header, ECookedSection::Bones, Bones.data(), Bones.size() );
+	AddSection( Buffer, Header, ECookedSection::Children, Children.data(), Children.size() );
+	AddSection( Buffer, Header, ECookedSection::Names, Names.data(), Names.size() );
+	AddSection( Buffer, Header, ECookedSection::Weights, Skeleton.Weights.data(), Skeleton.Weights.size() );
+	AddSection( Buffer, Header, ECookedSection::Animations, Animations.data(), Animations.size() );
+	AddSection( Buffer, Header, ECookedSection::Keys, Keys.data(), Keys.size() );
+	AddSection( Buffer, Header, ECookedSection::Lookup, Lookup.data(), Lookup.size() );
+	AddSection( Buffer, Header, ECookedSection::Dependencies, Dependencies.data(), Dependencies.size() );
+	AddSection( Buffer, Header, ECookedSection::Strings, Strings.data(), Strings.size() );
+
+	Header.Size = Buffer.size();
+	std::memcpy( &Buffer[0], &Header, sizeof( FCookedMeshHeader ) );
+
+	// The file takes ownership of the buffer.
+	char* Data = new char[Buffer.size()];
+	std::memcpy( Data, Buffer.data(), Buffer.size() );
+
+	CFile File( Location );
+	File.Load( Data, Buffer.size() );
+	if( !File.Save( true ) )
+	{
+		Log::Event( Log::Warning, "Couldn't write cooked mesh \"%s\".\n", Location.c_str() );
+		return false;
+	}
+
+	Counters.Cooked++;
+	return true;
+}
+
+bool CookedMesh::Load( const std::string& Location, const std::string& Source, FPrimitive& Primitive, AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree )
+{
+	CFile File( Location );
+	if( !File.Exists() || !File.Map() )
+	{
+		Counters.Misses++;
+		return false;
+	}
+
+	return Load( File.Fetch<char>(), File.Size(), Source, Primitive, Set, Tree );
+}
+
+static bool IsValid( const FCookedMeshHeader& Header, const size_t Size )
+{
+	if( std::memcmp( Header.Identifier, Identifier, sizeof( Identifier ) ) != 0 || Header.Version != CookedMesh::Version )
+		return false;
+
+	if( Header.VertexSize != sizeof( ComplexVertex ) || Header.LeafSize != sizeof( TriangleTree::Leaf ) || Header.Size != Size )
+		return false;
+
+	for( uint32_t Section = 0; Section < ECookedSection::Maximum; Section++ )
+	{
+		const auto& Entry = Header.Sections[Section];
+		if( Entry.Offset % SectionAlignment != 0 || Entry.Offset > Size || Entry.Count > ( Size - Entry.Offset ) / ElementSize[Section] )
+			return false;
+	}
+
+	return true;
+}
+
+static bool Unpack( const char* Data, const size_t Size, const std::string& Source, FPrimitive& Primitive, AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree )
+{
+	FCookedMeshHeader Header;
+	if( !Data || Size < sizeof( FCookedMeshHeader ) )
+		return false;
+
+	std::memcpy( &Header, Data, sizeof( FCookedMeshHeader ) );
+	if( !IsValid( Header, Size ) )
+		return false;
+
+	const auto& Sections = Header.Sections;
+	const char* Strings = Data + Sections[ECookedSection::Strings].Offset;
+	const auto StringCount = Sections[ECookedSection::Strings].Count;
+	const auto ToString = [Strings, StringCount] ( const FCookedString& String, std::string& Output )
+	{
+		if( static_cast<uint64_t>( String.Offset ) + String.Length > StringCount )
+			return false;
+
+		Output.assign( Strings + String.Offset, String.Length );
+		return true;
+	};
+
+	if( !Source.empty() )
+	{
+		// The cooked file has to belong to the source and none of the files it was cooked from may have changed.
+		bool Found = false;
+		for( const auto& Dependency : CopySection<FCookedDependency>( Data, Header, ECookedSection::Dependencies ) )
+		{
+			std::string Location;
+			if( !ToString( Dependency.Location, Location ) )
+				return false;
+
+			int64_t Time = 0;
+			int64_t DependencySize = -1;
+			Describe( Location, Time, DependencySize );
+			if( Time != Dependency.Time || DependencySize != Dependency.Size )
+				return false;
+
+			Found |= Location == Source;
+		}
+
+		if( !Found )
+			return false;
+	}
+
+	const auto Bones = CopySection<FCookedBone>( Data, Header, ECookedSection::Bones );
+	const auto Children = CopySection<int32_t>( Data, Header, ECookedSection::Children );
+	const auto Names = CopySection<FCookedString>( Data, Header, ECookedSection::Names );
+	const auto Animations = CopySection<FCookedAnimation>( Data, Header, ECookedSection::Animations );
+	const auto Keys = CopySection<Key>( Data, Header, ECookedSection::Keys );
+	const auto Lookup = CopySection<FCookedString>( Data, Header, ECookedSection::Lookup );
+
+	AnimationSet Cooked;
+	auto& Skeleton = Cooked.Skeleton;
+	if( Sections[ECookedSection::Skeleton].Count > 0 )
+	{
+		FCookedSkeleton Root;
+		CopySection( &Root, Data, Header, ECookedSection::Skeleton );
+		Skeleton.RootIndex = Root.RootIndex;
+		Skeleton.GlobalMatrix = Root.GlobalMatrix;
+		Skeleton.GlobalMatrixInverse = Root.GlobalMatrixInverse;
+	}
+
+	Skeleton.Bones.resize( Bones.size() );
+	for( size_t Index = 0; Index < Bones.size(); Index++ )
+	{
+		const auto& Source = Bones[Index];
+		if( static_cast<uint64_t>( Source.FirstChild ) + Source.ChildCount > Children.size() )
+			return false;
+
+		auto& Bone = Skeleton.Bones[Index];
+		Bone.Index = Source.Index;
+		Bone.ParentIndex = Source.ParentIndex;
+		Bone.Children.assign( Children.begin() + Source.FirstChild, Children.begin() + Source.FirstChild + Source.ChildCount );
+		Bone.ModelToBone = Source.ModelToBone;
+		Bone.BoneToModel = Source.BoneToModel;
+		Bone.BoneTransform = Source.BoneTransform;
+		Bone.ModelMatrix = Source.ModelMatrix;
+		Bone.InverseModelMatrix = Source.InverseModelMatrix;
+		Bone.LocalTransform = Source.LocalTransform;
+		Bone.GlobalTransform = Source.GlobalTransform;
+	}
+
+	Skeleton.MatrixNames.resize( Names.size() );
+	for( size_t Index = 0; Index < Names.size(); Index++ )
+	{
+		if( !ToString( Names[Index], Skeleton.MatrixNames[Index] ) )
+			return false;
+	}
+
+	Skeleton.Weights.resize( Sections[ECookedSection::Weights].Count );
+	CopySection( Skeleton.Weights.data(), Data, Header, ECookedSection::Weights );
+
+	Skeleton.Animations.reserve( Animations.size() );
+	for( const auto& Source : Animations )
+	{
+		const uint64_t KeyCount = static_cast<uint64_t>( Source.PositionKeys ) + Source.RotationKeys + Source.ScalingKeys;
+		if( Source.FirstKey + KeyCount > Keys.size() )
+			return false;
+
+		Animation Animation;
+		if( !ToString( Source.Name, Animation.Name ) )
+			return false;
+
+		Animation.Duration = Source.Duration;
+		Animation.RootMotion = static_cast<::Animation::RootMotionType>( Source.RootMotion );
+		Animation.Type = static_cast<::Animation::AnimationType>( Source.Type );
+
+		const Key* First = Keys.data() + Source.FirstKey;
+		Animation.PositionKeys = FixedVector<Key>( Source.PositionKeys );
+		Animation.RotationKeys = FixedVector<Key>( Source.RotationKeys );
+		Animation.ScalingKeys = FixedVector<Key>( Source.ScalingKeys );
+
+		for( uint32_t Index = 0; Index < Source.PositionKeys; Index++ )
+		{
+			Animation.PositionKeys[Index] = *First++;
+		}
+
+		for( uint32_t Index = 0; Index < Source.RotationKeys; Index++ )
+		{
+			Animation.RotationKeys[Index] = *First++;
+		}
+
+		for( uint32_t Index = 0; Index < Source.ScalingKeys; Index++ )
+		{
+			Animation.ScalingKeys[Index] = *First++;
+		}
+
+		const auto Name = Animation.Name;
+		Skeleton.Animations.insert_or_assign( Name, std::move( Animation ) );
+	}
+
+	for( size_t Index = 0; Index + 1 < Lookup.size(); Index += 2 )
+	{
+		std::string Key;
+		std::string Value;
+		if( !ToString( Lookup[Index], Key ) || !ToString( Lookup[Index + 1], Value ) )
+			return false;
+
+		Cooked.Set.insert_or_assign( Key, Value );
+	}
+
+	// The tree section is optional, meshes without it build their tree through TriangleTree::Get when it's needed.
+	const bool RestoreTree = Sections[ECookedSection::Nodes].Count > 0 && UsesTriangleCollisions();
+
+	std::vector<TriangleTree::Node> Nodes;
+	std::vector<TriangleTree::Leaf> Leaves;
+	if( RestoreTree )
+	{
+		Nodes.resize( Sections[ECookedSection::Nodes].Count );
+		CopySection( Nodes.data(), Data, Header, ECookedSection::Nodes );
+
+		Leaves.resize( Sections[ECookedSection::Leaves].Count );
+		CopySection( Leaves.data(), Data, Header, ECookedSection::Leaves );
+	}
+
+	// Everything has been validated, hand the buffers over.
+	delete[] Primitive.Vertices;
+	delete[] Primitive.Indices;
+
+	Primitive.VertexCount = static_cast<uint32_t>( Sections[ECookedSection::Vertices].Count );
+	Primitive.Vertices = new ComplexVertex[Primitive.VertexCount];
+	CopySection( Primitive.Vertices, Data, Header, ECookedSection::Vertices );
+
+	Primitive.IndexCount = static_cast<uint32_t>( Sections[ECookedSection::Indices].Count );
+	Primitive.Indices = new uint32_t[Primitive.IndexCount];
+	CopySection( Primitive.Indices, Data, Header, ECookedSection::Indices );
+
+	Primitive.HasNormals = Header.HasNormals != 0;
+
+	Set = std::move( Cooked );
+	Tree = RestoreTree ? TriangleTree::Restore( Header.TreeBounds, std::move( Nodes ), std::move( Leaves ) ) : nullptr;
+	return true;
+}
+
+bool CookedMesh::Load( const char* Data, const size_t Size, const std::string& Source, FPrimitive& Primitive, AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree )
+{
+	if( !Unpack( Data, Size, Source, Primitive, Set, Tree ) )
+	{
+		Counters.Misses++;
+		return false;
+	}
+
+	Counters.Hits++;
+	return true;
+}
+
+void CookedMesh::SetDirectory( const std::string& Directory )
+{
+	CacheDirectory = Directory;
+}
+
+const std::string& CookedMesh::GetDirectory()
+{
+	return CacheDirectory;
+}
+
+FCookedMeshStatistics& CookedMesh::Statistics()
+{
+	return Counters;
+}
@@ -0,0 +1,151 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Engine/Utility/Math.h>
+
+struct AnimationSet;
+struct FPrimitive;
+struct TriangleTree;
+
+// Sections of a cooked mesh, every section starts on a 16-byte boundary.
+namespace ECookedSection
+{
+	enum Type : uint32_t
+	{
+		Vertices = 0, // ComplexVertex
+		Indices, // uint32_t
+		Nodes, // TriangleTree::Node
+		Leaves, // TriangleTree::Leaf
+		Skeleton, // FCookedSkeleton, absent when the mesh has no bones.
+		Bones, // FCookedBone
+		Children, // int32_t, referenced by the bones.
+		Names, // FCookedString, the names of the skeleton's matrices.
+		Weights, // VertexWeight
+		Animations, // FCookedAnimation
+		Keys, // Key, the position, rotation and scaling keys of each animation.
+		Lookup, // FCookedString pairs, the keys and values of the animation set.
+		Dependencies, // FCookedDependency, the files the mesh was cooked from.
+		Strings, // char, referenced by FCookedString.
+
+		Maximum
+	};
+}
+
+struct FCookedSection
+{
+	uint64_t Offset = 0;
+	uint64_t Count = 0;
+};
+
+struct FCookedString
+{
+	uint32_t Offset = 0;
+	uint32_t Length = 0;
+};
+
+// Modification time and size of a file the mesh was cooked from.
+struct FCookedDependency
+{
+	FCookedString Location;
+	int64_t Time = 0;
+	int64_t Size = -1;
+};
+
+struct alignas( 16 ) FCookedSkeleton
+{
+	int32_t RootIndex = -1;
+	Matrix4D GlobalMatrix;
+	Matrix4D GlobalMatrixInverse;
+};
+
+// Bone without its list of children, those are stored in their own section.
+struct alignas( 16 ) FCookedBone
+{
+	int32_t Index = -1;
+	int32_t ParentIndex = -1;
+	uint32_t FirstChild = 0;
+	uint32_t ChildCount = 0;
+
+	Matrix4D ModelToBone;
+	Matrix4D BoneToModel;
+	Matrix4D BoneTransform;
+	Matrix4D ModelMatrix;
+	Matrix4D InverseModelMatrix;
+	Matrix4D LocalTransform;
+	Matrix4D GlobalTransform;
+};
+
+struct FCookedAnimation
+{
+	FCookedString Name;
+	float Duration = 0.0f;
+	int32_t RootMotion = 0;
+	int32_t Type = 0;
+
+	// The position keys start at the first key, followed by the rotation and scaling keys.
+	uint32_t FirstKey = 0;
+	uint32_t PositionKeys = 0;
+	uint32_t RotationKeys = 0;
+	uint32_t ScalingKeys = 0;
+};
+
+struct alignas( 16 ) FCookedMeshHeader
+{
+	char Identifier[4] = { 'L', 'M', 'C', 'K' };
+	uint32_t Version = 0;
+
+	// Guards against changes to the in-memory layout of the stored types.
+	uint32_t VertexSize = 0;
+	uint32_t LeafSize = 0;
+
+	BoundingBox Bounds;
+	BoundingBox TreeBounds;
+	uint32_t HasNormals = 0;
+	uint32_t TriangleCount = 0;
+
+	FCookedSection Sections[ECookedSection::Maximum];
+
+	// Size of the whole file, including the header.
+	uint64_t Size = 0;
+};
+
+// Meshes are loaded from multiple threads.
+struct FCookedMeshStatistics
+{
+	std::atomic<int64_t> Hits{ 0 };
+	std::atomic<int64_t> Misses{ 0 };
+	std::atomic<int64_t> Cooked{ 0 };
+};
+
+// Binary mesh format that stores the buffers exactly as they are laid out in memory.
+// Loading reads the file in one go and copies the sections out, nothing is parsed per vertex.
+namespace CookedMesh
+{
+	constexpr uint32_t Version = 2;
+
+	// Location of the cooked version of a named mesh.
+	std::string GetLocation( const std::string& Name );
+
+	// Writes the primitive, the animation set and the collision tree to the given location.
+	// The tree is built when it is empty and triangle collisions are enabled, it's left out otherwise.
+	// Every file that was read to produce the mesh has to be listed in the sources.
+	bool Cook( const std::string& Location, const std::vector<std::string>& Sources, const FPrimitive& Primitive, const AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree );
+
+	// Fails when the file is missing, was cooked by a different version, wasn't cooked from the source or when any of its sources has changed since.
+	// Pass an empty source to skip the source checks. The tree is only restored when triangle collisions are enabled.
+	bool Load( const std::string& Location, const std::string& Source, FPrimitive& Primitive, AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree );
+
+	// Same as above, for a file that has already been read into memory.
+	bool Load( const char* Data, const size_t Size, const std::string& Source, FPrimitive& Primitive, AnimationSet& Set, std::shared_ptr<TriangleTree>& Tree );
+
+	void SetDirectory( const std::string& Directory );
+	const std::string& GetDirectory();
+
+	FCookedMeshStatistics& Statistics();
+}
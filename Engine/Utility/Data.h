@@ -1,7 +1,13 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #pragma once
 
-#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 #include <Engine/Profiling/Logging.h>
 
 // Reverses the byte order. (little endian <-> big endian)
@@ -24,66 +30,366 @@ T Swap( const T& Input )
 	return Destination.Data;
 }
 
-class CData
+// Values that can be copied as raw bytes.
+// The math types define their own assignment operators, which only copy their members, so they don't count as trivially copyable.
+template<typename T>
+struct IsPlainData : std::integral_constant<bool, std::is_standard_layout<T>::value && !std::is_pointer<T>::value>
+{
+};
+
+// Nested blocks are rarely this large, the size is probably corrupt.
+static const uint32_t MaximumBlockSize = 1073741824;
+
+class CData;
+
+// Bounds-checked reading cursor over a buffer that is owned by someone else, nothing is copied until it is read.
+class CDataView
 {
 public:
-	CData()
+	CDataView() = default;
+	CDataView( const char* Data, const size_t Size )
+	{
+		Begin = Data;
+		Length = Data ? Size : 0;
+	}
+
+	// Copies the next bytes, fails without moving the cursor when there aren't enough left.
+	bool ReadBytes( void* Destination, const size_t Size )
+	{
+		if( Invalid || Size > Length - Cursor )
+			return false;
+
+		if( Size > 0 )
+		{
+			std::memcpy( Destination, Begin + Cursor, Size );
+		}
+
+		Cursor += Size;
+		return true;
+	}
+
+	template<typename T>
+	bool Read( T& Object )
 	{
-		Invalid = false;
+		static_assert( IsPlainData<T>::value, "Only plain values can be read directly." );
+		return ReadBytes( &Object, sizeof( T ) );
 	}
 
+	// Reads an array of plain values in one go.
 	template<typename T>
-	void operator<<( T& Object )
+	bool Read( T* Array, const size_t Count )
 	{
-		static_assert( !std::is_pointer<T>::value, "Pointers can not be serialized." );
-		const uint32_t Size = sizeof( T );
-		Data.write( reinterpret_cast<const char*>( &Object ), Size );
+		static_assert( IsPlainData<T>::value, "Only plain values can be read directly." );
+		if( Count > ( Length - Cursor ) / sizeof( T ) )
+			return false;
+
+		return ReadBytes( Array, Count * sizeof( T ) );
+	}
+
+	// Reads a null-terminated string.
+	bool ReadString( std::string& Object )
+	{
+		if( Invalid )
+			return false;
+
+		const void* Terminator = std::memchr( Begin + Cursor, '\0', Length - Cursor );
+		if( !Terminator )
+			return false;
+
+		const size_t Size = static_cast<const char*>( Terminator ) - ( Begin + Cursor );
+		Object.assign( Begin + Cursor, Size );
+		Cursor += Size + 1;
+		return true;
+	}
 
-		if( !Data.good() )
+	// Returns the next bytes without copying them, null when there aren't enough left.
+	const char* Borrow( const size_t Size )
+	{
+		if( Invalid || Size > Length - Cursor )
+			return nullptr;
+
+		const char* Result = Begin + Cursor;
+		Cursor += Size;
+		return Result;
+	}
+
+	template<typename T>
+	uint32_t operator>>( T& Object )
+	{
+		if( !Read( Object ) )
 		{
-			Log::Event( Log::Error, "Could not write data.\n" );
+			if( !Invalid )
+			{
+				Log::Event( Log::Warning, "Could not extract data view to object.\n" );
+			}
+
+			return 0;
 		}
+
+		return sizeof( T );
 	}
 
-	void operator<<( const char* Object )
+	void operator>>( char* Object )
 	{
-		const uint32_t Size = strlen( Object ) * sizeof( char );
-		Data.write( Object, Size + 1 );
+		if( Invalid )
+			return;
 
-		static const uint32_t MaximumSize = 1073741824;
-		if( Size > MaximumSize )
+		const void* Terminator = std::memchr( Begin + Cursor, '\0', Length - Cursor );
+		if( !Terminator )
 		{
-			Log::Event( Log::Warning, "Stored object is rather large.\n" );
+			Log::Event( Log::Error, "Could not extract data view to character array.\n" );
+			return;
 		}
 
-		if( !Data.good() )
+		const size_t Size = static_cast<const char*>( Terminator ) - ( Begin + Cursor ) + 1;
+		std::memcpy( Object, Begin + Cursor, Size );
+		Cursor += Size;
+	}
+
+	// Nested blocks are borrowed from this view.
+	void operator>>( CDataView& Object )
+	{
+		uint32_t Size = 0;
+		const char* Block = Read( Size ) ? Borrow( Size ) : nullptr;
+		if( !Block )
 		{
-			Log::Event( Log::Error, "Could not write string data.\n" );
+			Object.Invalidate();
+			Invalidate();
+			return;
 		}
+
+		Object = CDataView( Block, Size );
 	}
 
-	void operator<<( CData& Object )
+	inline void operator>>( CData& Object );
+
+	// Moves the reading cursor to the start of the data.
+	void ReadToStart()
+	{
+		Cursor = 0;
+	}
+
+	// Moves the reading cursor to the end of the data.
+	void ReadToEnd()
+	{
+		Cursor = Length;
+	}
+
+	void Jump( const int32_t Offset )
+	{
+		ReadPosition( static_cast<int32_t>( Cursor ) + Offset );
+	}
+
+	size_t ReadPosition() const
+	{
+		return Cursor;
+	}
+
+	void ReadPosition( const int32_t Position )
+	{
+		Cursor = Position < 0 ? 0 : std::min( static_cast<size_t>( Position ), Length );
+	}
+
+	const char* Data() const
+	{
+		return Begin;
+	}
+
+	size_t Size() const
+	{
+		return Length;
+	}
+
+	size_t Remaining() const
+	{
+		return Length - Cursor;
+	}
+
+	bool Valid() const
+	{
+		return !Invalid;
+	}
+
+	void Invalidate()
 	{
-		const uint32_t Size = Object.Size();
-		Data.write( reinterpret_cast<const char*>( &Size ), sizeof( uint32_t ) );
+		Invalid = true;
+		BreakDebugger();
+	}
+
+private:
+	const char* Begin = nullptr;
+	size_t Length = 0;
+	size_t Cursor = 0;
+	bool Invalid = false;
+};
 
-		static const uint32_t MaximumSize = 1073741824;
-		if( Size > MaximumSize )
+// Growable byte buffer, writes past the end append to it.
+class CDataWriter
+{
+public:
+	void WriteBytes( const void* Source, const size_t Size )
+	{
+		const char* Bytes = static_cast<const char*>( Source );
+		if( Cursor == Buffer.size() )
 		{
-			Log::Event( Log::Warning, "Stored object is rather large.\n" );
+			Buffer.insert( Buffer.end(), Bytes, Bytes + Size );
+		}
+		else
+		{
+			// Overwrite what is already there after the cursor has been moved back.
+			if( Cursor + Size > Buffer.size() )
+			{
+				Buffer.resize( Cursor + Size );
+			}
+
+			std::memcpy( Buffer.data() + Cursor, Bytes, Size );
 		}
 
-		if( !Data.good() )
+		Cursor += Size;
+	}
+
+	template<typename T>
+	void Write( const T& Object )
+	{
+		static_assert( IsPlainData<T>::value, "Only plain values can be written directly." );
+		WriteBytes( &Object, sizeof( T ) );
+	}
+
+	// Writes an array of plain values in one go.
+	template<typename T>
+	void Write( const T* Array, const size_t Count )
+	{
+		static_assert( IsPlainData<T>::value, "Only plain values can be written directly." );
+		WriteBytes( Array, Count * sizeof( T ) );
+	}
+
+	// Writes a null-terminated string.
+	void WriteString( const char* Object )
+	{
+		WriteBytes( Object, std::strlen( Object ) + 1 );
+	}
+
+	template<typename T>
+	void operator<<( const T& Object )
+	{
+		Write( Object );
+	}
+
+	void operator<<( const char* Object )
+	{
+		WriteString( Object );
+	}
+
+	// Writes a nested block, prefixed by its size.
+	void operator<<( const CDataWriter& Object )
+	{
+		WriteBlock( Object.Data(), Object.Size() );
+	}
+
+	void operator<<( const CDataView& Object )
+	{
+		WriteBlock( Object.Data(), Object.Size() );
+	}
+
+	void WriteBlock( const char* Data, const size_t Size )
+	{
+		if( Size > MaximumBlockSize )
 		{
-			Log::Event( Log::Error, "Could not write CData size.\n" );
+			Log::Event( Log::Warning, "Stored object is rather large.\n" );
 		}
 
-		Data.write( Object.Data.str().c_str(), Object.Size() );
+		Write( static_cast<uint32_t>( Size ) );
+		WriteBytes( Data, Size );
+	}
+
+	void Reserve( const size_t Size )
+	{
+		Buffer.reserve( Size );
+	}
+
+	void Clear()
+	{
+		Buffer.clear();
+		Cursor = 0;
+	}
+
+	// Moves the writing cursor to the start of the data.
+	void WriteToStart()
+	{
+		Cursor = 0;
+	}
+
+	// Moves the writing cursor to the end of the data.
+	void WriteToEnd()
+	{
+		Cursor = Buffer.size();
+	}
+
+	size_t WritePosition() const
+	{
+		return Cursor;
+	}
+
+	void WritePosition( const int32_t Position )
+	{
+		Cursor = Position < 0 ? 0 : std::min( static_cast<size_t>( Position ), Buffer.size() );
+	}
+
+	const char* Data() const
+	{
+		return Buffer.data();
+	}
+
+	size_t Size() const
+	{
+		return Buffer.size();
+	}
+
+	// The view is invalidated by the next write.
+	CDataView View() const
+	{
+		return CDataView( Buffer.data(), Buffer.size() );
+	}
+
+private:
+	std::vector<char> Buffer;
+	size_t Cursor = 0;
+};
+
+// Buffer that can be written to and read from, used by most of the serialization code.
+class CData
+{
+public:
+	CData() = default;
+
+	template<typename T>
+	void operator<<( T& Object )
+	{
+		static_assert( !std::is_pointer<T>::value, "Pointers can not be serialized." );
+		Writer.WriteBytes( &Object, sizeof( T ) );
+	}
 
-		if( !Data.good() )
+	void operator<<( const char* Object )
+	{
+		const size_t Size = strlen( Object ) * sizeof( char );
+		if( Size > MaximumBlockSize )
 		{
-			Log::Event( Log::Error, "Could not write CData data.\n" );
+			Log::Event( Log::Warning, "Stored object is rather large.\n" );
 		}
+
+		Writer.WriteBytes( Object, Size + 1 );
+	}
+
+	void operator<<( CData& Object )
+	{
+		Writer.WriteBlock( Object.Writer.Data(), Object.Writer.Size() );
+	}
+
+	// Writes an array of plain values in one go.
+	template<typename T>
+	void Write( const T* Array, const size_t Count )
+	{
+		Writer.Write( Array, Count );
 	}
 
 	template<typename T>
@@ -94,18 +400,9 @@ public:
 
 		static_assert( !std::is_pointer<T>::value, "Pointers can not be deserialized." );
 		const uint32_t Size = sizeof( T );
-
-		const auto Position = Data.tellg();
-		Data.read( reinterpret_cast<char*>( &Object ), Size );
-		
-		if( !Data.good() )
+		if( !ReadBytes( &Object, Size ) )
 		{
-			// Reset the position.
-			Data.clear();
-			Data.seekg( Position );
-
 			Log::Event( Log::Warning, "Could not extract data stream to object.\n" );
-
 			return 0;
 		}
 
@@ -117,21 +414,9 @@ public:
 		if( Invalid )
 			return;
 
-		const auto Position = Data.tellg();		
-		do
-		{
-			Data.read( Object, sizeof( char ) );
-			Object++;
-		} while( Object[-1] != '\0' );
-
-		if( !Data.good() )
-		{
-			// Reset the position.
-			Data.clear();
-			Data.seekg( Position );
-
-			Log::Event( Log::Error, "Could not extract data stream to character array.\n" );
-		}
+		auto View = Unread();
+		View >> Object;
+		ReadCursor += View.ReadPosition();
 	}
 
 	void operator>>( CData& Object )
@@ -140,94 +425,135 @@ public:
 			return;
 
 		uint32_t Size = 0;
-		Data.read( reinterpret_cast<char*>( &Size ), sizeof( uint32_t ) );
-		// Data >> Size;
+		if( !ReadBytes( &Size, sizeof( uint32_t ) ) )
+		{
+			Object.Invalidate();
+			Invalidate();
+			return;
+		}
 
 		// Warn when the size is rather large.
-		static const uint32_t MaximumSize = 1073741824;
-		if( Size > MaximumSize )
+		if( Size > MaximumBlockSize )
 		{
 			Log::Event( Log::Warning, "Extracted object is rather large.\n" );
 		}
 
-		char* Stream = new char[Size];
-		Data.read( Stream, Size );
-		Object.Data.write( Stream, Size );
-
-		if( !Data.good() )
+		if( Size > Writer.Size() - ReadCursor )
 		{
 			Object.Invalidate();
 			Invalidate();
+			return;
 		}
+
+		Object.Writer.WriteBytes( Writer.Data() + ReadCursor, Size );
+		ReadCursor += Size;
+	}
+
+	// Reads an array of plain values in one go.
+	template<typename T>
+	bool Read( T* Array, const size_t Count )
+	{
+		if( Invalid )
+			return false;
+
+		auto View = Unread();
+		if( !View.Read( Array, Count ) )
+			return false;
+
+		ReadCursor += View.ReadPosition();
+		return true;
+	}
+
+	// Reads a null-terminated string.
+	bool ReadString( std::string& Object )
+	{
+		if( Invalid )
+			return false;
+
+		auto View = Unread();
+		if( !View.ReadString( Object ) )
+			return false;
+
+		ReadCursor += View.ReadPosition();
+		return true;
 	}
 
 	void Store( char* Buffer, const size_t Size )
 	{
 		ReadToStart();
-		Data.read( Buffer, Size );
+		ReadBytes( Buffer, std::min( Size, Writer.Size() ) );
 	}
 
 	void Load( const char* Buffer, const size_t Size )
 	{
-		Data = std::stringstream();
-		Data.write( Buffer, Size );
+		Writer.Clear();
+		Writer.WriteBytes( Buffer, Size );
 		ReadToStart();
 	}
 
+	// View of the data that hasn't been read yet, it is invalidated by the next write.
+	CDataView Unread() const
+	{
+		return CDataView( Writer.Data() + ReadCursor, Writer.Size() - ReadCursor );
+	}
+
 	// Moves the reading cursor to the start of the data.
 	void ReadToStart()
 	{
-		Data.seekg( std::ios::beg );
+		ReadCursor = 0;
 	}
 
 	// Moves the reading cursor to the end of the data.
 	void ReadToEnd()
 	{
-		Data.seekg( Size() );
+		ReadCursor = Writer.Size();
 	}
 
 	// Moves the writing cursor to the start of the data.
 	void WriteToStart()
 	{
-		Data.seekp( std::ios::beg );
+		Writer.WriteToStart();
 	}
 
 	// Moves the writing cursor to the end of the data.
 	void WriteToEnd()
 	{
-		Data.seekp( Size() );
+		Writer.WriteToEnd();
 	}
 
 	void Jump( const int32_t Offset )
 	{
-		Data.seekg( Offset, std::ios::cur );
+		ReadPosition( static_cast<int32_t>( ReadCursor ) + Offset );
 	}
 
-	std::basic_stringstream<char>::pos_type WritePosition()
+	size_t WritePosition() const
 	{
-		return Data.tellp();
+		return Writer.WritePosition();
 	}
 
 	void WritePosition( const int32_t Position )
 	{
-		Data.clear();
-		Data.seekp( Position );
+		Writer.WritePosition( Position );
 	}
 
-	std::basic_stringstream<char>::pos_type ReadPosition()
+	size_t ReadPosition() const
 	{
-		return Data.tellg();
+		return ReadCursor;
 	}
 
 	void ReadPosition( const int32_t Position )
 	{
-		Data.clear();
-		Data.seekg( Position );
+		ReadCursor = Position < 0 ? 0 : std::min( static_cast<size_t>( Position ), Writer.Size() );
+	}
+
+	size_t Size() const
+	{
+		return Writer.Size();
 	}
 
-	size_t Size()
+	const char* Data() const
 	{
-		return Data.tellp();
+		return Writer.Data();
 	}
 
 	bool Valid() const
@@ -244,7 +570,36 @@ public:
 	}
 
 private:
-	std::stringstream Data;
+	bool ReadBytes( void* Destination, const size_t Size )
+	{
+		if( Size > Writer.Size() - ReadCursor )
+			return false;
+
+		if( Size > 0 )
+		{
+			std::memcpy( Destination, Writer.Data() + ReadCursor, Size );
+		}
+
+		ReadCursor += Size;
+		return true;
+	}
 
-	bool Invalid;
+	CDataWriter Writer;
+	size_t ReadCursor = 0;
+	bool Invalid = false;
 };
+
+// Copies a nested block into the given data.
+void CDataView::operator>>( CData& Object )
+{
+	CDataView Block;
+	*this >> Block;
+	if( Block.Valid() )
+	{
+		Object.Write( Block.Data(), Block.Size() );
+	}
+	else
+	{
+		Object.Invalidate();
+	}
+}
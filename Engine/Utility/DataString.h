@@ -4,9 +4,11 @@
 #include "Data.h"
 #include <string>
 
+// The helpers below work on CData as well as on CDataWriter and CDataView.
 struct DataMarker
 {
-	static void Mark( CData& Data, const char* Identifier )
+	template<typename DataType>
+	static void Mark( DataType& Data, const char* Identifier )
 	{
 		const size_t Length = std::strlen( Identifier );
 		for( size_t Index = 0; Index < Length; Index++ )
@@ -15,7 +17,8 @@ struct DataMarker
 		}
 	}
 
-	static bool Check( CData& Data, const char* Identifier )
+	template<typename DataType>
+	static bool Check( DataType& Data, const char* Identifier )
 	{
 		const auto ReadPosition = Data.ReadPosition();
 		const size_t Length = std::strlen( Identifier );
@@ -92,27 +95,40 @@ struct DataString
 		return Data;
 	}
 
-	static void Encode( CData& Data, const std::string& Object )
+	// Writes the same bytes as the stream operator without making a copy of the string.
+	template<typename DataType>
+	static void Encode( DataType& Data, const std::string& Object )
 	{
-		Data << DataString( Object );
+		const uint32_t Size = static_cast<uint32_t>( Object.size() );
+		Data << Size;
+		Data << Object.c_str();
 	}
 
-	static void Decode( CData& Data, std::string& Object )
+	template<typename DataType>
+	static void Decode( DataType& Data, std::string& Object )
 	{
-		DataString DataString;
-		Data >> DataString;
+		uint32_t Size = 0;
+		if( ( Data >> Size ) == 0 )
+			return;
 
-		if( Data.Valid() && DataString.Address )
+		std::string String;
+		if( !Data.ReadString( String ) )
 		{
-			Object = DataString.Address;
+			Log::Event( Log::Error, "Could not extract data stream to string.\n" );
+			return;
+		}
+
+		if( Data.Valid() )
+		{
+			Object = std::move( String );
 		}
 	}
 };
 
 struct DataVector
 {
-	template<typename T>
-	static void Encode( CData& Data, const std::vector<T>& Vector )
+	template<typename DataType, typename T>
+	static void Encode( DataType& Data, const std::vector<T>& Vector )
 	{
 		const uint32_t Count = static_cast<uint32_t>( Vector.size() );
 		Data << Count;
@@ -123,8 +139,8 @@ struct DataVector
 		}
 	}
 
-	template<typename T>
-	static void Decode( CData& Data, std::vector<T>& Vector )
+	template<typename DataType, typename T>
+	static void Decode( DataType& Data, std::vector<T>& Vector )
 	{
 		uint32_t ItemCount;
 		Data >> ItemCount;
@@ -132,7 +148,7 @@ struct DataVector
 		Vector.reserve( ItemCount );
 		for( uint32_t Index = 0; Index < ItemCount; Index++ )
 		{
-			typedef std::remove_pointer<T>::type U;
+			typedef typename std::remove_pointer<T>::type U;
 			U Item = U();
 			Data >> Item;
 			Vector.emplace_back( Item );
@@ -2,6 +2,7 @@
 #pragma warning( disable:4996 ) // Disable std::basic_string::copy warning.
 
 #include "File.h"
+#include <Engine/Configuration/Configuration.h>
 #include <Engine/Profiling/Logging.h>
 #include <Engine/Utility/Math.h>
 
@@ -9,9 +10,13 @@
 #include <fstream>
 #include <algorithm>
 
+// Size in megabytes above which files are streamed in chunks instead of being mapped.
+ConfigurationVariable<int> StreamLimit( "file.StreamLimit", 256 );
+
 CFile::CFile( const std::string& FileLocationIn )
 {
 	Data = nullptr;
+	FileSize = 0;
 	FileLocation = FileLocationIn;
 	Binary = false;
 
@@ -40,6 +45,28 @@ CFile::~CFile()
 	}
 }
 
+CFile::CFile( CFile&& File ) : CFile( File.FileLocation )
+{
+	*this = std::move( File );
+}
+
+CFile& CFile::operator=( CFile&& File )
+{
+	if( this != &File )
+	{
+		std::swap( Data, File.Data );
+		std::swap( Mapping, File.Mapping );
+		std::swap( FileSize, File.FileSize );
+		std::swap( FileLocation, File.FileLocation );
+		std::swap( FileExtension, File.FileExtension );
+		std::swap( FileLocationStripped, File.FileLocationStripped );
+		std::swap( Binary, File.Binary );
+		std::swap( Statistics, File.Statistics );
+	}
+
+	return *this;
+}
+
 bool CFile::Load( bool InBinary )
 {
 	if( Data )
@@ -48,6 +75,8 @@ bool CFile::Load( bool InBinary )
 		Data = nullptr;
 	}
 
+	Mapping.Close();
+
 	if( !Exists() )
 	{
 		Log::Event( Log::Warning, "File does not exist \"%s\"\n", FileLocation.c_str() );
@@ -110,6 +139,8 @@ bool CFile::Load( char* DataSource, const size_t SizeIn )
 		Data = nullptr;
 	}
 
+	Mapping.Close();
+
 	Binary = true;
 	Data = DataSource;
 	FileSize = SizeIn;
@@ -125,6 +156,8 @@ bool CFile::Load( const std::string& DataIn )
 		Data = nullptr;
 	}
 
+	Mapping.Close();
+
 	const size_t Characters = DataIn.length();
 
 	Binary = false;
@@ -148,6 +181,66 @@ bool CFile::Load( CData& Data )
 	return Load( Buffer, Size );
 }
 
+bool CFile::Map()
+{
+	if( Data )
+	{
+		delete[] Data;
+		Data = nullptr;
+	}
+
+	Binary = true;
+	FileSize = 0;
+
+	if( !Mapping.Open( FileLocation ) )
+	{
+		Log::Event( Log::Warning, "Failed to map file \"%s\".\n", FileLocation.c_str() );
+		return false;
+	}
+
+	FileSize = Mapping.Size();
+	stat( FileLocation.c_str(), &Statistics );
+
+	return true;
+}
+
+bool CFile::Stream( const std::function<bool( const CDataView& )>& Callback ) const
+{
+	struct stat Buffer;
+	if( stat( FileLocation.c_str(), &Buffer ) != 0 )
+	{
+		Log::Event( Log::Warning, "File does not exist \"%s\"\n", FileLocation.c_str() );
+		return false;
+	}
+
+	const auto Limit = static_cast<size_t>( std::max( StreamLimit.Get(), 0 ) ) * 1024 * 1024;
+	if( static_cast<size_t>( Buffer.st_size ) <= Limit )
+	{
+		CMappedFile File;
+		if( !File.Open( FileLocation ) )
+			return false;
+
+		Callback( File.View() );
+		return true;
+	}
+
+	CFileStream File;
+	if( !File.Open( FileLocation ) )
+	{
+		Log::Event( Log::Warning, "Failed to stream file \"%s\".\n", FileLocation.c_str() );
+		return false;
+	}
+
+	CDataView Chunk;
+	while( File.Next( Chunk ) )
+	{
+		if( !Callback( Chunk ) )
+			break;
+	}
+
+	return true;
+}
+
 bool CFile::Save( const bool& CreateDirectory )
 {
 	if( Data )
@@ -196,6 +289,13 @@ bool CFile::Save( const bool& CreateDirectory )
 
 void CFile::Delete( const bool& DeleteFromMemory )
 {
+	// Mapped files can't be removed on every platform.
+	if( Mapping.IsOpen() )
+	{
+		Mapping.Close();
+		FileSize = 0;
+	}
+
 	if( Exists() )
 	{
 		std::experimental::filesystem::remove( FileLocation );
@@ -1,10 +1,12 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #pragma once
 
+#include <functional>
 #include <string>
 
 #include <Engine/Profiling/Logging.h>
 #include <Engine/Utility/Data.h>
+#include <Engine/Utility/MappedFile.h>
 
 class CFile
 {
@@ -12,17 +14,41 @@ public:
 	CFile( const std::string& FileLocation );
 	~CFile();
 
+	// Files own their data, they can be moved but not copied.
+	CFile( CFile&& File );
+	CFile& operator=( CFile&& File );
+
 	bool Load( bool Binary = false );
 	bool Load( char* DataSource, const size_t SizeIn );
 	bool Load( const std::string& Data );
 	bool Load( CData& Data );
+
+	// Maps the file into memory instead of copying it, the contents are read-only and can't be saved.
+	bool Map();
+
+	// Passes the contents to the callback without loading them into the file.
+	// Files larger than file.StreamLimit are read in chunks, smaller files are mapped and passed in one go.
+	// Stops when the callback returns false.
+	bool Stream( const std::function<bool( const CDataView& )>& Callback ) const;
+
 	bool Save( const bool& CreateDirectory = false );
 
 	// Deletes the file from disk and by default also from memory.
 	void Delete( const bool& DeleteFromMemory = true );
 
 	template<typename T>
-	const T* Fetch() const { return reinterpret_cast<T*>( Data ); };
+	const T* Fetch() const { return reinterpret_cast<const T*>( Mapping.IsOpen() ? Mapping.Data() : Data ); };
+
+	// Reads the contents without copying them.
+	CDataView View() const
+	{
+		return CDataView( Fetch<char>(), Size() );
+	}
+
+	bool IsMapped() const
+	{
+		return Mapping.IsOpen();
+	}
 
 	bool Exists() const;
 	static bool Exists( const char* FileLocation );
@@ -74,6 +100,7 @@ public:
 
 private:
 	char* Data;
+	CMappedFile Mapping;
 	size_t FileSize;
 	std::string FileLocation;
 	std::string FileExtension;
@@ -0,0 +1,57 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// FNV-1a, the compile-time and runtime variants produce the same values.
+namespace FNV
+{
+	constexpr uint32_t Seed32 = 2166136261u;
+	constexpr uint32_t Prime32 = 16777619u;
+
+	constexpr uint64_t Seed64 = 14695981039346656037ull;
+	constexpr uint64_t Prime64 = 1099511628211ull;
+
+	// Null-terminated strings, written recursively so that they can be evaluated at compile time.
+	constexpr uint32_t String32( const char* String, const uint32_t Hash = Seed32 )
+	{
+		return *String == '\0' ? Hash : String32( String + 1, ( Hash ^ static_cast<uint8_t>( *String ) ) * Prime32 );
+	}
+
+	constexpr uint64_t String64( const char* String, const uint64_t Hash = Seed64 )
+	{
+		return *String == '\0' ? Hash : String64( String + 1, ( Hash ^ static_cast<uint8_t>( *String ) ) * Prime64 );
+	}
+
+	// Runtime variants, pass the previous result as the seed to hash several blocks as one.
+	inline uint32_t Bytes32( const void* Data, const size_t Size, const uint32_t Seed = Seed32 )
+	{
+		const auto* Bytes = static_cast<const uint8_t*>( Data );
+		uint32_t Hash = Seed;
+		for( size_t Index = 0; Index < Size; Index++ )
+		{
+			Hash = ( Hash ^ Bytes[Index] ) * Prime32;
+		}
+
+		return Hash;
+	}
+
+	inline uint64_t Bytes64( const void* Data, const size_t Size, const uint64_t Seed = Seed64 )
+	{
+		const auto* Bytes = static_cast<const uint8_t*>( Data );
+		uint64_t Hash = Seed;
+		for( size_t Index = 0; Index < Size; Index++ )
+		{
+			Hash = ( Hash ^ Bytes[Index] ) * Prime64;
+		}
+
+		return Hash;
+	}
+
+	inline uint64_t Bytes64( const std::string& String, const uint64_t Seed = Seed64 )
+	{
+		return Bytes64( String.data(), String.size(), Seed );
+	}
+}
@@ -0,0 +1,434 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Profiling/Profiling.h>
+#include <Engine/Utility/Thread.h>
+
+using namespace JobSystem;
+
+constexpr size_t JobPoolMask = JobPoolSize - 1;
+static_assert( ( JobPoolSize & JobPoolMask ) == 0, "Job pool size must be a power of two." );
+
+// Amount of times a worker looks for work before going to sleep.
+constexpr size_t IdleSpinCount = 64;
+
+// Chase-Lev work-stealing deque.
+// The owning thread pushes and pops at the bottom, other threads steal from the top.
+class WorkStealingQueue
+{
+public:
+	WorkStealingQueue()
+	{
+		for( auto& Entry : Entries )
+		{
+			Entry.store( nullptr, std::memory_order_relaxed );
+		}
+	}
+
+	// Only call this from the owning thread. Returns false when the queue is full.
+	bool Push( Job* ToPush )
+	{
+		const int64_t BottomIndex = Bottom.load( std::memory_order_relaxed );
+		const int64_t TopIndex = Top.load( std::memory_order_acquire );
+		if( BottomIndex - TopIndex >= static_cast<int64_t>( JobPoolSize ) )
+			return false;
+
+		Entries[BottomIndex & JobPoolMask].store( ToPush, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		Bottom.store( BottomIndex + 1, std::memory_order_relaxed );
+		return true;
+	}
+
+	// Only call this from the owning thread.
+	Job* Pop()
+	{
+		const int64_t BottomIndex = Bottom.load( std::memory_order_relaxed ) - 1;
+		Bottom.store( BottomIndex, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		int64_t TopIndex = Top.load( std::memory_order_relaxed );
+
+		if( TopIndex > BottomIndex )
+		{
+			// The queue is empty.
+			Bottom.store( BottomIndex + 1, std::memory_order_relaxed );
+			return nullptr;
+		}
+
+		Job* Result = Entries[BottomIndex & JobPoolMask].load( std::memory_order_relaxed );
+		if( TopIndex == BottomIndex )
+		{
+			// This is the last entry, race the thieves for it.
+			if( !Top.compare_exchange_strong( TopIndex, TopIndex + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+			{
+				Result = nullptr;
+			}
+
+			Bottom.store( BottomIndex + 1, std::memory_order_relaxed );
+		}
+
+		return Result;
+	}
+
+	// Can be called from any thread.
+	Job* Steal()
+	{
+		int64_t TopIndex = Top.load( std::memory_order_acquire );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		const int64_t BottomIndex = Bottom.load( std::memory_order_acquire );
+
+		if( TopIndex >= BottomIndex )
+			return nullptr;
+
+		Job* Result = Entries[TopIndex & JobPoolMask].load( std::memory_order_relaxed );
+		if( !Top.compare_exchange_strong( TopIndex, TopIndex + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+			return nullptr; // Another thread got to it first.
+
+		return Result;
+	}
+
+private:
+	alignas( 64 ) std::atomic<int64_t> Top{ 0 };
+	alignas( 64 ) std::atomic<int64_t> Bottom{ 0 };
+	std::atomic<Job*> Entries[JobPoolSize];
+};
+
+struct JobPool
+{
+	Job Jobs[JobPoolSize];
+	size_t Allocated = 0;
+};
+
+struct JobWorker
+{
+	WorkStealingQueue Queue;
+	JobPool Pool;
+	std::thread Thread;
+};
+
+static std::vector<std::unique_ptr<JobWorker>> Workers;
+static std::atomic<bool> Alive{ false };
+
+// Jobs that are scheduled by threads that aren't part of the job system. (loading thread etc.)
+static std::deque<Job*> SharedQueue;
+static std::mutex SharedMutex;
+static std::unique_ptr<JobPool> SharedPool;
+static std::atomic<size_t> SharedAllocated{ 0 };
+
+// Used to put idle workers to sleep.
+static std::atomic<int32_t> Pending{ 0 };
+static std::mutex SleepMutex;
+static std::condition_variable SleepNotify;
+
+// Index into the worker array, -1 for threads that aren't managed by the job system.
+static thread_local int32_t WorkerIndex = -1;
+static thread_local uint32_t StealSeed = 0;
+
+uint32_t NextVictim()
+{
+	// Xorshift, we just need some variation in the victims.
+	uint32_t State = StealSeed ? StealSeed : static_cast<uint32_t>( std::hash<std::thread::id>()( std::this_thread::get_id() ) ) | 1;
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	StealSeed = State;
+	return State;
+}
+
+Job* FetchShared()
+{
+	std::unique_lock<std::mutex> Lock( SharedMutex, std::try_to_lock );
+	if( !Lock.owns_lock() || SharedQueue.empty() )
+		return nullptr;
+
+	Job* Result = SharedQueue.front();
+	SharedQueue.pop_front();
+	return Result;
+}
+
+Job* Steal()
+{
+	const size_t WorkerCount = Workers.size();
+	if( WorkerCount == 0 )
+		return nullptr;
+
+	// Start at a random worker and try each of them once.
+	const size_t Offset = NextVictim() % WorkerCount;
+	for( size_t Index = 0; Index < WorkerCount; Index++ )
+	{
+		const size_t Victim = ( Offset + Index ) % WorkerCount;
+		if( static_cast<int32_t>( Victim ) == WorkerIndex )
+			continue;
+
+		if( Job* Stolen = Workers[Victim]->Queue.Steal() )
+			return Stolen;
+	}
+
+	return nullptr;
+}
+
+Job* Fetch()
+{
+	Job* Result = nullptr;
+	if( WorkerIndex >= 0 )
+	{
+		Result = Workers[WorkerIndex]->Queue.Pop();
+	}
+
+	if( !Result )
+	{
+		Result = FetchShared();
+	}
+
+	if( !Result )
+	{
+		Result = Steal();
+	}
+
+	if( Result )
+	{
+		Pending.fetch_sub( 1, std::memory_order_relaxed );
+	}
+
+	return Result;
+}
+
+void Finish( Job* Finished )
+{
+	// The slot can be recycled by another thread as soon as the count reaches zero.
+	Job* Parent = Finished->Parent;
+	const int32_t Remaining = Finished->Unfinished.fetch_sub( 1, std::memory_order_acq_rel ) - 1;
+	if( Remaining == 0 && Parent )
+	{
+		Finish( Parent );
+	}
+}
+
+void Execute( Job* ToExecute )
+{
+	if( ToExecute->Function )
+	{
+		ToExecute->Function( ToExecute );
+	}
+
+	Finish( ToExecute );
+}
+
+void Work( const int32_t Index )
+{
+	WorkerIndex = Index;
+	ProfileThread( "Shatter Engine Job Worker" );
+
+	size_t Idle = 0;
+	while( Alive.load( std::memory_order_relaxed ) )
+	{
+		if( Job* Next = Fetch() )
+		{
+			Execute( Next );
+			Idle = 0;
+			continue;
+		}
+
+		if( ++Idle < IdleSpinCount )
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Nothing to do, wait until new work comes in. The timeout covers missed notifications.
+		std::unique_lock<std::mutex> Lock( SleepMutex );
+		SleepNotify.wait_for( Lock, std::chrono::milliseconds( 1 ), []
+			{
+				return Pending.load( std::memory_order_relaxed ) > 0 || !Alive.load( std::memory_order_relaxed );
+			}
+		);
+
+		Idle = 0;
+	}
+}
+
+void JobSystem::Initialize( const size_t WorkerCount )
+{
+	Shutdown();
+
+	const size_t HardwareThreads = WorkerCount > 0 ? WorkerCount : std::max( 1u, std::thread::hardware_concurrency() );
+
+	SharedPool = std::make_unique<JobPool>();
+	Workers.reserve( HardwareThreads );
+	for( size_t Index = 0; Index < HardwareThreads; Index++ )
+	{
+		Workers.emplace_back( std::make_unique<JobWorker>() );
+	}
+
+	// The initializing thread (main) is worker 0, it executes jobs when it waits.
+	WorkerIndex = 0;
+	Alive = true;
+
+	for( size_t Index = 1; Index < HardwareThreads; Index++ )
+	{
+		auto& Worker = Workers[Index];
+		Worker->Thread = std::thread( Work, static_cast<int32_t>( Index ) );
+		SetThreadName( Worker->Thread, "Job" + std::to_string( Index ) );
+	}
+
+	Log::Event( "Job system started with %zu workers.\n", HardwareThreads );
+}
+
+void JobSystem::Shutdown()
+{
+	if( !Alive )
+		return;
+
+	// Finish any work that is still queued.
+	while( Job* Remaining = Fetch() )
+	{
+		Execute( Remaining );
+	}
+
+	{
+		std::unique_lock<std::mutex> Lock( SleepMutex );
+		Alive = false;
+	}
+
+	SleepNotify.notify_all();
+
+	for( auto& Worker : Workers )
+	{
+		if( Worker->Thread.joinable() )
+		{
+			Worker->Thread.join();
+		}
+	}
+
+	Workers.clear();
+	SharedQueue.clear();
+	SharedPool.reset();
+	WorkerIndex = -1;
+	Pending = 0;
+}
+
+bool JobSystem::IsInitialized()
+{
+	return Alive;
+}
+
+size_t JobSystem::GetWorkerCount()
+{
+	return Workers.empty() ? 1 : Workers.size();
+}
+
+Job* JobSystem::Allocate()
+{
+	Job* Slot = nullptr;
+	if( WorkerIndex >= 0 )
+	{
+		auto& Pool = Workers[WorkerIndex]->Pool;
+		Slot = &Pool.Jobs[Pool.Allocated++ & JobPoolMask];
+	}
+	else
+	{
+		// External threads share one pool.
+		Slot = &SharedPool->Jobs[SharedAllocated.fetch_add( 1, std::memory_order_relaxed ) & JobPoolMask];
+	}
+
+	// The slot is recycled, the job that used it last may still be in flight.
+	if( Slot->Queued.load( std::memory_order_acquire ) )
+	{
+		Wait( Slot );
+		return Slot;
+	}
+
+	if( !IsCompleted( Slot ) )
+	{
+		// The previous job was created but never run, it will never complete. Only its children can still refer to it.
+		Log::Event( Log::Warning, "Recycling a job that was created but never run.\n" );
+		while( Slot->Unfinished.load( std::memory_order_acquire ) > 1 )
+		{
+			if( Job* Next = Fetch() )
+			{
+				Execute( Next );
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	return Slot;
+}
+
+Job* JobSystem::Create()
+{
+	Job* New = Allocate();
+	New->Function = nullptr;
+	New->Parent = nullptr;
+	New->Unfinished.store( 1, std::memory_order_relaxed );
+	New->Queued.store( false, std::memory_order_relaxed );
+	return New;
+}
+
+void JobSystem::Run( Job* ToExecute )
+{
+	if( !ToExecute )
+		return;
+
+	ToExecute->Queued.store( true, std::memory_order_release );
+
+	if( !Alive )
+	{
+		// The job system isn't running, execute the job right away.
+		Execute( ToExecute );
+		return;
+	}
+
+	if( WorkerIndex >= 0 )
+	{
+		if( !Workers[WorkerIndex]->Queue.Push( ToExecute ) )
+		{
+			// The queue is full, just do the work ourselves.
+			Execute( ToExecute );
+			return;
+		}
+	}
+	else
+	{
+		std::unique_lock<std::mutex> Lock( SharedMutex );
+		SharedQueue.emplace_back( ToExecute );
+	}
+
+	Pending.fetch_add( 1, std::memory_order_relaxed );
+	SleepNotify.notify_one();
+}
+
+void JobSystem::Wait( const Job* ToWait )
+{
+	if( !ToWait )
+		return;
+
+	while( !IsCompleted( ToWait ) )
+	{
+		if( Job* Next = Fetch() )
+		{
+			Execute( Next );
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobSystem::IsCompleted( const Job* ToCheck )
+{
+	return ToCheck->Unfinished.load( std::memory_order_acquire ) <= 0;
+}
@@ -0,0 +1,145 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace JobSystem
+{
+	struct Job;
+	typedef void( *JobFunction )( Job* );
+
+	// Pooled unit of work, the callable is stored inside of the job itself.
+	struct alignas( 64 ) Job
+	{
+		JobFunction Function = nullptr;
+
+		// Job that is waiting for this job to finish. (can be null)
+		Job* Parent = nullptr;
+
+		// Counts this job and all of its unfinished children.
+		std::atomic<int32_t> Unfinished{ 0 };
+
+		// Set once the job has been handed to Run, jobs that were created but never run can't complete.
+		std::atomic<bool> Queued{ false };
+
+		static constexpr size_t PayloadSize = 96;
+		alignas( 16 ) unsigned char Payload[PayloadSize];
+	};
+
+	static_assert( sizeof( Job ) == 128, "Jobs are expected to span two cache lines." );
+
+	// Jobs are pooled per thread, this is the amount of jobs a single thread can have in flight.
+	constexpr size_t JobPoolSize = 4096;
+
+	// Spawns one worker per hardware thread unless a worker count is given, the calling thread acts as the first worker.
+	void Initialize( const size_t WorkerCount = 0 );
+	void Shutdown();
+
+	bool IsInitialized();
+
+	// Amount of threads that execute jobs, including the main thread.
+	size_t GetWorkerCount();
+
+	// Fetches a job from the calling thread's pool.
+	// Note: Pools are recycled, when a thread has more than JobPoolSize jobs in flight it waits for the oldest one to finish.
+	Job* Allocate();
+
+	// Schedules the job on the calling thread's queue, other workers may steal it.
+	void Run( Job* ToExecute );
+
+	// Executes other jobs until the given job and all of its children have finished.
+	void Wait( const Job* ToWait );
+
+	bool IsCompleted( const Job* ToCheck );
+
+	// Creates a job that executes the given callable. The parent won't complete until this job has finished.
+	template<typename Callable>
+	Job* Create( Job* Parent, Callable&& Function )
+	{
+		typedef typename std::decay<Callable>::type StoredType;
+		static_assert( sizeof( StoredType ) <= Job::PayloadSize, "Job callable does not fit in the job payload." );
+		static_assert( alignof( StoredType ) <= 16, "Job callable alignment is too strict." );
+
+		Job* New = Allocate();
+		New->Parent = Parent;
+		New->Unfinished.store( 1, std::memory_order_relaxed );
+		New->Queued.store( false, std::memory_order_relaxed );
+		new( New->Payload ) StoredType( std::forward<Callable>( Function ) );
+
+		New->Function = []( Job* Self )
+		{
+			auto* Stored = reinterpret_cast<StoredType*>( Self->Payload );
+			( *Stored )();
+			Stored->~StoredType();
+		};
+
+		if( Parent )
+		{
+			Parent->Unfinished.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		return New;
+	}
+
+	template<typename Callable>
+	Job* Create( Callable&& Function )
+	{
+		return Create( nullptr, std::forward<Callable>( Function ) );
+	}
+
+	// Creates an empty job that can be used to group other jobs.
+	Job* Create();
+
+	/// <summary>
+	/// Splits the range into chunks of Grain iterations and executes them on the workers.
+	/// Blocks until the whole range has been processed, the calling thread helps out while it waits.
+	/// </summary>
+	/// <param name="Count">Size of the range, starting at 0.</param>
+	/// <param name="Grain">Amount of iterations per job. (0 picks a size based on the worker count)</param>
+	/// <param name="Function">Called with the start (inclusive) and end (exclusive) index of each chunk.</param>
+	template<typename Callable>
+	void ParallelFor( const size_t Count, size_t Grain, const Callable& Function )
+	{
+		if( Count == 0 )
+			return;
+
+		if( Grain == 0 )
+		{
+			// Aim for a few chunks per worker so that stealing can balance uneven work.
+			const size_t Chunks = GetWorkerCount() * 4;
+			Grain = ( Count + Chunks - 1 ) / Chunks;
+		}
+
+		// Make sure we don't recycle jobs that haven't finished yet.
+		const size_t MaximumChunks = JobPoolSize / 4;
+		if( Count / Grain > MaximumChunks )
+		{
+			Grain = ( Count + MaximumChunks - 1 ) / MaximumChunks;
+		}
+
+		if( Grain >= Count || !IsInitialized() )
+		{
+			Function( static_cast<size_t>( 0 ), Count );
+			return;
+		}
+
+		Job* Root = Create();
+		for( size_t Start = 0; Start < Count; Start += Grain )
+		{
+			const size_t End = Start + Grain < Count ? Start + Grain : Count;
+			Run( Create( Root, [&Function, Start, End]()
+				{
+					Function( Start, End );
+				}
+			) );
+		}
+
+		Run( Root );
+		Wait( Root );
+	}
+}
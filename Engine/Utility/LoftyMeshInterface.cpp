@@ -43,7 +43,7 @@ void PrintBitString( const T Value )
 	Log::Event( "%s (0x%04x)\n", GetBitString( Value ).c_str(), Value );
 }
 
-bool ValidHeader( CData& Data )
+bool ValidHeader( CDataView& Data )
 {
 	for( uint8_t Offset = 0; Offset < HeaderSize; Offset++ )
 	{
@@ -58,7 +58,7 @@ bool ValidHeader( CData& Data )
 	return true;
 }
 
-bool ExtractMeshData( CData& Data, FPrimitive& Primitive )
+bool ExtractMeshData( CDataView& Data, FPrimitive& Primitive )
 {
 	Data >> Primitive.VertexCount;
 
@@ -129,7 +129,7 @@ bool ExtractMeshData( CData& Data, FPrimitive& Primitive )
 	return true;
 }
 
-Matrix4D ExtractMatrix4D( CData& Data )
+Matrix4D ExtractMatrix4D( CDataView& Data )
 {
 	Matrix4D Matrix;
 	Data >> Matrix[0][0];
@@ -155,7 +155,7 @@ Matrix4D ExtractMatrix4D( CData& Data )
 	return Matrix;
 }
 
-bool ExtractSkeletalData( CData& Data, AnimationSet& Set )
+bool ExtractSkeletalData( CDataView& Data, AnimationSet& Set )
 {
 	uint16_t BoneCount;
 	Data >> BoneCount;
@@ -208,7 +208,7 @@ bool ExtractSkeletalData( CData& Data, AnimationSet& Set )
 	return true;
 }
 
-bool ExtractAnimationData( CData& Data, AnimationSet& Set )
+bool ExtractAnimationData( CDataView& Data, AnimationSet& Set )
 {
 	uint16_t AnimationCount;
 	Data >> AnimationCount;
@@ -286,10 +286,8 @@ bool LoftyMeshInterface::Import( const CFile& File, FPrimitive* Output, Animatio
 	if( !Output )
 		return false;
 
-	CData Data;
-
-	// Fetch the file data.
-	File.Extract( Data );
+	// Read the file data in place.
+	CDataView Data = File.View();
 
 	if( !ValidHeader( Data ) )
 	{
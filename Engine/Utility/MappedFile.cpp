@@ -0,0 +1,189 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <Engine/Profiling/Logging.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+CMappedFile::CMappedFile( CMappedFile&& Other )
+{
+	*this = std::move( Other );
+}
+
+CMappedFile& CMappedFile::operator=( CMappedFile&& Other )
+{
+	if( this != &Other )
+	{
+		Close();
+		std::swap( Address, Other.Address );
+		std::swap( Length, Other.Length );
+		std::swap( Opened, Other.Opened );
+	}
+
+	return *this;
+}
+
+#if defined(_WIN32)
+bool CMappedFile::Open( const std::string& Location )
+{
+	Close();
+
+	HANDLE File = CreateFileA( Location.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if( File == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER FileSize;
+	if( !GetFileSizeEx( File, &FileSize ) )
+	{
+		CloseHandle( File );
+		return false;
+	}
+
+	Length = static_cast<size_t>( FileSize.QuadPart );
+	if( Length == 0 )
+	{
+		// Empty files can't be mapped.
+		CloseHandle( File );
+		Opened = true;
+		return true;
+	}
+
+	HANDLE Mapping = CreateFileMappingA( File, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( Mapping )
+	{
+		Address = static_cast<const char*>( MapViewOfFile( Mapping, FILE_MAP_READ, 0, 0, 0 ) );
+		CloseHandle( Mapping );
+	}
+
+	// The view keeps the file open.
+	CloseHandle( File );
+
+	if( !Address )
+	{
+		Log::Event( Log::Warning, "Failed to map file \"%s\" (%u).\n", Location.c_str(), GetLastError() );
+		Length = 0;
+		return false;
+	}
+
+	Opened = true;
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if( Address )
+	{
+		UnmapViewOfFile( Address );
+	}
+
+	Address = nullptr;
+	Length = 0;
+	Opened = false;
+}
+#else
+bool CMappedFile::Open( const std::string& Location )
+{
+	Close();
+
+	const int Descriptor = open( Location.c_str(), O_RDONLY );
+	if( Descriptor < 0 )
+		return false;
+
+	struct stat Statistics;
+	if( fstat( Descriptor, &Statistics ) != 0 )
+	{
+		close( Descriptor );
+		return false;
+	}
+
+	Length = static_cast<size_t>( Statistics.st_size );
+	if( Length == 0 )
+	{
+		// Empty files can't be mapped.
+		close( Descriptor );
+		Opened = true;
+		return true;
+	}
+
+	void* Mapping = mmap( nullptr, Length, PROT_READ, MAP_PRIVATE, Descriptor, 0 );
+
+	// The mapping keeps the file open.
+	close( Descriptor );
+
+	if( Mapping == MAP_FAILED )
+	{
+		Log::Event( Log::Warning, "Failed to map file \"%s\".\n", Location.c_str() );
+		Length = 0;
+		return false;
+	}
+
+	madvise( Mapping, Length, MADV_SEQUENTIAL );
+
+	Address = static_cast<const char*>( Mapping );
+	Opened = true;
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if( Address )
+	{
+		munmap( const_cast<char*>( Address ), Length );
+	}
+
+	Address = nullptr;
+	Length = 0;
+	Opened = false;
+}
+#endif
+
+bool CFileStream::Open( const std::string& Location, const size_t ChunkSize )
+{
+	Stream.close();
+	Stream.clear();
+	Stream.open( Location.c_str(), std::ios::in | std::ios::binary );
+	if( Stream.fail() )
+		return false;
+
+	Stream.seekg( 0, std::ios::end );
+	Length = static_cast<size_t>( Stream.tellg() );
+	Stream.seekg( 0, std::ios::beg );
+
+	Offset = 0;
+	Buffer.resize( std::max( ChunkSize, static_cast<size_t>( 1 ) ) );
+	return true;
+}
+
+bool CFileStream::Next( CDataView& Chunk )
+{
+	if( !Stream.is_open() || Offset >= Length )
+		return false;
+
+	const size_t Size = std::min( Buffer.size(), Length - Offset );
+	Stream.read( Buffer.data(), Size );
+
+	const size_t Read = static_cast<size_t>( Stream.gcount() );
+	if( Read == 0 )
+		return false;
+
+	Offset += Read;
+	Chunk = CDataView( Buffer.data(), Read );
+	return true;
+}
@@ -0,0 +1,85 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Engine/Utility/Data.h>
+
+// Read-only view of a file that is mapped into memory, pages are loaded by the OS when they're touched.
+class CMappedFile
+{
+public:
+	CMappedFile() = default;
+	~CMappedFile();
+
+	CMappedFile( const CMappedFile& ) = delete;
+	CMappedFile& operator=( const CMappedFile& ) = delete;
+
+	CMappedFile( CMappedFile&& Other );
+	CMappedFile& operator=( CMappedFile&& Other );
+
+	// Empty files can be opened but don't have any data.
+	bool Open( const std::string& Location );
+	void Close();
+
+	bool IsOpen() const
+	{
+		return Opened;
+	}
+
+	const char* Data() const
+	{
+		return Address;
+	}
+
+	size_t Size() const
+	{
+		return Length;
+	}
+
+	CDataView View() const
+	{
+		return CDataView( Address, Length );
+	}
+
+private:
+	const char* Address = nullptr;
+	size_t Length = 0;
+	bool Opened = false;
+};
+
+// Reads a file in fixed-size chunks, only a single chunk is kept in memory.
+class CFileStream
+{
+public:
+	static const size_t DefaultChunkSize = 4 * 1024 * 1024;
+
+	bool Open( const std::string& Location, const size_t ChunkSize = DefaultChunkSize );
+
+	// Reads the next chunk, fails at the end of the file. The view is invalidated by the next call.
+	bool Next( CDataView& Chunk );
+
+	size_t Size() const
+	{
+		return Length;
+	}
+
+	size_t Position() const
+	{
+		return Offset;
+	}
+
+	// Memory held by the stream, it doesn't depend on the size of the file.
+	size_t BufferSize() const
+	{
+		return Buffer.capacity();
+	}
+
+private:
+	std::ifstream Stream;
+	std::vector<char> Buffer;
+	size_t Length = 0;
+	size_t Offset = 0;
+};
@@ -1,6 +1,10 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "MeshBuilder.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 #include <Engine/Profiling/Logging.h>
 #include <Engine/Profiling/Profiling.h>
 #include <Engine/Display/Rendering/Mesh.h>
@@ -423,18 +427,242 @@ void MeshBuilder::Cells( FPrimitive& Primitive, const Vector2D& Dimensions, cons
 	Primitive.IndexCount = IndexCount;
 }
 
-bool MeshBuilder::FindVertex( const ComplexVertex& Vertex, const std::map<ComplexVertex, uint32_t>& IndexMap, uint32_t& OutIndex )
+// Open addressing table that keeps the index of the first occurrence of every key.
+// Keys are compared bit for bit, the same way ComplexVertex is ordered.
+template<typename KeyType>
+class CFirstIndexTable
 {
-	const auto Iterator = IndexMap.find( Vertex );
-	if( Iterator == IndexMap.end() )
+public:
+	CFirstIndexTable( const size_t Expected )
 	{
-		return false;
+		size_t Capacity = 16;
+		while( Capacity < Expected * 2 )
+		{
+			Capacity <<= 1;
+		}
+
+		Resize( Capacity );
 	}
-	else
+
+	// Returns the index the key was first added with, adds the key with the given index if it's new.
+	uint32_t Find( const KeyType& Key, const uint32_t Index )
+	{
+		size_t Slot = Hash( Key ) & Mask;
+		while( Indices[Slot] != Empty )
+		{
+			if( std::memcmp( &Keys[Slot], &Key, sizeof( KeyType ) ) == 0 )
+				return Indices[Slot];
+
+			Slot = ( Slot + 1 ) & Mask;
+		}
+
+		Keys[Slot] = Key;
+		Indices[Slot] = Index;
+		Count++;
+
+		// Keep the load factor below one half.
+		if( Count * 2 > Keys.size() )
+		{
+			Resize( Keys.size() * 2 );
+		}
+
+		return Index;
+	}
+
+private:
+	static const uint32_t Empty = 0xFFFFFFFF;
+
+	static size_t Hash( const KeyType& Key )
+	{
+		static_assert( sizeof( KeyType ) % sizeof( uint32_t ) == 0, "Keys are hashed per 32-bit word." );
+
+		uint32_t Words[sizeof( KeyType ) / sizeof( uint32_t )];
+		std::memcpy( Words, &Key, sizeof( KeyType ) );
+
+		uint32_t Hash = 0;
+		for( const auto Word : Words )
+		{
+			Hash = ( Hash ^ Word ) * 0x9E3779B1u;
+			Hash ^= Hash >> 15;
+		}
+
+		return Hash;
+	}
+
+	void Resize( const size_t Capacity )
+	{
+		std::vector<KeyType> OldKeys( Capacity );
+		std::vector<uint32_t> OldIndices( Capacity, static_cast<uint32_t>( Empty ) );
+		OldKeys.swap( Keys );
+		OldIndices.swap( Indices );
+		Mask = Capacity - 1;
+
+		for( size_t Slot = 0; Slot < OldIndices.size(); Slot++ )
+		{
+			if( OldIndices[Slot] == Empty )
+				continue;
+
+			size_t Target = Hash( OldKeys[Slot] ) & Mask;
+			while( Indices[Target] != Empty )
+			{
+				Target = ( Target + 1 ) & Mask;
+			}
+
+			Keys[Target] = OldKeys[Slot];
+			Indices[Target] = OldIndices[Slot];
+		}
+	}
+
+	std::vector<KeyType> Keys;
+	std::vector<uint32_t> Indices;
+	size_t Mask = 0;
+	size_t Count = 0;
+};
+
+// Maps every element to the first element with the same bits.
+template<typename Type>
+static std::vector<uint32_t> FirstIndices( const std::vector<Type>& Elements )
+{
+	std::vector<uint32_t> Indices( Elements.size() );
+	CFirstIndexTable<Type> Table( Elements.size() );
+	for( size_t Index = 0; Index < Elements.size(); Index++ )
 	{
-		OutIndex = Iterator->second;
-		return true;
+		Indices[Index] = Table.Find( Elements[Index], static_cast<uint32_t>( Index ) );
 	}
+
+	return Indices;
+}
+
+static bool IsEndOfLine( const char* Token )
+{
+	return Token[0] == '\0' || Token[0] == '\n' || ( Token[0] == '\r' && Token[1] == '\n' );
+}
+
+// Same result as ParseDouble, but reads the number in place.
+static float ParseNumber( const char* Start, const char* End )
+{
+	if( Start == End || *Start == '?' )
+		return static_cast<float>( static_cast<double>( -0x7FFFFFFF ) );
+
+	const char* Token = Start;
+	int Sign = 1;
+	if( *Token == '-' )
+	{
+		Sign = -1;
+		Token++;
+	}
+
+	// The arithmetic has to match ParseDouble exactly for the results to be identical.
+	double Accumulator = 0;
+	while( Token < End && *Token >= '0' && *Token <= '9' )
+		Accumulator = Accumulator * 10 + *Token++ - '0';
+
+	if( Token < End && *Token == '.' )
+	{
+		double Fraction = 0.1;
+		Token++;
+		while( Token < End && *Token >= '0' && *Token <= '9' )
+		{
+			Accumulator += ( *Token++ - '0' ) * Fraction;
+			Fraction *= 0.1;
+		}
+	}
+
+	if( Token != End )
+	{
+		Log::Event( Log::Error, "Invalid numeric format.\n" );
+	}
+
+	return static_cast<float>( Sign * Accumulator );
+}
+
+// Reads the numbers on a line the same way ExtractTokensFloat does, without copying them.
+// Returns the amount of numbers on the line, only the first few are stored.
+static size_t ParseNumbers( const char* Start, float* Output, const size_t Expected )
+{
+	size_t Count = 0;
+	const char* Token = Start;
+	while( true )
+	{
+		const bool EndOfLine = IsEndOfLine( Token );
+		if( Token[0] == ' ' || EndOfLine )
+		{
+			// ExtractTokensFloat skips tokens that don't fit its buffer.
+			if( Token - Start < 255 )
+			{
+				if( Count < Expected )
+				{
+					Output[Count] = ParseNumber( Start, Token );
+				}
+
+				Count++;
+			}
+
+			if( EndOfLine )
+				return Count;
+
+			Start = Token + 1;
+		}
+
+		Token++;
+	}
+}
+
+// Same result as Math::Integer, plain decimal numbers are read in place.
+static int ParseIndex( const char* Start, const char* End )
+{
+	const char* Token = Start;
+	const bool Negative = Token < End && *Token == '-';
+	if( Negative )
+	{
+		Token++;
+	}
+
+	// Leading zeroes are read as octal numbers by strtol.
+	const size_t Digits = End - Token;
+	if( Digits > 0 && Digits < 10 && !( *Token == '0' && Digits > 1 ) )
+	{
+		int Value = 0;
+		for( ; Token < End && *Token >= '0' && *Token <= '9'; Token++ )
+		{
+			Value = Value * 10 + ( *Token - '0' );
+		}
+
+		if( Token == End )
+			return Negative ? -Value : Value;
+	}
+
+	char Buffer[256];
+	const size_t Length = std::min( static_cast<size_t>( End - Start ), sizeof( Buffer ) - 1 );
+	std::memcpy( Buffer, Start, Length );
+	Buffer[Length] = '\0';
+	return static_cast<int>( std::strtol( Buffer, nullptr, 0 ) );
+}
+
+// Reads a face corner the same way ExtractTokensInteger does, it is only valid when it has exactly three components.
+static bool ParseCorner( const char* Start, const char* End, int* Components )
+{
+	size_t Count = 0;
+	const char* First = Start;
+	for( const char* Token = Start; ; Token++ )
+	{
+		if( Token == End || *Token == '/' )
+		{
+			if( Count < 3 )
+			{
+				Components[Count] = ParseIndex( First, Token );
+			}
+
+			Count++;
+
+			if( Token == End )
+				break;
+
+			First = Token + 1;
+		}
+	}
+
+	return Count == 3;
 }
 
 void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
@@ -456,7 +684,6 @@ void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
 	CoordinateIndices.reserve( 100000 );
 	NormalIndices.reserve( 100000 );
 
-	const char Delimiter = ' ';
 	const char* Data = File.Fetch<char>();
 
 	const char* Start = Data;
@@ -464,8 +691,7 @@ void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
 
 	const char* LoopToken = Start;
 
-	bool ShouldPrintToken = true;
-	std::string Line;
+	float Tokens[3];
 	while( LoopToken )
 	{
 		LoopToken = GetLine( Start, End );
@@ -479,9 +705,7 @@ void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
 
 				Start += 3;
 
-				size_t OutTokenCount = 0;
-				auto Tokens = ExtractTokensFloat( Start, Delimiter, OutTokenCount, 2 );
-				if( Tokens && OutTokenCount == 2 )
+				if( ParseNumbers( Start, Tokens, 2 ) == 2 )
 				{
 					Coordinate[0] = Tokens[0];
 					Coordinate[1] = Tokens[1];
@@ -498,10 +722,7 @@ void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
 
 				Start += 3;
 
-				size_t OutTokenCount = 0;
-				auto Tokens = ExtractTokensFloat( Start, Delimiter, OutTokenCount, 3 );
-
-				if( Tokens && OutTokenCount == 3 )
+				if( ParseNumbers( Start, Tokens, 3 ) == 3 )
 				{
 					// Assume Y is up in the file.
 					Normal[1] = Tokens[0];
@@ -522,10 +743,7 @@ void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
 
 				Start += 2;
 
-				size_t OutTokenCount = 0;
-				auto Tokens = ExtractTokensFloat( Start, Delimiter, OutTokenCount, 3 );
-
-				if( Tokens && OutTokenCount == 3 )
+				if( ParseNumbers( Start, Tokens, 3 ) == 3 )
 				{
 					// Assume Y is up in the file.
 					Vertex[1] = Tokens[0];
@@ -538,26 +756,42 @@ void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
 		}
 		else if( Start[0] == 'f' )
 		{
-			// Face.
+			// Face, only the first three corners are used.
 			Start += 2;
-			auto Tokens = ExtractTokens( Start, Delimiter, 3 );
 
-			for( auto& Token : Tokens )
+			size_t Corners = 0;
+			const char* Token = Start;
+			while( Corners < 3 )
 			{
-				size_t OutTokenCount = 0;
-				auto ComponentTokens = ExtractTokensInteger( Token.c_str(), '/', OutTokenCount, 3 );
-				if( ComponentTokens && OutTokenCount == 3 )
+				const bool EndOfLine = IsEndOfLine( Token );
+				if( Token[0] == ' ' || EndOfLine )
 				{
-					// Indices start from 1 in OBJ files, subtract 1 to make them valid for our own arrays.
-					VertexIndices.emplace_back( ComponentTokens[0] - 1 );
-
-					if( ComponentTokens[1] != 0 )
+					if( Token - Start < 255 )
 					{
-						CoordinateIndices.emplace_back( ComponentTokens[1] - 1 );
+						Corners++;
+
+						int Components[3];
+						if( ParseCorner( Start, Token, Components ) )
+						{
+							// Indices start from 1 in OBJ files, subtract 1 to make them valid for our own arrays.
+							VertexIndices.emplace_back( Components[0] - 1 );
+
+							if( Components[1] != 0 )
+							{
+								CoordinateIndices.emplace_back( Components[1] - 1 );
+							}
+
+							NormalIndices.emplace_back( Components[2] - 1 );
+						}
 					}
 
-					NormalIndices.emplace_back( ComponentTokens[2] - 1 );
+					if( EndOfLine )
+						break;
+
+					Start = Token + 1;
 				}
+
+				Token++;
 			}
 		}
 
@@ -566,31 +800,44 @@ void MeshBuilder::OBJ( FPrimitive& Primitive, const CFile& File )
 
 	if( VertexIndices.size() == CoordinateIndices.size() && VertexIndices.size() == NormalIndices.size() )
 	{
+		// Corners are unique when the values they point to are, so each attribute index is replaced by the first index with the same value.
+		const auto Positions = FirstIndices( Vertices );
+		const auto TextureCoordinates = FirstIndices( Coordinates );
+		const auto Directions = FirstIndices( Normals );
+
+		struct FCorner
+		{
+			uint32_t Position;
+			uint32_t Coordinate;
+			uint32_t Normal;
+		};
+
 		std::vector<ComplexVertex> FatVertices;
 		std::vector<uint32_t> FatIndices;
-		std::map<ComplexVertex, uint32_t> IndexMap;
+		FatIndices.reserve( VertexIndices.size() );
+
+		CFirstIndexTable<FCorner> IndexMap( VertexIndices.size() / 4 );
 
 		for( size_t Index = 0; Index < VertexIndices.size(); Index++ )
 		{
-			ComplexVertex Vertex;
-			Vertex.Position = Vertices[VertexIndices[Index]];
-			Vertex.Normal = Normals[NormalIndices[Index]];
-			Vertex.TextureCoordinate = Coordinates[CoordinateIndices[Index]];
-			Vertex.Color = Vector3D( 1.0f, 1.0f, 1.0f );
-
-			uint32_t FatIndex = 0;
-			const bool ExistingVertex = FindVertex( Vertex, IndexMap, FatIndex );
-			if( ExistingVertex )
-			{
-				FatIndices.emplace_back( FatIndex );
-			}
-			else
+			FCorner Corner;
+			Corner.Position = Positions[VertexIndices[Index]];
+			Corner.Coordinate = TextureCoordinates[CoordinateIndices[Index]];
+			Corner.Normal = Directions[NormalIndices[Index]];
+
+			const auto NewIndex = static_cast<uint32_t>( FatVertices.size() );
+			const auto FatIndex = IndexMap.Find( Corner, NewIndex );
+			if( FatIndex == NewIndex )
 			{
+				ComplexVertex Vertex;
+				Vertex.Position = Vertices[VertexIndices[Index]];
+				Vertex.Normal = Normals[NormalIndices[Index]];
+				Vertex.TextureCoordinate = Coordinates[CoordinateIndices[Index]];
+				Vertex.Color = Vector3D( 1.0f, 1.0f, 1.0f );
 				FatVertices.emplace_back( Vertex );
-				const auto NewIndex = FatVertices.size() - 1;
-				FatIndices.emplace_back( NewIndex );
-				IndexMap.insert_or_assign( Vertex, NewIndex );
 			}
+
+			FatIndices.emplace_back( FatIndex );
 		}
 
 		ComplexVertex* VertexArray = new ComplexVertex[FatVertices.size()];
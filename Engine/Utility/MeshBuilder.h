@@ -47,6 +47,4 @@ public:
 
 private:
 	static void Soup( FPrimitive& Primitive, std::vector<Vector3D> Vertices );
-
-	static bool FindVertex( const ComplexVertex& Vertex, const std::map<ComplexVertex, uint32_t>& IndexMap, uint32_t& OutIndex );
 };
@@ -116,7 +116,7 @@ namespace ScriptEngine
 		AddTypeMethod( Entity, "void SetParent(Entity &in)", &T::SetParent );
 		AddTypeMethod( Entity, "Entity @ GetParent() const", &T::GetParent );
 
-		AddTypeMethod( Entity, "void Send(string &in, Entity @)", &T::Send );
+		AddTypeMethod( Entity, "void Send(string &in, Entity @)", static_cast<void( CEntity::* )( const char*, CEntity* )>( &T::Send ) );
 		AddTypeMethod( Entity, "void Receive(string &in, Entity @)", &T::Receive );
 		AddTypeMethod( Entity, "void Tag(string &in)", &T::Tag );
 		AddTypeMethod( Entity, "void Untag(string &in)", &T::Untag );
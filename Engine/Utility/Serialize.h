@@ -12,8 +12,8 @@
 struct Serialize
 {
 	// Adds a marker for verification purposes and exports the given data (pointers will assert).
-	template<typename T>
-	static void Export( CData& Data, const char* Identifier, const T& Snippet )
+	template<typename DataType, typename T>
+	static void Export( DataType& Data, const char* Identifier, const T& Snippet )
 	{
 		static_assert( !std::is_pointer<T>::value, "Pointers can not be serialized directly." );
 		DataMarker::Mark( Data, Identifier );
@@ -21,8 +21,8 @@ struct Serialize
 	}
 
 	// Checks if the given marker is found and extracts the associated data.
-	template<typename T>
-	static bool Import( CData& Data, const char* Identifier, T& Snippet )
+	template<typename DataType, typename T>
+	static bool Import( DataType& Data, const char* Identifier, T& Snippet )
 	{
 		if( !DataMarker::Check( Data, Identifier ) )
 			return false;
@@ -32,7 +32,8 @@ struct Serialize
 		return true;
 	}
 
-	static void Export( CData& Data, const char* Identifier, const std::set<std::string>& Set )
+	template<typename DataType>
+	static void Export( DataType& Data, const char* Identifier, const std::set<std::string>& Set )
 	{
 		DataMarker::Mark( Data, Identifier );
 		
@@ -45,7 +46,8 @@ struct Serialize
 		}
 	}
 
-	static bool Import( CData& Data, const char* Identifier, std::set<std::string>& Set )
+	template<typename DataType>
+	static bool Import( DataType& Data, const char* Identifier, std::set<std::string>& Set )
 	{
 		if( !DataMarker::Check( Data, Identifier ) )
 			return false;
@@ -64,7 +66,8 @@ struct Serialize
 		return true;
 	}
 
-	static void Export( CData& Data, const char* Identifier, const std::vector<std::string>& Vector )
+	template<typename DataType>
+	static void Export( DataType& Data, const char* Identifier, const std::vector<std::string>& Vector )
 	{
 		DataMarker::Mark( Data, Identifier );
 
@@ -77,7 +80,8 @@ struct Serialize
 		}
 	}
 
-	static bool Import( CData& Data, const char* Identifier, std::vector<std::string>& Vector )
+	template<typename DataType>
+	static bool Import( DataType& Data, const char* Identifier, std::vector<std::string>& Vector )
 	{
 		if( !DataMarker::Check( Data, Identifier ) )
 			return false;
@@ -96,13 +100,15 @@ struct Serialize
 		return true;
 	}
 
-	static void Export( CData& Data, const char* Identifier, const std::string& Snippet )
+	template<typename DataType>
+	static void Export( DataType& Data, const char* Identifier, const std::string& Snippet )
 	{
 		DataMarker::Mark( Data, Identifier );
 		DataString::Encode( Data, Snippet );
 	}
 
-	static bool Import( CData& Data, const char* Identifier, std::string& Snippet )
+	template<typename DataType>
+	static bool Import( DataType& Data, const char* Identifier, std::string& Snippet )
 	{
 		if( !DataMarker::Check( Data, Identifier ) )
 			return false;
@@ -282,7 +282,7 @@ void BoundingVolumeHierarchy::Node::Recalculate()
 {
 	if( Left && Right )
 	{
-		Bounds = BoundingBox::Combine( Left->GetBounds().Fetch(), Right->GetBounds().Fetch() );
+		Bounds = BoundingBoxSIMD::Combine( Left->GetBounds(), Right->GetBounds() );
 	}
 	else if( Left )
 	{
@@ -296,6 +296,47 @@ void BoundingVolumeHierarchy::Node::Recalculate()
 	BoundsExpensive = Bounds.Fetch();
 }
 
+float SurfaceArea( const BoundingBox& Box )
+{
+	const auto Size = Box.Size();
+	return 2.0f * ( Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X );
+}
+
+float BoundingVolumeHierarchy::Node::Refit()
+{
+	float ChildArea = 0.0f;
+	if( auto* LeftNode = dynamic_cast<Node*>( Left ) )
+	{
+		ChildArea += LeftNode->Refit();
+	}
+
+	if( auto* RightNode = dynamic_cast<Node*>( Right ) )
+	{
+		ChildArea += RightNode->Refit();
+	}
+
+	// The children are up-to-date, we can grow or shrink around them.
+	Recalculate();
+
+	return ChildArea + SurfaceArea( BoundsExpensive );
+}
+
+float BoundingVolumeHierarchy::Node::Area() const
+{
+	float ChildArea = 0.0f;
+	if( const auto* LeftNode = dynamic_cast<const Node*>( Left ) )
+	{
+		ChildArea += LeftNode->Area();
+	}
+
+	if( const auto* RightNode = dynamic_cast<const Node*>( Right ) )
+	{
+		ChildArea += RightNode->Area();
+	}
+
+	return ChildArea + SurfaceArea( BoundsExpensive );
+}
+
 bool HasActiveLeaves( BoundingVolumeHierarchy::Node* Leaf )
 {
 	return Leaf->Left || Leaf->Right;
@@ -528,6 +569,34 @@ std::shared_ptr<Testable> BoundingVolumeHierarchy::Build( RawObjectList& Source
 	return Result;
 }
 
+float RelativeCost( const BoundingVolumeHierarchy::Node* Root, const float Area )
+{
+	const float RootArea = SurfaceArea( Root->BoundsExpensive );
+	if( RootArea <= 0.0f )
+		return 0.0f;
+
+	return Area / RootArea;
+}
+
+float BoundingVolumeHierarchy::Refit( const std::shared_ptr<Testable>& Hierarchy )
+{
+	auto* Tree = dynamic_cast<Node*>( Hierarchy.get() );
+	if( !Tree )
+		return 0.0f;
+
+	const float Area = Tree->Refit();
+	return RelativeCost( Tree, Area );
+}
+
+float BoundingVolumeHierarchy::Cost( const std::shared_ptr<Testable>& Hierarchy )
+{
+	const auto* Tree = dynamic_cast<const Node*>( Hierarchy.get() );
+	if( !Tree )
+		return 0.0f;
+
+	return RelativeCost( Tree, Tree->Area() );
+}
+
 void BoundingVolumeHierarchy::Destroy( std::shared_ptr<Testable>& Hierarchy )
 {
 	auto* Tree = dynamic_cast<Node*>( Hierarchy.get() );
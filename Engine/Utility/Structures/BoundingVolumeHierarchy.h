@@ -34,6 +34,13 @@ public:
 		// Re-calculate the bounds of this node.
 		void Recalculate();
 
+		// Re-calculates the bounds of this node and all of its child nodes, bottom-up.
+		// The topology of the tree is left untouched. Returns the summed surface area of the nodes.
+		float Refit();
+
+		// Summed surface area of this node and all of its child nodes.
+		float Area() const;
+
 		// Remove leafless nodes.
 		void Clean();
 
@@ -54,4 +61,11 @@ public:
 
 	static std::shared_ptr<Testable> Build( RawObjectList& Source );
 	static void Destroy( std::shared_ptr<Testable>& Hierarchy );
+
+	// Updates the node bounds using the current bounds of the objects. Returns the new cost of the tree.
+	static float Refit( const std::shared_ptr<Testable>& Hierarchy );
+
+	// Surface area heuristic cost of the tree. (summed node area relative to the root area)
+	// Refitting increases the cost when objects move away from each other, a rebuild resets it.
+	static float Cost( const std::shared_ptr<Testable>& Hierarchy );
 };
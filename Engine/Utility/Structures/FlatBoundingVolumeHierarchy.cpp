@@ -0,0 +1,533 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "FlatBoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Display/UserInterface.h>
+
+ConfigurationVariable<bool> DrawFlatBVHBounds( "debug.Physics.DrawFlatBVHBounds", false );
+
+// Maximum amount of objects in a leaf.
+constexpr size_t LeafSize = 4;
+
+// Amount of bins used to evaluate the split candidates on each axis.
+constexpr size_t BinCount = 16;
+
+// Past this depth we stop trusting the heuristic and split at the median to keep the tree shallow.
+constexpr size_t MaximumHeuristicDepth = 48;
+
+// Each visited node pushes at most three more entries than it pops.
+constexpr size_t StackSize = 256;
+
+// Marks unused child slots.
+constexpr int32_t EmptyChild = -1;
+
+struct FlatBuildEntry
+{
+	BoundingBox Bounds;
+	Vector3D Centroid;
+	Testable* Object;
+};
+
+struct FlatBuildRange
+{
+	size_t Start;
+	size_t End;
+
+	// The heuristic prefers to keep these objects together.
+	bool Final;
+
+	size_t Count() const
+	{
+		return End - Start;
+	}
+};
+
+static BoundingBox EmptyBox()
+{
+	return { Vector3D( FLT_MAX, FLT_MAX, FLT_MAX ), Vector3D( -FLT_MAX, -FLT_MAX, -FLT_MAX ) };
+}
+
+static void Grow( BoundingBox& Box, const BoundingBox& Other )
+{
+	Box.Minimum.X = std::min( Box.Minimum.X, Other.Minimum.X );
+	Box.Minimum.Y = std::min( Box.Minimum.Y, Other.Minimum.Y );
+	Box.Minimum.Z = std::min( Box.Minimum.Z, Other.Minimum.Z );
+	Box.Maximum.X = std::max( Box.Maximum.X, Other.Maximum.X );
+	Box.Maximum.Y = std::max( Box.Maximum.Y, Other.Maximum.Y );
+	Box.Maximum.Z = std::max( Box.Maximum.Z, Other.Maximum.Z );
+}
+
+static void Grow( BoundingBox& Box, const Vector3D& Point )
+{
+	Grow( Box, BoundingBox( Point, Point ) );
+}
+
+static float SurfaceArea( const BoundingBox& Box )
+{
+	const auto Size = Box.Size();
+	if( Size.X < 0.0f || Size.Y < 0.0f || Size.Z < 0.0f )
+		return 0.0f;
+
+	return 2.0f * ( Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X );
+}
+
+static size_t MedianSplit( std::vector<FlatBuildEntry>& Entries, const size_t Start, const size_t End, const int32_t Axis )
+{
+	const auto Middle = Start + ( End - Start ) / 2;
+	std::nth_element( Entries.begin() + Start, Entries.begin() + Middle, Entries.begin() + End,
+		[Axis] ( const FlatBuildEntry& A, const FlatBuildEntry& B )
+		{
+			return A.Centroid[Axis] < B.Centroid[Axis];
+		}
+	);
+
+	return Middle;
+}
+
+// Partitions the range using the binned surface area heuristic.
+// Returns End if the objects should stay together in a single leaf.
+static size_t Split( std::vector<FlatBuildEntry>& Entries, const size_t Start, const size_t End, const size_t Depth )
+{
+	const auto Count = End - Start;
+
+	BoundingBox Bounds = EmptyBox();
+	BoundingBox CentroidBounds = EmptyBox();
+	for( size_t Index = Start; Index < End; Index++ )
+	{
+		Grow( Bounds, Entries[Index].Bounds );
+		Grow( CentroidBounds, Entries[Index].Centroid );
+	}
+
+	const auto Extent = CentroidBounds.Size();
+	int32_t LargestAxis = 0;
+	if( Extent[1] > Extent[LargestAxis] )
+		LargestAxis = 1;
+	if( Extent[2] > Extent[LargestAxis] )
+		LargestAxis = 2;
+
+	if( Extent[LargestAxis] <= 0.0f )
+	{
+		// All of the centroids are in the same spot, the heuristic can't separate them.
+		return Count > LeafSize ? MedianSplit( Entries, Start, End, LargestAxis ) : End;
+	}
+
+	if( Depth > MaximumHeuristicDepth )
+		return MedianSplit( Entries, Start, End, LargestAxis );
+
+	float BestCost = FLT_MAX;
+	int32_t BestAxis = -1;
+	size_t BestBin = 0;
+
+	for( int32_t Axis = 0; Axis < 3; Axis++ )
+	{
+		if( Extent[Axis] <= 0.0f )
+			continue;
+
+		BoundingBox BinBounds[BinCount];
+		size_t BinCounts[BinCount] = {};
+		for( auto& Box : BinBounds )
+		{
+			Box = EmptyBox();
+		}
+
+		const float Scale = static_cast<float>( BinCount ) / Extent[Axis];
+		for( size_t Index = Start; Index < End; Index++ )
+		{
+			const auto Bin = std::min( BinCount - 1, static_cast<size_t>( ( Entries[Index].Centroid[Axis] - CentroidBounds.Minimum[Axis] ) * Scale ) );
+			Grow( BinBounds[Bin], Entries[Index].Bounds );
+			BinCounts[Bin]++;
+		}
+
+		// Sweep from the right to gather the costs of everything past each split plane.
+		float RightArea[BinCount];
+		size_t RightCount[BinCount];
+		BoundingBox Accumulated = EmptyBox();
+		size_t AccumulatedCount = 0;
+		for( size_t Bin = BinCount - 1; Bin > 0; Bin-- )
+		{
+			Grow( Accumulated, BinBounds[Bin] );
+			AccumulatedCount += BinCounts[Bin];
+			RightArea[Bin] = SurfaceArea( Accumulated );
+			RightCount[Bin] = AccumulatedCount;
+		}
+
+		Accumulated = EmptyBox();
+		AccumulatedCount = 0;
+		for( size_t Bin = 0; Bin < BinCount - 1; Bin++ )
+		{
+			Grow( Accumulated, BinBounds[Bin] );
+			AccumulatedCount += BinCounts[Bin];
+
+			if( AccumulatedCount == 0 || RightCount[Bin + 1] == 0 )
+				continue;
+
+			const float Cost = SurfaceArea( Accumulated ) * AccumulatedCount + RightArea[Bin + 1] * RightCount[Bin + 1];
+			if( Cost < BestCost )
+			{
+				BestCost = Cost;
+				BestAxis = Axis;
+				BestBin = Bin;
+			}
+		}
+	}
+
+	if( BestAxis < 0 )
+		return Count > LeafSize ? MedianSplit( Entries, Start, End, LargestAxis ) : End;
+
+	// Small ranges only get split when it's cheaper than testing all of the objects.
+	const float LeafCost = SurfaceArea( Bounds ) * Count;
+	if( Count <= LeafSize && BestCost >= LeafCost )
+		return End;
+
+	const float Scale = static_cast<float>( BinCount ) / Extent[BestAxis];
+	const float Minimum = CentroidBounds.Minimum[BestAxis];
+	const auto Middle = std::partition( Entries.begin() + Start, Entries.begin() + End,
+		[BestAxis, BestBin, Scale, Minimum] ( const FlatBuildEntry& Entry )
+		{
+			const auto Bin = std::min( BinCount - 1, static_cast<size_t>( ( Entry.Centroid[BestAxis] - Minimum ) * Scale ) );
+			return Bin <= BestBin;
+		}
+	);
+
+	const auto Result = static_cast<size_t>( Middle - Entries.begin() );
+	if( Result == Start || Result == End )
+		return MedianSplit( Entries, Start, End, LargestAxis );
+
+	return Result;
+}
+
+int32_t FlatBoundingVolumeHierarchy::BuildNode( std::vector<FlatBuildEntry>& Entries, const size_t Start, const size_t End, const size_t Depth )
+{
+	const auto NodeIndex = static_cast<int32_t>( Nodes.size() );
+	Nodes.emplace_back();
+
+	// Keep splitting the largest range until we've filled all of the child slots.
+	FlatBuildRange Ranges[Width];
+	size_t RangeCount = 1;
+	Ranges[0] = { Start, End, false };
+
+	while( RangeCount < Width )
+	{
+		size_t Largest = Width;
+		for( size_t Index = 0; Index < RangeCount; Index++ )
+		{
+			const auto& Range = Ranges[Index];
+			if( Range.Final || Range.Count() <= 1 )
+				continue;
+
+			if( Largest == Width || Range.Count() > Ranges[Largest].Count() )
+			{
+				Largest = Index;
+			}
+		}
+
+		if( Largest == Width )
+			break;
+
+		auto& Range = Ranges[Largest];
+		const auto Middle = Split( Entries, Range.Start, Range.End, Depth );
+		if( Middle == Range.End )
+		{
+			Range.Final = true;
+			continue;
+		}
+
+		Ranges[RangeCount++] = { Middle, Range.End, false };
+		Range.End = Middle;
+	}
+
+	for( size_t Index = 0; Index < Width; Index++ )
+	{
+		BoundingBox Box = EmptyBox();
+		int32_t Child = EmptyChild;
+		int32_t Count = 0;
+
+		if( Index < RangeCount )
+		{
+			const auto& Range = Ranges[Index];
+			for( size_t Entry = Range.Start; Entry < Range.End; Entry++ )
+			{
+				Grow( Box, Entries[Entry].Bounds );
+			}
+
+			if( Range.Count() <= LeafSize || Range.Final )
+			{
+				Child = static_cast<int32_t>( Range.Start );
+				Count = static_cast<int32_t>( Range.Count() );
+			}
+			else
+			{
+				Child = BuildNode( Entries, Range.Start, Range.End, Depth + 1 );
+			}
+		}
+
+		// Building child nodes may have re-allocated the node array.
+		auto& Current = Nodes[NodeIndex];
+		Current.MinimumX[Index] = Box.Minimum.X;
+		Current.MinimumY[Index] = Box.Minimum.Y;
+		Current.MinimumZ[Index] = Box.Minimum.Z;
+		Current.MaximumX[Index] = Box.Maximum.X;
+		Current.MaximumY[Index] = Box.Maximum.Y;
+		Current.MaximumZ[Index] = Box.Maximum.Z;
+		Current.Children[Index] = Child;
+		Current.Count[Index] = Count;
+	}
+
+	return NodeIndex;
+}
+
+void FlatBoundingVolumeHierarchy::Remove( RawObject Object )
+{
+	for( auto& Entry : Objects )
+	{
+		if( Entry == Object )
+		{
+			Entry = nullptr;
+		}
+	}
+}
+
+void FlatBoundingVolumeHierarchy::Query( const BoundingBoxSIMD& Box, QueryResult& Result )
+{
+	if( Nodes.empty() )
+		return;
+
+	const auto QueryMinimumX = _mm_shuffle_ps( Box.Minimum, Box.Minimum, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+	const auto QueryMinimumY = _mm_shuffle_ps( Box.Minimum, Box.Minimum, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+	const auto QueryMinimumZ = _mm_shuffle_ps( Box.Minimum, Box.Minimum, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+	const auto QueryMaximumX = _mm_shuffle_ps( Box.Maximum, Box.Maximum, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+	const auto QueryMaximumY = _mm_shuffle_ps( Box.Maximum, Box.Maximum, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+	const auto QueryMaximumZ = _mm_shuffle_ps( Box.Maximum, Box.Maximum, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+	int32_t Stack[StackSize];
+	size_t Top = 0;
+	Stack[Top++] = 0;
+
+	while( Top > 0 )
+	{
+		const auto& Current = Nodes[Stack[--Top]];
+
+		// Same comparison as BoundingBoxSIMD::Intersects, for all four children.
+		auto Overlap = _mm_and_ps( _mm_cmple_ps( _mm_load_ps( Current.MinimumX ), QueryMaximumX ), _mm_cmpge_ps( _mm_load_ps( Current.MaximumX ), QueryMinimumX ) );
+		Overlap = _mm_and_ps( Overlap, _mm_and_ps( _mm_cmple_ps( _mm_load_ps( Current.MinimumY ), QueryMaximumY ), _mm_cmpge_ps( _mm_load_ps( Current.MaximumY ), QueryMinimumY ) ) );
+		Overlap = _mm_and_ps( Overlap, _mm_and_ps( _mm_cmple_ps( _mm_load_ps( Current.MinimumZ ), QueryMaximumZ ), _mm_cmpge_ps( _mm_load_ps( Current.MaximumZ ), QueryMinimumZ ) ) );
+
+		const auto Mask = _mm_movemask_ps( Overlap );
+		if( Mask == 0 )
+			continue;
+
+		for( size_t Index = 0; Index < Width; Index++ )
+		{
+			if( ( Mask & ( 1 << Index ) ) == 0 )
+				continue;
+
+			// Unbounded query boxes overlap the inverted bounds of unused slots.
+			const auto Child = Current.Children[Index];
+			if( Child == EmptyChild )
+				continue;
+
+			const auto Count = Current.Count[Index];
+			if( Count == 0 )
+			{
+				Stack[Top++] = Child;
+				continue;
+			}
+
+			for( int32_t Offset = 0; Offset < Count; Offset++ )
+			{
+				if( auto* Object = Objects[Child + Offset] )
+				{
+					Object->Query( Box, Result );
+				}
+			}
+		}
+	}
+}
+
+Geometry::Result FlatBoundingVolumeHierarchy::Cast( const Vector3D& Start, const Vector3D& End, const std::vector<Testable*>& Ignore ) const
+{
+	Geometry::Result Closest;
+	if( Nodes.empty() )
+		return Closest;
+
+	auto Direction = End - Start;
+	const float Length = Direction.Normalize();
+	if( Length <= 0.0f )
+		return Closest;
+
+	// Avoid infinities in the slab test, they turn into NaNs when the ray starts on a plane.
+	for( int32_t Axis = 0; Axis < 3; Axis++ )
+	{
+		if( std::abs( Direction[Axis] ) < 1e-8f )
+		{
+			Direction[Axis] = Direction[Axis] < 0.0f ? -1e-8f : 1e-8f;
+		}
+	}
+
+	const auto OriginX = _mm_set1_ps( Start.X );
+	const auto OriginY = _mm_set1_ps( Start.Y );
+	const auto OriginZ = _mm_set1_ps( Start.Z );
+	const auto InverseX = _mm_set1_ps( 1.0f / Direction.X );
+	const auto InverseY = _mm_set1_ps( 1.0f / Direction.Y );
+	const auto InverseZ = _mm_set1_ps( 1.0f / Direction.Z );
+	const auto Zero = _mm_setzero_ps();
+
+	float Far = Length;
+
+	int32_t Stack[StackSize];
+	size_t Top = 0;
+	Stack[Top++] = 0;
+
+	while( Top > 0 )
+	{
+		const auto& Current = Nodes[Stack[--Top]];
+
+		const auto MinimumX = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( Current.MinimumX ), OriginX ), InverseX );
+		const auto MaximumX = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( Current.MaximumX ), OriginX ), InverseX );
+		const auto MinimumY = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( Current.MinimumY ), OriginY ), InverseY );
+		const auto MaximumY = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( Current.MaximumY ), OriginY ), InverseY );
+		const auto MinimumZ = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( Current.MinimumZ ), OriginZ ), InverseZ );
+		const auto MaximumZ = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( Current.MaximumZ ), OriginZ ), InverseZ );
+
+		auto Near = _mm_max_ps( _mm_min_ps( MinimumX, MaximumX ), _mm_min_ps( MinimumY, MaximumY ) );
+		Near = _mm_max_ps( Near, _mm_min_ps( MinimumZ, MaximumZ ) );
+		Near = _mm_max_ps( Near, Zero );
+
+		auto Exit = _mm_min_ps( _mm_max_ps( MinimumX, MaximumX ), _mm_max_ps( MinimumY, MaximumY ) );
+		Exit = _mm_min_ps( Exit, _mm_max_ps( MinimumZ, MaximumZ ) );
+		Exit = _mm_min_ps( Exit, _mm_set1_ps( Far ) );
+
+		const auto Mask = _mm_movemask_ps( _mm_cmple_ps( Near, Exit ) );
+		if( Mask == 0 )
+			continue;
+
+		alignas( 16 ) float Distances[Width];
+		_mm_store_ps( Distances, Near );
+
+		// Push the furthest child first so that the nearest one is visited first.
+		int32_t Order[Width];
+		size_t OrderCount = 0;
+
+		for( size_t Index = 0; Index < Width; Index++ )
+		{
+			if( ( Mask & ( 1 << Index ) ) == 0 )
+				continue;
+
+			// Inverted bounds don't reject rays in the slab test, skip the unused slots explicitly.
+			const auto Child = Current.Children[Index];
+			if( Child == EmptyChild )
+				continue;
+
+			const auto Count = Current.Count[Index];
+			if( Count == 0 )
+			{
+				Order[OrderCount++] = static_cast<int32_t>( Index );
+				continue;
+			}
+
+			for( int32_t Offset = 0; Offset < Count; Offset++ )
+			{
+				auto* Object = Objects[Child + Offset];
+				if( !Object )
+					continue;
+
+				const auto Result = Object->Cast( Start, End, Ignore );
+				if( Result.Hit && ( !Closest.Hit || Result.Distance < Closest.Distance ) )
+				{
+					Closest = Result;
+					Far = Result.Distance;
+				}
+			}
+		}
+
+		std::sort( Order, Order + OrderCount, [&Distances] ( const int32_t A, const int32_t B )
+			{
+				return Distances[A] > Distances[B];
+			}
+		);
+
+		for( size_t Index = 0; Index < OrderCount; Index++ )
+		{
+			// The closest hit may have moved in front of this child.
+			if( Distances[Order[Index]] > Far )
+				continue;
+
+			Stack[Top++] = Current.Children[Order[Index]];
+		}
+	}
+
+	return Closest;
+}
+
+void FlatBoundingVolumeHierarchy::Debug() const
+{
+	for( const auto& Current : Nodes )
+	{
+		for( size_t Index = 0; Index < Width; Index++ )
+		{
+			if( Current.Children[Index] == EmptyChild )
+				continue;
+
+			if( DrawFlatBVHBounds )
+			{
+				const Vector3D Minimum( Current.MinimumX[Index], Current.MinimumY[Index], Current.MinimumZ[Index] );
+				const Vector3D Maximum( Current.MaximumX[Index], Current.MaximumY[Index], Current.MaximumZ[Index] );
+				UI::AddAABB( Minimum, Maximum, Current.Count[Index] == 0 ? Color::Blue : Color::Green );
+			}
+
+			for( int32_t Offset = 0; Offset < Current.Count[Index]; Offset++ )
+			{
+				if( auto* Object = Objects[Current.Children[Index] + Offset] )
+				{
+					Object->Debug();
+				}
+			}
+		}
+	}
+}
+
+BoundingBoxSIMD FlatBoundingVolumeHierarchy::GetBounds() const
+{
+	return Bounds;
+}
+
+std::shared_ptr<Testable> FlatBoundingVolumeHierarchy::Build( RawObjectList& Source )
+{
+	const auto Result = std::make_shared<FlatBoundingVolumeHierarchy>();
+
+	std::vector<FlatBuildEntry> Entries;
+	Entries.reserve( Source.size() );
+
+	BoundingBox Bounds = EmptyBox();
+	for( auto* Object : Source )
+	{
+		if( !Object )
+			continue;
+
+		const auto ObjectBounds = Object->GetBounds().Fetch();
+		Entries.push_back( { ObjectBounds, ObjectBounds.Center(), Object } );
+		Grow( Bounds, ObjectBounds );
+	}
+
+	if( Entries.empty() )
+		return Result;
+
+	Result->Bounds = Bounds;
+
+	// Leaves hold up to four objects and nodes up to four leaves.
+	Result->Nodes.reserve( Entries.size() / ( LeafSize * Width ) * 2 + 1 );
+	Result->BuildNode( Entries, 0, Entries.size(), 0 );
+
+	// The builder has sorted the entries in leaf order.
+	Result->Objects.reserve( Entries.size() );
+	for( const auto& Entry : Entries )
+	{
+		Result->Objects.emplace_back( Entry.Object );
+	}
+
+	return Result;
+}
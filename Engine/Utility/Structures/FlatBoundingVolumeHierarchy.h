@@ -0,0 +1,69 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <Engine/Physics/GeometryResult.h>
+#include <Engine/Utility/Math/BoundingBox.h>
+#include <Engine/Utility/Structures/Testable.h>
+#include <Engine/Utility/Structures/QueryResult.h>
+
+#include <memory>
+#include <vector>
+
+struct FlatBuildEntry;
+
+// Four-wide bounding volume hierarchy that is stored in a single array.
+// Built using a binned surface area heuristic, the child boxes of a node are tested at once.
+// Objects can't be inserted after building, use this for geometry that doesn't move.
+class FlatBoundingVolumeHierarchy : public Testable
+{
+public:
+	typedef Testable* RawObject;
+	typedef std::vector<RawObject> RawObjectList;
+
+	static constexpr size_t Width = 4;
+
+	// The child bounds are stored per axis so that they can be loaded straight into SIMD registers.
+	struct alignas( 16 ) Node
+	{
+		float MinimumX[Width];
+		float MinimumY[Width];
+		float MinimumZ[Width];
+		float MaximumX[Width];
+		float MaximumY[Width];
+		float MaximumZ[Width];
+
+		// Index of the child node, or the index of the first object when the child is a leaf.
+		int32_t Children[Width];
+
+		// Amount of objects in the leaf, zero for child nodes.
+		int32_t Count[Width];
+	};
+
+	static_assert( sizeof( Node ) == 128, "Flat BVH nodes are expected to span two cache lines." );
+
+	FlatBoundingVolumeHierarchy() = default;
+	~FlatBoundingVolumeHierarchy() override = default;
+
+	// Removes the object without changing the layout of the tree.
+	void Remove( RawObject Object );
+
+	void Query( const BoundingBoxSIMD& Box, QueryResult& Result ) override;
+	Geometry::Result Cast( const Vector3D& Start, const Vector3D& End, const std::vector<Testable*>& Ignore ) const override;
+	void Debug() const override;
+
+	BoundingBoxSIMD GetBounds() const override;
+
+	size_t GetNodeCount() const
+	{
+		return Nodes.size();
+	}
+
+	static std::shared_ptr<Testable> Build( RawObjectList& Source );
+
+private:
+	int32_t BuildNode( std::vector<FlatBuildEntry>& Entries, const size_t Start, const size_t End, const size_t Depth );
+
+	std::vector<Node> Nodes;
+	std::vector<RawObject> Objects;
+	BoundingBoxSIMD Bounds;
+};
@@ -4,6 +4,7 @@
 #include <Engine/Profiling/Logging.h>
 
 #include <algorithm>
+#include <sstream>
 
 namespace JSON
 {
@@ -0,0 +1,468 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "JSONDocument.h"
+#include "JSONReader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <Engine/Utility/Hash.h>
+#include <Engine/Utility/String.h>
+
+namespace JSON
+{
+	ENodeType::Type Node::Type() const
+	{
+		return Owner ? Owner->Entries[Index].Type : ENodeType::Null;
+	}
+
+	const char* Node::Key() const
+	{
+		return Owner ? &Owner->Strings[Owner->Entries[Index].Key] : "";
+	}
+
+	size_t Node::KeyLength() const
+	{
+		return Owner ? Owner->Entries[Index].KeyLength : 0;
+	}
+
+	const char* Node::Value() const
+	{
+		return Owner ? &Owner->Strings[Owner->Entries[Index].Value] : "";
+	}
+
+	size_t Node::ValueLength() const
+	{
+		return Owner ? Owner->Entries[Index].ValueLength : 0;
+	}
+
+	bool Node::HasNumber() const
+	{
+		return Owner && Owner->Entries[Index].HasNumber;
+	}
+
+	double Node::Number() const
+	{
+		return Owner ? Owner->Entries[Index].Number : 0.0;
+	}
+
+	size_t Node::Size() const
+	{
+		return Owner ? Owner->Entries[Index].Children : 0;
+	}
+
+	Node Node::operator[]( const size_t Child ) const
+	{
+		if( Child >= Size() )
+			return Node();
+
+		return Node( Owner, Owner->Entries[Index].FirstChild + static_cast<uint32_t>( Child ) );
+	}
+
+	Node Node::Find( const char* Key ) const
+	{
+		if( !Owner )
+			return Node();
+
+		const auto& Entry = Owner->Entries[Index];
+		if( Entry.Lookups == 0 )
+			return Node();
+
+		const size_t Length = std::strlen( Key );
+		const uint32_t KeyHash = FNV::Bytes32( Key, Length );
+
+		const auto* Begin = Owner->Lookup.data() + Entry.FirstLookup;
+		const auto* End = Begin + Entry.Lookups;
+		auto* Lookup = std::lower_bound( Begin, End, KeyHash, [] ( const Document::FLookup& Lookup, const uint32_t Hash ) -> bool
+			{
+				return Lookup.Hash < Hash;
+			}
+		);
+
+		// Entries with the same hash are stored in the order they appear in, the first matching key wins.
+		for( ; Lookup != End && Lookup->Hash == KeyHash; ++Lookup )
+		{
+			const auto& Child = Owner->Entries[Lookup->Index];
+			if( Child.KeyLength == Length && std::memcmp( &Owner->Strings[Child.Key], Key, Length ) == 0 )
+				return Node( Owner, Lookup->Index );
+		}
+
+		return Node();
+	}
+
+	Node Node::Find( const std::string& Key ) const
+	{
+		return Find( Key.c_str() );
+	}
+
+	Node::Iterator Node::begin() const
+	{
+		return Owner ? Iterator( Owner, Owner->Entries[Index].FirstChild ) : Iterator( nullptr, 0 );
+	}
+
+	Node::Iterator Node::end() const
+	{
+		if( !Owner )
+			return Iterator( nullptr, 0 );
+
+		const auto& Entry = Owner->Entries[Index];
+		return Iterator( Owner, Entry.FirstChild + Entry.Children );
+	}
+
+	bool Node::Assign( const char* Key, std::string& Target ) const
+	{
+		const auto Child = Find( Key );
+		if( !Child.Valid() )
+			return false;
+
+		Target.assign( Child.Value(), Child.ValueLength() );
+		Target = String::Replace( Target, "\\\\n", "\n" );
+		return true;
+	}
+
+	bool Node::Assign( const char* Key, bool& Target ) const
+	{
+		const auto Child = Find( Key );
+		if( !Child.Valid() )
+			return false;
+
+		Target = !( Child.ValueLength() == 1 && Child.Value()[0] == '0' );
+		return true;
+	}
+
+	// Clamps the number to the range of the target type, converting a double that is out of range is undefined.
+	template<typename T>
+	static T Clamp( const double Number )
+	{
+		constexpr auto Minimum = static_cast<double>( std::numeric_limits<T>::lowest() );
+		constexpr auto Maximum = static_cast<double>( std::numeric_limits<T>::max() );
+		return static_cast<T>( std::max( Minimum, std::min( Number, Maximum ) ) );
+	}
+
+	bool Node::Assign( const char* Key, int& Target ) const
+	{
+		const auto Child = Find( Key );
+		if( !Child.HasNumber() )
+			return false;
+
+		Target = Clamp<int>( Child.Number() );
+		return true;
+	}
+
+	bool Node::Assign( const char* Key, unsigned int& Target ) const
+	{
+		const auto Child = Find( Key );
+		if( !Child.HasNumber() )
+			return false;
+
+		Target = Clamp<unsigned int>( Child.Number() );
+		return true;
+	}
+
+	bool Node::Assign( const char* Key, float& Target ) const
+	{
+		const auto Child = Find( Key );
+		if( !Child.HasNumber() )
+			return false;
+
+		Target = static_cast<float>( Child.Number() );
+		return true;
+	}
+
+	bool Node::Assign( const char* Key, Vector3D& Target ) const
+	{
+		const auto Child = Find( Key );
+		if( !Child.Valid() )
+			return false;
+
+		Extract( Child.Value(), Target );
+		return true;
+	}
+
+	bool Node::Assign( const char* Key, Vector4D& Target ) const
+	{
+		const auto Child = Find( Key );
+		if( !Child.Valid() )
+			return false;
+
+		Extract( Child.Value(), Target );
+		return true;
+	}
+
+	// Parses the stored text as a number if it doesn't contain anything else.
+	static bool ToNumber( const char* Text, const size_t Length, double& Number )
+	{
+		if( Length == 0 || !IsNumeric( Text[0] ) || Text[0] == 'e' || Text[0] == 'E' )
+			return false;
+
+		char* Last = nullptr;
+		Number = std::strtod( Text, &Last );
+		return Last == Text + Length;
+	}
+
+	// Stores the nodes in the arrays of the document as the reader finds them.
+	class DocumentHandler : public Handler
+	{
+	public:
+		DocumentHandler( Document& Target ) : Target( Target ) {}
+
+		bool OnObjectBegin() override
+		{
+			return Begin( ENodeType::Object );
+		}
+
+		bool OnObjectEnd() override
+		{
+			return End();
+		}
+
+		bool OnArrayBegin() override
+		{
+			return Begin( ENodeType::Array );
+		}
+
+		bool OnArrayEnd() override
+		{
+			return End();
+		}
+
+		bool OnKey( const char* Text, const size_t Length ) override
+		{
+			Key = Target.Store( Text, Length );
+			KeyLength = static_cast<uint32_t>( Length );
+
+			if( !Scopes.empty() )
+			{
+				Scopes.back().HasKeys = true;
+			}
+
+			return true;
+		}
+
+		bool OnValue( const char* Value, const size_t Length, const ENodeType::Type Type ) override
+		{
+			auto Entry = Next();
+			Entry.Type = Type;
+
+			if( Type != ENodeType::Null )
+			{
+				// Most numbers in level files are stored as strings, booleans are stored as "1" and "0".
+				Entry.Value = Target.Store( Value, Length );
+				Entry.ValueLength = static_cast<uint32_t>( Length );
+				Entry.HasNumber = ToNumber( &Target.Strings[Entry.Value], Entry.ValueLength, Entry.Number );
+			}
+
+			Add( Entry );
+			return true;
+		}
+
+		Document::FEntry Root;
+
+	private:
+		struct FScope
+		{
+			Document::FEntry Entry;
+
+			// Position of the first child on the stack of the document.
+			size_t First = 0;
+			bool HasKeys = false;
+		};
+
+		// Creates an entry for the key that was read last.
+		Document::FEntry Next()
+		{
+			Document::FEntry Entry;
+			Entry.Key = Key;
+			Entry.KeyLength = KeyLength;
+
+			Key = 0;
+			KeyLength = 0;
+			return Entry;
+		}
+
+		void Add( const Document::FEntry& Entry )
+		{
+			if( Scopes.empty() )
+			{
+				Root = Entry;
+			}
+			else
+			{
+				Target.Stack.emplace_back( Entry );
+			}
+		}
+
+		bool Begin( const ENodeType::Type Type )
+		{
+			FScope Scope;
+			Scope.Entry = Next();
+			Scope.Entry.Type = Type;
+			Scope.First = Target.Stack.size();
+			Scopes.emplace_back( Scope );
+			return true;
+		}
+
+		bool End()
+		{
+			const FScope Scope = Scopes.back();
+			Scopes.pop_back();
+
+			auto Entry = Scope.Entry;
+			auto& Entries = Target.Entries;
+			auto& Lookup = Target.Lookup;
+			auto& Stack = Target.Stack;
+
+			// Move the children next to each other.
+			Entry.FirstChild = static_cast<uint32_t>( Entries.size() );
+			Entry.Children = static_cast<uint32_t>( Stack.size() - Scope.First );
+			Entries.insert( Entries.end(), Stack.begin() + Scope.First, Stack.end() );
+			Stack.resize( Scope.First );
+
+			if( Scope.HasKeys )
+			{
+				Entry.FirstLookup = static_cast<uint32_t>( Lookup.size() );
+				for( uint32_t Index = 0; Index < Entry.Children; Index++ )
+				{
+					const auto& Child = Entries[Entry.FirstChild + Index];
+					if( Child.KeyLength == 0 )
+						continue;
+
+					Document::FLookup Item;
+					Item.Hash = FNV::Bytes32( &Target.Strings[Child.Key], Child.KeyLength );
+					Item.Index = Entry.FirstChild + Index;
+					Lookup.emplace_back( Item );
+				}
+
+				Entry.Lookups = static_cast<uint32_t>( Lookup.size() - Entry.FirstLookup );
+
+				// Keys with the same hash stay in document order.
+				std::sort( Lookup.begin() + Entry.FirstLookup, Lookup.end(), [] ( const Document::FLookup& A, const Document::FLookup& B ) -> bool
+					{
+						return A.Hash < B.Hash || ( A.Hash == B.Hash && A.Index < B.Index );
+					}
+				);
+			}
+
+			Add( Entry );
+			return true;
+		}
+
+		Document& Target;
+		std::vector<FScope> Scopes;
+
+		uint32_t Key = 0;
+		uint32_t KeyLength = 0;
+	};
+
+	bool Document::Parse( const char* Data, const size_t Length )
+	{
+		Entries.clear();
+		Lookup.clear();
+		Strings.clear();
+		Stack.clear();
+		ErrorMessage.clear();
+		Line = 1;
+		Offset = 0;
+
+		// Keys and values that are empty point at the first character.
+		Strings.reserve( Length + 1 );
+		Strings.emplace_back( '\0' );
+
+		// Roughly one node per 16 characters in typical level files.
+		Entries.reserve( Length / 16 + 1 );
+
+		DocumentHandler Handler( *this );
+		Reader Parser;
+		if( !Parser.Parse( Data, Length, Handler ) )
+		{
+			ErrorMessage = Parser.Error();
+			Line = Parser.ErrorLine();
+			Offset = Parser.ErrorOffset();
+
+			Entries.clear();
+			Lookup.clear();
+			Stack = std::vector<FEntry>();
+			return false;
+		}
+
+		Entries.emplace_back( Handler.Root );
+		Stack = std::vector<FEntry>();
+		return true;
+	}
+
+	bool Document::Parse( const std::string& Data )
+	{
+		return Parse( Data.c_str(), Data.size() );
+	}
+
+	bool Document::Parse( const CFile& File )
+	{
+		return Parse( File.Fetch<char>(), File.Size() );
+	}
+
+	Node Document::Root() const
+	{
+		if( Entries.empty() )
+			return Node();
+
+		return Node( this, static_cast<uint32_t>( Entries.size() - 1 ) );
+	}
+
+	uint32_t Document::Store( const char* Text, const size_t Length )
+	{
+		const auto Position = static_cast<uint32_t>( Strings.size() );
+		Strings.insert( Strings.end(), Text, Text + Length );
+		Strings.emplace_back( '\0' );
+		return Position;
+	}
+
+	static void Convert( Container& Container, const Node& Source, Object* Parent )
+	{
+		auto* Target = Container.Allocate();
+		Target->Parent = Parent;
+		if( Parent )
+		{
+			Parent->Objects.emplace_back( Target );
+		}
+
+		const auto Type = Source.Type();
+		if( Type == ENodeType::Object || Type == ENodeType::Array )
+		{
+			Target->Key.assign( Source.Key(), Source.KeyLength() );
+			Target->IsObject = Type == ENodeType::Object || Source.KeyLength() == 0;
+			Target->IsArray = !Target->IsObject;
+
+			for( const auto& Child : Source )
+			{
+				Convert( Container, Child, Target );
+			}
+		}
+		else if( Source.KeyLength() > 0 )
+		{
+			Target->IsField = true;
+			Target->Key.assign( Source.Key(), Source.KeyLength() );
+			Target->Value.assign( Source.Value(), Source.ValueLength() );
+		}
+		else
+		{
+			// The linked tree stores the elements of string arrays as keys.
+			Target->IsField = true;
+			Target->Key.assign( Source.Value(), Source.ValueLength() );
+		}
+	}
+
+	Container Tree( const Document& Document )
+	{
+		Container Container;
+
+		const auto Root = Document.Root();
+		for( const auto& Child : Root )
+		{
+			Convert( Container, Child, nullptr );
+		}
+
+		Container.Regenerate();
+		return Container;
+	}
+}
@@ -0,0 +1,193 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Engine/Utility/Structures/JSON.h>
+
+namespace JSON
+{
+	namespace ENodeType
+	{
+		enum Type : uint8_t
+		{
+			Null = 0,
+			Object,
+			Array,
+			String,
+			Number,
+			Boolean
+		};
+	}
+
+	class Document;
+
+	// Handle to a node in a document, it is only valid as long as the document isn't modified or destroyed.
+	class Node
+	{
+	public:
+		class Iterator
+		{
+		public:
+			Iterator( const Document* Owner, const uint32_t Index ) : Owner( Owner ), Index( Index ) {}
+
+			Node operator*() const
+			{
+				return Node( Owner, Index );
+			}
+
+			Iterator& operator++()
+			{
+				Index++;
+				return *this;
+			}
+
+			bool operator!=( const Iterator& Other ) const
+			{
+				return Index != Other.Index;
+			}
+
+		private:
+			const Document* Owner;
+			uint32_t Index;
+		};
+
+		Node() = default;
+		Node( const Document* Owner, const uint32_t Index ) : Owner( Owner ), Index( Index ) {}
+
+		bool Valid() const
+		{
+			return Owner != nullptr;
+		}
+
+		ENodeType::Type Type() const;
+
+		bool IsObject() const
+		{
+			return Type() == ENodeType::Object;
+		}
+
+		bool IsArray() const
+		{
+			return Type() == ENodeType::Array;
+		}
+
+		// Empty for array elements and the root.
+		const char* Key() const;
+		size_t KeyLength() const;
+
+		// Text of strings, numbers and booleans. Numbers keep the text they were written with.
+		const char* Value() const;
+		size_t ValueLength() const;
+
+		// Numbers are parsed once when the document is parsed, this includes strings that only contain a number.
+		bool HasNumber() const;
+		double Number() const;
+
+		// Amount of children of objects and arrays.
+		size_t Size() const;
+		Node operator[]( const size_t Index ) const;
+
+		// Binary search over the hashed keys of the children, returns an invalid node when the key can't be found.
+		Node Find( const char* Key ) const;
+		Node Find( const std::string& Key ) const;
+
+		Iterator begin() const;
+		Iterator end() const;
+
+		// Same behavior as JSON::Assign, the target is left untouched when the key can't be found.
+		bool Assign( const char* Key, std::string& Target ) const;
+		bool Assign( const char* Key, bool& Target ) const;
+		bool Assign( const char* Key, int& Target ) const;
+		bool Assign( const char* Key, unsigned int& Target ) const;
+		bool Assign( const char* Key, float& Target ) const;
+		bool Assign( const char* Key, Vector3D& Target ) const;
+		bool Assign( const char* Key, Vector4D& Target ) const;
+
+	private:
+		const Document* Owner = nullptr;
+		uint32_t Index = 0;
+	};
+
+	// Parsed JSON document, all of its nodes, strings and keys are stored in a few contiguous arrays.
+	// The children of a node are stored next to each other and can be looked up by the hash of their key.
+	// The syntax is handled by JSON::Reader, so it also accepts the files written by Container::Export.
+	class Document
+	{
+	public:
+		bool Parse( const char* Data, const size_t Length );
+		bool Parse( const std::string& Data );
+		bool Parse( const CFile& File );
+
+		Node Root() const;
+
+		size_t Nodes() const
+		{
+			return Entries.size();
+		}
+
+		// Description of the first syntax error, its line and byte offset.
+		const std::string& Error() const
+		{
+			return ErrorMessage;
+		}
+
+		size_t ErrorLine() const
+		{
+			return Line;
+		}
+
+		size_t ErrorOffset() const
+		{
+			return Offset;
+		}
+
+	private:
+		friend class Node;
+		friend class DocumentHandler;
+
+		struct FEntry
+		{
+			uint32_t Key = 0;
+			uint32_t KeyLength = 0;
+			uint32_t Value = 0;
+			uint32_t ValueLength = 0;
+
+			// Children for objects and arrays, each child has an entry in the lookup table when its parent has keys.
+			uint32_t FirstChild = 0;
+			uint32_t Children = 0;
+			uint32_t FirstLookup = 0;
+			uint32_t Lookups = 0;
+
+			double Number = 0.0;
+			ENodeType::Type Type = ENodeType::Null;
+			bool HasNumber = false;
+		};
+
+		struct FLookup
+		{
+			uint32_t Hash = 0;
+			uint32_t Index = 0;
+		};
+
+		uint32_t Store( const char* Text, const size_t Length );
+
+		std::vector<FEntry> Entries;
+		std::vector<FLookup> Lookup;
+
+		// Null-terminated keys and values.
+		std::vector<char> Strings;
+
+		// Children of the containers that are being parsed.
+		std::vector<FEntry> Stack;
+
+		std::string ErrorMessage;
+		size_t Line = 1;
+		size_t Offset = 0;
+	};
+
+	// Converts the document for loaders that use the linked tree.
+	Container Tree( const Document& Document );
+}
@@ -0,0 +1,378 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "JSONReader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/String.h>
+
+namespace JSON
+{
+	// Nesting limit, protects the stack against malicious or broken files.
+	static const size_t MaximumDepth = 256;
+
+	bool Reader::Parse( const char* Data, const size_t Length, Handler& Handler )
+	{
+		Target = &Handler;
+		Scopes.clear();
+		ErrorMessage.clear();
+		Line = 1;
+		Offset = 0;
+		Stopped = false;
+
+		Start = Data;
+		Token = Data;
+		End = Data + Length;
+
+		if( !SkipWhitespace() )
+			return Fail( "The document is empty." );
+
+		if( !ParseValue() )
+			return false;
+
+		while( !Scopes.empty() )
+		{
+			const char Close = Scopes.back();
+			if( !SkipWhitespace() )
+				return Fail( Close == '}' ? "Unterminated object." : "Unterminated array." );
+
+			if( *Token == Close )
+			{
+				Token++;
+				Scopes.pop_back();
+
+				const bool Continue = Close == '}' ? Target->OnObjectEnd() : Target->OnArrayEnd();
+				if( !Continue )
+					return Abort();
+
+				continue;
+			}
+
+			// Commas are optional, the exporter doesn't write them after arrays.
+			if( *Token == ',' )
+			{
+				Token++;
+				continue;
+			}
+
+			if( *Token == '"' )
+			{
+				const char* Text = nullptr;
+				size_t TextLength = 0;
+				if( !ParseString( Text, TextLength ) )
+					return false;
+
+				if( !SkipWhitespace() )
+					return Fail( "Unexpected end of the document." );
+
+				if( *Token == ':' )
+				{
+					Token++;
+					if( !Target->OnKey( Text, TextLength ) )
+						return Abort();
+
+					if( !SkipWhitespace() )
+						return Fail( "Missing value." );
+
+					if( !ParseValue() )
+						return false;
+				}
+				else if( Close == '}' )
+				{
+					return Fail( "Expected ':' after the key." );
+				}
+				else
+				{
+					// String array element.
+					if( !Target->OnValue( Text, TextLength, ENodeType::String ) )
+						return Abort();
+				}
+			}
+			else if( Close == '}' )
+			{
+				return Fail( "Expected a key." );
+			}
+			else if( !ParseValue() )
+			{
+				return false;
+			}
+		}
+
+		// Text files can have a terminator.
+		if( SkipWhitespace() && *Token != '\0' )
+			return Fail( "Unexpected data after the root." );
+
+		return true;
+	}
+
+	bool Reader::Parse( const std::string& Data, Handler& Handler )
+	{
+		return Parse( Data.c_str(), Data.size(), Handler );
+	}
+
+	bool Reader::Parse( const CFile& File, Handler& Handler )
+	{
+		return Parse( File.Fetch<char>(), File.Size(), Handler );
+	}
+
+	bool Reader::Fail( const char* Message )
+	{
+		Offset = static_cast<size_t>( Token - Start );
+		ErrorMessage = Message;
+		Log::Event( Log::Warning, "JSON syntax error on line %zu (offset %zu): %s\n", Line, Offset, Message );
+		return false;
+	}
+
+	bool Reader::Abort()
+	{
+		Offset = static_cast<size_t>( Token - Start );
+		Stopped = true;
+		return false;
+	}
+
+	// Skips spaces and comments, returns false at the end of the data.
+	bool Reader::SkipWhitespace()
+	{
+		while( Token < End )
+		{
+			const char Character = *Token;
+			if( Character == '\n' )
+			{
+				Line++;
+			}
+			else if( Character == '/' && Token + 1 < End && Token[1] == '/' )
+			{
+				while( Token < End && *Token != '\n' )
+				{
+					Token++;
+				}
+
+				continue;
+			}
+			else if( Character != ' ' && Character != '\t' && Character != '\r' )
+			{
+				return true;
+			}
+
+			Token++;
+		}
+
+		return false;
+	}
+
+	bool Reader::ParseString( const char*& Text, size_t& Length )
+	{
+		// Skip the opening quote.
+		Token++;
+
+		const char* First = Token;
+		bool Escaped = false;
+		while( Token < End && *Token != '"' )
+		{
+			if( *Token == '\\' )
+			{
+				// Hop over the escaped character.
+				Escaped = true;
+				Token++;
+			}
+
+			if( Token < End && *Token == '\n' )
+			{
+				Line++;
+			}
+
+			Token++;
+		}
+
+		if( Token >= End )
+			return Fail( "Unterminated string." );
+
+		if( Escaped )
+		{
+			// Uses the same rules as the strings written by the exporter.
+			Buffer = String::Unescape( std::string( First, Token ) );
+			Text = Buffer.c_str();
+			Length = Buffer.size();
+		}
+		else
+		{
+			// Points straight into the source.
+			Text = First;
+			Length = static_cast<size_t>( Token - First );
+		}
+
+		// Skip the closing quote.
+		Token++;
+		return true;
+	}
+
+	bool Reader::ParseNumber()
+	{
+		const char* First = Token;
+		while( Token < End && IsNumeric( *Token ) )
+		{
+			Token++;
+		}
+
+		// The source doesn't have to be null-terminated.
+		Buffer.assign( First, Token );
+
+		char* Last = nullptr;
+		std::strtod( Buffer.c_str(), &Last );
+		if( *First == 'e' || *First == 'E' || Last != Buffer.c_str() + Buffer.size() )
+			return Fail( "Invalid number." );
+
+		return Target->OnValue( First, Buffer.size(), ENodeType::Number ) || Abort();
+	}
+
+	bool Reader::ParseLiteral()
+	{
+		const size_t Remaining = End - Token;
+		if( Remaining >= 4 && std::memcmp( Token, "true", 4 ) == 0 )
+		{
+			Token += 4;
+			return Target->OnValue( "1", 1, ENodeType::Boolean ) || Abort();
+		}
+
+		if( Remaining >= 5 && std::memcmp( Token, "false", 5 ) == 0 )
+		{
+			Token += 5;
+			return Target->OnValue( "0", 1, ENodeType::Boolean ) || Abort();
+		}
+
+		if( Remaining >= 4 && std::memcmp( Token, "null", 4 ) == 0 )
+		{
+			Token += 4;
+			return Target->OnValue( "", 0, ENodeType::Null ) || Abort();
+		}
+
+		return Fail( "Unexpected character." );
+	}
+
+	bool Reader::ParseValue()
+	{
+		const char Character = *Token;
+		if( Character == '{' || Character == '[' )
+		{
+			if( Scopes.size() >= MaximumDepth )
+				return Fail( "The document is nested too deeply." );
+
+			Token++;
+
+			if( Character == '{' )
+			{
+				Scopes.emplace_back( '}' );
+				return Target->OnObjectBegin() || Abort();
+			}
+
+			Scopes.emplace_back( ']' );
+			return Target->OnArrayBegin() || Abort();
+		}
+
+		if( Character == '"' )
+		{
+			const char* Text = nullptr;
+			size_t Length = 0;
+			if( !ParseString( Text, Length ) )
+				return false;
+
+			return Target->OnValue( Text, Length, ENodeType::String ) || Abort();
+		}
+
+		if( IsNumeric( Character ) )
+			return ParseNumber();
+
+		return ParseLiteral();
+	}
+
+	Object* Builder::Add()
+	{
+		auto* Object = Target.Allocate();
+		if( !Stack.empty() )
+		{
+			Object->Parent = Stack.back();
+			Object->Parent->Objects.emplace_back( Object );
+		}
+
+		return Object;
+	}
+
+	bool Builder::Begin( const bool IsObject )
+	{
+		auto* Object = Add();
+		Object->Key.swap( Key );
+		Object->IsObject = IsObject || Object->Key.empty();
+		Object->IsArray = !Object->IsObject;
+		Key.clear();
+
+		Stack.emplace_back( Object );
+		return true;
+	}
+
+	bool Builder::End()
+	{
+		if( !Stack.empty() )
+		{
+			Stack.pop_back();
+		}
+
+		if( Stack.empty() )
+		{
+			Target.Regenerate();
+		}
+
+		return true;
+	}
+
+	bool Builder::OnObjectBegin()
+	{
+		return Begin( true );
+	}
+
+	bool Builder::OnObjectEnd()
+	{
+		return End();
+	}
+
+	bool Builder::OnArrayBegin()
+	{
+		return Begin( false );
+	}
+
+	bool Builder::OnArrayEnd()
+	{
+		return End();
+	}
+
+	bool Builder::OnKey( const char* Text, const size_t Length )
+	{
+		Key.assign( Text, Length );
+		return true;
+	}
+
+	bool Builder::OnValue( const char* Value, const size_t Length, const ENodeType::Type Type )
+	{
+		auto* Object = Add();
+		Object->IsField = true;
+
+		if( Key.empty() )
+		{
+			// The linked tree stores the elements of string arrays as keys.
+			Object->Key.assign( Value, Length );
+		}
+		else
+		{
+			Object->Key.swap( Key );
+			Object->Value.assign( Value, Length );
+			Key.clear();
+		}
+
+		if( Stack.empty() )
+		{
+			Target.Regenerate();
+		}
+
+		return true;
+	}
+}
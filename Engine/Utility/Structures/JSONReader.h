@@ -0,0 +1,148 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Engine/Utility/Structures/JSONDocument.h>
+
+namespace JSON
+{
+	// Characters that can appear in numbers.
+	inline bool IsNumeric( const char Character )
+	{
+		return ( Character >= '0' && Character <= '9' ) || Character == '-' || Character == '+' || Character == '.' || Character == 'e' || Character == 'E';
+	}
+
+	// Receives the events of a reader, returning false stops the reader.
+	class Handler
+	{
+	public:
+		virtual ~Handler() = default;
+
+		virtual bool OnObjectBegin()
+		{
+			return true;
+		}
+
+		virtual bool OnObjectEnd()
+		{
+			return true;
+		}
+
+		virtual bool OnArrayBegin()
+		{
+			return true;
+		}
+
+		virtual bool OnArrayEnd()
+		{
+			return true;
+		}
+
+		// Keys and values are only valid during the call and aren't null-terminated.
+		virtual bool OnKey( const char* Key, const size_t Length )
+		{
+			return true;
+		}
+
+		// Booleans are passed as "1" and "0" like the exporter writes them, null is passed as an empty value.
+		virtual bool OnValue( const char* Value, const size_t Length, const ENodeType::Type Type )
+		{
+			return true;
+		}
+	};
+
+	// Reads a document from front to back and passes everything it finds on to a handler, nothing is stored.
+	// Also accepts the files written by Container::Export, which contain keys in arrays and omit some of the commas.
+	class Reader
+	{
+	public:
+		bool Parse( const char* Data, const size_t Length, Handler& Handler );
+		bool Parse( const std::string& Data, Handler& Handler );
+		bool Parse( const CFile& File, Handler& Handler );
+
+		// Description of the first syntax error, its line and byte offset.
+		const std::string& Error() const
+		{
+			return ErrorMessage;
+		}
+
+		size_t ErrorLine() const
+		{
+			return Line;
+		}
+
+		size_t ErrorOffset() const
+		{
+			return Offset;
+		}
+
+		// True when the handler stopped the reader, the line and offset point at where it stopped.
+		bool Aborted() const
+		{
+			return Stopped;
+		}
+
+		// Byte offset right after the token that was passed to the handler, only valid during the call.
+		size_t Position() const
+		{
+			return static_cast<size_t>( Token - Start );
+		}
+
+	private:
+		bool ParseValue();
+		bool ParseString( const char*& Text, size_t& Length );
+		bool ParseNumber();
+		bool ParseLiteral();
+		bool SkipWhitespace();
+		bool Fail( const char* Message );
+		bool Abort();
+
+		Handler* Target = nullptr;
+
+		// Closing characters of the containers that are open.
+		std::vector<char> Scopes;
+
+		// Unescaped strings and numbers.
+		std::string Buffer;
+
+		const char* Token = nullptr;
+		const char* End = nullptr;
+		const char* Start = nullptr;
+
+		std::string ErrorMessage;
+		size_t Line = 1;
+		size_t Offset = 0;
+		bool Stopped = false;
+	};
+
+	// Builds the linked tree out of the events it receives, using the same layout as JSON::Tree.
+	class Builder : public Handler
+	{
+	public:
+		Builder( Container& Target ) : Target( Target ) {}
+
+		bool OnObjectBegin() override;
+		bool OnObjectEnd() override;
+		bool OnArrayBegin() override;
+		bool OnArrayEnd() override;
+		bool OnKey( const char* Key, const size_t Length ) override;
+		bool OnValue( const char* Value, const size_t Length, const ENodeType::Type Type ) override;
+
+		// Amount of objects and arrays that haven't been closed yet.
+		size_t Depth() const
+		{
+			return Stack.size();
+		}
+
+	private:
+		Object* Add();
+		bool Begin( const bool IsObject );
+		bool End();
+
+		Container& Target;
+		std::vector<Object*> Stack;
+		std::string Key;
+	};
+}
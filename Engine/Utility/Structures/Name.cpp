@@ -1,52 +1,127 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "Name.h"
 
+#include <cstring>
 #include <mutex>
 
-static NameIndex PoolIndex = 0;
+#include <Engine/Profiling/Logging.h>
 
-NameSymbol NameSymbol::Invalid = NameSymbol( "INVALID STRING" );
-
-NameSymbol::NameSymbol()
+NamePool::NamePool()
 {
-	Index = Invalid.Index;
+	for( auto& Chunk : Chunks )
+	{
+		Chunk.store( nullptr, std::memory_order_relaxed );
+	}
+
+	Count.store( 0, std::memory_order_release );
 }
 
-NameSymbol::NameSymbol( const char* Name )
+NamePool::~NamePool()
 {
-	std::lock_guard<std::shared_mutex> Lock( NamePool::Get().Mutex );
-
-	const auto String = std::string( Name );
-	const auto& NamePool = NamePool::Get().Pool();
-	const auto& Iterator = NamePool.find( String );
-
-	if( Iterator == NamePool.end() )
+	for( auto& Chunk : Chunks )
 	{
-		const auto& Result = NamePool::Get().Pool().insert_or_assign( String, PoolIndex++ );
-		Index = Result.first->second;
+		delete[] Chunk.load( std::memory_order_acquire );
 	}
-	else
+}
+
+NameIndex NamePool::Find( const char* Name, const size_t Length, const uint32_t Hash )
+{
+	NameIndex Index;
+
 	{
-		Index = Iterator->second;
+		// Most names already exist, readers don't block each other.
+		std::shared_lock<std::shared_mutex> Lock( Mutex );
+		if( Search( Name, Length, Hash, Index ) )
+			return Index;
 	}
+
+	std::lock_guard<std::shared_mutex> Lock( Mutex );
+
+	// Another thread may have added the name in the meantime.
+	if( Search( Name, Length, Hash, Index ) )
+		return Index;
+
+	return Add( Name, Length, Hash );
 }
 
-NameSymbol::NameSymbol( const std::string& Name )
+const std::string* NamePool::String( const NameIndex Index ) const
 {
-	std::lock_guard<std::shared_mutex> Lock( NamePool::Get().Mutex );
+	if( Index >= Count.load( std::memory_order_acquire ) )
+		return nullptr;
+
+	const FEntry* Chunk = Chunks[Index / ChunkSize].load( std::memory_order_acquire );
+	return &Chunk[Index % ChunkSize].Text;
+}
+
+bool NamePool::Search( const char* Name, const size_t Length, const uint32_t Hash, NameIndex& Index ) const
+{
+	const auto Iterator = Buckets.find( Hash );
+	if( Iterator == Buckets.end() )
+		return false;
+
+	for( Index = Iterator->second; Index != None; )
+	{
+		const FEntry& Entry = Chunks[Index / ChunkSize].load( std::memory_order_relaxed )[Index % ChunkSize];
+		if( Entry.Text.size() == Length && std::memcmp( Entry.Text.data(), Name, Length ) == 0 )
+			return true;
+
+		Index = Entry.Next;
+	}
 
-	const auto& NamePool = NamePool::Get().Pool();
-	const auto& Iterator = NamePool.find( Name );
+	return false;
+}
 
-	if( Iterator == NamePool.end() )
+NameIndex NamePool::Add( const char* Name, const size_t Length, const uint32_t Hash )
+{
+	const NameIndex Index = Count.load( std::memory_order_relaxed );
+	const size_t ChunkIndex = Index / ChunkSize;
+	if( ChunkIndex >= MaximumChunks )
 	{
-		const auto& Result = NamePool::Get().Pool().insert_or_assign( Name, PoolIndex++ );
-		Index = Result.first->second;
+		Log::Event( Log::Fatal, "Name pool is full (%zu names).\n", ChunkSize * MaximumChunks );
+		return NameSymbol::Invalid.Get();
 	}
-	else
+
+	FEntry* Chunk = Chunks[ChunkIndex].load( std::memory_order_relaxed );
+	if( !Chunk )
 	{
-		Index = Iterator->second;
+		Chunk = new FEntry[ChunkSize];
+		Chunks[ChunkIndex].store( Chunk, std::memory_order_release );
 	}
+
+	FEntry& Entry = Chunk[Index % ChunkSize];
+	Entry.Text.assign( Name, Length );
+	Entry.Hash = Hash;
+
+	auto& First = Buckets.emplace( Hash, static_cast<NameIndex>( None ) ).first->second;
+	Entry.Next = First;
+	First = Index;
+
+	// Publishes the entry to String, which doesn't lock.
+	Count.store( Index + 1, std::memory_order_release );
+	return Index;
+}
+
+NameSymbol NameSymbol::Invalid = NameSymbol( "INVALID STRING" );
+
+NameSymbol::NameSymbol()
+{
+	Index = Invalid.Index;
+}
+
+NameSymbol::NameSymbol( const char* Name )
+{
+	const size_t Length = std::strlen( Name );
+	Index = NamePool::Get().Find( Name, Length, FNV::Bytes32( Name, Length ) );
+}
+
+NameSymbol::NameSymbol( const std::string& Name )
+{
+	Index = NamePool::Get().Find( Name.c_str(), Name.size(), FNV::Bytes32( Name.c_str(), Name.size() ) );
+}
+
+NameSymbol::NameSymbol( const NameLiteral& Name )
+{
+	Index = NamePool::Get().Find( Name.Text, Name.Length, Name.Hash );
 }
 
 NameSymbol::NameSymbol( const NameIndex& Index )
@@ -56,14 +131,9 @@ NameSymbol::NameSymbol( const NameIndex& Index )
 
 const std::string& NameSymbol::String() const
 {
-	const auto& NamePool = NamePool::Get().Pool();
-	for( const auto& Iterator : NamePool )
-	{
-		if( Iterator.second == Index )
-		{
-			return Iterator.first;
-		}
-	}
+	const auto* String = NamePool::Get().String( Index );
+	if( String )
+		return *String;
 
 	return Invalid.String();
 }
@@ -3,9 +3,11 @@
 
 #include <unordered_map>
 #include <atomic>
+#include <cstdint>
 #include <string>
 #include <shared_mutex>
 
+#include <Engine/Utility/Hash.h>
 #include <Engine/Utility/Singleton.h>
 
 typedef uint32_t NameIndex;
@@ -13,13 +15,57 @@ typedef uint32_t NameIndex;
 class NamePool : public Singleton<NamePool>
 {
 public:
-	std::unordered_map<std::string, NameIndex>& Pool()
+	NamePool();
+	~NamePool();
+
+	// Returns the index of a name, the name is added if it doesn't exist yet.
+	// Existing names are looked up under a shared lock.
+	NameIndex Find( const char* Name, const size_t Length, const uint32_t Hash );
+
+	// Doesn't lock, names are never moved once they have been added. Returns null for unknown indices.
+	const std::string* String( const NameIndex Index ) const;
+
+	size_t Size() const
 	{
-		return Names;
+		return Count.load( std::memory_order_acquire );
 	}
 
-	std::unordered_map<std::string, NameIndex> Names;
-	std::shared_mutex Mutex;
+private:
+	struct FEntry
+	{
+		std::string Text;
+		uint32_t Hash = 0;
+
+		// Next entry with the same hash.
+		NameIndex Next = None;
+	};
+
+	static const NameIndex None = static_cast<NameIndex>( -1 );
+
+	bool Search( const char* Name, const size_t Length, const uint32_t Hash, NameIndex& Index ) const;
+	NameIndex Add( const char* Name, const size_t Length, const uint32_t Hash );
+
+	// Entries are appended to fixed-size chunks that are never reallocated.
+	static const size_t ChunkSize = 4096;
+	static const size_t MaximumChunks = 16384;
+	std::atomic<FEntry*> Chunks[MaximumChunks];
+	std::atomic<NameIndex> Count;
+
+	// First entry of every hash.
+	std::unordered_map<uint32_t, NameIndex> Buckets;
+	mutable std::shared_mutex Mutex;
+};
+
+// String literal with its hash computed at compile time, use it to construct symbols for fixed names.
+//	static constexpr NameLiteral DrawCalls( "Draw Calls" );
+struct NameLiteral
+{
+	template<size_t Length>
+	constexpr NameLiteral( const char( &Text )[Length] ) : Text( Text ), Length( Length - 1 ), Hash( FNV::String32( Text ) ) {}
+
+	const char* Text;
+	size_t Length;
+	uint32_t Hash;
 };
 
 /// <summary>
@@ -34,12 +80,13 @@ public:
 
 	NameSymbol( const char* Name );
 	NameSymbol( const std::string& Name );
+	NameSymbol( const NameLiteral& Name );
 	NameSymbol( const NameIndex& Index );
 
 	NameSymbol& operator=( const NameSymbol& Name );
 	NameSymbol& operator=( const std::string& String );
 
-	// Fetches the string from the pool. Note: This is an expensive lookup.
+	// Fetches the string from the pool.
 	const std::string& String() const;
 
 	bool operator==( const NameSymbol& Name ) const;
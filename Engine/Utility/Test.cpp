@@ -0,0 +1,135 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "Test.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+
+#include <Engine/Utility/Test/DynamicStorageBufferTest.h>
+#include <Engine/Utility/Test/InstancingTest.h>
+#include <Engine/Utility/Test/LevelLoadTest.h>
+#include <Engine/Utility/Test/LightGridTest.h>
+#include <Engine/Utility/Test/PerformanceBVHTest.h>
+#include <Engine/Utility/Test/PerformanceCookedMeshTest.h>
+#include <Engine/Utility/Test/PerformanceCullingTest.h>
+#include <Engine/Utility/Test/PerformanceDataTest.h>
+#include <Engine/Utility/Test/PerformanceFileTest.h>
+#include <Engine/Utility/Test/PerformanceIntegrationTest.h>
+#include <Engine/Utility/Test/PerformanceJSONTest.h>
+#include <Engine/Utility/Test/PerformanceJobTest.h>
+#include <Engine/Utility/Test/PerformanceLevelReaderTest.h>
+#include <Engine/Utility/Test/PerformanceLightGridTest.h>
+#include <Engine/Utility/Test/PerformanceNameTest.h>
+#include <Engine/Utility/Test/PerformanceOBJTest.h>
+#include <Engine/Utility/Test/PerformancePhysicsQueryTest.h>
+#include <Engine/Utility/Test/PerformancePhysicsSleepTest.h>
+#include <Engine/Utility/Test/PerformancePhysicsTest.h>
+#include <Engine/Utility/Test/PerformanceRenderSortTest.h>
+#include <Engine/Utility/Test/PerformanceShaderCacheTest.h>
+#include <Engine/Utility/Test/PerformanceStringTest.h>
+#include <Engine/Utility/Test/PerformanceTextureDecodeTest.h>
+#include <Engine/Utility/Test/PerformanceTriangleTreeTest.h>
+#include <Engine/Utility/Test/PhysicsReplayTest.h>
+#include <Engine/Utility/Test/PhysicsTunnelingTest.h>
+#include <Engine/Utility/Test/ShaderCacheTest.h>
+#include <Engine/Utility/Test/UniformCacheTest.h>
+
+static std::string ToLower( std::string String )
+{
+	std::transform( String.begin(), String.end(), String.begin(), ::tolower );
+	return String;
+}
+
+static std::vector<CTest*> GetTests()
+{
+	static CStringPerformanceTest StringPerformance;
+	static CJobPerformanceTest JobPerformance;
+	static CPhysicsPerformanceTest PhysicsPerformance;
+	static CBVHPerformanceTest BVHPerformance;
+	static CPhysicsQueryPerformanceTest PhysicsQueryPerformance;
+	static CPhysicsSleepPerformanceTest PhysicsSleepPerformance;
+	static CIntegrationPerformanceTest IntegrationPerformance;
+	static CPhysicsTunnelingTest PhysicsTunneling;
+	static CTriangleTreePerformanceTest TriangleTreePerformance;
+	static CPhysicsReplayTest PhysicsReplay;
+	static CRenderSortPerformanceTest RenderSortPerformance;
+	static CCullingPerformanceTest CullingPerformance;
+	static CUniformCacheTest UniformCache;
+	static CInstancingTest Instancing;
+	static CLightGridTest LightGrid;
+	static CLightGridPerformanceTest LightGridPerformance;
+	static CDynamicStorageBufferTest DynamicStorageBuffer;
+	static CShaderCacheTest ShaderCache;
+	static CShaderCachePerformanceTest ShaderCachePerformance;
+	static CTextureDecodePerformanceTest TextureDecodePerformance;
+	static CCookedMeshPerformanceTest CookedMeshPerformance;
+	static CDataPerformanceTest DataPerformance;
+	static CFilePerformanceTest FilePerformance;
+	static CJSONPerformanceTest JSONPerformance;
+	static CLevelReaderPerformanceTest LevelReaderPerformance;
+	static CLevelLoadTest LevelLoad;
+	static COBJPerformanceTest OBJPerformance;
+	static CNamePerformanceTest NamePerformance;
+
+	return {
+		&StringPerformance,
+		&JobPerformance,
+		&PhysicsPerformance,
+		&BVHPerformance,
+		&PhysicsQueryPerformance,
+		&PhysicsSleepPerformance,
+		&IntegrationPerformance,
+		&PhysicsTunneling,
+		&TriangleTreePerformance,
+		&PhysicsReplay,
+		&RenderSortPerformance,
+		&CullingPerformance,
+		&UniformCache,
+		&Instancing,
+		&LightGrid,
+		&LightGridPerformance,
+		&DynamicStorageBuffer,
+		&ShaderCache,
+		&ShaderCachePerformance,
+		&TextureDecodePerformance,
+		&CookedMeshPerformance,
+		&DataPerformance,
+		&FilePerformance,
+		&JSONPerformance,
+		&LevelReaderPerformance,
+		&LevelLoad,
+		&OBJPerformance,
+		&NamePerformance
+	};
+}
+
+bool Tests::Run( const std::string& Filter )
+{
+	const auto Query = ToLower( Filter );
+	const bool RunAll = Query.empty() || Query == "all";
+
+	bool Success = true;
+	size_t Executed = 0;
+	for( auto* Test : GetTests() )
+	{
+		const auto Name = ToLower( Test->GetName() );
+		if( !RunAll && Name.find( Query ) == std::string::npos )
+			continue;
+
+		Log::Event( "Running \"%s\".\n", Test->GetName() );
+		const auto Result = Test->Run();
+		Log::Event( "\"%s\" %s.\n", Test->GetName(), Result == ETestResult::Succeeded ? "succeeded" : "failed" );
+
+		Success &= Result == ETestResult::Succeeded;
+		Executed++;
+	}
+
+	if( Executed == 0 )
+	{
+		Log::Event( Log::Warning, "No tests match \"%s\".\n", Filter.c_str() );
+		return false;
+	}
+
+	return Success;
+}
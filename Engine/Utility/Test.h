@@ -3,6 +3,8 @@
 
 #include "TestResult.h"
 
+#include <string>
+
 class CTest
 {
 public:
@@ -26,3 +28,10 @@ public:
 		return "Unnamed";
 	};
 };
+
+namespace Tests
+{
+	// Runs every registered test whose name contains the filter. ("all" runs everything)
+	// Returns false if any of the tests failed.
+	bool Run( const std::string& Filter );
+}
@@ -0,0 +1,181 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "DynamicStorageBufferTest.h"
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/Display/Rendering/DynamicStorageBuffer.h>
+#include <Engine/Display/Rendering/Light/Light.h>
+#include <Engine/Profiling/Logging.h>
+
+constexpr size_t LightCount = 64;
+constexpr size_t StaticFrames = 100;
+
+// Stand-in for the GL buffer objects.
+struct RecordedBuffers
+{
+	std::unordered_map<unsigned int, std::vector<uint8_t>> Storage;
+	unsigned int NextHandle = 1;
+	size_t Alignment = 0;
+	size_t Fences = 0;
+
+	unsigned int Bound = 0;
+	size_t BoundOffset = 0;
+	size_t BoundSize = 0;
+};
+
+static RecordedBuffers Recorded;
+
+static void* Create( unsigned int& Handle, size_t Size, bool Persistent )
+{
+	Handle = Recorded.NextHandle++;
+	auto& Storage = Recorded.Storage[Handle];
+	Storage.resize( Size );
+	return Persistent ? Storage.data() : nullptr;
+}
+
+static void Destroy( unsigned int Handle )
+{
+	Recorded.Storage.erase( Handle );
+}
+
+static void Upload( unsigned int Handle, size_t Offset, size_t Size, const void* Data )
+{
+	std::memcpy( Recorded.Storage[Handle].data() + Offset, Data, Size );
+}
+
+static void Bind( unsigned int Handle, uint32_t Binding, size_t Offset, size_t Size )
+{
+	Recorded.Bound = Handle;
+	Recorded.BoundOffset = Offset;
+	Recorded.BoundSize = Size;
+}
+
+static void* Fence()
+{
+	Recorded.Fences++;
+	return &Recorded.Fences;
+}
+
+static bool Wait( void* Fence )
+{
+	return false;
+}
+
+static size_t Alignment()
+{
+	return Recorded.Alignment;
+}
+
+// Checks if the bound range holds the same lights as the CPU.
+static bool Matches( const std::vector<Light>& Lights )
+{
+	if( Recorded.BoundSize != Lights.size() * sizeof( Light ) )
+		return false;
+
+	const auto& Storage = Recorded.Storage[Recorded.Bound];
+	return std::memcmp( Storage.data() + Recorded.BoundOffset, Lights.data(), Recorded.BoundSize ) == 0;
+}
+
+static size_t Frame( CDynamicStorageBuffer& Buffer, const std::vector<Light>& Lights, bool& Valid )
+{
+	const size_t Bytes = Buffer.Upload( Lights.data() );
+	Buffer.Bind();
+	Valid &= Matches( Lights );
+	return Bytes;
+}
+
+static bool Measure( const bool Persistent )
+{
+	Recorded = RecordedBuffers();
+	Recorded.Alignment = Persistent ? 256 : 0;
+	StorageBufferDispatch::ResetStatistics();
+
+	std::vector<Light> Lights( LightCount );
+	for( size_t Index = 0; Index < LightCount; Index++ )
+	{
+		const float Offset = static_cast<float>( Index );
+		Lights[Index].Position = glm::vec4( Offset, 10.0f, -Offset, Index < 16 ? 0.0f : -1.0f );
+		Lights[Index].Direction = glm::vec4( 0.0f, -1.0f, 0.0f, 10.0f );
+		Lights[Index].Color = glm::vec4( 1.0f, 1.0f, 1.0f, 100.0f );
+		Lights[Index].Properties = glm::vec4( 1.0f, 1.0f, 0.0f, 0.0f );
+	}
+
+	CDynamicStorageBuffer Buffer;
+	Buffer.Initialize( LightCount, sizeof( Light ), Persistent );
+
+	bool Valid = Buffer.IsPersistent() == Persistent;
+	const size_t Initial = Frame( Buffer, Lights, Valid );
+
+	size_t Static = 0;
+	for( size_t Index = 0; Index < StaticFrames; Index++ )
+	{
+		Static += Frame( Buffer, Lights, Valid );
+	}
+
+	// Change a light until the ring has wrapped around, every region has to catch up on the changes it missed.
+	for( size_t Index = 0; Index < CDynamicStorageBuffer::RingSize * 2; Index++ )
+	{
+		Lights[3].Color.w += 1.0f;
+		Buffer.MarkDirty( 3 );
+		Frame( Buffer, Lights, Valid );
+	}
+
+	// Two adjacent lights and one on its own should be written as two ranges.
+	const auto Ranges = StorageBufferDispatch::Statistics().Ranges;
+	for( const size_t Index : { 3, 4, 20 } )
+	{
+		Lights[Index].Position.y += 5.0f;
+		Buffer.MarkDirty( Index );
+	}
+
+	const size_t Moved = Frame( Buffer, Lights, Valid );
+	const auto MovedRanges = StorageBufferDispatch::Statistics().Ranges - Ranges;
+
+	size_t Settled = 0;
+	for( size_t Index = 0; Index < StaticFrames; Index++ )
+	{
+		Settled += Frame( Buffer, Lights, Valid );
+	}
+
+	const auto Total = StorageBufferDispatch::Statistics().Bytes;
+	Buffer.Release();
+
+	Log::Event( "%s: initial %zu bytes | %zu static frames %zu bytes | moved 3 lights %zu bytes in %lli ranges | settled %zu bytes | total %lli bytes\n",
+		Persistent ? "Persistent ring" : "Sub-data", Initial, StaticFrames, Static, Moved, MovedRanges, Settled, Total );
+
+	if( !Valid )
+	{
+		Log::Event( Log::Error, "The bound light buffer doesn't match the lights.\n" );
+		return false;
+	}
+
+	return Initial == LightCount * sizeof( Light ) && Static == 0 && Settled == 0 && Moved == 3 * sizeof( Light ) && MovedRanges == 2;
+}
+
+ETestResult CDynamicStorageBufferTest::Run()
+{
+	StorageBufferFunctions Functions;
+	Functions.Create = Create;
+	Functions.Destroy = Destroy;
+	Functions.Upload = Upload;
+	Functions.Bind = Bind;
+	Functions.Fence = Fence;
+	Functions.Wait = Wait;
+	Functions.PersistentAlignment = Alignment;
+	StorageBufferDispatch::Override( Functions );
+
+	const bool SubData = Measure( false );
+	const bool Persistent = Measure( true );
+
+	StorageBufferDispatch::Override( StorageBufferFunctions() );
+	StorageBufferDispatch::ResetStatistics();
+
+	return SubData && Persistent ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CDynamicStorageBufferTest::GetName()
+{
+	return "Dynamic Storage Buffer Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Records the light buffer uploads without a GPU, static lights shouldn't be uploaded again.
+class CDynamicStorageBufferTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
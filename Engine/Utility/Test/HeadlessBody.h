@@ -0,0 +1,35 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <Engine/Physics/Body/Body.h>
+
+// Body that isn't attached to an entity, its transform is stored in the body itself.
+// Used to run the physics simulation without a world.
+class CHeadlessBody : public CBody
+{
+public:
+	const FTransform& GetTransform() const override
+	{
+		return Transform;
+	}
+
+	void SetTransform( const FTransform& NewTransform ) const override
+	{
+		Transform = NewTransform;
+	}
+
+	// The body doesn't have an owner to pass the integrated position on to.
+	void PostIntegrate( const Vector3D& Position ) override
+	{
+		CBody::PostIntegrate( Position );
+
+		Transform.SetPosition( Position );
+		PreviousTransform = Transform;
+		CalculateBounds();
+	}
+
+	mutable FTransform Transform;
+
+	// Velocity that is applied by the test itself.
+	Vector3D Direction = Vector3D::Zero;
+};
@@ -0,0 +1,196 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "InstancingTest.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <Engine/Display/Rendering/InstanceBatch.h>
+#include <Engine/Display/Rendering/Mesh.h>
+#include <Engine/Display/Rendering/Renderable.h>
+#include <Engine/Display/Rendering/Shader.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t PropCount = 4000;
+
+// Every n-th renderable is culled.
+constexpr size_t CullInterval = 7;
+
+// Draw call as it would be submitted by the render pass.
+struct RecordedDraw
+{
+	CRenderable* Renderable = nullptr;
+	uint32_t Instances = 1;
+	int32_t InstanceOffset = -1;
+};
+
+// Records the draw calls in the order CRenderPass::Render submits them.
+static void Record( const std::vector<CRenderable*>& Renderables, const bool Instancing, std::vector<FInstanceBatch>& Batches, std::vector<FInstanceData>& Instances, std::vector<RecordedDraw>& Draws )
+{
+	Draws.clear();
+
+	if( Instancing )
+	{
+		InstanceBatch::Build( Renderables, Batches, Instances );
+	}
+
+	InstanceBatch::Submit( Renderables, Batches, Instancing, [&Draws] ( CRenderable* Renderable, const uint32_t Instances, const int32_t InstanceOffset )
+		{
+			RecordedDraw Draw;
+			Draw.Renderable = Renderable;
+			Draw.Instances = Instances;
+			Draw.InstanceOffset = InstanceOffset;
+			Draws.emplace_back( Draw );
+		}
+	);
+}
+
+static bool Equal( const Matrix4D& A, const Matrix4D& B )
+{
+	for( int Column = 0; Column < 4; Column++ )
+	{
+		for( int Row = 0; Row < 4; Row++ )
+		{
+			if( A[Column][Row] != B[Column][Row] )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+ETestResult CInstancingTest::Run()
+{
+	// Shaders only have to be preprocessed, the batching doesn't need a GPU.
+	CShader InstancedShader;
+	InstancedShader.Process( "#version 430\n#instanced\nvoid main() {}\n" );
+
+	CShader PlainShader;
+	PlainShader.Process( "#version 430\nvoid main() {}\n" );
+
+	if( !InstancedShader.IsInstanced() || PlainShader.IsInstanced() )
+	{
+		Log::Event( Log::Error, "The #instanced directive wasn't picked up.\n" );
+		return ETestResult::Failed;
+	}
+
+	CMesh Rock;
+	CMesh Tree;
+
+	std::vector<std::unique_ptr<CRenderable>> Props;
+	std::vector<CRenderable*> Renderables;
+
+	// Renderables that can't be merged with their neighbours.
+	size_t Unique = 0;
+	for( size_t Index = 0; Index < PropCount; Index++ )
+	{
+		Props.emplace_back( new CRenderable() );
+		auto* Renderable = Props.back().get();
+
+		// Most of the scene consists of identical props, some use a plain shader or have their own tint.
+		const size_t Kind = Index % 10;
+		Renderable->SetShader( Kind == 9 ? &PlainShader : &InstancedShader );
+		Renderable->SetMesh( Kind < 6 ? &Rock : &Tree );
+		if( Kind == 8 )
+		{
+			Renderable->SetUniform( "Tint", static_cast<float>( Index ) );
+		}
+
+		auto& RenderData = Renderable->GetRenderData();
+		RenderData.DrawMode = EDrawMode::Triangles;
+		RenderData.Transform.SetPosition( Vector3D( static_cast<float>( Index ), 0.0f, static_cast<float>( Index % 13 ) ) );
+		RenderData.ShouldRender = Index % CullInterval != 0;
+
+		if( RenderData.ShouldRender && Kind >= 8 )
+		{
+			Unique++;
+		}
+
+		Renderables.emplace_back( Renderable );
+	}
+
+	// Render queues are sorted by shader and mesh.
+	std::stable_sort( Renderables.begin(), Renderables.end(), [] ( CRenderable* A, CRenderable* B )
+		{
+			if( A->GetShader() != B->GetShader() )
+				return A->GetShader() < B->GetShader();
+
+			if( A->GetMesh() != B->GetMesh() )
+				return A->GetMesh() < B->GetMesh();
+
+			return A->GetUniforms().Size() < B->GetUniforms().Size();
+		}
+	);
+
+	std::vector<FInstanceBatch> Batches;
+	std::vector<FInstanceData> Instances;
+	std::vector<RecordedDraw> Draws;
+
+	Record( Renderables, false, Batches, Instances, Draws );
+	const size_t PlainDraws = Draws.size();
+
+	Timer Build;
+	Build.Start();
+	Record( Renderables, true, Batches, Instances, Draws );
+	Build.Stop();
+
+	Log::Event( "%zu renderables: %zu draws without instancing, %zu draws with instancing (%zu instances, %llius).\n",
+		PropCount, PlainDraws, Draws.size(), Instances.size(), Build.GetElapsedTimeMicroseconds() );
+
+	// Every visible renderable has to be drawn exactly once, with its own transform.
+	size_t Drawn = 0;
+	size_t Cursor = 0;
+	for( const auto& Draw : Draws )
+	{
+		while( Renderables[Cursor] != Draw.Renderable )
+		{
+			Cursor++;
+		}
+
+		if( Draw.InstanceOffset < 0 )
+		{
+			Drawn++;
+			Cursor++;
+			continue;
+		}
+
+		for( uint32_t Instance = 0; Instance < Draw.Instances; Cursor++ )
+		{
+			auto& RenderData = Renderables[Cursor]->GetRenderData();
+			if( !RenderData.ShouldRender )
+				continue;
+
+			const auto& Packed = Instances[Draw.InstanceOffset + Instance];
+			if( !Equal( Packed.Model, RenderData.Transform.GetTransformationMatrix() ) )
+			{
+				Log::Event( Log::Error, "Instance %u doesn't match its renderable.\n", Draw.InstanceOffset + Instance );
+				return ETestResult::Failed;
+			}
+
+			Instance++;
+			Drawn++;
+		}
+	}
+
+	if( Drawn != PlainDraws )
+	{
+		Log::Event( Log::Error, "Instancing drew %zu renderables instead of %zu.\n", Drawn, PlainDraws );
+		return ETestResult::Failed;
+	}
+
+	// Untinted props should end up in one draw per mesh.
+	const size_t Expected = Unique + 2;
+	if( Draws.size() != Expected )
+	{
+		Log::Event( Log::Error, "Expected %zu draws.\n", Expected );
+		return ETestResult::Failed;
+	}
+
+	return ETestResult::Succeeded;
+}
+
+const char* CInstancingTest::GetName()
+{
+	return "Instancing Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Counts the draw calls that a render pass submits with and without instanced batching.
+class CInstancingTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,205 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "LevelLoadTest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/Structures/JSON.h>
+#include <Engine/World/Level/Level.h>
+#include <Engine/World/World.h>
+
+static const std::string Directory = "Cache/Test/Level/";
+static const std::string LevelLocation = Directory + "Test.sls";
+static const std::string SubLevelLocation = Directory + "SubLevel.sls";
+
+static const char* TargetIdentifier = "6f1c2d3e-4a5b-4c6d-8e7f-0123456789ab";
+
+// The entities are listed before the assets, the source links to a target that is spawned after it.
+static std::string LevelSource()
+{
+	return
+		"{\n"
+		"\t\"entities\" : [\n"
+		"\t\t{\n"
+		"\t\t\t\"type\" : \"logic_point\",\n"
+		"\t\t\t\"name\" : \"Source\",\n"
+		"\t\t\t\"outputs\" : [\n"
+		"\t\t\t\t{ \"name\" : \"OnTrigger\", \"target\" : \"Target\", \"input\" : \"Trigger\" }\n"
+		"\t\t\t]\n"
+		"\t\t},\n"
+		"\t\t\"comment\",\n"
+		"\t\t{\n"
+		"\t\t\t\"type\" : \"logic_point\",\n"
+		"\t\t\t\"name\" : \"Target\",\n"
+		"\t\t\t\"uuid\" : \"" + std::string( TargetIdentifier ) + "\"\n"
+		"\t\t},\n"
+		"\t\t{\n"
+		"\t\t\t\"type\" : \"level\",\n"
+		"\t\t\t\"name\" : \"Prefab\",\n"
+		"\t\t\t\"path\" : \"" + SubLevelLocation + "\",\n"
+		"\t\t\t\"position\" : \"1 2 3\"\n"
+		"\t\t}\n"
+		"\t],\n"
+		"\t\"assets\" : [ ]\n"
+		"}\n";
+}
+
+// The assets are listed before the entities, the last entity is empty.
+static std::string SubLevelSource()
+{
+	return
+		"{\n"
+		"\t\"assets\" : [ ],\n"
+		"\t\"entities\" : [\n"
+		"\t\t{\n"
+		"\t\t\t\"type\" : \"logic_point\",\n"
+		"\t\t\t\"name\" : \"Inner\"\n"
+		"\t\t},\n"
+		"\t\t{}\n"
+		"\t]\n"
+		"}\n";
+}
+
+static bool Save( const std::string& Location, const std::string& Contents )
+{
+	CFile File( Location );
+	File.Load( Contents );
+	return File.Save( true );
+}
+
+static std::string Read( const std::string& Location )
+{
+	CFile File( Location );
+	if( !File.Load() )
+		return std::string();
+
+	// Text files are terminated.
+	return std::string( File.Fetch<char>() );
+}
+
+// Identifiers of the entities in the order they are listed in, empty for elements without one.
+static std::vector<std::string> Identifiers( const std::string& Location )
+{
+	std::vector<std::string> Result;
+
+	const auto Tree = JSON::Tree( Read( Location ) );
+	if( const auto* Entities = JSON::Find( Tree.Tree, "entities" ) )
+	{
+		for( const auto* Entity : Entities->Objects )
+		{
+			const auto* Identifier = JSON::Find( Entity->Objects, "uuid" );
+			Result.emplace_back( Identifier ? Identifier->Value : std::string() );
+		}
+	}
+
+	return Result;
+}
+
+ETestResult CLevelLoadTest::Run()
+{
+	if( !Save( LevelLocation, LevelSource() ) || !Save( SubLevelLocation, SubLevelSource() ) )
+	{
+		Log::Event( Log::Error, "Couldn't write the test levels to \"%s\".\n", Directory.c_str() );
+		return ETestResult::Failed;
+	}
+
+	std::string SourceIdentifier;
+	std::string InnerIdentifier;
+
+	bool Success = true;
+	{
+		CWorld World;
+		CLevel& Level = World.Add();
+		Level.Load( LevelLocation );
+
+		auto* Source = World.Find( NameSymbol( "Source" ) );
+		auto* Target = World.Find( NameSymbol( "Target" ) );
+		auto* Inner = World.Find( NameSymbol( "Inner" ) );
+
+		const bool Spawned = Source && Target && Inner;
+		Log::Event( "Spawned: %s\n", Spawned ? "valid" : "invalid" );
+		Success &= Spawned;
+
+		if( Spawned )
+		{
+			SourceIdentifier = Source->Identifier.ID;
+			InnerIdentifier = Inner->Identifier.ID;
+
+			const bool Identified = std::strcmp( Target->Identifier.ID, TargetIdentifier ) == 0 && Source->Identifier.Valid() && Inner->Identifier.Valid();
+			Log::Event( "Identifiers: %s\n", Identified ? "valid" : "invalid" );
+			Success &= Identified;
+
+			// Outputs are linked once every entity of the level exists.
+			const auto Output = Source->Outputs.find( NameSymbol( "OnTrigger" ) );
+			const bool Linked = Output != Source->Outputs.end() &&
+				Output->second.size() == 1 &&
+				Output->second.front().TargetID.ID == Target->GetEntityID().ID &&
+				Output->second.front().Inputs.size() == 1 &&
+				Output->second.front().Inputs.front() == "Trigger";
+			Log::Event( "Outputs: %s\n", Linked ? "valid" : "invalid" );
+			Success &= Linked;
+		}
+
+		auto& Levels = World.GetLevels();
+		bool SubLevel = Levels.size() == 2;
+		if( SubLevel )
+		{
+			const auto Transform = Levels[1].GetTransform();
+			const auto& Position = Transform.GetPosition();
+			SubLevel = Levels[1].Prefab && Position.X == 1.0f && Position.Y == 2.0f && Position.Z == 3.0f && Inner && Inner->GetLevel() == &Levels[1];
+		}
+
+		Log::Event( "Sub-level: %s\n", SubLevel ? "valid" : "invalid" );
+		Success &= SubLevel;
+
+		World.Destroy();
+	}
+
+	// Generated identifiers are written into the entities they belong to, the string element doesn't shift them.
+	const auto LevelIdentifiers = Identifiers( LevelLocation );
+	const auto SubLevelIdentifiers = Identifiers( SubLevelLocation );
+
+	UniqueIdentifier Prefab;
+	UniqueIdentifier Empty;
+	bool Written = LevelIdentifiers.size() == 4 && SubLevelIdentifiers.size() == 2;
+	if( Written )
+	{
+		Prefab.Set( LevelIdentifiers[3] );
+		Empty.Set( SubLevelIdentifiers[1] );
+
+		Written = LevelIdentifiers[0] == SourceIdentifier &&
+			LevelIdentifiers[1].empty() &&
+			LevelIdentifiers[2] == TargetIdentifier &&
+			Prefab.Valid() &&
+			SubLevelIdentifiers[0] == InnerIdentifier &&
+			Empty.Valid();
+	}
+
+	Log::Event( "Write-back: %s\n", Written ? "valid" : "invalid" );
+	Success &= Written;
+
+	// Loading the level again has to use the identifiers that were written and leave the files alone.
+	const std::string Contents = Read( LevelLocation ) + Read( SubLevelLocation );
+	{
+		CWorld World;
+		CLevel& Level = World.Add();
+		Level.Load( LevelLocation );
+
+		auto* Source = World.Find( NameSymbol( "Source" ) );
+		const bool Stable = Source && SourceIdentifier == Source->Identifier.ID && Contents == Read( LevelLocation ) + Read( SubLevelLocation );
+		Log::Event( "Reload: %s\n", Stable ? "valid" : "invalid" );
+		Success &= Stable;
+
+		World.Destroy();
+	}
+
+	return Success ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CLevelLoadTest::GetName()
+{
+	return "Level Load Test";
+}
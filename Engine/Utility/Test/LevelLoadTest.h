@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Loads a small level through CLevel::Load, checks the spawned entities, their links, the sub-level and the identifiers that are written back.
+class CLevelLoadTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,117 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "LightGridTest.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <Engine/Display/Rendering/Light/LightGrid.h>
+#include <Engine/Profiling/Logging.h>
+
+constexpr int32_t LightCount = 200;
+constexpr size_t SampleCount = 20000;
+
+static bool Matches( const LightIndices& A, const LightIndices& B )
+{
+	for( size_t Index = 0; Index < 4; Index++ )
+	{
+		if( A.Index[Index] != B.Index[Index] )
+			return false;
+	}
+
+	return true;
+}
+
+static bool Compare( const CLightGrid& Grid, const std::vector<Light>& Lights, const Vector3D& Position )
+{
+	const auto Expected = LightGrid::Fetch( Lights.data(), static_cast<int32_t>( Lights.size() ), Position );
+	const auto Result = Grid.Fetch( Position );
+	if( Matches( Expected, Result ) )
+		return true;
+
+	Log::Event( Log::Error, "Light mismatch at (%.3f, %.3f, %.3f): expected %i %i %i %i, got %i %i %i %i\n",
+		Position.X, Position.Y, Position.Z,
+		Expected.Index[0], Expected.Index[1], Expected.Index[2], Expected.Index[3],
+		Result.Index[0], Result.Index[1], Result.Index[2], Result.Index[3] );
+	return false;
+}
+
+ETestResult CLightGridTest::Run()
+{
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Coordinate( -600.0f, 600.0f );
+	std::uniform_real_distribution<float> Unit( -1.0f, 1.0f );
+	std::uniform_real_distribution<float> Intensity( 0.0f, 2000.0f );
+	std::uniform_int_distribution<int> Type( -1, 2 );
+
+	// An empty grid shouldn't return any lights.
+	CLightGrid Grid;
+	Grid.Build( nullptr, 0 );
+	if( Grid.Fetch( Vector3D::Zero ).Index[0] != -1 )
+	{
+		Log::Event( Log::Error, "Empty light grid returned a light.\n" );
+		return ETestResult::Failed;
+	}
+
+	// Mix of point, spot and directional lights, including unallocated and dim ones.
+	std::vector<Light> Lights( LightCount );
+	for( auto& Information : Lights )
+	{
+		const auto Direction = Vector3D( Unit( Generator ), Unit( Generator ), Unit( Generator ) ).Normalized();
+		Information.Position = glm::vec4( Coordinate( Generator ), Coordinate( Generator ) * 0.25f, Coordinate( Generator ), static_cast<float>( Type( Generator ) ) );
+		Information.Direction = glm::vec4( Direction.X, Direction.Y, Direction.Z, 10.0f );
+		Information.Color = glm::vec4( 1.0f, 1.0f, 1.0f, Unit( Generator ) > 0.9f ? 0.0f : Intensity( Generator ) );
+		Information.Properties = glm::vec4( 1.0f, 1.0f, 0.0f, 0.0f );
+	}
+
+	// Stack a few lights on top of each other, the selection depends on their order.
+	for( int32_t Index = 1; Index < 8; Index++ )
+	{
+		Lights[Index].Position = Lights[0].Position;
+	}
+
+	Grid.Build( Lights.data(), LightCount );
+
+	size_t Failures = 0;
+	for( size_t Sample = 0; Sample < SampleCount; Sample++ )
+	{
+		// Sample outside of the lit area as well.
+		const Vector3D Position( Coordinate( Generator ) * 1.5f, Coordinate( Generator ) * 0.5f, Coordinate( Generator ) * 1.5f );
+		Failures += Compare( Grid, Lights, Position ) ? 0 : 1;
+	}
+
+	// Positions right around the cull distance of each light.
+	const float CullDistance = std::sqrt( LightGrid::CullDistanceSquared );
+	for( int32_t Index = 0; Index < LightCount; Index++ )
+	{
+		const Vector3D Center( Lights[Index].Position.x, Lights[Index].Position.y, Lights[Index].Position.z );
+		for( const float Scale : { 0.0f, 0.5f, 0.999f, 1.0f, 1.001f } )
+		{
+			const auto Direction = Vector3D( Unit( Generator ), Unit( Generator ), Unit( Generator ) ).Normalized();
+			Failures += Compare( Grid, Lights, Center + Direction * CullDistance * Scale ) ? 0 : 1;
+		}
+	}
+
+	// Changing the lights requires a rebuild.
+	for( int32_t Index = 0; Index < LightCount; Index += 3 )
+	{
+		Lights[Index].Position.x += 75.0f;
+		Lights[Index].Color.w *= 0.5f;
+	}
+
+	Grid.Build( Lights.data(), LightCount );
+	for( size_t Sample = 0; Sample < SampleCount; Sample++ )
+	{
+		const Vector3D Position( Coordinate( Generator ), Coordinate( Generator ) * 0.25f, Coordinate( Generator ) );
+		Failures += Compare( Grid, Lights, Position ) ? 0 : 1;
+	}
+
+	Log::Event( "%u cells, %u entries for %i lights, %u mismatches.\n", Grid.GetCellCount(), Grid.GetEntryCount(), LightCount, Failures );
+
+	return Failures == 0 ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CLightGridTest::GetName()
+{
+	return "Light Grid Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Checks that the light grid picks the same lights as scanning all of them.
+class CLightGridTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
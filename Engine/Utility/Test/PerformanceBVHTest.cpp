@@ -0,0 +1,199 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceBVHTest.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Structures/BoundingVolumeHierarchy.h>
+#include <Engine/Utility/Structures/FlatBoundingVolumeHierarchy.h>
+#include <Engine/Utility/Test/HeadlessBody.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t BodyCount = 50000;
+constexpr size_t QueryCount = 100000;
+
+// Amount of queries that are validated against a brute force search.
+constexpr size_t ValidationCount = 1000;
+
+constexpr float WorldExtent = 500.0f;
+
+struct Segment
+{
+	Vector3D Start;
+	Vector3D End;
+};
+
+static size_t MeasureQueries( const char* Name, Testable* Tree, const std::vector<BoundingBoxSIMD>& Boxes )
+{
+	size_t Hits = 0;
+
+	Timer Total;
+	Total.Start();
+	for( const auto& Box : Boxes )
+	{
+		QueryResult Result;
+		Tree->Query( Box, Result );
+		Hits += Result.Objects.size();
+	}
+	Total.Stop();
+
+	Log::Event( "%s: %zu queries in %ims (%zu objects found)\n", Name, Boxes.size(), Total.GetElapsedTimeMilliseconds(), Hits );
+	return Hits;
+}
+
+static void MeasureCasts( const char* Name, Testable* Tree, const std::vector<Segment>& Segments )
+{
+	size_t Hits = 0;
+
+	Timer Total;
+	Total.Start();
+	for( const auto& Segment : Segments )
+	{
+		const auto Result = Tree->Cast( Segment.Start, Segment.End );
+		Hits += Result.Hit ? 1 : 0;
+	}
+	Total.Stop();
+
+	Log::Event( "%s: %zu casts in %ims (%zu hits)\n", Name, Segments.size(), Total.GetElapsedTimeMilliseconds(), Hits );
+}
+
+static bool ValidateQueries( Testable* Reference, Testable* Tree, const std::vector<BoundingBoxSIMD>& Boxes )
+{
+	for( size_t Index = 0; Index < ValidationCount; Index++ )
+	{
+		QueryResult Expected;
+		Reference->Query( Boxes[Index], Expected );
+
+		QueryResult Result;
+		Tree->Query( Boxes[Index], Result );
+
+		std::sort( Expected.Objects.begin(), Expected.Objects.end() );
+		std::sort( Result.Objects.begin(), Result.Objects.end() );
+		if( Expected.Objects != Result.Objects )
+		{
+			Log::Event( Log::Error, "Query %zu returned %zu objects, expected %zu.\n", Index, Result.Objects.size(), Expected.Objects.size() );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Unbounded boxes also overlap the inverted bounds of unused slots, those shouldn't be visited.
+static bool ValidateUnbounded( Testable* Tree, const size_t Count )
+{
+	const Vector3D Extent( FLT_MAX, FLT_MAX, FLT_MAX );
+	QueryResult Result;
+	Tree->Query( BoundingBox( -Extent, Extent ), Result );
+	if( Result.Objects.size() != Count )
+	{
+		Log::Event( Log::Error, "Unbounded query returned %zu objects, expected %zu.\n", Result.Objects.size(), Count );
+		return false;
+	}
+
+	return true;
+}
+
+static bool ValidateCasts( const std::vector<std::unique_ptr<CHeadlessBody>>& Bodies, Testable* Tree, const std::vector<Segment>& Segments )
+{
+	for( size_t Index = 0; Index < ValidationCount; Index++ )
+	{
+		const auto& Segment = Segments[Index];
+
+		Geometry::Result Expected;
+		for( const auto& Body : Bodies )
+		{
+			const auto Result = Body->Cast( Segment.Start, Segment.End );
+			if( Result.Hit && ( !Expected.Hit || Result.Distance < Expected.Distance ) )
+			{
+				Expected = Result;
+			}
+		}
+
+		const auto Result = Tree->Cast( Segment.Start, Segment.End );
+		if( Result.Hit != Expected.Hit || ( Result.Hit && std::abs( Result.Distance - Expected.Distance ) > 0.001f ) )
+		{
+			Log::Event( Log::Error, "Cast %zu hit at %.3f, expected %.3f.\n", Index, Result.Distance, Expected.Distance );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ETestResult CBVHPerformanceTest::Run()
+{
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( -WorldExtent, WorldExtent );
+	std::uniform_real_distribution<float> Size( 0.25f, 4.0f );
+
+	std::vector<std::unique_ptr<CHeadlessBody>> Bodies;
+	BoundingVolumeHierarchy::RawObjectList Objects;
+	Bodies.reserve( BodyCount );
+	Objects.reserve( BodyCount );
+	for( size_t Index = 0; Index < BodyCount; Index++ )
+	{
+		auto Body = std::make_unique<CHeadlessBody>();
+		Body->Static = true;
+		Body->Transform.SetPosition( Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) * 0.1f ) );
+
+		const Vector3D Extent( Size( Generator ), Size( Generator ), Size( Generator ) );
+		Body->LocalBounds = BoundingBox( -Extent, Extent );
+		Body->CalculateBounds();
+
+		Objects.emplace_back( Body.get() );
+		Bodies.emplace_back( std::move( Body ) );
+	}
+
+	std::vector<BoundingBoxSIMD> Boxes;
+	std::vector<Segment> Segments;
+	Boxes.reserve( QueryCount );
+	Segments.reserve( QueryCount );
+	for( size_t Index = 0; Index < QueryCount; Index++ )
+	{
+		const Vector3D Center( Position( Generator ), Position( Generator ), Position( Generator ) * 0.1f );
+		const Vector3D Extent( Size( Generator ) * 2.0f, Size( Generator ) * 2.0f, Size( Generator ) * 2.0f );
+		Boxes.emplace_back( BoundingBox( Center - Extent, Center + Extent ) );
+
+		const Vector3D Offset( Position( Generator ), Position( Generator ), Position( Generator ) * 0.1f );
+		Segments.push_back( { Center, Center + Offset * 0.2f } );
+	}
+
+	// The builder sorts the list, give both trees the same input.
+	auto SortedObjects = Objects;
+
+	Timer BuildTimer;
+	BuildTimer.Start();
+	auto Tree = BoundingVolumeHierarchy::Build( SortedObjects );
+	BuildTimer.Stop();
+	Log::Event( "BVH: built %zu objects in %ims\n", BodyCount, BuildTimer.GetElapsedTimeMilliseconds() );
+
+	BuildTimer.Start();
+	auto FlatTree = FlatBoundingVolumeHierarchy::Build( Objects );
+	BuildTimer.Stop();
+	Log::Event( "Flat BVH: built %zu objects in %ims\n", BodyCount, BuildTimer.GetElapsedTimeMilliseconds() );
+
+	bool Valid = ValidateQueries( Tree.get(), FlatTree.get(), Boxes );
+	Valid &= ValidateUnbounded( FlatTree.get(), Objects.size() );
+	Valid &= ValidateCasts( Bodies, FlatTree.get(), Segments );
+
+	MeasureQueries( "BVH", Tree.get(), Boxes );
+	MeasureQueries( "Flat BVH", FlatTree.get(), Boxes );
+
+	MeasureCasts( "BVH", Tree.get(), Segments );
+	MeasureCasts( "Flat BVH", FlatTree.get(), Segments );
+
+	BoundingVolumeHierarchy::Destroy( Tree );
+
+	return Valid ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CBVHPerformanceTest::GetName()
+{
+	return "BVH Performance Test";
+}
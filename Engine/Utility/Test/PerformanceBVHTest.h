@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares the build, query and cast performance of the pointer based and flat bounding volume hierarchies.
+class CBVHPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
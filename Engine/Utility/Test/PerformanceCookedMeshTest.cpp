@@ -0,0 +1,349 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceCookedMeshTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <Engine/Animation/AnimationSet.h>
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Display/Rendering/Vertex.h>
+#include <Engine/Physics/TriangleTree.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/CookedMesh.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/LoftyMeshInterface.h>
+#include <Engine/Utility/Primitive.h>
+#include <Engine/Utility/Timer.h>
+
+// 224 x 224 quads, just over 100k triangles.
+constexpr size_t GridSize = 224;
+constexpr uint16_t BoneCount = 32;
+constexpr uint16_t AnimationCount = 4;
+constexpr uint32_t FrameCount = 60;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 5;
+
+static const std::string Directory = "Cache/Test/CookedMesh/";
+static const std::string SourceLocation = Directory + "grid.lmi";
+static const std::string SetLocation = Directory + "grid.ses";
+static const std::string CookedLocation = Directory + "grid.lmc";
+static const std::string PlainLocation = Directory + "plain.lmc";
+
+template<typename T>
+static void Write( std::string& Buffer, const T& Value )
+{
+	Buffer.append( reinterpret_cast<const char*>( &Value ), sizeof( T ) );
+}
+
+static void Write( std::string& Buffer, const std::string& Value )
+{
+	Write( Buffer, static_cast<uint16_t>( Value.size() ) );
+	Buffer.append( Value );
+}
+
+// Writes a skinned grid in the Lofty Mesh Interface format.
+static std::string CreateSource()
+{
+	std::string Buffer = "Lofty-Mesh-Interface ";
+	Write( Buffer, static_cast<uint16_t>( 1 ) );
+	Write( Buffer, static_cast<uint8_t>( 3 ) ); // Mesh and animation.
+
+	const size_t Stride = GridSize + 1;
+	const auto VertexCount = static_cast<uint32_t>( Stride * Stride );
+	Write( Buffer, VertexCount );
+	for( size_t Y = 0; Y < Stride; Y++ )
+	{
+		for( size_t X = 0; X < Stride; X++ )
+		{
+			const float PositionX = static_cast<float>( X );
+			const float PositionY = static_cast<float>( Y );
+			const float Values[14] = {
+				PositionX, PositionY, std::sin( PositionX * 0.1f ) * std::cos( PositionY * 0.13f ) * 4.0f,
+				PositionX / GridSize, PositionY / GridSize,
+				0.0f, 0.0f, 1.0f,
+				1.0f, 0.0f, 0.0f,
+				1.0f, 1.0f, 1.0f
+			};
+
+			Buffer.append( reinterpret_cast<const char*>( Values ), sizeof( Values ) );
+		}
+	}
+
+	const auto IndexCount = static_cast<uint32_t>( GridSize * GridSize * 6 );
+	Write( Buffer, IndexCount );
+	for( size_t Y = 0; Y < GridSize; Y++ )
+	{
+		for( size_t X = 0; X < GridSize; X++ )
+		{
+			const auto Corner = static_cast<uint32_t>( Y * Stride + X );
+			const auto Above = static_cast<uint32_t>( Corner + Stride );
+			for( const uint32_t Index : { Corner, Corner + 1, Above, Corner + 1, Above + 1, Above } )
+			{
+				Write( Buffer, Index );
+			}
+		}
+	}
+
+	Write( Buffer, VertexCount );
+	for( uint32_t Index = 0; Index < VertexCount; Index++ )
+	{
+		const float Bone = static_cast<float>( Index % BoneCount );
+		const float Values[8] = { Bone, -1.0f, -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+		Buffer.append( reinterpret_cast<const char*>( Values ), sizeof( Values ) );
+	}
+
+	Write( Buffer, BoneCount );
+	for( uint16_t Index = 0; Index < BoneCount; Index++ )
+	{
+		Write( Buffer, "bone_" + std::to_string( Index ) );
+		for( uint32_t Element = 0; Element < 16; Element++ )
+		{
+			Write( Buffer, Element % 5 == 0 ? 1.0f : 0.0f );
+		}
+	}
+
+	// A chain of bones, the parent is stored one higher.
+	for( uint16_t Index = 0; Index < BoneCount; Index++ )
+	{
+		Write( Buffer, Index );
+		Write( Buffer, Index );
+	}
+
+	Write( Buffer, AnimationCount );
+	for( uint16_t Animation = 0; Animation < AnimationCount; Animation++ )
+	{
+		Write( Buffer, "animation_" + std::to_string( Animation ) );
+		Write( Buffer, 2.0f );
+		Write( Buffer, FrameCount );
+		for( uint32_t Frame = 0; Frame < FrameCount; Frame++ )
+		{
+			for( uint16_t Bone = 0; Bone < BoneCount; Bone++ )
+			{
+				Write( Buffer, Bone );
+
+				const float Time = static_cast<float>( Frame ) * 0.1f;
+				const float Values[10] = { Time, 0.0f, 0.0f, 0.0f, 0.0f, std::sin( Time ), std::cos( Time ), 1.0f, 1.0f, 1.0f };
+				Buffer.append( reinterpret_cast<const char*>( Values ), sizeof( Values ) );
+			}
+		}
+	}
+
+	return Buffer;
+}
+
+static bool Save( const std::string& Location, const std::string& Buffer )
+{
+	// The file takes ownership of the buffer.
+	char* Data = new char[Buffer.size()];
+	std::memcpy( Data, Buffer.data(), Buffer.size() );
+
+	CFile File( Location );
+	File.Load( Data, Buffer.size() );
+	return File.Save( true );
+}
+
+struct FLoadedMesh
+{
+	FPrimitive Primitive;
+	AnimationSet Set;
+	std::shared_ptr<TriangleTree> Tree;
+};
+
+// Imports the source and builds the collision tree, which is what the first collision with the mesh would do.
+static double MeasureSource( FLoadedMesh& Result )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		FLoadedMesh Mesh;
+
+		Timer Load;
+		Load.Start();
+		CFile File( SourceLocation );
+		File.Load( true );
+		LoftyMeshInterface::Import( File, &Mesh.Primitive, Mesh.Set );
+
+		std::vector<VertexFormat> Vertices( Mesh.Primitive.VertexCount );
+		for( size_t Index = 0; Index < Mesh.Primitive.VertexCount; Index++ )
+		{
+			Vertices[Index].Position = Mesh.Primitive.Vertices[Index].Position;
+		}
+
+		Mesh.Tree = TriangleTree::Build( Vertices.data(), Vertices.size(), Mesh.Primitive.Indices, Mesh.Primitive.IndexCount );
+		Load.Stop();
+
+		const double Seconds = Load.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+
+		if( Repetition + 1 == Repetitions )
+		{
+			std::swap( Result.Primitive.Vertices, Mesh.Primitive.Vertices );
+			std::swap( Result.Primitive.Indices, Mesh.Primitive.Indices );
+			Result.Primitive.VertexCount = Mesh.Primitive.VertexCount;
+			Result.Primitive.IndexCount = Mesh.Primitive.IndexCount;
+			Result.Primitive.HasNormals = Mesh.Primitive.HasNormals;
+			Result.Set = Mesh.Set;
+			Result.Tree = Mesh.Tree;
+		}
+	}
+
+	return Best;
+}
+
+static double MeasureCooked( FLoadedMesh& Result, bool& Loaded )
+{
+	Loaded = true;
+
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Load;
+		Load.Start();
+		Loaded &= CookedMesh::Load( CookedLocation, SetLocation, Result.Primitive, Result.Set, Result.Tree );
+		Load.Stop();
+
+		const double Seconds = Load.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+static bool Matches( const FLoadedMesh& Expected, const FLoadedMesh& Result )
+{
+	const auto& A = Expected.Primitive;
+	const auto& B = Result.Primitive;
+	if( A.VertexCount != B.VertexCount || A.IndexCount != B.IndexCount || A.HasNormals != B.HasNormals )
+		return false;
+
+	if( std::memcmp( A.Vertices, B.Vertices, A.VertexCount * sizeof( ComplexVertex ) ) != 0 || std::memcmp( A.Indices, B.Indices, A.IndexCount * sizeof( uint32_t ) ) != 0 )
+		return false;
+
+	if( !Result.Tree || Expected.Tree->GetTriangleCount() != Result.Tree->GetTriangleCount() ||
+		Expected.Tree->Nodes.size() != Result.Tree->Nodes.size() || Expected.Tree->Leaves.size() != Result.Tree->Leaves.size() )
+		return false;
+
+	if( std::memcmp( Expected.Tree->Leaves.data(), Result.Tree->Leaves.data(), Expected.Tree->Leaves.size() * sizeof( TriangleTree::Leaf ) ) != 0 )
+		return false;
+
+	const auto& First = Expected.Set.Skeleton;
+	const auto& Second = Result.Set.Skeleton;
+	if( First.Bones.size() != Second.Bones.size() || First.MatrixNames != Second.MatrixNames || First.Animations.size() != Second.Animations.size() )
+		return false;
+
+	for( size_t Index = 0; Index < First.Bones.size(); Index++ )
+	{
+		if( First.Bones[Index].ParentIndex != Second.Bones[Index].ParentIndex || First.Bones[Index].Children != Second.Bones[Index].Children ||
+			std::memcmp( &First.Bones[Index].ModelToBone, &Second.Bones[Index].ModelToBone, sizeof( Matrix4D ) ) != 0 )
+			return false;
+	}
+
+	for( const auto& Pair : First.Animations )
+	{
+		const auto Iterator = Second.Animations.find( Pair.first );
+		if( Iterator == Second.Animations.end() )
+			return false;
+
+		const auto& Keys = Pair.second.RotationKeys;
+		const auto& CookedKeys = Iterator->second.RotationKeys;
+		if( Keys.size() != CookedKeys.size() || Pair.second.Duration != Iterator->second.Duration )
+			return false;
+
+		for( size_t Index = 0; Index < Keys.size(); Index++ )
+		{
+			if( std::memcmp( &Keys[Index], &CookedKeys[Index], sizeof( Key ) ) != 0 )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+ETestResult CCookedMeshPerformanceTest::Run()
+{
+	const auto Source = CreateSource();
+	if( !Save( SourceLocation, Source ) )
+	{
+		Log::Event( Log::Error, "Couldn't write \"%s\".\n", SourceLocation.c_str() );
+		return ETestResult::Failed;
+	}
+
+	// The mesh is cooked as if it was requested through an animation set that points to it.
+	if( !Save( SetLocation, "{ \"path\" : \"" + SourceLocation + "\" }" ) )
+	{
+		Log::Event( Log::Error, "Couldn't write \"%s\".\n", SetLocation.c_str() );
+		return ETestResult::Failed;
+	}
+
+	// The tree is only cooked and restored for triangle collisions.
+	const bool TriangleCollisions = CConfiguration::Get().IsEnabled( "physics.TriangleCollisions" );
+	CConfiguration::Get().Store( "physics.TriangleCollisions", true );
+
+	FLoadedMesh Expected;
+	const double Imported = MeasureSource( Expected );
+
+	Timer CookTimer;
+	CookTimer.Start();
+	const bool Cooked = CookedMesh::Cook( CookedLocation, { SetLocation, SourceLocation }, Expected.Primitive, Expected.Set, Expected.Tree );
+	CookTimer.Stop();
+	const double Cook = CookTimer.GetElapsedTimeSeconds();
+
+	FLoadedMesh Result;
+	bool Loaded = false;
+	const double Load = MeasureCooked( Result, Loaded );
+	const bool Valid = Loaded && Matches( Expected, Result );
+
+	// Without triangle collisions the tree is left out of the file.
+	CConfiguration::Get().Store( "physics.TriangleCollisions", false );
+	std::shared_ptr<TriangleTree> NoTree;
+	FLoadedMesh Plain;
+	const bool Optional = CookedMesh::Cook( PlainLocation, { SourceLocation }, Expected.Primitive, Expected.Set, NoTree ) && !NoTree &&
+		CookedMesh::Load( PlainLocation, std::string(), Plain.Primitive, Plain.Set, Plain.Tree ) && !Plain.Tree &&
+		Plain.Primitive.VertexCount == Expected.Primitive.VertexCount;
+	CConfiguration::Get().Store( "physics.TriangleCollisions", TriangleCollisions );
+
+	// Cooked files only belong to the sources they were cooked from.
+	FLoadedMesh Unrelated;
+	bool Rejected = !CookedMesh::Load( CookedLocation, Directory + "other.ses", Unrelated.Primitive, Unrelated.Set, Unrelated.Tree );
+
+	// Changing the mesh that the set points to has to invalidate the cooked file, even though the set itself didn't change.
+	Save( SourceLocation, Source + '\0' );
+	FLoadedMesh Stale;
+	Rejected &= !CookedMesh::Load( CookedLocation, SetLocation, Stale.Primitive, Stale.Set, Stale.Tree );
+
+	Log::Event( "Cooked mesh: %u vertices | %u triangles | %u bones | %u animations | %.2f MB source | %.2f MB cooked\n",
+		Expected.Primitive.VertexCount, Expected.Primitive.IndexCount / 3, BoneCount, AnimationCount,
+		static_cast<double>( Source.size() ) / ( 1024.0 * 1024.0 ), static_cast<double>( CFile( CookedLocation ).Exists() ? std::experimental::filesystem::file_size( CookedLocation ) : 0 ) / ( 1024.0 * 1024.0 ) );
+	Log::Event( "LMI import and tree build: %.2fms | cook: %.2fms | cooked load: %.2fms (%.1fx)\n",
+		Imported * 1000.0, Cook * 1000.0, Load * 1000.0, Load > 0.0 ? Imported / Load : 0.0 );
+
+	if( !Cooked || !Valid )
+	{
+		Log::Event( Log::Error, "The cooked mesh doesn't match the imported mesh.\n" );
+		return ETestResult::Failed;
+	}
+
+	if( !Optional )
+	{
+		Log::Event( Log::Error, "The triangle tree was cooked or restored without triangle collisions.\n" );
+		return ETestResult::Failed;
+	}
+
+	if( !Rejected )
+	{
+		Log::Event( Log::Error, "The cooked mesh was loaded for a different source or after one of its sources changed.\n" );
+		return ETestResult::Failed;
+	}
+
+	return Load < Imported ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CCookedMeshPerformanceTest::GetName()
+{
+	return "Cooked Mesh Performance Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares importing a skinned mesh from the Lofty Mesh Interface format with loading its cooked version.
+class CCookedMeshPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
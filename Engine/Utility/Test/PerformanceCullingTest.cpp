@@ -0,0 +1,136 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceCullingTest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Display/Rendering/Camera.h>
+#include <Engine/Display/Rendering/Culling.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/JobSystem.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t BoxCount = 100000;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 10;
+
+static double MeasurePerObject( const CCamera& Camera, const std::vector<BoundingBox>& Boxes, std::vector<uint32_t>& Visible )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Visible.clear();
+
+		Timer Cull;
+		Cull.Start();
+		for( size_t Index = 0; Index < Boxes.size(); Index++ )
+		{
+			if( Culling::Frustum( Camera, Boxes[Index] ) )
+			{
+				Visible.emplace_back( static_cast<uint32_t>( Index ) );
+			}
+		}
+		Cull.Stop();
+
+		const double Seconds = Cull.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+// Includes gathering the bounds, like the renderer has to every frame.
+static double MeasureBatch( const CCamera& Camera, const std::vector<BoundingBox>& Boxes, std::vector<uint32_t>& Visible )
+{
+	CullingBounds Bounds;
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Cull;
+		Cull.Start();
+
+		Bounds.Clear();
+		for( const auto& Box : Boxes )
+		{
+			Bounds.Add( Box );
+		}
+
+		Culling::Frustum( Camera.GetFrustum(), Bounds, Visible );
+		Cull.Stop();
+
+		const double Seconds = Cull.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+ETestResult CCullingPerformanceTest::Run()
+{
+	CCamera Camera;
+	Camera.SetCameraPosition( Vector3D( 0.0f, 0.0f, 10.0f ) );
+	Camera.SetCameraDirection( Vector3D( 1.0f, 0.3f, -0.1f ).Normalized() );
+	Camera.SetFarPlaneDistance( 1000.0f );
+	Camera.Update();
+
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( -1000.0f, 1000.0f );
+	std::uniform_real_distribution<float> Size( 0.5f, 20.0f );
+
+	std::vector<BoundingBox> Boxes;
+	Boxes.reserve( BoxCount );
+	for( size_t Index = 0; Index < BoxCount; Index++ )
+	{
+		const auto Center = Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) * 0.1f );
+		const auto HalfSize = Vector3D( Size( Generator ), Size( Generator ), Size( Generator ) ) * 0.5f;
+		Boxes.emplace_back( Center - HalfSize, Center + HalfSize );
+	}
+
+	// The benchmark can run before the application has been initialized.
+	const bool InitializeJobs = !JobSystem::IsInitialized();
+
+	const bool ParallelCulling = CConfiguration::Get().IsEnabled( "render.ParallelCulling" );
+
+	std::vector<uint32_t> Expected;
+	const double PerObject = MeasurePerObject( Camera, Boxes, Expected );
+
+	CConfiguration::Get().Store( "render.ParallelCulling", false );
+	std::vector<uint32_t> Batched;
+	const double Batch = MeasureBatch( Camera, Boxes, Batched );
+
+	if( InitializeJobs )
+	{
+		JobSystem::Initialize();
+	}
+
+	CConfiguration::Get().Store( "render.ParallelCulling", true );
+	std::vector<uint32_t> Parallel;
+	const double ParallelBatch = MeasureBatch( Camera, Boxes, Parallel );
+
+	if( InitializeJobs )
+	{
+		JobSystem::Shutdown();
+	}
+
+	CConfiguration::Get().Store( "render.ParallelCulling", ParallelCulling );
+
+	Log::Event( "%zu boxes, %zu visible: per-object %.3fms | batched %.3fms (%.2fx) | batched parallel %.3fms (%.2fx)\n",
+		BoxCount, Expected.size(), PerObject * 1000.0, Batch * 1000.0, PerObject / Batch,
+		ParallelBatch * 1000.0, PerObject / ParallelBatch );
+
+	if( Batched != Expected || Parallel != Expected )
+	{
+		Log::Event( Log::Error, "Batched culling results don't match the per-object path. (%zu and %zu visible)\n", Batched.size(), Parallel.size() );
+		return ETestResult::Failed;
+	}
+
+	return ETestResult::Succeeded;
+}
+
+const char* CCullingPerformanceTest::GetName()
+{
+	return "Culling Performance Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares per-object frustum culling against the batched SIMD culling stage.
+class CCullingPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,397 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceDataTest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Data.h>
+#include <Engine/Utility/DataString.h>
+#include <Engine/Utility/Math/Vector.h>
+#include <Engine/Utility/Serialize.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t LevelCount = 16;
+constexpr size_t EntityCount = 2000;
+constexpr size_t SampleCount = 32;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 5;
+
+struct FEntityPayload
+{
+	std::string Name;
+	std::string Type;
+	Vector3D Position;
+	Vector3D Orientation;
+	Vector3D Size;
+	uint32_t Flags = 0;
+	std::vector<float> Samples;
+};
+
+typedef std::vector<FEntityPayload> FLevelPayload;
+
+// Replicates the stringstream backend that CData used to have, used as the baseline.
+class CLegacyData
+{
+public:
+	template<typename T>
+	void operator<<( const T& Object )
+	{
+		Stream.write( reinterpret_cast<const char*>( &Object ), sizeof( T ) );
+	}
+
+	void operator<<( const char* Object )
+	{
+		Stream.write( Object, std::strlen( Object ) + 1 );
+	}
+
+	void operator<<( const CLegacyData& Object )
+	{
+		const auto Data = Object.Stream.str();
+		const auto Size = static_cast<uint32_t>( Data.size() );
+		Stream.write( reinterpret_cast<const char*>( &Size ), sizeof( uint32_t ) );
+		Stream.write( Data.c_str(), Size );
+	}
+
+	template<typename T>
+	uint32_t operator>>( T& Object )
+	{
+		const auto Position = Stream.tellg();
+		Stream.read( reinterpret_cast<char*>( &Object ), sizeof( T ) );
+		if( !Stream.good() )
+		{
+			Stream.clear();
+			Stream.seekg( Position );
+			return 0;
+		}
+
+		return sizeof( T );
+	}
+
+	void operator>>( CLegacyData& Object )
+	{
+		uint32_t Size = 0;
+		Stream.read( reinterpret_cast<char*>( &Size ), sizeof( uint32_t ) );
+
+		char* Block = new char[Size];
+		Stream.read( Block, Size );
+		Object.Stream.write( Block, Size );
+		delete[] Block;
+
+		Invalid |= !Stream.good();
+	}
+
+	// Reads one character at a time, like the old character array extraction.
+	bool ReadString( std::string& Object )
+	{
+		Object.clear();
+
+		char Character = 0;
+		while( Stream.read( &Character, sizeof( char ) ) && Character != '\0' )
+		{
+			Object += Character;
+		}
+
+		return Stream.good();
+	}
+
+	int32_t ReadPosition()
+	{
+		return static_cast<int32_t>( Stream.tellg() );
+	}
+
+	void ReadPosition( const int32_t Position )
+	{
+		Stream.seekg( Position );
+	}
+
+	size_t Size()
+	{
+		const auto Position = Stream.tellp();
+		Stream.seekp( 0, std::ios::end );
+		const auto End = Stream.tellp();
+		Stream.seekp( Position );
+		return static_cast<size_t>( End );
+	}
+
+	bool Valid() const
+	{
+		return !Invalid;
+	}
+
+private:
+	std::stringstream Stream;
+	bool Invalid = false;
+};
+
+static std::vector<FLevelPayload> CreatePayload()
+{
+	std::vector<FLevelPayload> Levels( LevelCount );
+	for( size_t LevelIndex = 0; LevelIndex < LevelCount; LevelIndex++ )
+	{
+		auto& Level = Levels[LevelIndex];
+		Level.resize( EntityCount );
+		for( size_t Index = 0; Index < EntityCount; Index++ )
+		{
+			auto& Entity = Level[Index];
+			const float Offset = static_cast<float>( Index );
+			Entity.Name = "level_" + std::to_string( LevelIndex ) + "_entity_" + std::to_string( Index );
+			Entity.Type = Index % 3 == 0 ? "mesh" : "sound";
+			Entity.Position = Vector3D( Offset, Offset * 0.5f, -Offset );
+			Entity.Orientation = Vector3D( 0.0f, Offset * 0.1f, 0.0f );
+			Entity.Size = Vector3D( 1.0f, 1.0f, 1.0f );
+			Entity.Flags = static_cast<uint32_t>( Index * 7 );
+
+			Entity.Samples.resize( SampleCount );
+			for( size_t Sample = 0; Sample < SampleCount; Sample++ )
+			{
+				Entity.Samples[Sample] = Offset + static_cast<float>( Sample );
+			}
+		}
+	}
+
+	return Levels;
+}
+
+// Each level is written to its own block, like the chunks in a level file.
+template<typename DataType>
+static void Write( DataType& Data, const std::vector<FLevelPayload>& Levels )
+{
+	const auto Count = static_cast<uint32_t>( Levels.size() );
+	Data << Count;
+
+	for( const auto& Level : Levels )
+	{
+		DataType LevelData;
+		DataMarker::Mark( LevelData, "lvl" );
+		const auto EntityCount = static_cast<uint32_t>( Level.size() );
+		LevelData << EntityCount;
+
+		for( const auto& Entity : Level )
+		{
+			Serialize::Export( LevelData, "nm", Entity.Name );
+			Serialize::Export( LevelData, "tp", Entity.Type );
+			Serialize::Export( LevelData, "pos", Entity.Position );
+			Serialize::Export( LevelData, "ori", Entity.Orientation );
+			Serialize::Export( LevelData, "siz", Entity.Size );
+			Serialize::Export( LevelData, "flg", Entity.Flags );
+			DataVector::Encode( LevelData, Entity.Samples );
+		}
+
+		Data << LevelData;
+	}
+}
+
+template<typename DataType>
+static bool Read( DataType& Data, std::vector<FLevelPayload>& Levels )
+{
+	uint32_t Count = 0;
+	Data >> Count;
+	Levels.resize( Count );
+
+	for( auto& Level : Levels )
+	{
+		DataType LevelData;
+		Data >> LevelData;
+		if( !Data.Valid() || !DataMarker::Check( LevelData, "lvl" ) )
+			return false;
+
+		uint32_t EntityCount = 0;
+		LevelData >> EntityCount;
+		Level.resize( EntityCount );
+
+		bool Valid = true;
+		for( auto& Entity : Level )
+		{
+			Valid &= Serialize::Import( LevelData, "nm", Entity.Name );
+			Valid &= Serialize::Import( LevelData, "tp", Entity.Type );
+			Valid &= Serialize::Import( LevelData, "pos", Entity.Position );
+			Valid &= Serialize::Import( LevelData, "ori", Entity.Orientation );
+			Valid &= Serialize::Import( LevelData, "siz", Entity.Size );
+			Valid &= Serialize::Import( LevelData, "flg", Entity.Flags );
+			DataVector::Decode( LevelData, Entity.Samples );
+		}
+
+		if( !Valid || !LevelData.Valid() )
+			return false;
+	}
+
+	return true;
+}
+
+static bool Equal( const Vector3D& A, const Vector3D& B )
+{
+	return A.X == B.X && A.Y == B.Y && A.Z == B.Z;
+}
+
+static bool Matches( const std::vector<FLevelPayload>& Expected, const std::vector<FLevelPayload>& Result )
+{
+	if( Expected.size() != Result.size() )
+		return false;
+
+	for( size_t LevelIndex = 0; LevelIndex < Expected.size(); LevelIndex++ )
+	{
+		const auto& Level = Expected[LevelIndex];
+		const auto& ResultLevel = Result[LevelIndex];
+		if( Level.size() != ResultLevel.size() )
+			return false;
+
+		for( size_t Index = 0; Index < Level.size(); Index++ )
+		{
+			const auto& A = Level[Index];
+			const auto& B = ResultLevel[Index];
+			if( A.Name != B.Name || A.Type != B.Type || A.Flags != B.Flags || A.Samples != B.Samples )
+				return false;
+
+			if( !Equal( A.Position, B.Position ) || !Equal( A.Orientation, B.Orientation ) || !Equal( A.Size, B.Size ) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+struct FDataMeasurement
+{
+	double Write = 0.0;
+	double Read = 0.0;
+	size_t Size = 0;
+	bool Valid = true;
+};
+
+static void Keep( FDataMeasurement& Result, const size_t Repetition, const double Write, const double Read )
+{
+	Result.Write = Repetition == 0 ? Write : std::min( Result.Write, Write );
+	Result.Read = Repetition == 0 ? Read : std::min( Result.Read, Read );
+}
+
+static FDataMeasurement MeasureLegacy( const std::vector<FLevelPayload>& Levels )
+{
+	FDataMeasurement Result;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Measure;
+		Measure.Start();
+		CLegacyData Data;
+		Write( Data, Levels );
+		Measure.Stop();
+		const double Written = Measure.GetElapsedTimeSeconds();
+
+		std::vector<FLevelPayload> Extracted;
+		Measure.Start();
+		Result.Valid &= Read( Data, Extracted );
+		Measure.Stop();
+
+		Keep( Result, Repetition, Written, Measure.GetElapsedTimeSeconds() );
+		Result.Valid &= Matches( Levels, Extracted );
+		Result.Size = Data.Size();
+	}
+
+	return Result;
+}
+
+static FDataMeasurement MeasureData( const std::vector<FLevelPayload>& Levels, std::string& Bytes )
+{
+	FDataMeasurement Result;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Measure;
+		Measure.Start();
+		CData Data;
+		Write( Data, Levels );
+		Measure.Stop();
+		const double Written = Measure.GetElapsedTimeSeconds();
+
+		std::vector<FLevelPayload> Extracted;
+		Measure.Start();
+		Result.Valid &= Read( Data, Extracted );
+		Measure.Stop();
+
+		Keep( Result, Repetition, Written, Measure.GetElapsedTimeSeconds() );
+		Result.Valid &= Matches( Levels, Extracted );
+		Result.Size = Data.Size();
+		Bytes.assign( Data.Data(), Data.Size() );
+	}
+
+	return Result;
+}
+
+// Writes into a single growing buffer and reads through views that borrow from it.
+static FDataMeasurement MeasureView( const std::vector<FLevelPayload>& Levels, std::string& Bytes )
+{
+	FDataMeasurement Result;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Measure;
+		Measure.Start();
+		CDataWriter Writer;
+		Write( Writer, Levels );
+		Measure.Stop();
+		const double Written = Measure.GetElapsedTimeSeconds();
+
+		std::vector<FLevelPayload> Extracted;
+		Measure.Start();
+		auto View = Writer.View();
+		Result.Valid &= Read( View, Extracted );
+		Measure.Stop();
+
+		Keep( Result, Repetition, Written, Measure.GetElapsedTimeSeconds() );
+		Result.Valid &= Matches( Levels, Extracted );
+		Result.Size = Writer.Size();
+		Bytes.assign( Writer.Data(), Writer.Size() );
+	}
+
+	return Result;
+}
+
+static double Throughput( const size_t Size, const double Seconds )
+{
+	return Seconds > 0.0 ? static_cast<double>( Size ) / ( 1024.0 * 1024.0 ) / Seconds : 0.0;
+}
+
+static void Report( const char* Name, const FDataMeasurement& Measurement )
+{
+	Log::Event( "%s: write %.2fms (%.1f MB/s) | read %.2fms (%.1f MB/s)\n", Name,
+		Measurement.Write * 1000.0, Throughput( Measurement.Size, Measurement.Write ),
+		Measurement.Read * 1000.0, Throughput( Measurement.Size, Measurement.Read ) );
+}
+
+ETestResult CDataPerformanceTest::Run()
+{
+	const auto Levels = CreatePayload();
+
+	std::string DataBytes;
+	std::string ViewBytes;
+	const auto Legacy = MeasureLegacy( Levels );
+	const auto Data = MeasureData( Levels, DataBytes );
+	const auto View = MeasureView( Levels, ViewBytes );
+
+	Log::Event( "Data: %u levels | %u entities | %.2f MB\n", LevelCount, LevelCount * EntityCount, static_cast<double>( Data.Size ) / ( 1024.0 * 1024.0 ) );
+	Report( "Stringstream", Legacy );
+	Report( "CData", Data );
+	Report( "Writer and view", View );
+
+	if( !Legacy.Valid || !Data.Valid || !View.Valid )
+	{
+		Log::Event( Log::Error, "The extracted payload doesn't match the serialized payload.\n" );
+		return ETestResult::Failed;
+	}
+
+	// Files written by the old backend have to remain readable.
+	if( DataBytes != ViewBytes || Legacy.Size != Data.Size )
+	{
+		Log::Event( Log::Error, "The serialized formats don't match.\n" );
+		return ETestResult::Failed;
+	}
+
+	return Data.Read < Legacy.Read && View.Read < Legacy.Read ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CDataPerformanceTest::GetName()
+{
+	return "Data Performance Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares serializing a world-like payload through CData, the writer and view, and the old stringstream backend.
+class CDataPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,244 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceFileTest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Data.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/MappedFile.h>
+#include <Engine/Utility/Timer.h>
+
+#if defined(_WIN32)
+#include <Engine/Profiling/Profiling.h>
+#else
+#include <unistd.h>
+#endif
+
+// File sizes in megabytes.
+static const size_t Sizes[] = { 10, 100 };
+
+// Loading keeps two copies of the file in memory, this size is only tested when test.LargeFiles is enabled.
+static const size_t LargeSize = 1000;
+
+static const std::string Directory = "Cache/Test/File/";
+static const std::string Location = Directory + "large.bin";
+
+static size_t GetResidentBytes()
+{
+#if defined(_WIN32)
+	return CProfiler::GetMemoryUsageInBytes();
+#else
+	size_t Pages = 0;
+	size_t Resident = 0;
+	std::ifstream Stream( "/proc/self/statm" );
+	Stream >> Pages >> Resident;
+	return Resident * static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+#endif
+}
+
+static double ToMegaBytes( const size_t Bytes )
+{
+	return static_cast<double>( Bytes ) / ( 1024.0 * 1024.0 );
+}
+
+// Sums the data as 64-bit words so that every page is touched, chunks have to be a multiple of 8 bytes apart from the last one.
+static uint64_t Checksum( const char* Data, const size_t Size, uint64_t Sum = 0 )
+{
+	size_t Offset = 0;
+	for( ; Offset + sizeof( uint64_t ) <= Size; Offset += sizeof( uint64_t ) )
+	{
+		uint64_t Word;
+		std::memcpy( &Word, Data + Offset, sizeof( uint64_t ) );
+		Sum += Word;
+	}
+
+	for( ; Offset < Size; Offset++ )
+	{
+		Sum += static_cast<uint8_t>( Data[Offset] );
+	}
+
+	return Sum;
+}
+
+static bool Generate( const size_t Size )
+{
+	std::experimental::filesystem::create_directories( Directory );
+
+	std::ofstream Stream( Location.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if( Stream.fail() )
+		return false;
+
+	std::vector<uint32_t> Block( CFileStream::DefaultChunkSize / sizeof( uint32_t ) );
+	size_t Written = 0;
+	uint32_t Value = 0;
+	while( Written < Size )
+	{
+		for( auto& Word : Block )
+		{
+			Word = Value++ * 2654435761u;
+		}
+
+		const size_t Bytes = std::min( Block.size() * sizeof( uint32_t ), Size - Written );
+		Stream.write( reinterpret_cast<const char*>( Block.data() ), Bytes );
+		Written += Bytes;
+	}
+
+	return Stream.good();
+}
+
+struct FFileMeasurement
+{
+	double Seconds = 0.0;
+	size_t Resident = 0;
+	uint64_t Checksum = 0;
+};
+
+// The old path, the file is read into its own buffer and copied again when it is extracted.
+static FFileMeasurement MeasureLoad()
+{
+	FFileMeasurement Result;
+	const size_t Baseline = GetResidentBytes();
+
+	Timer Measure;
+	Measure.Start();
+	CFile File( Location );
+	File.Load( true );
+	CData Data;
+	File.Extract( Data );
+	Result.Checksum = Checksum( Data.Data(), Data.Size() );
+	Measure.Stop();
+
+	Result.Seconds = Measure.GetElapsedTimeSeconds();
+	const size_t Resident = GetResidentBytes();
+	Result.Resident = Resident - std::min( Baseline, Resident );
+	return Result;
+}
+
+static FFileMeasurement MeasureMap()
+{
+	FFileMeasurement Result;
+	const size_t Baseline = GetResidentBytes();
+
+	Timer Measure;
+	Measure.Start();
+	CFile File( Location );
+	File.Map();
+	Result.Checksum = Checksum( File.Fetch<char>(), File.Size() );
+	Measure.Stop();
+
+	Result.Seconds = Measure.GetElapsedTimeSeconds();
+	const size_t Resident = GetResidentBytes();
+	Result.Resident = Resident - std::min( Baseline, Resident );
+	return Result;
+}
+
+static FFileMeasurement MeasureStream()
+{
+	FFileMeasurement Result;
+	const size_t Baseline = GetResidentBytes();
+	size_t Peak = 0;
+
+	Timer Measure;
+	Measure.Start();
+	CFileStream Stream;
+	Stream.Open( Location );
+
+	CDataView Chunk;
+	while( Stream.Next( Chunk ) )
+	{
+		Result.Checksum = Checksum( Chunk.Data(), Chunk.Size(), Result.Checksum );
+		Peak = std::max( Peak, GetResidentBytes() );
+	}
+	Measure.Stop();
+
+	Result.Seconds = Measure.GetElapsedTimeSeconds();
+	Result.Resident = Peak - std::min( Baseline, Peak );
+	return Result;
+}
+
+static void Report( const char* Name, const size_t Size, const FFileMeasurement& Measurement )
+{
+	Log::Event( "\t%s: %.2fms (%.1f MB/s) | resident +%.1f MB\n", Name, Measurement.Seconds * 1000.0,
+		Measurement.Seconds > 0.0 ? ToMegaBytes( Size ) / Measurement.Seconds : 0.0, ToMegaBytes( Measurement.Resident ) );
+}
+
+ETestResult CFilePerformanceTest::Run()
+{
+	auto& Configuration = CConfiguration::Get();
+	std::vector<size_t> Tested( std::begin( Sizes ), std::end( Sizes ) );
+	if( Configuration.IsEnabled( "test.LargeFiles" ) )
+	{
+		Tested.emplace_back( LargeSize );
+	}
+
+	// Every tested file is larger than a megabyte, this makes CFile::Stream take the chunked path.
+	const int StreamLimit = Configuration.GetInteger( "file.StreamLimit", 256 );
+	Configuration.Store( "file.StreamLimit", 1 );
+
+	bool Valid = true;
+	bool Chunked = true;
+	for( const size_t MegaBytes : Tested )
+	{
+		const size_t Size = MegaBytes * 1024 * 1024;
+		if( !Generate( Size ) )
+		{
+			Log::Event( Log::Error, "Couldn't write \"%s\".\n", Location.c_str() );
+			return ETestResult::Failed;
+		}
+
+		const auto Load = MeasureLoad();
+		const auto Map = MeasureMap();
+		const auto Stream = MeasureStream();
+
+		uint64_t Streamed = 0;
+		size_t Chunks = 0;
+		size_t LargestChunk = 0;
+		CFile( Location ).Stream( [&Streamed, &Chunks, &LargestChunk] ( const CDataView& Chunk ) {
+			Streamed = Checksum( Chunk.Data(), Chunk.Size(), Streamed );
+			LargestChunk = std::max( LargestChunk, Chunk.Size() );
+			Chunks++;
+			return true;
+		} );
+
+		Log::Event( "%zu MB file:\n", MegaBytes );
+		Report( "Load and extract", Size, Load );
+		Report( "Mapped", Size, Map );
+		Report( "Streamed", Size, Stream );
+
+		Valid &= Load.Checksum == Map.Checksum && Load.Checksum == Stream.Checksum && Load.Checksum == Streamed;
+
+		// The file should have been passed in as many chunks as fit in the file, never as a single mapped view.
+		const size_t ExpectedChunks = ( Size + CFileStream::DefaultChunkSize - 1 ) / CFileStream::DefaultChunkSize;
+		Chunked &= Chunks == ExpectedChunks && LargestChunk <= CFileStream::DefaultChunkSize;
+	}
+
+	Configuration.Store( "file.StreamLimit", StreamLimit );
+	CFile( Location ).Delete();
+
+	if( !Valid )
+	{
+		Log::Event( Log::Error, "The mapped or streamed contents don't match the loaded file.\n" );
+		return ETestResult::Failed;
+	}
+
+	if( !Chunked )
+	{
+		Log::Event( Log::Error, "Files larger than file.StreamLimit weren't streamed in chunks.\n" );
+		return ETestResult::Failed;
+	}
+
+	return ETestResult::Succeeded;
+}
+
+const char* CFilePerformanceTest::GetName()
+{
+	return "File Performance Test";
+}
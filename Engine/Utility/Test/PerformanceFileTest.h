@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares loading and extracting large files with mapping them and reading them in chunks.
+class CFilePerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,173 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceIntegrationTest.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Engine/Physics/Body/BodyStore.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/JobSystem.h>
+#include <Engine/Utility/Math.h>
+#include <Engine/Utility/Test/HeadlessBody.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t IterationCount = 100;
+constexpr float TimeStep = 1.0f / 60.0f;
+
+typedef std::vector<std::unique_ptr<CHeadlessBody>> BodyList;
+
+static BodyList CreateBodies( const size_t BodyCount )
+{
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( -100.0f, 100.0f );
+	std::uniform_real_distribution<float> Speed( -5.0f, 5.0f );
+	std::uniform_real_distribution<float> Mass( 0.5f, 10.0f );
+
+	BodyList Bodies;
+	Bodies.reserve( BodyCount );
+	for( size_t Index = 0; Index < BodyCount; Index++ )
+	{
+		auto Body = std::make_unique<CHeadlessBody>();
+		Body->Transform.SetPosition( Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) ) );
+		Body->Velocity = Vector3D( Speed( Generator ), Speed( Generator ), Speed( Generator ) );
+		Body->Stationary = false;
+		Body->Damping = 0.9f;
+		Body->SetMass( Mass( Generator ) );
+
+		// Mix in a few bodies that use the other integrator.
+		if( Index % 8 == 0 )
+		{
+			Body->Integrator = Integrator::Verlet;
+		}
+
+		Bodies.emplace_back( std::move( Body ) );
+	}
+
+	return Bodies;
+}
+
+static void IntegrateScalar( BodyList& Bodies )
+{
+	for( auto& Body : Bodies )
+	{
+		Body->Acceleration = Body->Gravity;
+
+		const auto Previous = Body->Transform.GetPosition();
+		auto Position = Previous;
+		Body->Integrate( Position, Previous, TimeStep );
+		Body->Transform.SetPosition( Position );
+	}
+}
+
+static void IntegrateStore( BodyList& Bodies, CBodyStore& Store )
+{
+	Store.Clear();
+	for( auto& Body : Bodies )
+	{
+		Body->Acceleration = Body->Gravity;
+
+		const auto Previous = Body->Transform.GetPosition();
+		Store.Add( Body.get(), Previous, Previous, TimeStep );
+	}
+
+	Store.Integrate( TimeStep );
+
+	for( auto& Body : Bodies )
+	{
+		Body->Transform.SetPosition( Store.Fetch( Body.get() ) );
+	}
+}
+
+static bool Validate( const size_t BodyCount )
+{
+	auto Scalar = CreateBodies( BodyCount );
+	auto Batched = CreateBodies( BodyCount );
+
+	CBodyStore Store;
+	for( size_t Iteration = 0; Iteration < 10; Iteration++ )
+	{
+		IntegrateScalar( Scalar );
+		IntegrateStore( Batched, Store );
+	}
+
+	for( size_t Index = 0; Index < BodyCount; Index++ )
+	{
+		const auto Distance = Scalar[Index]->Transform.GetPosition().Distance( Batched[Index]->Transform.GetPosition() );
+		if( Distance > 0.001f || !Math::Equal( Scalar[Index]->Velocity, Batched[Index]->Velocity ) )
+		{
+			Log::Event( Log::Error, "Body %u was integrated differently by the body store.\n", Index );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void Measure( const size_t BodyCount )
+{
+	auto Bodies = CreateBodies( BodyCount );
+
+	Timer Scalar;
+	Scalar.Start();
+	for( size_t Iteration = 0; Iteration < IterationCount; Iteration++ )
+	{
+		IntegrateScalar( Bodies );
+	}
+	Scalar.Stop();
+
+	CBodyStore Store;
+	Timer Batched;
+	Batched.Start();
+	for( size_t Iteration = 0; Iteration < IterationCount; Iteration++ )
+	{
+		IntegrateStore( Bodies, Store );
+	}
+	Batched.Stop();
+
+	// Only the integration itself, without copying the bodies in and out of the store.
+	Timer Integration;
+	Integration.Start();
+	for( size_t Iteration = 0; Iteration < IterationCount; Iteration++ )
+	{
+		Store.Integrate( TimeStep );
+	}
+	Integration.Stop();
+
+	const double Scale = 1000000.0 / static_cast<double>( IterationCount ) * ( 10000.0 / static_cast<double>( BodyCount ) );
+	const double ScalarCost = Scalar.GetElapsedTimeSeconds() * Scale;
+	const double BatchedCost = Batched.GetElapsedTimeSeconds() * Scale;
+	const double IntegrationCost = Integration.GetElapsedTimeSeconds() * Scale;
+	Log::Event( "%u bodies: per body %.1fus | store %.1fus (%.2fx) | store integration only %.1fus (per 10k bodies)\n",
+		BodyCount, ScalarCost, BatchedCost, ScalarCost / BatchedCost, IntegrationCost );
+}
+
+ETestResult CIntegrationPerformanceTest::Run()
+{
+	// The benchmark can run before the application has been initialized.
+	const bool InitializeJobs = !JobSystem::IsInitialized();
+	if( InitializeJobs )
+	{
+		JobSystem::Initialize();
+	}
+
+	const bool Valid = Validate( 10001 );
+
+	for( const size_t BodyCount : { 10000, 100000, 1000000 } )
+	{
+		Measure( BodyCount );
+	}
+
+	if( InitializeJobs )
+	{
+		JobSystem::Shutdown();
+	}
+
+	return Valid ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CIntegrationPerformanceTest::GetName()
+{
+	return "Integration Performance Test";
+}
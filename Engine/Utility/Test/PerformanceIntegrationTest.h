@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares the cost of integrating bodies one at a time against the structure-of-arrays body store.
+class CIntegrationPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
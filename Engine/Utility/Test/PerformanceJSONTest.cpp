@@ -0,0 +1,270 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceJSONTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/Math/Vector.h>
+#include <Engine/Utility/Structures/JSON.h>
+#include <Engine/Utility/Structures/JSONDocument.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t EntityCount = 20000;
+constexpr size_t AssetCount = 500;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 3;
+
+// The properties that entities typically read when they're loaded.
+struct FEntityProperties
+{
+	std::string Type;
+	std::string Name;
+	Vector3D Position;
+	float Mass = 0.0f;
+	int Priority = 0;
+	bool Static = false;
+};
+
+static std::string CreateLevel()
+{
+	std::string Level = "{\n\t\"uuid\" : \"0123456789abcdef\",\n\t\"assets\" : {\n\t\t\"meshes\" : [\n";
+	for( size_t Index = 0; Index < AssetCount; Index++ )
+	{
+		const auto Name = "mesh_" + std::to_string( Index );
+		Level += "\t\t\t{ \"name\" : \"" + Name + "\", \"path\" : \"Models/" + Name + ".lmi\" }";
+		Level += Index + 1 < AssetCount ? ",\n" : "\n";
+	}
+
+	Level += "\t\t]\n\t},\n\t\"entities\" : [\n";
+	for( size_t Index = 0; Index < EntityCount; Index++ )
+	{
+		const auto Offset = std::to_string( Index % 1000 );
+		Level += "\t\t{\n";
+		Level += "\t\t\t\"type\" : \"" + std::string( Index % 4 == 0 ? "light" : "mesh" ) + "\",\n";
+		Level += "\t\t\t\"name\" : \"entity_" + std::to_string( Index ) + "\",\n";
+		Level += "\t\t\t\"uuid\" : \"" + std::to_string( 1000000 + Index ) + "\",\n";
+		Level += "\t\t\t\"position\" : \"" + Offset + " 2.5 -" + Offset + "\",\n";
+		Level += "\t\t\t\"rotation\" : \"0 90 0\",\n";
+		Level += "\t\t\t\"scale\" : \"1 1 1\",\n";
+		Level += "\t\t\t\"mesh\" : \"mesh_" + std::to_string( Index % AssetCount ) + "\",\n";
+		Level += "\t\t\t\"color\" : \"1 0.5 0.25\",\n";
+		Level += "\t\t\t\"mass\" : \"" + Offset + ".5\",\n";
+		Level += "\t\t\t\"priority\" : \"" + std::to_string( Index % 7 ) + "\",\n";
+		Level += "\t\t\t\"static\" : \"" + std::string( Index % 2 == 0 ? "1" : "0" ) + "\"\n";
+		Level += Index + 1 < EntityCount ? "\t\t},\n" : "\t\t}\n";
+	}
+
+	Level += "\t]\n}\n";
+	return Level;
+}
+
+static std::vector<std::string> GatherLevels()
+{
+	std::vector<std::string> Levels;
+	if( !std::experimental::filesystem::exists( "Levels" ) )
+		return Levels;
+
+	for( const auto& Entry : std::experimental::filesystem::recursive_directory_iterator( "Levels" ) )
+	{
+		if( std::experimental::filesystem::is_regular_file( Entry.path() ) )
+		{
+			Levels.emplace_back( Entry.path().generic_string() );
+		}
+	}
+
+	// Only the largest few are measured.
+	std::sort( Levels.begin(), Levels.end(), [] ( const std::string& A, const std::string& B ) -> bool
+		{
+			return std::experimental::filesystem::file_size( A ) > std::experimental::filesystem::file_size( B );
+		}
+	);
+
+	Levels.resize( std::min( Levels.size(), static_cast<size_t>( 3 ) ) );
+	return Levels;
+}
+
+static double MeasureTree( const std::string& Level, std::vector<FEntityProperties>& Entities )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Entities.clear();
+
+		Timer Measure;
+		Measure.Start();
+		const auto Tree = JSON::Tree( Level );
+		if( const auto* Objects = JSON::Find( Tree.Tree, "entities" ) )
+		{
+			for( const auto* Object : Objects->Objects )
+			{
+				FEntityProperties Entity;
+				JSON::Assign( Object->Objects, "type", Entity.Type );
+				JSON::Assign( Object->Objects, "name", Entity.Name );
+				JSON::Assign( Object->Objects, "position", Entity.Position );
+				JSON::Assign( Object->Objects, "mass", Entity.Mass );
+				JSON::Assign( Object->Objects, "priority", Entity.Priority );
+				JSON::Assign( Object->Objects, "static", Entity.Static );
+				Entities.emplace_back( Entity );
+			}
+		}
+		Measure.Stop();
+
+		const double Seconds = Measure.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+static double MeasureDocument( const std::string& Level, std::vector<FEntityProperties>& Entities )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Entities.clear();
+
+		Timer Measure;
+		Measure.Start();
+		JSON::Document Document;
+		Document.Parse( Level );
+		for( const auto& Object : Document.Root().Find( "entities" ) )
+		{
+			FEntityProperties Entity;
+			Object.Assign( "type", Entity.Type );
+			Object.Assign( "name", Entity.Name );
+			Object.Assign( "position", Entity.Position );
+			Object.Assign( "mass", Entity.Mass );
+			Object.Assign( "priority", Entity.Priority );
+			Object.Assign( "static", Entity.Static );
+			Entities.emplace_back( Entity );
+		}
+		Measure.Stop();
+
+		const double Seconds = Measure.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+static bool Matches( const std::vector<FEntityProperties>& Expected, const std::vector<FEntityProperties>& Result )
+{
+	if( Expected.size() != Result.size() )
+		return false;
+
+	for( size_t Index = 0; Index < Expected.size(); Index++ )
+	{
+		const auto& A = Expected[Index];
+		const auto& B = Result[Index];
+		if( A.Type != B.Type || A.Name != B.Name || A.Priority != B.Priority || A.Static != B.Static )
+			return false;
+
+		if( A.Position.X != B.Position.X || A.Position.Y != B.Position.Y || A.Position.Z != B.Position.Z || std::fabs( A.Mass - B.Mass ) > 1e-4f )
+			return false;
+	}
+
+	return true;
+}
+
+// Checks if the converted document has the same layout as the linked tree.
+static bool Matches( const JSON::Vector& Expected, const JSON::Vector& Result )
+{
+	if( Expected.size() != Result.size() )
+		return false;
+
+	auto Iterator = Result.begin();
+	for( const auto* Object : Expected )
+	{
+		const auto* Other = *Iterator++;
+		if( Object->Key != Other->Key || Object->Value != Other->Value || !Matches( Object->Objects, Other->Objects ) )
+			return false;
+	}
+
+	return true;
+}
+
+static bool Compare( const char* Name, const std::string& Level )
+{
+	std::vector<FEntityProperties> Expected;
+	std::vector<FEntityProperties> Result;
+	const double Tree = MeasureTree( Level, Expected );
+	const double Document = MeasureDocument( Level, Result );
+
+	JSON::Document Parsed;
+	Parsed.Parse( Level );
+	const auto Legacy = JSON::Tree( Level );
+	const auto Converted = JSON::Tree( Parsed );
+	const bool Compatible = Matches( Legacy.Tree, Converted.Tree );
+
+	Log::Event( "%s: %.2f MB | %zu nodes | %zu entities | linked tree %.2fms | document %.2fms (%.1fx)\n", Name,
+		static_cast<double>( Level.size() ) / ( 1024.0 * 1024.0 ), Parsed.Nodes(), Result.size(),
+		Tree * 1000.0, Document * 1000.0, Document > 0.0 ? Tree / Document : 0.0 );
+
+	if( !Matches( Expected, Result ) )
+	{
+		Log::Event( Log::Error, "The document returned different values than the linked tree.\n" );
+		return false;
+	}
+
+	if( !Compatible )
+	{
+		Log::Event( Log::Error, "The converted document doesn't match the linked tree.\n" );
+		return false;
+	}
+
+	// The timings depend on the machine, only the results decide whether the test passes.
+	return true;
+}
+
+// Files written by the exporter contain keys in arrays and omit the commas after arrays.
+static bool CompareExport( const std::string& Level )
+{
+	auto Tree = JSON::Tree( Level );
+	const auto Exported = Tree.Export();
+
+	JSON::Document Document;
+	if( !Document.Parse( Exported ) || !Matches( JSON::Tree( Exported ).Tree, JSON::Tree( Document ).Tree ) )
+	{
+		Log::Event( Log::Error, "The document doesn't read exported files the same way as the linked tree.\n" );
+		return false;
+	}
+
+	return true;
+}
+
+ETestResult CJSONPerformanceTest::Run()
+{
+	const auto Level = CreateLevel();
+	bool Succeeded = Compare( "Synthetic level", Level );
+	Succeeded &= CompareExport( Level );
+
+	for( const auto& Location : GatherLevels() )
+	{
+		CFile File( Location );
+		if( File.Load() )
+		{
+			Succeeded &= Compare( Location.c_str(), std::string( File.Fetch<char>(), File.Size() ) );
+		}
+	}
+
+	// Errors should point at the line they occurred on.
+	JSON::Document Broken;
+	if( Broken.Parse( "{\n\t\"a\" : \"1\",\n\t\"b\" \"2\"\n}" ) || Broken.ErrorLine() != 3 )
+	{
+		Log::Event( Log::Error, "The syntax error wasn't reported on the right line.\n" );
+		Succeeded = false;
+	}
+
+	return Succeeded ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CJSONPerformanceTest::GetName()
+{
+	return "JSON Performance Test";
+}
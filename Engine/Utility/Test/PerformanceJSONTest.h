@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares parsing and querying level files with the linked JSON tree and the arena-backed document.
+class CJSONPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
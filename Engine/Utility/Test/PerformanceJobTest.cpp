@@ -0,0 +1,196 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceJobTest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/JobSystem.h>
+#include <Engine/Utility/Thread.h>
+#include <Engine/Utility/ThreadPool.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t TaskCount = 100000;
+
+// Amount of jobs that are scheduled before waiting, keeps us within the job pool limits.
+constexpr size_t JobBatchSize = 1024;
+
+// Amount of (pointless) work performed by each task.
+constexpr size_t TaskIterations = 64;
+
+struct TaskStatistics
+{
+	// Time between submission and execution, in nanoseconds.
+	std::vector<int64_t> Latency;
+
+	// Stores the task output so that it isn't optimized away.
+	std::vector<float> Results;
+	double Seconds = 0.0;
+};
+
+static int64_t Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static float Busywork( const size_t Seed )
+{
+	float Value = static_cast<float>( Seed );
+	for( size_t Index = 0; Index < TaskIterations; Index++ )
+	{
+		Value = std::sqrt( Value + 1.0f );
+	}
+
+	return Value;
+}
+
+static void Report( const char* Name, TaskStatistics& Statistics )
+{
+	auto& Latency = Statistics.Latency;
+	std::sort( Latency.begin(), Latency.end() );
+
+	const auto Percentile = [&Latency] ( const double Fraction )
+	{
+		const size_t Index = std::min( Latency.size() - 1, static_cast<size_t>( Fraction * Latency.size() ) );
+		return static_cast<double>( Latency[Index] ) / 1000.0;
+	};
+
+	const double Throughput = static_cast<double>( TaskCount ) / Statistics.Seconds;
+	Log::Event( "%s: %.0f tasks/s | latency p50 %.1fus p99 %.1fus p99.9 %.1fus max %.1fus\n",
+		Name, Throughput, Percentile( 0.5 ), Percentile( 0.99 ), Percentile( 0.999 ), Percentile( 1.0 ) );
+}
+
+static TaskStatistics MeasureThreadPool()
+{
+	TaskStatistics Statistics;
+	Statistics.Latency.resize( TaskCount );
+	Statistics.Results.resize( TaskCount );
+	std::vector<int64_t> Submitted( TaskCount );
+
+	std::vector<std::future<void>> Futures;
+	Futures.reserve( TaskCount );
+
+	Timer Total;
+	Total.Start();
+
+	for( size_t Index = 0; Index < TaskCount; Index++ )
+	{
+		Submitted[Index] = Now();
+		Futures.emplace_back( ThreadPool::Add( [&Statistics, &Submitted, Index] ()
+			{
+				Statistics.Latency[Index] = Now() - Submitted[Index];
+				Statistics.Results[Index] = Busywork( Index );
+			}
+		) );
+	}
+
+	for( auto& Future : Futures )
+	{
+		Future.wait();
+	}
+
+	Total.Stop();
+	Statistics.Seconds = Total.GetElapsedTimeSeconds();
+	return Statistics;
+}
+
+static TaskStatistics MeasureJobSystem()
+{
+	TaskStatistics Statistics;
+	Statistics.Latency.resize( TaskCount );
+	Statistics.Results.resize( TaskCount );
+	std::vector<int64_t> Submitted( TaskCount );
+
+	Timer Total;
+	Total.Start();
+
+	for( size_t Batch = 0; Batch < TaskCount; Batch += JobBatchSize )
+	{
+		auto* Root = JobSystem::Create();
+		const size_t End = std::min( Batch + JobBatchSize, TaskCount );
+		for( size_t Index = Batch; Index < End; Index++ )
+		{
+			Submitted[Index] = Now();
+			JobSystem::Run( JobSystem::Create( Root, [&Statistics, &Submitted, Index] ()
+				{
+					Statistics.Latency[Index] = Now() - Submitted[Index];
+					Statistics.Results[Index] = Busywork( Index );
+				}
+			) );
+		}
+
+		JobSystem::Run( Root );
+		JobSystem::Wait( Root );
+	}
+
+	Total.Stop();
+	Statistics.Seconds = Total.GetElapsedTimeSeconds();
+	return Statistics;
+}
+
+static void MeasureParallelFor()
+{
+	constexpr size_t Count = 4000000;
+	std::vector<float> Values( Count );
+
+	Timer Serial;
+	Serial.Start();
+	for( size_t Index = 0; Index < Count; Index++ )
+	{
+		Values[Index] = Busywork( Index );
+	}
+	Serial.Stop();
+
+	Timer Parallel;
+	Parallel.Start();
+	JobSystem::ParallelFor( Count, 0, [&Values] ( const size_t Start, const size_t End )
+		{
+			for( size_t Index = Start; Index < End; Index++ )
+			{
+				Values[Index] = Busywork( Index );
+			}
+		}
+	);
+	Parallel.Stop();
+
+	Log::Event( "ParallelFor: %zu iterations | serial %ims | parallel %ims (%zu workers)\n",
+		Count, Serial.GetElapsedTimeMilliseconds(), Parallel.GetElapsedTimeMilliseconds(), JobSystem::GetWorkerCount() );
+}
+
+ETestResult CJobPerformanceTest::Run()
+{
+	// The benchmark can run before the application has been initialized.
+	const bool InitializeJobs = !JobSystem::IsInitialized();
+	if( InitializeJobs )
+	{
+		JobSystem::Initialize();
+	}
+
+	ThreadPool::Initialize();
+
+	Log::Event( "Scheduling %zu tasks.\n", TaskCount );
+
+	auto ThreadPoolStatistics = MeasureThreadPool();
+	Report( "ThreadPool", ThreadPoolStatistics );
+
+	auto JobStatistics = MeasureJobSystem();
+	Report( "JobSystem", JobStatistics );
+
+	MeasureParallelFor();
+
+	if( InitializeJobs )
+	{
+		JobSystem::Shutdown();
+	}
+
+	return ETestResult::Succeeded;
+}
+
+const char* CJobPerformanceTest::GetName()
+{
+	return "Job Performance Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares task throughput and scheduling latency of the thread pool and the job system.
+class CJobPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
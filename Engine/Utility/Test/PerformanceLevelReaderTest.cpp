@@ -0,0 +1,261 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceLevelReaderTest.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Math/Vector.h>
+#include <Engine/Utility/Structures/JSON.h>
+#include <Engine/Utility/Structures/JSONReader.h>
+#include <Engine/Utility/Timer.h>
+#include <Engine/World/Level/LevelReader.h>
+
+constexpr size_t EntityCount = 100000;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 3;
+
+// Stand-in for entities, the level reader doesn't need a world to be tested.
+struct FTestEntity
+{
+	std::string Type;
+	std::string Name;
+	Vector3D Position;
+	float Mass = 0.0f;
+	bool Linked = false;
+
+	void Load( const JSON::Vector& Objects )
+	{
+		JSON::Assign( Objects, "name", Name );
+		JSON::Assign( Objects, "position", Position );
+		JSON::Assign( Objects, "mass", Mass );
+	}
+};
+
+typedef std::function<FTestEntity*()> FTestFactory;
+
+// Same lookup as CEntityMap.
+static const std::unordered_map<std::string, FTestFactory>& Factories()
+{
+	static const std::unordered_map<std::string, FTestFactory> Map = {
+		{ "mesh", [] () { auto* Entity = new FTestEntity(); Entity->Type = "mesh"; return Entity; } },
+		{ "light", [] () { auto* Entity = new FTestEntity(); Entity->Type = "light"; return Entity; } }
+	};
+
+	return Map;
+}
+
+static std::unique_ptr<FTestEntity> Spawn( const JSON::Vector& Objects )
+{
+	std::string Type;
+	JSON::Assign( Objects, "type", Type );
+
+	const auto& Map = Factories();
+	const auto Factory = Map.find( Type );
+	if( Factory == Map.end() )
+		return nullptr;
+
+	std::unique_ptr<FTestEntity> Entity( Factory->second() );
+	Entity->Load( Objects );
+	Entity->Linked = JSON::Find( Objects, "outputs" ) != nullptr;
+	return Entity;
+}
+
+static std::string CreateLevel()
+{
+	std::string Level = "{\n\t\"uuid\" : \"0123456789abcdef\",\n\t\"assets\" : {\n\t\t\"meshes\" : [\n";
+	Level += "\t\t\t{ \"name\" : \"cube\", \"path\" : \"Models/cube.lmi\" }\n";
+	Level += "\t\t]\n\t},\n\t\"entities\" : [\n";
+	for( size_t Index = 0; Index < EntityCount; Index++ )
+	{
+		const auto Offset = std::to_string( Index % 1000 );
+		Level += "\t\t{\n";
+		Level += "\t\t\t\"type\" : \"" + std::string( Index % 4 == 0 ? "light" : "mesh" ) + "\",\n";
+		Level += "\t\t\t\"name\" : \"entity_" + std::to_string( Index ) + "\",\n";
+		Level += "\t\t\t\"uuid\" : \"" + std::to_string( 1000000 + Index ) + "\",\n";
+		Level += "\t\t\t\"position\" : \"" + Offset + " 2.5 -" + Offset + "\",\n";
+		Level += "\t\t\t\"rotation\" : \"0 90 0\",\n";
+		Level += "\t\t\t\"scale\" : \"1 1 1\",\n";
+		Level += "\t\t\t\"mesh\" : \"cube\",\n";
+		Level += "\t\t\t\"mass\" : \"" + Offset + ".5\"";
+
+		if( Index % 10 == 0 )
+		{
+			Level += ",\n\t\t\t\"outputs\" : [\n\t\t\t\t{ \"name\" : \"OnTrigger\", \"target\" : \"entity_" + std::to_string( ( Index + 1 ) % EntityCount ) + "\", \"input\" : \"Hide\" }\n\t\t\t]";
+		}
+
+		Level += Index + 1 < EntityCount ? "\n\t\t},\n" : "\n\t\t}\n";
+	}
+
+	Level += "\t]\n}\n";
+	return Level;
+}
+
+struct FMeasurement
+{
+	double FirstEntity = 0.0;
+	double Total = 0.0;
+};
+
+static void Keep( FMeasurement& Best, const FMeasurement& Measurement, const size_t Repetition )
+{
+	if( Repetition == 0 )
+	{
+		Best = Measurement;
+		return;
+	}
+
+	Best.FirstEntity = std::min( Best.FirstEntity, Measurement.FirstEntity );
+	Best.Total = std::min( Best.Total, Measurement.Total );
+}
+
+static FMeasurement MeasureTree( const std::string& Level, std::vector<std::unique_ptr<FTestEntity>>& Entities )
+{
+	FMeasurement Best;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Entities.clear();
+
+		FMeasurement Measurement;
+		Timer Measure;
+		Measure.Start();
+		const auto Tree = JSON::Tree( Level );
+		if( const auto* Objects = JSON::Find( Tree.Tree, "entities" ) )
+		{
+			for( const auto* Object : Objects->Objects )
+			{
+				auto Entity = Spawn( Object->Objects );
+				if( Entities.empty() )
+				{
+					Measurement.FirstEntity = Measure.GetElapsedTimeSeconds();
+				}
+
+				Entities.emplace_back( std::move( Entity ) );
+			}
+		}
+		Measure.Stop();
+
+		Measurement.Total = Measure.GetElapsedTimeSeconds();
+		Keep( Best, Measurement, Repetition );
+	}
+
+	return Best;
+}
+
+static FMeasurement MeasureReader( const std::string& Level, std::vector<std::unique_ptr<FTestEntity>>& Entities, size_t& Kept )
+{
+	FMeasurement Best;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Entities.clear();
+
+		// Entities with outputs keep their data until they're linked, like they do when a level is loaded.
+		std::vector<std::unique_ptr<JSON::Container>> Links;
+
+		FMeasurement Measurement;
+		Timer Measure;
+		Measure.Start();
+
+		CLevelReader Reader;
+		Reader.OnEntity = [&] ( std::unique_ptr<JSON::Container> Data, const size_t Offset )
+		{
+			auto Entity = Spawn( Data->Tree.front()->Objects );
+			if( Entities.empty() )
+			{
+				Measurement.FirstEntity = Measure.GetElapsedTimeSeconds();
+			}
+
+			if( Entity && Entity->Linked )
+			{
+				Links.emplace_back( std::move( Data ) );
+			}
+
+			Entities.emplace_back( std::move( Entity ) );
+		};
+
+		Reader.Read( Level.c_str(), Level.size() );
+		Measure.Stop();
+
+		Measurement.Total = Measure.GetElapsedTimeSeconds();
+		Keep( Best, Measurement, Repetition );
+		Kept = Links.size();
+	}
+
+	return Best;
+}
+
+static bool Matches( const std::vector<std::unique_ptr<FTestEntity>>& Expected, const std::vector<std::unique_ptr<FTestEntity>>& Result )
+{
+	if( Expected.size() != Result.size() )
+		return false;
+
+	for( size_t Index = 0; Index < Expected.size(); Index++ )
+	{
+		const auto* A = Expected[Index].get();
+		const auto* B = Result[Index].get();
+		if( !A || !B )
+			return false;
+
+		if( A->Type != B->Type || A->Name != B->Name || A->Linked != B->Linked || A->Mass != B->Mass )
+			return false;
+
+		if( A->Position.X != B->Position.X || A->Position.Y != B->Position.Y || A->Position.Z != B->Position.Z )
+			return false;
+	}
+
+	return true;
+}
+
+// Errors should point at the line and byte they occurred at.
+static bool CheckError()
+{
+	const std::string Broken = "{\n\t\"entities\" : [\n\t\t{ \"type\" \"mesh\" }\n\t]\n}";
+
+	CLevelReader Reader;
+	if( Reader.Read( Broken.c_str(), Broken.size() ) )
+		return false;
+
+	const auto& Error = Reader.GetReader();
+	return Error.ErrorLine() == 3 && Error.ErrorOffset() == Broken.find( "\"mesh\"" );
+}
+
+ETestResult CLevelReaderPerformanceTest::Run()
+{
+	const auto Level = CreateLevel();
+
+	std::vector<std::unique_ptr<FTestEntity>> Expected;
+	std::vector<std::unique_ptr<FTestEntity>> Result;
+	size_t Kept = 0;
+	const auto Tree = MeasureTree( Level, Expected );
+	const auto Reader = MeasureReader( Level, Result, Kept );
+
+	Log::Event( "%.2f MB | %zu entities | linked tree: first entity %.2fms, total %.2fms | level reader: first entity %.3fms, total %.2fms (%.1fx) | %zu entities kept for linking\n",
+		static_cast<double>( Level.size() ) / ( 1024.0 * 1024.0 ), Result.size(),
+		Tree.FirstEntity * 1000.0, Tree.Total * 1000.0, Reader.FirstEntity * 1000.0, Reader.Total * 1000.0,
+		Reader.Total > 0.0 ? Tree.Total / Reader.Total : 0.0, Kept );
+
+	bool Succeeded = true;
+	if( Result.size() != EntityCount || !Matches( Expected, Result ) )
+	{
+		Log::Event( Log::Error, "The level reader spawned different entities than the linked tree.\n" );
+		Succeeded = false;
+	}
+
+	if( !CheckError() )
+	{
+		Log::Event( Log::Error, "The syntax error wasn't reported at the right position.\n" );
+		Succeeded = false;
+	}
+
+	return Succeeded ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CLevelReaderPerformanceTest::GetName()
+{
+	return "Level Reader Performance Test";
+}
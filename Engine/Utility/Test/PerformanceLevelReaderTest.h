@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares spawning the entities of a level from the linked JSON tree and straight from the level reader.
+class CLevelReaderPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
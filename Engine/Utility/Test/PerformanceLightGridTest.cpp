@@ -0,0 +1,132 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceLightGridTest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <Engine/Display/Rendering/Light/LightGrid.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t MeshCount = 10000;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 5;
+
+// Size of the area that the lights and meshes are spread across.
+constexpr float WorldSize = 4000.0f;
+
+static double MeasureScan( const std::vector<Light>& Lights, const std::vector<Vector3D>& Meshes, std::vector<LightIndices>& Result )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Fetch;
+		Fetch.Start();
+		for( size_t Index = 0; Index < Meshes.size(); Index++ )
+		{
+			Result[Index] = LightGrid::Fetch( Lights.data(), static_cast<int32_t>( Lights.size() ), Meshes[Index] );
+		}
+		Fetch.Stop();
+
+		const double Seconds = Fetch.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+// Includes building the grid, which happens whenever the lights change.
+static double MeasureGrid( const std::vector<Light>& Lights, const std::vector<Vector3D>& Meshes, std::vector<LightIndices>& Result, CLightGrid& Grid )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Fetch;
+		Fetch.Start();
+		Grid.Build( Lights.data(), static_cast<int32_t>( Lights.size() ) );
+		for( size_t Index = 0; Index < Meshes.size(); Index++ )
+		{
+			Result[Index] = Grid.Fetch( Meshes[Index] );
+		}
+		Fetch.Stop();
+
+		const double Seconds = Fetch.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+static bool Measure( const size_t LightCount )
+{
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( -WorldSize * 0.5f, WorldSize * 0.5f );
+	std::uniform_real_distribution<float> Height( 0.0f, 100.0f );
+	std::uniform_real_distribution<float> Intensity( 10.0f, 2000.0f );
+
+	std::vector<Light> Lights( LightCount );
+	for( auto& Information : Lights )
+	{
+		Information.Position = glm::vec4( Position( Generator ), Height( Generator ), Position( Generator ), 0.0f );
+		Information.Direction = glm::vec4( 0.0f, -1.0f, 0.0f, 10.0f );
+		Information.Color = glm::vec4( 1.0f, 1.0f, 1.0f, Intensity( Generator ) );
+		Information.Properties = glm::vec4( 1.0f, 1.0f, 0.0f, 0.0f );
+	}
+
+	std::vector<Vector3D> Meshes;
+	Meshes.reserve( MeshCount );
+	for( size_t Index = 0; Index < MeshCount; Index++ )
+	{
+		Meshes.emplace_back( Position( Generator ), Height( Generator ), Position( Generator ) );
+	}
+
+	std::vector<LightIndices> Expected( MeshCount );
+	const double Scan = MeasureScan( Lights, Meshes, Expected );
+
+	CLightGrid Grid;
+	std::vector<LightIndices> Binned( MeshCount );
+	const double Binning = MeasureGrid( Lights, Meshes, Binned, Grid );
+
+	size_t Mismatches = 0;
+	for( size_t Index = 0; Index < MeshCount; Index++ )
+	{
+		for( size_t Slot = 0; Slot < 4; Slot++ )
+		{
+			if( Expected[Index].Index[Slot] != Binned[Index].Index[Slot] )
+			{
+				Mismatches++;
+				break;
+			}
+		}
+	}
+
+	Log::Event( "%u lights, %u meshes: scan %.3fms | grid %.3fms (%.2fx) | %u cells, %.1f lights per cell\n",
+		LightCount, MeshCount, Scan * 1000.0, Binning * 1000.0, Scan / Binning,
+		Grid.GetCellCount(), static_cast<double>( Grid.GetEntryCount() ) / static_cast<double>( std::max( Grid.GetCellCount(), size_t( 1 ) ) ) );
+
+	if( Mismatches > 0 )
+	{
+		Log::Event( Log::Error, "The light grid picked different lights for %u meshes.\n", Mismatches );
+		return false;
+	}
+
+	return true;
+}
+
+ETestResult CLightGridPerformanceTest::Run()
+{
+	bool Success = true;
+	for( const size_t LightCount : { 256, 1024 } )
+	{
+		Success &= Measure( LightCount );
+	}
+
+	return Success ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CLightGridPerformanceTest::GetName()
+{
+	return "Light Grid Performance Test";
+}
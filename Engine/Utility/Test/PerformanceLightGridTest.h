@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares fetching the lights of each mesh by scanning every light against the light grid.
+class CLightGridPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,254 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceNameTest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Structures/Name.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t NameCount = 4000;
+constexpr size_t LookupsPerThread = 250000;
+constexpr size_t StringLookups = 20000;
+
+// Every so many lookups a thread adds a name that doesn't exist yet.
+constexpr size_t InsertInterval = 64;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 3;
+
+// Reference values of 32-bit FNV-1a.
+static_assert( FNV::String32( "" ) == 2166136261u, "String32 doesn't match FNV-1a." );
+static_assert( FNV::String32( "a" ) == 0xe40c292cu, "String32 doesn't match FNV-1a." );
+static_assert( FNV::String32( "foobar" ) == 0xbf9cf968u, "String32 doesn't match FNV-1a." );
+
+// Copy of the previous name pool, every lookup takes the lock exclusively and fetching a string scans the whole pool.
+class FLegacyPool
+{
+public:
+	NameIndex Find( const char* Name )
+	{
+		std::lock_guard<std::shared_mutex> Lock( Mutex );
+
+		const auto String = std::string( Name );
+		const auto Iterator = Names.find( String );
+		if( Iterator == Names.end() )
+		{
+			const auto Result = Names.insert_or_assign( String, PoolIndex++ );
+			return Result.first->second;
+		}
+
+		return Iterator->second;
+	}
+
+	const std::string* String( const NameIndex Index ) const
+	{
+		for( const auto& Iterator : Names )
+		{
+			if( Iterator.second == Index )
+			{
+				return &Iterator.first;
+			}
+		}
+
+		return nullptr;
+	}
+
+private:
+	std::unordered_map<std::string, NameIndex> Names;
+	std::shared_mutex Mutex;
+	NameIndex PoolIndex = 0;
+};
+
+// Wraps the new pool so that both pools can be measured by the same code.
+class FPool
+{
+public:
+	FPool() : Pool( new NamePool() ) {}
+
+	NameIndex Find( const char* Name )
+	{
+		const size_t Length = std::strlen( Name );
+		return Pool->Find( Name, Length, FNV::Bytes32( Name, Length ) );
+	}
+
+	const std::string* String( const NameIndex Index ) const
+	{
+		return Pool->String( Index );
+	}
+
+private:
+	// The pool is too large for the stack.
+	std::unique_ptr<NamePool> Pool;
+};
+
+struct FMeasurement
+{
+	double Lookups = 0.0;
+	double Strings = 0.0;
+	bool Valid = true;
+};
+
+static std::vector<std::string> CreateNames()
+{
+	std::vector<std::string> Names;
+	Names.reserve( NameCount );
+	for( size_t Index = 0; Index < NameCount; Index++ )
+	{
+		Names.emplace_back( "entity_" + std::to_string( Index ) + ( Index % 2 == 0 ? ".OnTrigger" : ".OnDamage" ) );
+	}
+
+	return Names;
+}
+
+template<typename PoolType>
+static FMeasurement Measure( const std::vector<std::string>& Names, const size_t Threads )
+{
+	FMeasurement Best;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		PoolType Pool;
+		for( const auto& Name : Names )
+		{
+			Pool.Find( Name.c_str() );
+		}
+
+		// Indices every thread found for the existing names.
+		std::vector<std::vector<NameIndex>> Found( Threads, std::vector<NameIndex>( Names.size(), 0 ) );
+
+		FMeasurement Measurement;
+		Timer Measure;
+		Measure.Start();
+
+		std::vector<std::thread> Workers;
+		for( size_t Thread = 0; Thread < Threads; Thread++ )
+		{
+			Workers.emplace_back( [&, Thread] ()
+			{
+				auto& Indices = Found[Thread];
+				std::string Added;
+				for( size_t Lookup = 0; Lookup < LookupsPerThread; Lookup++ )
+				{
+					if( Lookup % InsertInterval == InsertInterval - 1 )
+					{
+						Added = "thread_" + std::to_string( Thread ) + "_" + std::to_string( Lookup );
+						Pool.Find( Added.c_str() );
+						continue;
+					}
+
+					const size_t Index = ( Lookup * 7919 + Thread * 104729 ) % Names.size();
+					Indices[Index] = Pool.Find( Names[Index].c_str() );
+				}
+			} );
+		}
+
+		for( auto& Worker : Workers )
+		{
+			Worker.join();
+		}
+
+		Measure.Stop();
+		Measurement.Lookups = Measure.GetElapsedTimeSeconds();
+
+		// Every thread should have found the index the name was added with.
+		for( size_t Index = 0; Index < Names.size(); Index++ )
+		{
+			for( const auto& Indices : Found )
+			{
+				if( Indices[Index] != static_cast<NameIndex>( Index ) && Indices[Index] != 0 )
+				{
+					Measurement.Valid = false;
+				}
+			}
+		}
+
+		Measure.Start();
+		for( size_t Lookup = 0; Lookup < StringLookups; Lookup++ )
+		{
+			const size_t Index = ( Lookup * 7919 ) % Names.size();
+			const auto* String = Pool.String( static_cast<NameIndex>( Index ) );
+			if( !String || *String != Names[Index] )
+			{
+				Measurement.Valid = false;
+			}
+		}
+		Measure.Stop();
+		Measurement.Strings = Measure.GetElapsedTimeSeconds();
+
+		if( Repetition == 0 || Measurement.Lookups < Best.Lookups )
+		{
+			Best.Lookups = Measurement.Lookups;
+		}
+
+		if( Repetition == 0 || Measurement.Strings < Best.Strings )
+		{
+			Best.Strings = Measurement.Strings;
+		}
+
+		Best.Valid = Best.Valid && Measurement.Valid;
+	}
+
+	return Best;
+}
+
+// Symbols created from literals should end up with the same index as symbols created at run-time.
+static bool CheckLiteral()
+{
+	static constexpr NameLiteral Literal( "Name Performance Test" );
+	static_assert( Literal.Hash == FNV::String32( "Name Performance Test" ), "The literal hash wasn't computed correctly." );
+
+	const std::string Runtime = "Name Performance Test";
+	const NameSymbol FromLiteral( Literal );
+	const NameSymbol FromString( Runtime );
+	return FromLiteral == FromString && FromLiteral.String() == Runtime;
+}
+
+ETestResult CNamePerformanceTest::Run()
+{
+	const auto Names = CreateNames();
+	const size_t Threads = std::max<size_t>( 2, std::min<size_t>( 8, std::thread::hardware_concurrency() ) );
+
+	const auto Legacy = Measure<FLegacyPool>( Names, Threads );
+	const auto Result = Measure<FPool>( Names, Threads );
+
+	const double Lookups = static_cast<double>( Threads * LookupsPerThread );
+	Log::Event( "%zu names | %zu threads | exclusive lock: %.2fms (%.1f ns/lookup), strings %.2fms | shared lock: %.2fms (%.1f ns/lookup), strings %.3fms (%.1fx, %.0fx)\n",
+		Names.size(), Threads,
+		Legacy.Lookups * 1000.0, Legacy.Lookups * 1e9 / Lookups, Legacy.Strings * 1000.0,
+		Result.Lookups * 1000.0, Result.Lookups * 1e9 / Lookups, Result.Strings * 1000.0,
+		Result.Lookups > 0.0 ? Legacy.Lookups / Result.Lookups : 0.0,
+		Result.Strings > 0.0 ? Legacy.Strings / Result.Strings : 0.0 );
+
+	bool Succeeded = true;
+	if( !Legacy.Valid || !Result.Valid )
+	{
+		Log::Event( Log::Error, "The name pool returned the wrong index or string.\n" );
+		Succeeded = false;
+	}
+
+	if( !CheckLiteral() )
+	{
+		Log::Event( Log::Error, "The name literal didn't match the run-time name.\n" );
+		Succeeded = false;
+	}
+
+	if( Result.Lookups >= Legacy.Lookups || Result.Strings >= Legacy.Strings )
+	{
+		Succeeded = false;
+	}
+
+	return Succeeded ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CNamePerformanceTest::GetName()
+{
+	return "Name Performance Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares name lookups from several threads and fetching their strings against the previous name pool.
+class CNamePerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
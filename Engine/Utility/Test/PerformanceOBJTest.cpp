@@ -0,0 +1,324 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceOBJTest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/MeshBuilder.h>
+#include <Engine/Utility/Primitive.h>
+#include <Engine/Utility/Timer.h>
+
+// 720 x 720 quads, just over 1M triangles.
+constexpr size_t GridSize = 720;
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 3;
+
+// The importer as it was before vertices were deduplicated with a hash table.
+static void LegacyOBJ( FPrimitive& Primitive, const CFile& File )
+{
+	std::vector<Vector3D> Vertices;
+	std::vector<Vector2D> Coordinates;
+	std::vector<Vector3D> Normals;
+
+	std::vector<glm::uint> VertexIndices;
+	std::vector<size_t> CoordinateIndices;
+	std::vector<size_t> NormalIndices;
+
+	const char Delimiter = ' ';
+	const char* Start = File.Fetch<char>();
+	const char* End = nullptr;
+	const char* LoopToken = Start;
+	while( LoopToken )
+	{
+		LoopToken = GetLine( Start, End );
+
+		if( Start[0] == 'v' )
+		{
+			if( Start[1] == 't' )
+			{
+				Start += 3;
+
+				size_t OutTokenCount = 0;
+				auto Tokens = ExtractTokensFloat( Start, Delimiter, OutTokenCount, 2 );
+				if( Tokens && OutTokenCount == 2 )
+				{
+					Coordinates.emplace_back( Vector2D( Tokens[0], Tokens[1] ) );
+				}
+			}
+			else if( Start[1] == 'n' )
+			{
+				Primitive.HasNormals = true;
+
+				Start += 3;
+
+				size_t OutTokenCount = 0;
+				auto Tokens = ExtractTokensFloat( Start, Delimiter, OutTokenCount, 3 );
+				if( Tokens && OutTokenCount == 3 )
+				{
+					Normals.emplace_back( Vector3D( Tokens[2], Tokens[0], Tokens[1] ) );
+				}
+			}
+			else if( Start[1] != 'p' )
+			{
+				Start += 2;
+
+				size_t OutTokenCount = 0;
+				auto Tokens = ExtractTokensFloat( Start, Delimiter, OutTokenCount, 3 );
+				if( Tokens && OutTokenCount == 3 )
+				{
+					Vertices.emplace_back( Vector3D( Tokens[2], Tokens[0], Tokens[1] ) );
+				}
+			}
+		}
+		else if( Start[0] == 'f' )
+		{
+			Start += 2;
+			auto Tokens = ExtractTokens( Start, Delimiter, 3 );
+			for( auto& Token : Tokens )
+			{
+				size_t OutTokenCount = 0;
+				auto ComponentTokens = ExtractTokensInteger( Token.c_str(), '/', OutTokenCount, 3 );
+				if( ComponentTokens && OutTokenCount == 3 )
+				{
+					VertexIndices.emplace_back( ComponentTokens[0] - 1 );
+
+					if( ComponentTokens[1] != 0 )
+					{
+						CoordinateIndices.emplace_back( ComponentTokens[1] - 1 );
+					}
+
+					NormalIndices.emplace_back( ComponentTokens[2] - 1 );
+				}
+			}
+		}
+
+		Start = End;
+	}
+
+	if( VertexIndices.size() != CoordinateIndices.size() || VertexIndices.size() != NormalIndices.size() )
+		return;
+
+	std::vector<ComplexVertex> FatVertices;
+	std::vector<uint32_t> FatIndices;
+	std::map<ComplexVertex, uint32_t> IndexMap;
+	for( size_t Index = 0; Index < VertexIndices.size(); Index++ )
+	{
+		ComplexVertex Vertex;
+		Vertex.Position = Vertices[VertexIndices[Index]];
+		Vertex.Normal = Normals[NormalIndices[Index]];
+		Vertex.TextureCoordinate = Coordinates[CoordinateIndices[Index]];
+		Vertex.Color = Vector3D( 1.0f, 1.0f, 1.0f );
+
+		const auto Iterator = IndexMap.find( Vertex );
+		if( Iterator != IndexMap.end() )
+		{
+			FatIndices.emplace_back( Iterator->second );
+		}
+		else
+		{
+			FatVertices.emplace_back( Vertex );
+			const auto NewIndex = static_cast<uint32_t>( FatVertices.size() - 1 );
+			FatIndices.emplace_back( NewIndex );
+			IndexMap.insert( std::make_pair( Vertex, NewIndex ) );
+		}
+	}
+
+	Primitive.Vertices = new ComplexVertex[FatVertices.size()];
+	std::copy( FatVertices.begin(), FatVertices.end(), Primitive.Vertices );
+	Primitive.VertexCount = static_cast<uint32_t>( FatVertices.size() );
+
+	Primitive.Indices = new glm::uint[FatIndices.size()];
+	std::copy( FatIndices.begin(), FatIndices.end(), Primitive.Indices );
+	Primitive.IndexCount = static_cast<uint32_t>( FatIndices.size() );
+}
+
+// A scanned surface, neighbouring vertices share their normals and every vertex has its own texture coordinate.
+static std::string CreateGrid()
+{
+	std::string Text;
+	const size_t Stride = GridSize + 1;
+	char Line[128];
+	for( size_t Y = 0; Y < Stride; Y++ )
+	{
+		for( size_t X = 0; X < Stride; X++ )
+		{
+			snprintf( Line, sizeof( Line ), "v %.4f %.4f %.4f\n", X * 0.01f, ( ( X * 7 + Y * 13 ) % 100 ) * 0.001f, Y * 0.01f );
+			Text += Line;
+		}
+	}
+
+	for( size_t Y = 0; Y < Stride; Y++ )
+	{
+		for( size_t X = 0; X < Stride; X++ )
+		{
+			snprintf( Line, sizeof( Line ), "vt %.5f %.5f\n", static_cast<float>( X ) / GridSize, static_cast<float>( Y ) / GridSize );
+			Text += Line;
+		}
+	}
+
+	// The same few normals are written over and over again, like exporters that don't share them.
+	for( size_t Index = 0; Index < Stride * Stride; Index++ )
+	{
+		snprintf( Line, sizeof( Line ), "vn 0.%u 0.9 0.%u\n", static_cast<unsigned>( Index % 5 ), static_cast<unsigned>( Index % 3 ) );
+		Text += Line;
+	}
+
+	for( size_t Y = 0; Y < GridSize; Y++ )
+	{
+		for( size_t X = 0; X < GridSize; X++ )
+		{
+			const size_t A = Y * Stride + X + 1;
+			const size_t B = A + 1;
+			const size_t C = A + Stride;
+			const size_t D = C + 1;
+			snprintf( Line, sizeof( Line ), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", A, A, A, B, B, B, D, D, D );
+			Text += Line;
+			snprintf( Line, sizeof( Line ), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", A, A, A, D, D, D, C, C, C );
+			Text += Line;
+		}
+	}
+
+	return Text;
+}
+
+// Files that the importer reads in unusual ways, these have to come out the same as well.
+static std::string CreateQuirks()
+{
+	std::string Text = "# Comment\r\n";
+	Text += "v 0.0 1.5 -0.0\r\n";
+	Text += "v -0.0 1.5 0.0\r\n";
+	Text += "v 1.0 1.5 0.0\r\n";
+	Text += "v 1.0 1.5 0.0 \r\n";
+	Text += "v 2.5e-3 1 ?\r\n";
+	Text += "v -1 -2 -3\r\n";
+	Text += "v 0.1 0.2 0.3\r\n";
+	Text += "v 0.1 0.2 0.3\r\n";
+	Text += "vt 0 0\r\nvt 1 0\r\nvt 0 1 0\r\nvt 1 1\r\nvt 0 0\r\n";
+	Text += "vn 0 1 0\r\nvn 0 1 0\r\nvn 0 -0 1\r\n";
+	Text += "o Quirks\r\nvp 0.5\r\n";
+	Text += "f 1/1/1 2/2/2 3/3/3\r\n";
+	Text += "f 4/4/2 5/1/1 6/1/3 7/2/1\r\n";
+	Text += "f 07/1/1 06/4/2 0x5/3/3\r\n";
+	Text += "f 7/4/1 6/1/2 5/2/2\r\n";
+	Text += "f 1/1/1  2/2/2 3/3/3\r\n";
+	Text += "f 1/1/1 2/2/2\r\n";
+	Text += "f 1/1/1 2/2/2/2 3/3/3\r\n";
+	Text += "f 5/1/3 4/4/2 7/4/1";
+	return Text;
+}
+
+static void Load( CFile& File, const std::string& Text )
+{
+	// The importer expects the data to be null-terminated.
+	char* Buffer = new char[Text.size() + 1];
+	std::memcpy( Buffer, Text.c_str(), Text.size() + 1 );
+	File.Load( Buffer, Text.size() );
+}
+
+static bool Identical( const FPrimitive& A, const FPrimitive& B )
+{
+	if( A.VertexCount != B.VertexCount || A.IndexCount != B.IndexCount || A.HasNormals != B.HasNormals )
+		return false;
+
+	if( A.VertexCount > 0 && std::memcmp( A.Vertices, B.Vertices, A.VertexCount * sizeof( ComplexVertex ) ) != 0 )
+		return false;
+
+	return A.IndexCount == 0 || std::memcmp( A.Indices, B.Indices, A.IndexCount * sizeof( uint32_t ) ) == 0;
+}
+
+static bool Compare( const char* Name, const CFile& File )
+{
+	double Legacy = 0.0;
+	double Hashed = 0.0;
+	bool Matches = true;
+	uint32_t Triangles = 0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		FPrimitive Expected;
+		Timer Measure;
+		Measure.Start();
+		LegacyOBJ( Expected, File );
+		Measure.Stop();
+
+		const double LegacyTime = Measure.GetElapsedTimeSeconds();
+		Legacy = Repetition == 0 ? LegacyTime : std::min( Legacy, LegacyTime );
+
+		FPrimitive Result;
+		Measure.Start();
+		MeshBuilder::OBJ( Result, File );
+		Measure.Stop();
+
+		const double HashedTime = Measure.GetElapsedTimeSeconds();
+		Hashed = Repetition == 0 ? HashedTime : std::min( Hashed, HashedTime );
+
+		Matches &= Identical( Expected, Result );
+		Triangles = Result.IndexCount / 3;
+	}
+
+	Log::Event( "%s: %.2f MB | %u triangles | ordered map %.2fms | hash table %.2fms (%.1fx)\n", Name,
+		static_cast<double>( File.Size() ) / ( 1024.0 * 1024.0 ), Triangles,
+		Legacy * 1000.0, Hashed * 1000.0, Hashed > 0.0 ? Legacy / Hashed : 0.0 );
+
+	if( !Matches )
+	{
+		Log::Event( Log::Error, "The importer output changed for \"%s\".\n", Name );
+		return false;
+	}
+
+	return true;
+}
+
+static std::vector<std::string> GatherModels()
+{
+	std::vector<std::string> Models;
+	if( !std::experimental::filesystem::exists( "Models" ) )
+		return Models;
+
+	for( const auto& Entry : std::experimental::filesystem::recursive_directory_iterator( "Models" ) )
+	{
+		if( std::experimental::filesystem::is_regular_file( Entry.path() ) && Entry.path().extension() == ".obj" )
+		{
+			Models.emplace_back( Entry.path().generic_string() );
+		}
+	}
+
+	return Models;
+}
+
+ETestResult COBJPerformanceTest::Run()
+{
+	bool Succeeded = true;
+
+	CFile Quirks( "quirks.obj" );
+	Load( Quirks, CreateQuirks() );
+	Succeeded &= Compare( "Unusual file", Quirks );
+
+	CFile Grid( "grid.obj" );
+	Load( Grid, CreateGrid() );
+	Succeeded &= Compare( "Synthetic scan", Grid );
+
+	// Existing models have to be imported the same way.
+	for( const auto& Location : GatherModels() )
+	{
+		CFile File( Location );
+		if( File.Load() )
+		{
+			Succeeded &= Compare( Location.c_str(), File );
+		}
+	}
+
+	return Succeeded ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* COBJPerformanceTest::GetName()
+{
+	return "OBJ Performance Test";
+}
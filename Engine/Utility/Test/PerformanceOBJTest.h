@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares the OBJ importer with the one that deduplicated vertices using an ordered map, their output has to be identical.
+class COBJPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
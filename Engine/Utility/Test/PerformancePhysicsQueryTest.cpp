@@ -0,0 +1,161 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformancePhysicsQueryTest.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Engine/Physics/Physics.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/JobSystem.h>
+#include <Engine/Utility/Test/HeadlessBody.h>
+#include <Engine/Utility/ThreadPool.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t StaticBodyCount = 20000;
+constexpr size_t DynamicBodyCount = 5000;
+constexpr size_t RayCount = 100000;
+constexpr size_t FrameCount = 10;
+
+// Amount of rays that are validated against a brute force search.
+constexpr size_t ValidationCount = 1000;
+
+constexpr float WorldExtent = 250.0f;
+constexpr double TimeStep = 1.0 / 60.0;
+
+static bool Validate( const std::vector<std::unique_ptr<CHeadlessBody>>& Bodies, const std::vector<PhysicsRay>& Rays, const QueryBatchResult& Batch )
+{
+	for( size_t Index = 0; Index < ValidationCount; Index++ )
+	{
+		const auto& Ray = Rays[Index];
+
+		Geometry::Result Expected;
+		for( const auto& Body : Bodies )
+		{
+			const auto Result = Body->Cast( Ray.Start, Ray.End );
+			if( Result.Hit && ( !Expected.Hit || Result.Distance < Expected.Distance ) )
+			{
+				Expected = Result;
+			}
+		}
+
+		const auto& Result = Batch.Casts[Index];
+		if( Result.Hit != Expected.Hit || ( Result.Hit && std::abs( Result.Distance - Expected.Distance ) > 0.001f ) )
+		{
+			Log::Event( Log::Error, "Ray %u hit at %.3f, expected %.3f.\n", Index, Result.Distance, Expected.Distance );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ETestResult CPhysicsQueryPerformanceTest::Run()
+{
+	const bool InitializeJobs = !JobSystem::IsInitialized();
+	if( InitializeJobs )
+	{
+		JobSystem::Initialize();
+	}
+
+	ThreadPool::Initialize();
+
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( -WorldExtent, WorldExtent );
+	std::uniform_real_distribution<float> Size( 0.25f, 4.0f );
+
+	CPhysics Physics;
+	Physics.SetSynchronous( false );
+
+	std::vector<std::unique_ptr<CHeadlessBody>> Bodies;
+	Bodies.reserve( StaticBodyCount + DynamicBodyCount );
+	for( size_t Index = 0; Index < StaticBodyCount + DynamicBodyCount; Index++ )
+	{
+		auto Body = std::make_unique<CHeadlessBody>();
+		Body->Static = Index < StaticBodyCount;
+
+		// Stationary static bodies aren't part of the static scene, the dynamic bodies stay stationary so that they don't need a world.
+		Body->Stationary = !Body->Static;
+		Body->Transform.SetPosition( Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) * 0.1f ) );
+
+		const Vector3D Extent( Size( Generator ), Size( Generator ), Size( Generator ) );
+		Body->LocalBounds = BoundingBox( -Extent, Extent );
+		Body->Construct( &Physics );
+		Bodies.emplace_back( std::move( Body ) );
+	}
+
+	std::vector<PhysicsRay> Rays( RayCount );
+	for( auto& Ray : Rays )
+	{
+		Ray.Start = Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) * 0.1f );
+		Ray.End = Ray.Start + Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) * 0.1f ) * 0.2f;
+	}
+
+	// Snapshots are only taken on request, the first batch runs once the tick has published one.
+	double Time = 0.0;
+	const auto Ticket = Physics.SubmitRays( Rays );
+	Physics.Tick( Time );
+	Physics.Guard();
+
+	const bool Valid = Validate( Bodies, Rays, Physics.Collect( Ticket ) );
+
+	int64_t BlockingTime = 0;
+	int64_t BatchedTime = 0;
+	size_t BlockingHits = 0;
+	size_t BatchedHits = 0;
+
+	for( size_t Frame = 0; Frame < FrameCount; Frame++ )
+	{
+		Time += TimeStep;
+		Physics.Tick( Time );
+
+		// Every cast waits for the physics workers.
+		Timer Blocking;
+		Blocking.Start();
+		for( const auto& Ray : Rays )
+		{
+			BlockingHits += Physics.Cast( Ray.Start, Ray.End ).Hit ? 1 : 0;
+		}
+		Blocking.Stop();
+		BlockingTime += Blocking.GetElapsedTimeMicroseconds();
+
+		Time += TimeStep;
+		Physics.Tick( Time );
+
+		// The batch runs alongside the physics workers.
+		Timer Batched;
+		Batched.Start();
+		const auto Result = Physics.Collect( Physics.SubmitRays( Rays ) );
+		Batched.Stop();
+		BatchedTime += Batched.GetElapsedTimeMicroseconds();
+
+		for( const auto& Cast : Result.Casts )
+		{
+			BatchedHits += Cast.Hit ? 1 : 0;
+		}
+	}
+
+	Physics.Guard();
+	Physics.Destroy();
+
+	const auto Throughput = [] ( const int64_t Microseconds )
+	{
+		return static_cast<double>( RayCount * FrameCount ) / ( static_cast<double>( Microseconds ) / 1000000.0 );
+	};
+
+	Log::Event( "Blocking casts: %.0f rays/s | %.2fms per frame (%u hits)\n", Throughput( BlockingTime ), BlockingTime / 1000.0 / FrameCount, BlockingHits );
+	Log::Event( "Batched casts: %.0f rays/s | %.2fms per frame (%u hits, %u workers)\n", Throughput( BatchedTime ), BatchedTime / 1000.0 / FrameCount, BatchedHits, JobSystem::GetWorkerCount() );
+
+	if( InitializeJobs )
+	{
+		JobSystem::Shutdown();
+	}
+
+	return Valid ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CPhysicsQueryPerformanceTest::GetName()
+{
+	return "Physics Query Performance Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares blocking physics casts with batched casts that run against the physics snapshot.
+class CPhysicsQueryPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
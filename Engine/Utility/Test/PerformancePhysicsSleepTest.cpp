@@ -0,0 +1,192 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformancePhysicsSleepTest.h"
+
+#include <memory>
+#include <vector>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Physics/Physics.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Test/HeadlessBody.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t TickCount = 600;
+constexpr double TimeStep = 1.0 / 60.0;
+
+// Amount of stacks along each side of the grid, and the amount of boxes per stack.
+constexpr size_t GridSize = 16;
+constexpr size_t StackHeight = 6;
+
+struct SleepStatistics
+{
+	double MillisecondsPerTick = 0.0;
+
+	// Bodies that were still being simulated during the last tick.
+	size_t ActiveBodies = 0;
+
+	// Bodies that ended up below the floor.
+	size_t Fallen = 0;
+};
+
+static SleepStatistics Measure( const bool Sleeping )
+{
+	CConfiguration::Get().Store( "physics.Sleeping", Sleeping );
+
+	CPhysics Physics;
+	Physics.SetSynchronous( true );
+
+	const float Extent = static_cast<float>( GridSize ) * 2.0f;
+
+	auto Floor = std::make_unique<CHeadlessBody>();
+	Floor->LocalBounds = BoundingBox( Vector3D( -Extent, -Extent, -1.0f ), Vector3D( Extent, Extent, 0.0f ) );
+	Floor->Static = true;
+	Floor->Stationary = false;
+	Floor->Construct( &Physics );
+
+	std::vector<std::unique_ptr<CHeadlessBody>> Bodies;
+	Bodies.reserve( GridSize * GridSize * StackHeight );
+	for( size_t X = 0; X < GridSize; X++ )
+	{
+		for( size_t Y = 0; Y < GridSize; Y++ )
+		{
+			for( size_t Z = 0; Z < StackHeight; Z++ )
+			{
+				const auto Location = Vector3D(
+					static_cast<float>( X ) * 4.0f - Extent + 2.0f,
+					static_cast<float>( Y ) * 4.0f - Extent + 2.0f,
+					static_cast<float>( Z ) * 1.05f + 0.55f
+				);
+
+				auto Body = std::make_unique<CHeadlessBody>();
+				Body->Transform.SetPosition( Location );
+				Body->LocalBounds = BoundingBox( Vector3D( -0.5f, -0.5f, -0.5f ), Vector3D( 0.5f, 0.5f, 0.5f ) );
+				Body->Stationary = false;
+
+				Body->Construct( &Physics );
+				Bodies.emplace_back( std::move( Body ) );
+			}
+		}
+	}
+
+	double Time = 0.0;
+	Timer Total;
+	Total.Start();
+
+	for( size_t Tick = 0; Tick < TickCount; Tick++ )
+	{
+		Physics.Tick( Time );
+		Time += TimeStep;
+	}
+
+	Physics.Guard();
+	Total.Stop();
+
+	SleepStatistics Statistics;
+	Statistics.MillisecondsPerTick = Total.GetElapsedTimeSeconds() * 1000.0 / static_cast<double>( TickCount );
+	for( auto& Body : Bodies )
+	{
+		if( !Body->Sleeping )
+		{
+			Statistics.ActiveBodies++;
+		}
+
+		if( Body->Transform.GetPosition().Z < -1.0f )
+		{
+			Statistics.Fallen++;
+		}
+	}
+
+	Physics.Destroy();
+
+	return Statistics;
+}
+
+// Moves a platform out from under a sleeping box, the box should wake up and fall.
+static bool WakesOnPlatform()
+{
+	CConfiguration::Get().Store( "physics.Sleeping", true );
+
+	CPhysics Physics;
+	Physics.SetSynchronous( true );
+
+	auto Platform = std::make_unique<CHeadlessBody>();
+	Platform->LocalBounds = BoundingBox( Vector3D( -2.0f, -2.0f, -1.0f ), Vector3D( 2.0f, 2.0f, 0.0f ) );
+	Platform->Static = false;
+	Platform->Stationary = true;
+	Platform->Construct( &Physics );
+
+	auto Box = std::make_unique<CHeadlessBody>();
+	Box->Transform.SetPosition( Vector3D( 0.0f, 0.0f, 0.55f ) );
+	Box->LocalBounds = BoundingBox( Vector3D( -0.5f, -0.5f, -0.5f ), Vector3D( 0.5f, 0.5f, 0.5f ) );
+	Box->Stationary = false;
+	Box->Construct( &Physics );
+
+	double Time = 0.0;
+	for( size_t Tick = 0; Tick < TickCount && !Box->Sleeping; Tick++ )
+	{
+		Physics.Tick( Time );
+		Time += TimeStep;
+	}
+
+	const bool Slept = Box->Sleeping;
+
+	Platform->Transform.SetPosition( Vector3D( 0.0f, 0.0f, -0.5f ) );
+	Physics.Tick( Time );
+	Physics.Guard();
+
+	const bool Woke = !Box->Sleeping;
+
+	Physics.Destroy();
+
+	if( !Slept )
+	{
+		Log::Event( Log::Error, "The box on the platform never went to sleep.\n" );
+	}
+	else if( !Woke )
+	{
+		Log::Event( Log::Error, "Moving the platform didn't wake up the box resting on it.\n" );
+	}
+
+	return Slept && Woke;
+}
+
+ETestResult CPhysicsSleepPerformanceTest::Run()
+{
+	const bool Sleeping = CConfiguration::Get().IsEnabled( "physics.Sleeping" );
+
+	const auto Awake = Measure( false );
+	const auto Asleep = Measure( true );
+	const bool Platform = WakesOnPlatform();
+
+	const size_t BodyCount = GridSize * GridSize * StackHeight;
+	Log::Event( "%zu stacked bodies, %zu ticks\n", BodyCount, TickCount );
+	Log::Event( "Sleeping off: %zu active | %.3f ms/tick | %zu fell through\n", Awake.ActiveBodies, Awake.MillisecondsPerTick, Awake.Fallen );
+	Log::Event( "Sleeping on: %zu active | %.3f ms/tick | %zu fell through (%.2fx)\n",
+		Asleep.ActiveBodies, Asleep.MillisecondsPerTick, Asleep.Fallen, Awake.MillisecondsPerTick / Asleep.MillisecondsPerTick );
+
+	CConfiguration::Get().Store( "physics.Sleeping", Sleeping );
+
+	// Sleeping stacks shouldn't behave any worse than the awake ones.
+	if( Asleep.Fallen > Awake.Fallen )
+	{
+		Log::Event( Log::Error, "Sleeping bodies fell through the floor.\n" );
+		return ETestResult::Failed;
+	}
+
+	// Most of the stacks should have come to rest by now.
+	if( Asleep.ActiveBodies * 4 > BodyCount )
+	{
+		Log::Event( Log::Error, "Only %zu of %zu bodies went to sleep.\n", BodyCount - Asleep.ActiveBodies, BodyCount );
+		return ETestResult::Failed;
+	}
+
+	if( !Platform )
+		return ETestResult::Failed;
+
+	return ETestResult::Succeeded;
+}
+
+const char* CPhysicsSleepPerformanceTest::GetName()
+{
+	return "Physics Sleep Performance Test";
+}
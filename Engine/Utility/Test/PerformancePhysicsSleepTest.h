@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Measures the physics tick rate of stacked bodies coming to rest, with and without sleeping.
+class CPhysicsSleepPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,103 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformancePhysicsTest.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Physics/Physics.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Test/HeadlessBody.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t TickCount = 120;
+constexpr double TimeStep = 1.0 / 60.0;
+
+static double Measure( const size_t BodyCount, const bool Refit )
+{
+	CConfiguration::Get().Store( "physics.RefitDynamicScene", Refit );
+
+	CPhysics Physics;
+	Physics.SetSynchronous( true );
+
+	// Spread the bodies out so that the density stays roughly the same for each body count.
+	const float Extent = std::cbrt( static_cast<float>( BodyCount ) ) * 4.0f;
+
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( -Extent, Extent );
+	std::uniform_real_distribution<float> Speed( -5.0f, 5.0f );
+
+	std::vector<std::unique_ptr<CHeadlessBody>> Bodies;
+	Bodies.reserve( BodyCount );
+	for( size_t Index = 0; Index < BodyCount; Index++ )
+	{
+		auto Body = std::make_unique<CHeadlessBody>();
+		Body->Transform.SetPosition( Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) ) );
+		Body->Direction = Vector3D( Speed( Generator ), Speed( Generator ), Speed( Generator ) );
+		Body->LocalBounds = BoundingBox( Vector3D( -0.5f, -0.5f, -0.5f ), Vector3D( 0.5f, 0.5f, 0.5f ) );
+
+		// We're measuring the scene maintenance, not the collision responses.
+		Body->Block = false;
+
+		Body->Construct( &Physics );
+		Bodies.emplace_back( std::move( Body ) );
+	}
+
+	double Time = 0.0;
+	Timer Total;
+	Total.Start();
+
+	for( size_t Tick = 0; Tick < TickCount; Tick++ )
+	{
+		for( auto& Body : Bodies )
+		{
+			auto Location = Body->Transform.GetPosition() + Body->Direction * static_cast<float>( TimeStep );
+
+			// Bounce off of the edges of the volume.
+			for( int Axis = 0; Axis < 3; Axis++ )
+			{
+				if( std::abs( Location[Axis] ) > Extent )
+				{
+					Body->Direction[Axis] = -Body->Direction[Axis];
+				}
+			}
+
+			Body->Transform.SetPosition( Location );
+			Body->CalculateBounds();
+		}
+
+		Physics.Tick( Time );
+		Time += TimeStep;
+	}
+
+	Physics.Guard();
+	Total.Stop();
+
+	Physics.Destroy();
+
+	return static_cast<double>( TickCount ) / Total.GetElapsedTimeSeconds();
+}
+
+ETestResult CPhysicsPerformanceTest::Run()
+{
+	const bool Refit = CConfiguration::Get().IsEnabled( "physics.RefitDynamicScene" );
+
+	for( const size_t BodyCount : { 1000, 10000, 50000 } )
+	{
+		const double Rebuild = Measure( BodyCount, false );
+		const double Refitted = Measure( BodyCount, true );
+		Log::Event( "%u bodies: rebuild %.1f ticks/s | refit %.1f ticks/s (%.2fx)\n",
+			BodyCount, Rebuild, Refitted, Refitted / Rebuild );
+	}
+
+	CConfiguration::Get().Store( "physics.RefitDynamicScene", Refit );
+
+	return ETestResult::Succeeded;
+}
+
+const char* CPhysicsPerformanceTest::GetName()
+{
+	return "Physics Performance Test";
+}
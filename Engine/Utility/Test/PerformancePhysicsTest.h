@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Measures the physics tick rate of large amounts of moving bodies, with and without dynamic scene refitting.
+class CPhysicsPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,215 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceRenderSortTest.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Engine/Display/Rendering/RenderKey.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Math/Vector.h>
+#include <Engine/Utility/Timer.h>
+
+// Amount of times each sort is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 5;
+
+constexpr uint32_t ProgramCount = 64;
+constexpr uint32_t MeshCount = 2048;
+
+// Stand-ins for the shader and mesh objects, the comparator has to chase pointers just like the renderer did.
+struct SyntheticShader
+{
+	uint32_t Program = 0;
+	uint32_t BlendMode = 0;
+};
+
+struct SyntheticMesh
+{
+	uint32_t IndexBuffer = 0;
+	uint32_t VertexBuffer = 0;
+};
+
+struct SyntheticRenderable
+{
+	SyntheticShader* Shader = nullptr;
+	SyntheticMesh* Mesh = nullptr;
+	Vector3D Position;
+};
+
+struct SyntheticScene
+{
+	std::vector<std::unique_ptr<SyntheticShader>> Shaders;
+	std::vector<std::unique_ptr<SyntheticMesh>> Meshes;
+	std::vector<std::unique_ptr<SyntheticRenderable>> Renderables;
+	std::vector<SyntheticRenderable*> Queue;
+};
+
+static void CreateScene( SyntheticScene& Scene, const size_t Count )
+{
+	std::mt19937 Generator( 1337 );
+	std::uniform_int_distribution<uint32_t> Program( 0, ProgramCount - 1 );
+	std::uniform_int_distribution<uint32_t> Mesh( 0, MeshCount - 1 );
+	std::uniform_real_distribution<float> Position( -500.0f, 500.0f );
+
+	for( uint32_t Index = 0; Index < ProgramCount; Index++ )
+	{
+		auto Shader = std::make_unique<SyntheticShader>();
+		Shader->Program = Index + 1;
+		Scene.Shaders.emplace_back( std::move( Shader ) );
+	}
+
+	for( uint32_t Index = 0; Index < MeshCount; Index++ )
+	{
+		auto Buffers = std::make_unique<SyntheticMesh>();
+		Buffers->IndexBuffer = Index * 2 + 1;
+		Buffers->VertexBuffer = Index * 2 + 2;
+		Scene.Meshes.emplace_back( std::move( Buffers ) );
+	}
+
+	Scene.Renderables.reserve( Count );
+	for( size_t Index = 0; Index < Count; Index++ )
+	{
+		auto Renderable = std::make_unique<SyntheticRenderable>();
+		Renderable->Shader = Scene.Shaders[Program( Generator )].get();
+		Renderable->Mesh = Scene.Meshes[Mesh( Generator )].get();
+		Renderable->Position = Vector3D( Position( Generator ), Position( Generator ), Position( Generator ) );
+		Scene.Renderables.emplace_back( std::move( Renderable ) );
+	}
+
+	// Queues are usually not in allocation order.
+	for( auto& Renderable : Scene.Renderables )
+	{
+		Scene.Queue.emplace_back( Renderable.get() );
+	}
+
+	std::shuffle( Scene.Queue.begin(), Scene.Queue.end(), Generator );
+}
+
+static uint64_t CreateKey( const SyntheticRenderable* Renderable, const Vector3D& Camera )
+{
+	return RenderKey::Create( false, Renderable->Shader->BlendMode, Renderable->Shader->Program,
+		Renderable->Mesh->IndexBuffer, Renderable->Mesh->VertexBuffer, Camera.DistanceSquared( Renderable->Position ) );
+}
+
+// The comparator that was used by CRenderer::SortQueue, with front-to-back sorting added.
+static double MeasureComparator( const std::vector<SyntheticRenderable*>& Input, const Vector3D& Camera )
+{
+	double Best = 0.0;
+	std::vector<SyntheticRenderable*> Queue;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Queue = Input;
+
+		Timer Sort;
+		Sort.Start();
+		std::sort( Queue.begin(), Queue.end(), [&Camera] ( const SyntheticRenderable* A, const SyntheticRenderable* B )
+			{
+				if( A->Shader->Program != B->Shader->Program )
+					return A->Shader->Program < B->Shader->Program;
+
+				if( A->Mesh->IndexBuffer != B->Mesh->IndexBuffer )
+					return A->Mesh->IndexBuffer < B->Mesh->IndexBuffer;
+
+				if( A->Mesh->VertexBuffer != B->Mesh->VertexBuffer )
+					return A->Mesh->VertexBuffer < B->Mesh->VertexBuffer;
+
+				return Camera.DistanceSquared( A->Position ) < Camera.DistanceSquared( B->Position );
+			}
+		);
+		Sort.Stop();
+
+		const double Seconds = Sort.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+// Includes building the keys and re-ordering the queue, just like the renderer.
+static double MeasureRadix( const std::vector<SyntheticRenderable*>& Input, const Vector3D& Camera, std::vector<uint64_t>& Keys )
+{
+	double Best = 0.0;
+	std::vector<uint64_t> ScratchKeys;
+	std::vector<uint32_t> Indices;
+	std::vector<uint32_t> ScratchIndices;
+	std::vector<SyntheticRenderable*> Sorted;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Sort;
+		Sort.Start();
+
+		Keys.clear();
+		Keys.reserve( Input.size() );
+		for( const auto* Renderable : Input )
+		{
+			Keys.emplace_back( CreateKey( Renderable, Camera ) );
+		}
+
+		RenderKey::Sort( Keys, Indices, ScratchKeys, ScratchIndices );
+
+		Sorted.resize( Input.size() );
+		for( size_t Index = 0; Index < Indices.size(); Index++ )
+		{
+			Sorted[Index] = Input[Indices[Index]];
+		}
+
+		Sort.Stop();
+
+		const double Seconds = Sort.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	// The sorted queue has to produce the same keys in the same order.
+	for( size_t Index = 0; Index < Sorted.size(); Index++ )
+	{
+		if( CreateKey( Sorted[Index], Camera ) != Keys[Index] )
+		{
+			Keys.clear();
+			break;
+		}
+	}
+
+	return Best;
+}
+
+ETestResult CRenderSortPerformanceTest::Run()
+{
+	const Vector3D Camera( 10.0f, 20.0f, 5.0f );
+
+	bool Valid = true;
+	for( const size_t Count : { 10000, 50000, 200000 } )
+	{
+		SyntheticScene Scene;
+		CreateScene( Scene, Count );
+
+		std::vector<uint64_t> Keys;
+		const double Comparator = MeasureComparator( Scene.Queue, Camera );
+		const double Radix = MeasureRadix( Scene.Queue, Camera, Keys );
+
+		// Compare the radix sort against a comparison sort of the same keys.
+		std::vector<uint64_t> Expected;
+		Expected.reserve( Count );
+		for( const auto* Renderable : Scene.Queue )
+		{
+			Expected.emplace_back( CreateKey( Renderable, Camera ) );
+		}
+
+		std::sort( Expected.begin(), Expected.end() );
+		if( Keys != Expected )
+		{
+			Log::Event( Log::Error, "Radix sorted keys don't match for %u renderables.\n", Count );
+			Valid = false;
+		}
+
+		Log::Event( "%u renderables: comparator %.3fms | radix keys %.3fms (%.2fx)\n",
+			Count, Comparator * 1000.0, Radix * 1000.0, Comparator / Radix );
+	}
+
+	return Valid ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CRenderSortPerformanceTest::GetName()
+{
+	return "Render Sort Performance Test";
+}
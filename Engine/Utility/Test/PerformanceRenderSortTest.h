@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares sorting the render queue with a comparator against sorting packed render keys.
+class CRenderSortPerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,156 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceShaderCacheTest.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <vector>
+
+#include <Engine/Display/Rendering/ShaderCache.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Timer.h>
+
+// Amount of times each path is repeated, the fastest time is reported.
+constexpr size_t Repetitions = 10;
+
+static std::vector<std::string> GatherStages()
+{
+	std::vector<std::string> Stages;
+	if( !std::experimental::filesystem::exists( "Shaders" ) )
+		return Stages;
+
+	for( const auto& Entry : std::experimental::filesystem::directory_iterator( "Shaders" ) )
+	{
+		const auto Extension = Entry.path().extension().string();
+		if( Extension == ".vs" || Extension == ".fs" || Extension == ".gs" || Extension == ".cs" )
+		{
+			Stages.emplace_back( "Shaders/" + Entry.path().filename().string() );
+		}
+	}
+
+	std::sort( Stages.begin(), Stages.end() );
+	return Stages;
+}
+
+// Reads and preprocesses every stage, this is what loading a shader did before the cache existed.
+static double MeasureUncached( const std::vector<std::string>& Stages, const FShaderDefines& Defines, std::vector<FPreprocessedShader>& Result )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		Timer Load;
+		Load.Start();
+		for( size_t Index = 0; Index < Stages.size(); Index++ )
+		{
+			CFile File( Stages[Index] );
+			File.Load();
+
+			std::stringstream Stream;
+			if( const char* Data = File.Fetch<char>() )
+			{
+				Stream << Data;
+			}
+
+			Result[Index] = FPreprocessedShader();
+			ShaderCache::Preprocess( Stream, Defines, Result[Index] );
+		}
+		Load.Stop();
+
+		const double Seconds = Load.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+// Disk hits forget the entries in memory before every pass, like a fresh start of the application.
+static double MeasureCached( const std::vector<std::string>& Stages, const FShaderDefines& Defines, std::vector<FPreprocessedShader>& Result, const bool Disk )
+{
+	double Best = 0.0;
+	for( size_t Repetition = 0; Repetition < Repetitions; Repetition++ )
+	{
+		if( Disk )
+		{
+			ShaderCache::ClearMemory();
+		}
+
+		Timer Load;
+		Load.Start();
+		for( size_t Index = 0; Index < Stages.size(); Index++ )
+		{
+			ShaderCache::Load( Stages[Index], Defines, Result[Index] );
+		}
+		Load.Stop();
+
+		const double Seconds = Load.GetElapsedTimeSeconds();
+		Best = Repetition == 0 ? Seconds : std::min( Best, Seconds );
+	}
+
+	return Best;
+}
+
+static size_t CountMismatches( const std::vector<FPreprocessedShader>& Expected, const std::vector<FPreprocessedShader>& Result )
+{
+	size_t Mismatches = 0;
+	for( size_t Index = 0; Index < Expected.size(); Index++ )
+	{
+		if( Expected[Index].Code != Result[Index].Code || Expected[Index].Hash != Result[Index].Hash ||
+			Expected[Index].Directives.DepthTest != Result[Index].Directives.DepthTest ||
+			Expected[Index].Directives.DepthMask != Result[Index].Directives.DepthMask ||
+			Expected[Index].Directives.BlendMode != Result[Index].Directives.BlendMode ||
+			Expected[Index].Directives.Instanced != Result[Index].Directives.Instanced )
+		{
+			Mismatches++;
+		}
+	}
+
+	return Mismatches;
+}
+
+ETestResult CShaderCachePerformanceTest::Run()
+{
+	const auto Stages = GatherStages();
+	if( Stages.empty() )
+	{
+		Log::Event( Log::Warning, "No shaders found, the test has to run from the output directory.\n" );
+		return ETestResult::Unknown;
+	}
+
+	const std::string Previous = ShaderCache::GetDirectory();
+	ShaderCache::SetDirectory( "Cache/Test/ShaderCachePerformance/" );
+
+	const FShaderDefines Defines;
+	std::vector<FPreprocessedShader> Expected( Stages.size() );
+	const double Uncached = MeasureUncached( Stages, Defines, Expected );
+
+	// Populates the cache.
+	std::vector<FPreprocessedShader> Result( Stages.size() );
+	MeasureCached( Stages, Defines, Result, true );
+	size_t Mismatches = CountMismatches( Expected, Result );
+
+	const auto Misses = ShaderCache::Statistics().Misses;
+	const double Disk = MeasureCached( Stages, Defines, Result, true );
+	Mismatches += CountMismatches( Expected, Result );
+
+	const double Memory = MeasureCached( Stages, Defines, Result, false );
+	Mismatches += CountMismatches( Expected, Result );
+	const auto Recompiled = ShaderCache::Statistics().Misses - Misses;
+
+	ShaderCache::SetDirectory( Previous );
+
+	Log::Event( "%zu stages: preprocessor %.3fms | disk hits %.3fms (%.2fx) | memory hits %.3fms (%.2fx) | %lli misses after warming up\n",
+		Stages.size(), Uncached * 1000.0, Disk * 1000.0, Uncached / Disk, Memory * 1000.0, Uncached / Memory, Recompiled );
+
+	if( Mismatches > 0 )
+	{
+		Log::Event( Log::Error, "The shader cache returned different results for %zu stages.\n", Mismatches );
+		return ETestResult::Failed;
+	}
+
+	return Recompiled == 0 ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CShaderCachePerformanceTest::GetName()
+{
+	return "Shader Cache Performance Test";
+}
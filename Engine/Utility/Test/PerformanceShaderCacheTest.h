@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares preprocessing the shipped shaders with loading them from the shader cache.
+class CShaderCachePerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -2,7 +2,7 @@
 
 #include "../Test.h"
 
-class CStringPerformanceTest : CTest
+class CStringPerformanceTest : public CTest
 {
 public:
 	CStringPerformanceTest();
@@ -0,0 +1,169 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceTextureDecodeTest.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/Display/Rendering/TextureStreaming.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Hash.h>
+#include <Engine/Utility/Timer.h>
+
+// Bytes that can be uploaded per frame while streaming.
+constexpr size_t Budget = 4 * 1024 * 1024;
+
+struct RecordedUploads
+{
+	std::unordered_map<std::string, uint64_t> Hashes;
+	size_t Bytes = 0;
+	size_t Largest = 0;
+	size_t Uploads = 0;
+};
+
+static RecordedUploads Recorded;
+
+static uint64_t Hash( const FDecodedImage& Image )
+{
+	uint64_t Result = FNV::Seed64;
+	for( size_t Level = 0; Level < Image.Levels.size(); Level++ )
+	{
+		Result = FNV::Bytes64( Image.GetLevel( Level ), Image.Levels[Level].Size, Result );
+	}
+
+	return Result;
+}
+
+// Stand-in for the GL upload.
+static bool Upload( CTexture& Texture, FDecodedImage& Image )
+{
+	const size_t Size = Image.Size();
+	Recorded.Hashes[Texture.GetLocation()] = Hash( Image );
+	Recorded.Bytes += Size;
+	Recorded.Largest = std::max( Recorded.Largest, Size );
+	Recorded.Uploads++;
+
+	Image.Release();
+	return true;
+}
+
+static std::vector<std::string> GatherTextures()
+{
+	std::vector<std::string> Textures;
+	if( !std::experimental::filesystem::exists( "Textures" ) )
+		return Textures;
+
+	for( const auto& Entry : std::experimental::filesystem::recursive_directory_iterator( "Textures" ) )
+	{
+		auto Extension = Entry.path().extension().string();
+		std::transform( Extension.begin(), Extension.end(), Extension.begin(), ::tolower );
+		if( Extension == ".png" || Extension == ".tga" )
+		{
+			Textures.emplace_back( Entry.path().generic_string() );
+		}
+	}
+
+	std::sort( Textures.begin(), Textures.end() );
+	return Textures;
+}
+
+ETestResult CTextureDecodePerformanceTest::Run()
+{
+	const auto Textures = GatherTextures();
+	if( Textures.empty() )
+	{
+		Log::Event( Log::Warning, "No textures found, the test has to run from the output directory.\n" );
+		return ETestResult::Unknown;
+	}
+
+	// Decode everything on this thread, this is what loading a level used to do. (minus the upload)
+	std::unordered_map<std::string, uint64_t> Expected;
+	size_t SerialBytes = 0;
+
+	Timer Serial;
+	Serial.Start();
+	for( const auto& Location : Textures )
+	{
+		FDecodedImage Image;
+		if( TextureStreaming::Decode( Location, EImageFormat::RGBA8, true, Image ) )
+		{
+			Expected[Location] = Hash( Image );
+			SerialBytes += Image.Size();
+		}
+	}
+	Serial.Stop();
+	const double SerialSeconds = Serial.GetElapsedTimeSeconds();
+
+	Recorded = RecordedUploads();
+	TextureStreaming::Override( Upload );
+	TextureStreaming::ResetStatistics();
+
+	std::vector<std::unique_ptr<CTexture>> Streamed;
+	Streamed.reserve( Textures.size() );
+
+	size_t Frames = 0;
+	size_t OverBudget = 0;
+
+	Timer Streaming;
+	Streaming.Start();
+	for( const auto& Location : Textures )
+	{
+		Streamed.emplace_back( new CTexture( Location.c_str() ) );
+		TextureStreaming::Request( Streamed.back().get(), nullptr, nullptr, EFilteringMode::Trilinear, EImageFormat::RGBA8, true );
+	}
+
+	// Pretend to render frames until everything has been uploaded.
+	while( TextureStreaming::Pending() > 0 )
+	{
+		const size_t Bytes = TextureStreaming::Update( Budget );
+		if( Bytes > Budget && Bytes > Recorded.Largest )
+		{
+			OverBudget++;
+		}
+
+		Frames++;
+		std::this_thread::yield();
+	}
+	Streaming.Stop();
+	const double StreamingSeconds = Streaming.GetElapsedTimeSeconds();
+
+	const auto Failed = TextureStreaming::Statistics().Failed;
+	TextureStreaming::Override( nullptr );
+	TextureStreaming::ResetStatistics();
+
+	size_t Mismatches = 0;
+	for( const auto& Entry : Expected )
+	{
+		const auto Iterator = Recorded.Hashes.find( Entry.first );
+		if( Iterator == Recorded.Hashes.end() || Iterator->second != Entry.second )
+		{
+			Mismatches++;
+		}
+	}
+
+	const double Megabytes = static_cast<double>( SerialBytes ) / ( 1024.0 * 1024.0 );
+	Log::Event( "%u textures, %.1fMB with mips: main thread %.1fms (%.1fMB/s) | streamed %.1fms (%.1fMB/s, %.2fx) over %u polled frames\n",
+		Textures.size(), Megabytes, SerialSeconds * 1000.0, Megabytes / SerialSeconds, StreamingSeconds * 1000.0, Megabytes / StreamingSeconds, SerialSeconds / StreamingSeconds, Frames );
+
+	if( Mismatches > 0 || Failed != static_cast<int64_t>( Textures.size() - Expected.size() ) )
+	{
+		Log::Event( Log::Error, "Streamed textures don't match the textures that were decoded directly. (%u mismatches)\n", Mismatches );
+		return ETestResult::Failed;
+	}
+
+	if( OverBudget > 0 )
+	{
+		Log::Event( Log::Error, "Exceeded the upload budget %u times.\n", OverBudget );
+		return ETestResult::Failed;
+	}
+
+	return ETestResult::Succeeded;
+}
+
+const char* CTextureDecodePerformanceTest::GetName()
+{
+	return "Texture Decode Performance Test";
+}
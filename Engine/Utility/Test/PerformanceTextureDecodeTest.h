@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Compares decoding the textures in the Textures directory on the main thread with streaming them in the background.
+class CTextureDecodePerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
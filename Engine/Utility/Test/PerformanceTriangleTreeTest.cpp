@@ -0,0 +1,165 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PerformanceTriangleTreeTest.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <Engine/Physics/Response.h>
+#include <Engine/Physics/TriangleTree.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Timer.h>
+
+// 224 x 224 quads, just over 100k triangles.
+constexpr size_t GridSize = 224;
+constexpr float GridSpacing = 1.0f;
+
+constexpr size_t QueryCount = 100000;
+
+// The scalar loop tests every triangle, only a few queries are needed to get a decent measurement.
+constexpr size_t ScalarQueryCount = 100;
+
+static float Height( const float X, const float Y )
+{
+	return std::sin( X * 0.1f ) * std::cos( Y * 0.13f ) * 4.0f + std::sin( X * 0.7f + Y * 0.3f ) * 0.5f;
+}
+
+static void CreateLevel( std::vector<VertexFormat>& Vertices, std::vector<glm::uint>& Indices )
+{
+	const size_t Stride = GridSize + 1;
+	Vertices.resize( Stride * Stride );
+	for( size_t Y = 0; Y < Stride; Y++ )
+	{
+		for( size_t X = 0; X < Stride; X++ )
+		{
+			const float PositionX = static_cast<float>( X ) * GridSpacing;
+			const float PositionY = static_cast<float>( Y ) * GridSpacing;
+			Vertices[Y * Stride + X].Position = Vector3D( PositionX, PositionY, Height( PositionX, PositionY ) );
+		}
+	}
+
+	Indices.reserve( GridSize * GridSize * 6 );
+	for( size_t Y = 0; Y < GridSize; Y++ )
+	{
+		for( size_t X = 0; X < GridSize; X++ )
+		{
+			const auto Corner = static_cast<glm::uint>( Y * Stride + X );
+			const auto Above = static_cast<glm::uint>( Corner + Stride );
+			Indices.insert( Indices.end(), { Corner, Corner + 1, Above, Corner + 1, Above + 1, Above } );
+		}
+	}
+}
+
+ETestResult CTriangleTreePerformanceTest::Run()
+{
+	std::vector<VertexFormat> Vertices;
+	std::vector<glm::uint> Indices;
+	CreateLevel( Vertices, Indices );
+
+	Timer BuildTimer;
+	BuildTimer.Start();
+	const auto Tree = TriangleTree::Build( Vertices.data(), Vertices.size(), Indices.data(), Indices.size() );
+	BuildTimer.Stop();
+
+	Log::Event( "Triangle tree: %u triangles | %u nodes | %u leaves | built in %ims\n",
+		Tree->GetTriangleCount(), Tree->Nodes.size(), Tree->Leaves.size(), BuildTimer.GetElapsedTimeMilliseconds() );
+
+	// Bodies hovering around the surface of the level.
+	const float LevelSize = static_cast<float>( GridSize ) * GridSpacing;
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( 0.0f, LevelSize );
+	std::uniform_real_distribution<float> Offset( -1.0f, 1.0f );
+	std::uniform_real_distribution<float> Size( 0.25f, 2.0f );
+
+	std::vector<BoundingBox> Boxes( QueryCount );
+	std::vector<BoundingSphere> Spheres;
+	Spheres.reserve( QueryCount );
+	for( size_t Index = 0; Index < QueryCount; Index++ )
+	{
+		const float X = Position( Generator );
+		const float Y = Position( Generator );
+		const auto Center = Vector3D( X, Y, Height( X, Y ) + Offset( Generator ) );
+		const auto HalfSize = Vector3D( Size( Generator ), Size( Generator ), Size( Generator ) ) * 0.5f;
+		Boxes[Index] = BoundingBox( Center - HalfSize, Center + HalfSize );
+		Spheres.emplace_back( Center, Size( Generator ) * 0.5f );
+	}
+
+	size_t BoxContacts = 0;
+	Timer BoxTimer;
+	BoxTimer.Start();
+	for( const auto& Box : Boxes )
+	{
+		CollisionResponse Response;
+		BoxContacts += Tree->CollideAABB( Box, Response );
+	}
+	BoxTimer.Stop();
+
+	size_t SphereContacts = 0;
+	Timer SphereTimer;
+	SphereTimer.Start();
+	for( const auto& Sphere : Spheres )
+	{
+		CollisionResponse Response;
+		SphereContacts += Tree->CollideSphere( Sphere, Response );
+	}
+	SphereTimer.Stop();
+
+	// Previously the tree was a single leaf, every triangle was tested one by one.
+	size_t ScalarHits = 0;
+	Timer ScalarTimer;
+	ScalarTimer.Start();
+	for( size_t Index = 0; Index < ScalarQueryCount; Index++ )
+	{
+		const auto Center = Boxes[Index].Center();
+		const auto Extent = Boxes[Index].Size() * 0.5f;
+		for( size_t Triangle = 0; Triangle < Indices.size(); Triangle += 3 )
+		{
+			const auto Response = Response::TriangleAABB( Vertices[Indices[Triangle]], Vertices[Indices[Triangle + 1]], Vertices[Indices[Triangle + 2]], Center, Extent );
+			if( Response.Distance > 0.0f )
+			{
+				ScalarHits++;
+			}
+		}
+	}
+	ScalarTimer.Stop();
+
+	const double BoxSeconds = BoxTimer.GetElapsedTimeSeconds();
+	const double SphereSeconds = SphereTimer.GetElapsedTimeSeconds();
+	const double ScalarSeconds = ScalarTimer.GetElapsedTimeSeconds();
+
+	Log::Event( "AABB: %u queries | %u contacts | %.0f queries/s | %.0f contacts/s\n",
+		QueryCount, BoxContacts, QueryCount / BoxSeconds, BoxContacts / BoxSeconds );
+	Log::Event( "Sphere: %u queries | %u contacts | %.0f queries/s | %.0f contacts/s\n",
+		QueryCount, SphereContacts, QueryCount / SphereSeconds, SphereContacts / SphereSeconds );
+	Log::Event( "Scalar AABB (all triangles): %.0f queries/s (%u responses)\n", ScalarQueryCount / ScalarSeconds, ScalarHits );
+
+	// Meshes without indices should collide the same as their indexed counterparts.
+	std::vector<VertexFormat> Expanded;
+	Expanded.reserve( Indices.size() );
+	for( const auto Index : Indices )
+	{
+		Expanded.emplace_back( Vertices[Index] );
+	}
+
+	const auto Unindexed = TriangleTree::Build( Expanded.data(), Expanded.size(), nullptr, 0 );
+	bool Matches = Unindexed->GetTriangleCount() == Tree->GetTriangleCount();
+	for( size_t Index = 0; Index < ScalarQueryCount && Matches; Index++ )
+	{
+		CollisionResponse Expected;
+		CollisionResponse Result;
+		Matches = Tree->CollideAABB( Boxes[Index], Expected ) == Unindexed->CollideAABB( Boxes[Index], Result );
+	}
+
+	if( !Matches )
+	{
+		Log::Event( Log::Error, "The tree of the unindexed mesh doesn't match the indexed one.\n" );
+		return ETestResult::Failed;
+	}
+
+	return BoxContacts > 0 && SphereContacts > 0 ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CTriangleTreePerformanceTest::GetName()
+{
+	return "Triangle Tree Performance Test";
+}
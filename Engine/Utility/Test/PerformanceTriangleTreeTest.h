@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Measures the triangle mesh narrow phase against a large static level mesh.
+class CTriangleTreePerformanceTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,392 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PhysicsReplayTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Physics/Physics.h>
+#include <Engine/Physics/TriangleTree.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/Hash.h>
+#include <Engine/Utility/JobSystem.h>
+#include <Engine/Utility/Test/HeadlessBody.h>
+#include <Engine/Utility/ThreadPool.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t BodyCount = 2000;
+constexpr size_t TickCount = 300;
+constexpr double TimeStep = 1.0 / 60.0;
+
+// Size of the terrain the bodies are dropped on, in quads along each side.
+constexpr size_t TerrainSize = 64;
+constexpr float TerrainSpacing = 2.0f;
+
+constexpr const char* TimingsFile = "PhysicsReplay.csv";
+constexpr const char* SummaryFile = "PhysicsReplay.json";
+
+// Hashes of the reference run from an earlier session, delete it to record a new trace after intentional physics changes.
+constexpr const char* TraceFile = "Cache/Test/PhysicsReplay.trace";
+
+struct ReplaySettings
+{
+	const char* Name;
+	bool Synchronous;
+	bool SynchronousBodyUpdate;
+	bool Jobs;
+
+	// Amount of job system workers, zero spawns one per hardware thread.
+	size_t Workers;
+};
+
+struct ReplayRun
+{
+	ReplaySettings Settings;
+	std::vector<uint64_t> Hashes;
+	std::vector<PhysicsTimings> Timings;
+	double Milliseconds = 0.0;
+};
+
+static float Height( const float X, const float Y )
+{
+	return std::sin( X * 0.1f ) * std::cos( Y * 0.13f ) * 3.0f;
+}
+
+static std::shared_ptr<TriangleTree> CreateTerrain( BoundingBox& Bounds )
+{
+	const size_t Stride = TerrainSize + 1;
+	std::vector<VertexFormat> Vertices( Stride * Stride );
+	for( size_t Y = 0; Y < Stride; Y++ )
+	{
+		for( size_t X = 0; X < Stride; X++ )
+		{
+			const float PositionX = static_cast<float>( X ) * TerrainSpacing;
+			const float PositionY = static_cast<float>( Y ) * TerrainSpacing;
+			Vertices[Y * Stride + X].Position = Vector3D( PositionX, PositionY, Height( PositionX, PositionY ) );
+		}
+	}
+
+	std::vector<glm::uint> Indices;
+	Indices.reserve( TerrainSize * TerrainSize * 6 );
+	for( size_t Y = 0; Y < TerrainSize; Y++ )
+	{
+		for( size_t X = 0; X < TerrainSize; X++ )
+		{
+			const auto Corner = static_cast<glm::uint>( Y * Stride + X );
+			const auto Above = static_cast<glm::uint>( Corner + Stride );
+			Indices.insert( Indices.end(), { Corner, Corner + 1, Above, Corner + 1, Above + 1, Above } );
+		}
+	}
+
+	const float Extent = static_cast<float>( TerrainSize ) * TerrainSpacing;
+	Bounds = BoundingBox( Vector3D( 0.0f, 0.0f, -3.0f ), Vector3D( Extent, Extent, 3.0f ) );
+
+	return TriangleTree::Build( Vertices.data(), Vertices.size(), Indices.data(), Indices.size() );
+}
+
+static uint64_t HashBodies( const std::vector<std::unique_ptr<CHeadlessBody>>& Bodies )
+{
+	uint64_t Hash = FNV::Seed64;
+	for( const auto& Body : Bodies )
+	{
+		const auto& Transform = Body->GetTransform();
+		Hash = FNV::Bytes64( &Transform.GetPosition(), sizeof( Vector3D ), Hash );
+		Hash = FNV::Bytes64( &Transform.GetOrientation(), sizeof( Vector3D ), Hash );
+		Hash = FNV::Bytes64( &Body->Velocity, sizeof( Vector3D ), Hash );
+	}
+
+	return Hash;
+}
+
+static size_t WorkerCount( const ReplaySettings& Settings )
+{
+	if( !Settings.Jobs )
+		return 0;
+
+	return Settings.Workers > 0 ? Settings.Workers : std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+// Compares the reference run against the trace stored by a previous session, records the trace if there is none yet.
+static bool CompareTrace( const ReplayRun& Reference )
+{
+	char Line[64];
+	snprintf( Line, sizeof( Line ), "%zu %zu\n", BodyCount, TickCount );
+	const std::string Header = Line;
+
+	CFile Trace( TraceFile );
+	if( Trace.Exists() && Trace.Load() )
+	{
+		const std::string Data( Trace.Fetch<char>(), Trace.Size() );
+		if( Data.compare( 0, Header.size(), Header ) == 0 )
+		{
+			const char* Cursor = Data.c_str() + Header.size();
+			for( size_t Tick = 0; Tick < TickCount; Tick++ )
+			{
+				char* End = nullptr;
+				const auto Hash = static_cast<uint64_t>( strtoull( Cursor, &End, 16 ) );
+				if( End == Cursor || Hash != Reference.Hashes[Tick] )
+				{
+					Log::Event( Log::Error, "%s diverged from the stored trace \"%s\" at tick %zu.\n", Reference.Settings.Name, TraceFile, Tick );
+					return false;
+				}
+
+				Cursor = End;
+			}
+
+			Log::Event( "%s matches the stored trace \"%s\".\n", Reference.Settings.Name, TraceFile );
+			return true;
+		}
+
+		Log::Event( Log::Warning, "Stored trace \"%s\" was recorded with a different scene, recording a new one.\n", TraceFile );
+	}
+
+	std::string Data = Header;
+	for( const auto& Hash : Reference.Hashes )
+	{
+		snprintf( Line, sizeof( Line ), "%016llx\n", static_cast<unsigned long long>( Hash ) );
+		Data += Line;
+	}
+
+	Trace.Load( Data );
+	Trace.Save( true );
+	Log::Event( "Recorded trace \"%s\".\n", TraceFile );
+
+	return true;
+}
+
+static ReplayRun Replay( const ReplaySettings& Settings, const std::shared_ptr<TriangleTree>& Terrain, const BoundingBox& TerrainBounds )
+{
+	CConfiguration::Get().Store( "physics.SynchronousBodyUpdate", Settings.SynchronousBodyUpdate );
+
+	ReplayRun Run;
+	Run.Settings = Settings;
+	Run.Hashes.reserve( TickCount );
+	Run.Timings.reserve( TickCount );
+
+	CPhysics Physics;
+	Physics.SetSynchronous( Settings.Synchronous );
+
+	auto Ground = std::make_unique<CHeadlessBody>();
+	Ground->Type = BodyType::TriangleMesh;
+	Ground->Tree = Terrain;
+	Ground->LocalBounds = TerrainBounds;
+	Ground->Static = true;
+	Ground->Stationary = false;
+	Ground->Construct( &Physics );
+
+	const float Extent = static_cast<float>( TerrainSize ) * TerrainSpacing;
+	std::mt19937 Generator( 1337 );
+	std::uniform_real_distribution<float> Position( 4.0f, Extent - 4.0f );
+	std::uniform_real_distribution<float> Altitude( 4.0f, 24.0f );
+	std::uniform_real_distribution<float> Speed( -3.0f, 3.0f );
+
+	std::vector<std::unique_ptr<CHeadlessBody>> Bodies;
+	Bodies.reserve( BodyCount );
+	for( size_t Index = 0; Index < BodyCount; Index++ )
+	{
+		auto Body = std::make_unique<CHeadlessBody>();
+		Body->Transform.SetPosition( Vector3D( Position( Generator ), Position( Generator ), Altitude( Generator ) ) );
+		Body->Velocity = Vector3D( Speed( Generator ), Speed( Generator ), 0.0f );
+		Body->LocalBounds = BoundingBox( Vector3D( -0.5f, -0.5f, -0.5f ), Vector3D( 0.5f, 0.5f, 0.5f ) );
+		Body->Type = Index % 2 == 0 ? BodyType::AABB : BodyType::Sphere;
+		Body->Stationary = false;
+
+		Body->Construct( &Physics );
+		Bodies.emplace_back( std::move( Body ) );
+	}
+
+	double Time = 0.0;
+	Timer Total;
+	Total.Start();
+
+	for( size_t Tick = 0; Tick < TickCount; Tick++ )
+	{
+		Physics.Tick( Time );
+		Time += TimeStep;
+
+		// Waits for the workers, the hash has to be taken after the tick has completed.
+		Run.Timings.emplace_back( Physics.GetTimings() );
+		Run.Hashes.emplace_back( HashBodies( Bodies ) );
+	}
+
+	Total.Stop();
+	Run.Milliseconds = Total.GetElapsedTimeSeconds() * 1000.0;
+
+	Physics.Destroy();
+
+	return Run;
+}
+
+static PhysicsTimings Sum( const ReplayRun& Run )
+{
+	PhysicsTimings Total;
+	for( const auto& Timings : Run.Timings )
+	{
+		Total.PreCollision += Timings.PreCollision;
+		Total.UpdateBodies += Timings.UpdateBodies;
+		Total.StaticQueries += Timings.StaticQueries;
+		Total.DynamicQueries += Timings.DynamicQueries;
+	}
+
+	return Total;
+}
+
+static void Export( const std::vector<ReplayRun>& Runs, const std::vector<size_t>& Divergence )
+{
+	char Line[256];
+
+	std::string CSV = "run,tick,hash,precollision_us,updatebodies_us,staticqueries_us,dynamicqueries_us\n";
+	for( const auto& Run : Runs )
+	{
+		for( size_t Tick = 0; Tick < Run.Timings.size(); Tick++ )
+		{
+			const auto& Timings = Run.Timings[Tick];
+			snprintf( Line, sizeof( Line ), "%s,%zu,%016llx,%lld,%lld,%lld,%lld\n",
+				Run.Settings.Name, Tick, static_cast<unsigned long long>( Run.Hashes[Tick] ),
+				static_cast<long long>( Timings.PreCollision ), static_cast<long long>( Timings.UpdateBodies ),
+				static_cast<long long>( Timings.StaticQueries ), static_cast<long long>( Timings.DynamicQueries ) );
+			CSV += Line;
+		}
+	}
+
+	std::string JSON = "{\n\t\"bodies\": " + std::to_string( BodyCount ) + ",\n\t\"ticks\": " + std::to_string( TickCount ) + ",\n\t\"runs\": [\n";
+	for( size_t Index = 0; Index < Runs.size(); Index++ )
+	{
+		const auto& Run = Runs[Index];
+		const auto Total = Sum( Run );
+		snprintf( Line, sizeof( Line ), "\t\t{ \"name\": \"%s\", \"milliseconds\": %.3f, \"final_hash\": \"%016llx\", ",
+			Run.Settings.Name, Run.Milliseconds, static_cast<unsigned long long>( Run.Hashes.back() ) );
+		JSON += Line;
+
+		snprintf( Line, sizeof( Line ), "\"precollision_us\": %lld, \"updatebodies_us\": %lld, \"staticqueries_us\": %lld, \"dynamicqueries_us\": %lld, ",
+			static_cast<long long>( Total.PreCollision ), static_cast<long long>( Total.UpdateBodies ),
+			static_cast<long long>( Total.StaticQueries ), static_cast<long long>( Total.DynamicQueries ) );
+		JSON += Line;
+
+		// -1 when the run matches the reference run.
+		const auto Diverged = Divergence[Index] < TickCount ? static_cast<long long>( Divergence[Index] ) : -1ll;
+		JSON += "\"diverged_at\": " + std::to_string( Diverged ) + " }";
+		JSON += Index + 1 < Runs.size() ? ",\n" : "\n";
+	}
+
+	JSON += "\t]\n}\n";
+
+	CFile TimingsOutput( TimingsFile );
+	TimingsOutput.Load( CSV );
+	TimingsOutput.Save();
+
+	CFile SummaryOutput( SummaryFile );
+	SummaryOutput.Load( JSON );
+	SummaryOutput.Save();
+}
+
+ETestResult CPhysicsReplayTest::Run()
+{
+	auto& Configuration = CConfiguration::Get();
+	const bool SynchronousBodyUpdate = Configuration.IsEnabled( "physics.SynchronousBodyUpdate" );
+	const float SubStepBudget = Configuration.GetFloat( "physics.SubStepBudget" );
+
+	// The substep budget depends on how long the previous ticks took, which would make the replay depend on timing.
+	Configuration.Store( "physics.SubStepBudget", 1000000.0f );
+
+	ThreadPool::Initialize();
+
+	BoundingBox TerrainBounds;
+	const auto Terrain = CreateTerrain( TerrainBounds );
+
+	const ReplaySettings Settings[] = {
+		{ "synchronous", true, false, false, 0 },
+		{ "asynchronous", false, false, false, 0 },
+		{ "asynchronous-synchronous-body-update", false, true, false, 0 },
+		{ "asynchronous-jobs-single-worker", false, false, true, 1 },
+		{ "asynchronous-jobs", false, false, true, 0 },
+		{ "asynchronous-synchronous-body-update-jobs", false, true, true, 0 }
+	};
+
+	// The job system can already be running if the application was initialized.
+	const bool JobsRunning = JobSystem::IsInitialized();
+
+	std::vector<ReplayRun> Runs;
+	for( const auto& Setting : Settings )
+	{
+		// Batched integration falls back to a single thread when the job system isn't running.
+		const size_t Workers = JobSystem::IsInitialized() ? JobSystem::GetWorkerCount() : 0;
+		if( WorkerCount( Setting ) != Workers )
+		{
+			if( JobsRunning )
+				continue;
+
+			if( Setting.Jobs )
+			{
+				JobSystem::Initialize( Setting.Workers );
+			}
+			else
+			{
+				JobSystem::Shutdown();
+			}
+		}
+
+		Runs.emplace_back( Replay( Setting, Terrain, TerrainBounds ) );
+	}
+
+	if( !JobsRunning && JobSystem::IsInitialized() )
+	{
+		JobSystem::Shutdown();
+	}
+
+	Configuration.Store( "physics.SynchronousBodyUpdate", SynchronousBodyUpdate );
+	Configuration.Store( "physics.SubStepBudget", SubStepBudget );
+
+	// Compare every run against the first one.
+	bool Deterministic = true;
+	std::vector<size_t> Divergence( Runs.size(), TickCount );
+	for( size_t Index = 0; Index < Runs.size(); Index++ )
+	{
+		const auto& Run = Runs[Index];
+		for( size_t Tick = 0; Tick < TickCount; Tick++ )
+		{
+			if( Run.Hashes[Tick] != Runs.front().Hashes[Tick] )
+			{
+				Divergence[Index] = Tick;
+				Deterministic = false;
+				break;
+			}
+		}
+
+		const auto Total = Sum( Run );
+		Log::Event( "%s: %.1fms | pre-collision %lldus | update %lldus | static queries %lldus | dynamic queries %lldus | hash %016llx\n",
+			Run.Settings.Name, Run.Milliseconds,
+			static_cast<long long>( Total.PreCollision ), static_cast<long long>( Total.UpdateBodies ),
+			static_cast<long long>( Total.StaticQueries ), static_cast<long long>( Total.DynamicQueries ),
+			static_cast<unsigned long long>( Run.Hashes.back() ) );
+
+		if( Divergence[Index] < TickCount )
+		{
+			Log::Event( Log::Error, "%s diverged from %s at tick %zu.\n", Run.Settings.Name, Runs.front().Settings.Name, Divergence[Index] );
+		}
+	}
+
+	// Same-process runs can share a mistake, the stored trace also catches drift between builds and machines.
+	if( !Runs.empty() && !CompareTrace( Runs.front() ) )
+	{
+		Deterministic = false;
+	}
+
+	Export( Runs, Divergence );
+	Log::Event( "Timings written to \"%s\" and \"%s\".\n", TimingsFile, SummaryFile );
+
+	return Deterministic ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CPhysicsReplayTest::GetName()
+{
+	return "Physics Replay Test";
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../Test.h"
+
+// Steps a seeded scene headlessly and records per-tick state hashes and phase timings.
+// Runs the same scene with different threading settings, the hashes of each run have to match.
+// The job system runs with a single worker and with one worker per hardware thread.
+// The reference run is also compared against a trace stored by an earlier session in Cache/Test/PhysicsReplay.trace.
+class CPhysicsReplayTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
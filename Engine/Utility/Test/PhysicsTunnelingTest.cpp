@@ -0,0 +1,135 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "PhysicsTunnelingTest.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <Engine/Configuration/Configuration.h>
+#include <Engine/Physics/Physics.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Test/HeadlessBody.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t TickCount = 120;
+constexpr double TimeStep = 1.0 / 60.0;
+
+constexpr size_t ProjectileCount = 64;
+constexpr float WallLocation = 10.0f;
+constexpr float WallThickness = 0.1f;
+
+// Each lane is faster than the previous one, the fastest ones cover several units per tick.
+static float Speed( const size_t Index )
+{
+	return 60.0f + static_cast<float>( Index ) * 10.0f;
+}
+
+struct TunnelingStatistics
+{
+	size_t Tunneled = 0;
+	double MillisecondsPerTick = 0.0;
+};
+
+static TunnelingStatistics Measure( const int SubSteps )
+{
+	CConfiguration::Get().Store( "physics.MaximumSubSteps", SubSteps );
+
+	CPhysics Physics;
+	Physics.SetSynchronous( true );
+
+	const float Width = static_cast<float>( ProjectileCount ) * 2.0f;
+
+	auto Wall = std::make_unique<CHeadlessBody>();
+	Wall->LocalBounds = BoundingBox( Vector3D( WallLocation, -1.0f, -1.0f ), Vector3D( WallLocation + WallThickness, Width, 1.0f ) );
+	Wall->Static = true;
+	Wall->Stationary = false;
+	Wall->Construct( &Physics );
+
+	std::vector<std::unique_ptr<CHeadlessBody>> Projectiles;
+	Projectiles.reserve( ProjectileCount );
+	for( size_t Index = 0; Index < ProjectileCount; Index++ )
+	{
+		auto Projectile = std::make_unique<CHeadlessBody>();
+		Projectile->Transform.SetPosition( Vector3D( 0.0f, static_cast<float>( Index ) * 2.0f, 0.0f ) );
+		Projectile->LocalBounds = BoundingBox( Vector3D( -0.1f, -0.1f, -0.1f ), Vector3D( 0.1f, 0.1f, 0.1f ) );
+		Projectile->Stationary = false;
+		Projectile->AffectedByGravity = false;
+		Projectile->DragCoefficient = 0.0f;
+		Projectile->SetMass( 1.0f );
+		Projectile->Velocity = Vector3D( Speed( Index ), 0.0f, 0.0f );
+
+		Projectile->Construct( &Physics );
+		Projectiles.emplace_back( std::move( Projectile ) );
+	}
+
+	double Time = 0.0;
+	Timer Total;
+	Total.Start();
+
+	for( size_t Tick = 0; Tick < TickCount; Tick++ )
+	{
+		Physics.Tick( Time );
+		Time += TimeStep;
+	}
+
+	Physics.Guard();
+	Total.Stop();
+
+	TunnelingStatistics Statistics;
+	Statistics.MillisecondsPerTick = Total.GetElapsedTimeSeconds() * 1000.0 / static_cast<double>( TickCount );
+	for( auto& Projectile : Projectiles )
+	{
+		if( Projectile->Transform.GetPosition().X > WallLocation + WallThickness )
+		{
+			Statistics.Tunneled++;
+		}
+	}
+
+	Physics.Destroy();
+
+	return Statistics;
+}
+
+ETestResult CPhysicsTunnelingTest::Run()
+{
+	const int SubSteps = CConfiguration::Get().GetInteger( "physics.MaximumSubSteps", 8 );
+	const float Budget = CConfiguration::Get().GetFloat( "physics.SubStepBudget", 4.0f );
+	const float Travel = CConfiguration::Get().GetFloat( "physics.SubStepTravel", 0.5f );
+
+	// The budget depends on the timing of the machine, don't let it affect the outcome.
+	CConfiguration::Get().Store( "physics.SubStepBudget", 1000.0f );
+
+	// Allow enough substeps to keep the fastest projectile below the travel limit, the wall is the thinnest body.
+	const float Distance = Speed( ProjectileCount - 1 ) * static_cast<float>( TimeStep );
+	const int Required = static_cast<int>( std::ceil( Distance / ( WallThickness * Travel ) ) );
+
+	const auto Single = Measure( 1 );
+	const auto Adaptive = Measure( Required );
+
+	CConfiguration::Get().Store( "physics.MaximumSubSteps", SubSteps );
+	CConfiguration::Get().Store( "physics.SubStepBudget", Budget );
+
+	Log::Event( "%zu projectiles, %zu ticks\n", ProjectileCount, TickCount );
+	Log::Event( "Single step: %zu tunneled | %.3f ms/tick\n", Single.Tunneled, Single.MillisecondsPerTick );
+	Log::Event( "Adaptive substeps (up to %i): %zu tunneled | %.3f ms/tick\n", Required, Adaptive.Tunneled, Adaptive.MillisecondsPerTick );
+
+	bool Succeeded = true;
+	if( Single.Tunneled == 0 )
+	{
+		Log::Event( Log::Error, "Nothing tunneled without substepping, the test doesn't cover anything.\n" );
+		Succeeded = false;
+	}
+
+	if( Adaptive.Tunneled > 0 )
+	{
+		Log::Event( Log::Error, "%zu projectiles tunneled through the wall with substepping.\n", Adaptive.Tunneled );
+		Succeeded = false;
+	}
+
+	return Succeeded ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CPhysicsTunnelingTest::GetName()
+{
+	return "Physics Tunneling Test";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Fires fast projectiles at thin walls and counts how many of them pass through, with and without substepping.
+class CPhysicsTunnelingTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
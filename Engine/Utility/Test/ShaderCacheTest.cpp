@@ -0,0 +1,120 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "ShaderCacheTest.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <Engine/Display/Rendering/ShaderCache.h>
+#include <Engine/Profiling/Logging.h>
+
+static const std::string Directory = "Cache/Test/ShaderCache/";
+static const std::string Root = Directory + "Test.fs";
+static const std::string Include = Directory + "Common.glsl";
+
+static bool WriteFile( const std::string& Location, const std::string& Contents )
+{
+	std::ofstream Stream( Location, std::ios::out | std::ios::binary | std::ios::trunc );
+	Stream << Contents;
+	return !Stream.fail();
+}
+
+// Runs the preprocessor over the file directly, without the cache.
+static FPreprocessedShader Expected( const FShaderDefines& Defines )
+{
+	std::ifstream File( Root, std::ios::in | std::ios::binary );
+	std::stringstream Stream;
+	Stream << File.rdbuf();
+
+	FPreprocessedShader Output;
+	ShaderCache::Preprocess( Stream, Defines, Output );
+	return Output;
+}
+
+static bool Matches( const FPreprocessedShader& Output, const FPreprocessedShader& Reference )
+{
+	return Output.Code == Reference.Code &&
+		Output.Hash == Reference.Hash &&
+		Output.Directives.BlendMode == Reference.Directives.BlendMode &&
+		Output.Directives.HasBlendMode == Reference.Directives.HasBlendMode &&
+		Output.Directives.DepthMask == Reference.Directives.DepthMask &&
+		Output.Directives.DepthTest == Reference.Directives.DepthTest &&
+		Output.Directives.Instanced == Reference.Directives.Instanced;
+}
+
+// Loads the root file through the cache and checks if it was a hit or a miss.
+static bool Check( const char* Label, const FShaderDefines& Defines, const bool Hit )
+{
+	auto& Statistics = ShaderCache::Statistics();
+	const auto Hits = Statistics.Hits;
+	const auto Misses = Statistics.Misses;
+
+	FPreprocessedShader Output;
+	const bool Loaded = ShaderCache::Load( Root, Defines, Output );
+	const bool WasHit = Statistics.Hits == Hits + 1 && Statistics.Misses == Misses;
+	const bool WasMiss = Statistics.Misses == Misses + 1 && Statistics.Hits == Hits;
+	const bool Valid = Loaded && Matches( Output, Expected( Defines ) ) && ( Hit ? WasHit : WasMiss );
+
+	Log::Event( "%s: %s, %s\n", Label, WasHit ? "hit" : WasMiss ? "miss" : "unknown", Valid ? "valid" : "invalid" );
+	return Valid;
+}
+
+ETestResult CShaderCacheTest::Run()
+{
+	const std::string Previous = ShaderCache::GetDirectory();
+	ShaderCache::SetDirectory( Directory + "Cache/" );
+
+	// Creates the directories for the test files and the cache.
+	CFile Directories( Directory + "Cache/Placeholder" );
+	Directories.Load( std::string( "\n" ) );
+	Directories.Save( true );
+
+	WriteFile( Include, "float Brightness = 1.0;\n" );
+	WriteFile( Root, "#version 430\n#include \"Common.glsl\"\n#blendmode alpha\n#depthtest <=\n#instanced\nvoid main() {}\n" );
+
+	FShaderDefines Defines;
+	Defines.IncludeDirectory = Directory;
+
+	FShaderDefines PrePass = Defines;
+	PrePass.PrePass = true;
+
+	bool Success = true;
+
+	// Entries from an earlier run are replaced because the files were just written.
+	FPreprocessedShader Output;
+	ShaderCache::Load( Root, Defines, Output );
+	ShaderCache::Load( Root, PrePass, Output );
+	ShaderCache::ClearMemory();
+
+	Success &= Check( "Disk", Defines, true );
+	Success &= Check( "Memory", Defines, true );
+	Success &= Check( "Pre-pass disk", PrePass, true );
+
+	// Changing an include has to invalidate the stages that use it.
+	WriteFile( Include, "float Brightness = 2.0; // Changed.\n" );
+	Success &= Check( "Modified include", Defines, false );
+	Success &= Check( "Modified include memory", Defines, true );
+	Success &= Check( "Modified include pre-pass", PrePass, false );
+
+	ShaderCache::ClearMemory();
+	Success &= Check( "Modified include disk", Defines, true );
+
+	WriteFile( Root, "#version 430\n#include \"Common.glsl\"\n#blendmode additive\nvoid main() {}\n" );
+	Success &= Check( "Modified root", Defines, false );
+
+	const bool Missing = !ShaderCache::Load( Directory + "Missing.fs", Defines, Output );
+	Success &= Missing;
+
+	ShaderCache::SetDirectory( Previous );
+
+	if( !Missing )
+	{
+		Log::Event( Log::Error, "Loaded a shader that doesn't exist.\n" );
+	}
+
+	return Success ? ETestResult::Succeeded : ETestResult::Failed;
+}
+
+const char* CShaderCacheTest::GetName()
+{
+	return "Shader Cache Test";
+}
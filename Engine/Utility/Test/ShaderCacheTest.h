@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Checks that cached shader stages match the preprocessor and are invalidated when one of their includes changes.
+class CShaderCacheTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -0,0 +1,224 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "UniformCacheTest.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/Display/Rendering/UniformCache.h>
+#include <Engine/Profiling/Logging.h>
+#include <Engine/Utility/Timer.h>
+
+constexpr size_t RenderableCount = 2000;
+constexpr size_t FrameCount = 8;
+
+// Fake program handle, the recording functions don't care about it.
+constexpr unsigned int Program = 1;
+
+// Uniforms that the fake program doesn't use, they should never be uploaded.
+static const char* const UnusedPrefix = "Unused";
+
+struct Recording
+{
+	std::unordered_map<std::string, int> Locations;
+
+	// Values that the fake program holds, indexed by location.
+	std::vector<Uniform> State;
+};
+
+static Recording Recorder;
+
+static int RecordGetLocation( unsigned int, const char* Name )
+{
+	const std::string Key = Name;
+	if( Key.compare( 0, std::char_traits<char>::length( UnusedPrefix ), UnusedPrefix ) == 0 )
+		return -1;
+
+	const auto Iterator = Recorder.Locations.find( Key );
+	if( Iterator != Recorder.Locations.end() )
+		return Iterator->second;
+
+	const int Location = static_cast<int>( Recorder.Locations.size() );
+	Recorder.Locations.insert_or_assign( Key, Location );
+	Recorder.State.resize( Recorder.Locations.size() );
+	return Location;
+}
+
+static void RecordUpload( int Location, const Uniform& Value )
+{
+	Recorder.State[Location] = Value;
+}
+
+struct FakeRenderable
+{
+	UniformMap Uniforms;
+
+	// Same values as above, for the name based path.
+	std::vector<std::pair<std::string, Uniform>> Named;
+
+	void Set( const std::string& Name, const Uniform& Value )
+	{
+		Uniforms.Set( Name, Value );
+		for( auto& Entry : Named )
+		{
+			if( Entry.first == Name )
+			{
+				Entry.second = Value;
+				return;
+			}
+		}
+
+		Named.emplace_back( Name, Value );
+	}
+};
+
+static void Animate( std::vector<FakeRenderable>& Renderables, UniformMap& Globals, std::vector<std::pair<std::string, Uniform>>& NamedGlobals, const size_t Frame )
+{
+	for( size_t Index = 0; Index < Renderables.size(); Index++ )
+	{
+		auto& Renderable = Renderables[Index];
+
+		// Only some of the renderables move.
+		const float Offset = Index % 4 == 0 ? static_cast<float>( Frame ) : 0.0f;
+		Matrix4D Model( 1.0f );
+		Model.Translate( Vector3D( static_cast<float>( Index ), Offset, 0.0f ) );
+
+		Renderable.Set( "Model", Model );
+		Renderable.Set( "ObjectColor", Vector4D( 1.0f, 1.0f, 1.0f, 1.0f ) );
+		Renderable.Set( "ObjectPosition", Vector3D( static_cast<float>( Index ), Offset, 0.0f ) );
+		Renderable.Set( "Tint", static_cast<int>( Index % 3 ) );
+		Renderable.Set( "UnusedSway", static_cast<float>( Index ) );
+	}
+
+	const auto Time = Uniform( static_cast<float>( Frame ) * 0.016f );
+	const auto View = Uniform( Matrix4D( 1.0f ) );
+	Globals.Set( "Time", Time );
+	Globals.Set( "View", View );
+
+	NamedGlobals.clear();
+	NamedGlobals.emplace_back( "Time", Time );
+	NamedGlobals.emplace_back( "View", View );
+}
+
+static bool Matches( const UniformMap& Uniforms )
+{
+	for( const auto& Entry : Uniforms )
+	{
+		const auto Iterator = Recorder.Locations.find( UniformName::Get( Entry.first ) );
+		if( Iterator == Recorder.Locations.end() )
+			continue;
+
+		if( !Recorder.State[Iterator->second].Equals( Entry.second ) )
+			return false;
+	}
+
+	return true;
+}
+
+static void Report( const char* Name, const size_t Frame, const double Milliseconds )
+{
+	const auto& Statistics = UniformDispatch::Statistics();
+	Log::Event( "%s frame %zu: %lli lookups, %lli calls, %lli skipped (%.3fms)\n",
+		Name, Frame, Statistics.Lookups, Statistics.Calls, Statistics.Skipped, Milliseconds );
+}
+
+ETestResult CUniformCacheTest::Run()
+{
+	UniformFunctions Functions;
+	Functions.GetLocation = RecordGetLocation;
+	Functions.Upload = RecordUpload;
+	UniformDispatch::Override( Functions );
+
+	std::vector<FakeRenderable> Renderables( RenderableCount );
+	UniformMap Globals;
+	std::vector<std::pair<std::string, Uniform>> NamedGlobals;
+
+	Log::Event( "Binding %zu renderables over %zu frames.\n", RenderableCount, FrameCount );
+
+	int64_t NamedLookups = 0;
+	for( size_t Frame = 0; Frame < FrameCount; Frame++ )
+	{
+		Animate( Renderables, Globals, NamedGlobals, Frame );
+		UniformDispatch::ResetStatistics();
+
+		Timer Bind;
+		Bind.Start();
+		for( const auto& Renderable : Renderables )
+		{
+			for( const auto& Entry : Renderable.Named )
+			{
+				Entry.second.Bind( Program, Entry.first );
+			}
+
+			for( const auto& Entry : NamedGlobals )
+			{
+				Entry.second.Bind( Program, Entry.first );
+			}
+		}
+		Bind.Stop();
+
+		NamedLookups = UniformDispatch::Statistics().Lookups;
+		Report( "Names", Frame, Bind.GetElapsedTimeMicroseconds() / 1000.0 );
+	}
+
+	CUniformCache Cache;
+	Cache.Reset( Program );
+
+	int64_t CachedLookups = 0;
+	int64_t CachedCalls = 0;
+	for( size_t Frame = 0; Frame < FrameCount; Frame++ )
+	{
+		Animate( Renderables, Globals, NamedGlobals, Frame );
+		UniformDispatch::ResetStatistics();
+
+		Timer Bind;
+		Bind.Start();
+		for( const auto& Renderable : Renderables )
+		{
+			Cache.Bind( Renderable.Uniforms );
+			Cache.Bind( Globals );
+		}
+		Bind.Stop();
+
+		CachedLookups = UniformDispatch::Statistics().Lookups;
+		CachedCalls = UniformDispatch::Statistics().Calls;
+		Report( "Cache", Frame, Bind.GetElapsedTimeMicroseconds() / 1000.0 );
+	}
+
+	// The program has to hold the same values after every draw as when everything is uploaded.
+	bool Consistent = true;
+	Cache.Reset( Program );
+	for( size_t Frame = 0; Frame < FrameCount; Frame++ )
+	{
+		Animate( Renderables, Globals, NamedGlobals, Frame );
+		for( const auto& Renderable : Renderables )
+		{
+			Cache.Bind( Renderable.Uniforms );
+			Cache.Bind( Globals );
+			Consistent = Consistent && Matches( Renderable.Uniforms ) && Matches( Globals );
+		}
+	}
+
+	UniformDispatch::Override( UniformFunctions() );
+	UniformDispatch::ResetStatistics();
+
+	if( !Consistent )
+	{
+		Log::Event( Log::Error, "The cached uniforms don't match the uploaded ones.\n" );
+		return ETestResult::Failed;
+	}
+
+	// Once warmed up, the cache shouldn't have to look up anything by name.
+	if( CachedLookups != 0 || NamedLookups == 0 || CachedCalls >= NamedLookups )
+	{
+		Log::Event( Log::Error, "The uniform cache isn't reducing the amount of GL calls.\n" );
+		return ETestResult::Failed;
+	}
+
+	return ETestResult::Succeeded;
+}
+
+const char* CUniformCacheTest::GetName()
+{
+	return "Uniform Cache Test";
+}
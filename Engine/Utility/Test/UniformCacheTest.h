@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../Test.h"
+
+// Records the uniform traffic of name based binding and of the per-program uniform cache, without a GPU.
+class CUniformCacheTest : public CTest
+{
+public:
+	virtual ETestResult Run() override;
+	virtual const char* GetName() override;
+};
@@ -10,9 +10,23 @@
 
 #include <random>
 #include <iomanip>
+#include <sstream>
 
 ConVar<bool> DebugEntityIO( "debug.Entity.IO", false );
 
+namespace EntityOutput
+{
+	const NameSymbol OnTrigger = NameLiteral( "OnTrigger" );
+	const NameSymbol OnEnter = NameLiteral( "OnEnter" );
+	const NameSymbol OnLeave = NameLiteral( "OnLeave" );
+	const NameSymbol OnStart = NameLiteral( "OnStart" );
+	const NameSymbol OnFinish = NameLiteral( "OnFinish" );
+	const NameSymbol OnRun = NameLiteral( "OnRun" );
+	const NameSymbol OnInteract = NameLiteral( "OnInteract" );
+	const NameSymbol OnEnable = NameLiteral( "OnEnable" );
+	const NameSymbol OnDisable = NameLiteral( "OnDisable" );
+}
+
 void CEntityMap::Add( const std::string& Type, EntityFunction Factory )
 {
 	// Log::Event( "Registering entity \"%s\".\n", Type.c_str() );
@@ -294,6 +308,11 @@ void CEntity::Relink()
 }
 
 void CEntity::Send( const char* Output, CEntity* Origin )
+{
+	Send( NameSymbol( Output ), Origin );
+}
+
+void CEntity::Send( const NameSymbol& Output, CEntity* Origin )
 {
 	if( !Level )
 		return;
@@ -303,9 +322,9 @@ void CEntity::Send( const char* Output, CEntity* Origin )
 		return;
 
 	if( DebugEntityIO )
-		Log::Event( "Broadcasting output \"%s\".\n", Output );
+		Log::Event( "Broadcasting output \"%s\".\n", Output.String().c_str() );
 
-	for( auto& Message : Outputs[Output] )
+	for( auto& Message : Iterator->second )
 	{
 		const auto Entity = Level->GetWorld()->Find( Message.TargetID );
 		if( !Entity )
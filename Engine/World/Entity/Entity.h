@@ -62,6 +62,20 @@ typedef std::map<NameSymbol, std::function<bool(CEntity*)>> MessageInput;
 
 typedef std::map<NameSymbol, std::vector<FMessage>> MessageOutput;
 
+// Outputs that are sent by the engine's entities, their symbols are only looked up once.
+namespace EntityOutput
+{
+	extern const NameSymbol OnTrigger;
+	extern const NameSymbol OnEnter;
+	extern const NameSymbol OnLeave;
+	extern const NameSymbol OnStart;
+	extern const NameSymbol OnFinish;
+	extern const NameSymbol OnRun;
+	extern const NameSymbol OnInteract;
+	extern const NameSymbol OnEnable;
+	extern const NameSymbol OnDisable;
+}
+
 struct LevelUID
 {
 	LevelUID()
@@ -164,6 +178,7 @@ public:
 	// Entity I/O
 	/// Broadcasts an output to listening entities.
 	void Send( const char* Output, CEntity* Origin = nullptr );
+	void Send( const NameSymbol& Output, CEntity* Origin = nullptr );
 
 	/// Sends the input to this entity and executes its associated function, if it exists.
 	bool Receive( const char* Input, CEntity* Origin = nullptr );
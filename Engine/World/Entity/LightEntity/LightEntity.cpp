@@ -1,6 +1,7 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "LightEntity.h"
 
+#include <Engine/Configuration/Configuration.h>
 #include <Engine/Display/Rendering/Renderable.h>
 #include <Engine/Display/UserInterface.h>
 #include <Engine/Display/Window.h>
@@ -11,6 +12,8 @@
 
 static CEntityFactory<LightEntity> Factory( "light" );
 
+ConfigurationVariable<bool> PersistentLightBuffer( "render.PersistentLightBuffer", true );
+
 void LightEntity::Construct()
 {
 	if( LightIndex < 0 )
@@ -22,6 +25,7 @@ void LightEntity::Construct()
 		return;
 
 	Lights[LightIndex] = Information;
+	Invalidate( LightIndex );
 
 	// Check if the radius is large enough.
 	if( Information.Direction.w <= 0.1f )
@@ -184,17 +188,22 @@ void LightEntity::Initialize()
 	{
 		Lights[Index].Position.w = -1.0f;
 	}
+
+	Invalidate( -1 );
 }
 
 Light LightEntity::Lights[LightMaximum];
-ShaderStorageBuffer<Light> LightEntity::LightBuffer;
+CDynamicStorageBuffer LightEntity::LightBuffer;
 int32_t LightEntity::AllocationIndex = -1;
+CLightGrid LightEntity::Grid;
+bool LightEntity::GridDirty = true;
 
 int32_t LightEntity::AllocateLight()
 {
-	if( AllocationIndex < LightMaximum )
+	if( AllocationIndex < LightMaximum - 1 )
 	{
 		AllocationIndex++;
+		GridDirty = true;
 		return AllocationIndex;
 	}
 
@@ -259,11 +268,13 @@ void LightEntity::UploadToGPU()
 	if( CWindow::Get().IsWindowless() )
 		return;
 
-	// Create a new light buffer which destroys the previous one.
-	// LightBuffer = ShaderStorageBuffer<Light>();
+	if( LightBuffer.Count() == 0 )
+	{
+		LightBuffer.Initialize( LightMaximum, sizeof( Light ), PersistentLightBuffer.Get() );
+	}
 
-	// Initialize the light buffer with the lighting data.
-	LightBuffer.Initialize( Lights, LightMaximum, false );
+	// Only the lights that changed since the last upload are written.
+	LightBuffer.Upload( Lights );
 }
 
 void LightEntity::Bind()
@@ -274,69 +285,43 @@ void LightEntity::Bind()
 	LightBuffer.Bind();
 }
 
+void LightEntity::Shutdown()
+{
+	LightBuffer.Release();
+}
+
 LightIndices LightEntity::Fetch( const Vector3D& Position )
 {
-	Vector3D LightPosition;
-	Vector3D Direction;
-	int32_t Closest[4] { -1, -1, -1, -1 };
-	float Distance = FLT_MAX;
-	for( int32_t Index = 0; Index <= AllocationIndex; Index++ )
+	if( GridDirty )
 	{
-		const auto Type = static_cast<int>( Lights[Index].Position.w );
-		if( Type < 0 )
-			continue;
-
-		LightPosition.X = Lights[Index].Position.x;
-		LightPosition.Y = Lights[Index].Position.y;
-		LightPosition.Z = Lights[Index].Position.z;
-
-		// Check cone of spot lights.
-		if( Type == 1 )
-		{
-			Direction.X = Lights[Index].Direction.x;
-			Direction.Y = Lights[Index].Direction.y;
-			Direction.Z = Lights[Index].Direction.z;
-
-			auto Unit = ( Position - LightPosition );
-			// const auto Length = Unit.Normalize();
-
-			const auto Angle = cosf( Lights[Index].Properties.y );
-			const auto Visibility = Unit.Dot( Direction );// -Angle;
-			if( Visibility < 0.5f )
-				continue;
-		}
-
-		const auto LightDistance = LightPosition.DistanceSquared( Position );
-		const auto LightFactor = LightDistance - Lights[Index].Color.w * 0.1f;
-		const auto LightCullFactor = LightDistance * 0.01f;
-		if( LightCullFactor > 200.0f || Lights[Index].Color.w < 0.01f )
-		{
-			continue;
-		}
-
-		const bool FreeIndex = Closest[0] == -1 || Closest[1] == -1 || Closest[2] == -1 || Closest[3] == -1;
-		if( LightFactor < Distance )
-		{
-			Distance = LightDistance;
-
-			Closest[3] = Closest[2];
-			Closest[2] = Closest[1];
-			Closest[1] = Closest[0];
-
-			Closest[0] = Index;
-		}
+		Grid.Build( Lights, AllocationIndex + 1 );
+		GridDirty = false;
 	}
 
-	LightIndices Indices;
-	Indices.Index[0] = Closest[0];
-	Indices.Index[1] = Closest[1];
-	Indices.Index[2] = Closest[2];
-	Indices.Index[3] = Closest[3];
-
-	return Indices;
+	return Grid.Fetch( Position );
 }
 
 Light& LightEntity::Get( int32_t Index )
 {
+	Invalidate( Index );
 	return Lights[Index];
 }
+
+const Light& LightEntity::Read( int32_t Index )
+{
+	return Lights[Index];
+}
+
+void LightEntity::Invalidate( const int32_t Index )
+{
+	GridDirty = true;
+
+	if( Index < 0 )
+	{
+		LightBuffer.MarkDirty();
+	}
+	else
+	{
+		LightBuffer.MarkDirty( static_cast<size_t>( Index ) );
+	}
+}
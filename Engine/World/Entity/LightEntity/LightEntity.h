@@ -3,7 +3,8 @@
 
 #include <Engine/World/Entity/PointEntity/PointEntity.h>
 #include <Engine/Display/Rendering/Light/Light.h>
-#include <Engine/Display/Rendering/StorageBuffer.h>
+#include <Engine/Display/Rendering/Light/LightGrid.h>
+#include <Engine/Display/Rendering/DynamicStorageBuffer.h>
 
 class CRenderable;
 
@@ -26,9 +27,17 @@ public:
 	static void UploadToGPU();
 	static void Bind();
 
+	// Releases the light buffer, has to be called while the GL context still exists.
+	static void Shutdown();
+
 	// Fetch nearby lights.
 	static LightIndices Fetch( const Vector3D& Position );
+
+	// Marks the light as modified, it is uploaded and rebinned on the next update.
 	static Light& Get( int32_t Index );
+
+	// Read-only access, doesn't mark the light as modified.
+	static const Light& Read( int32_t Index );
 	static int32_t AllocateLight();
 	static void ConfigureLight(
 		Light& Information,
@@ -52,5 +61,11 @@ protected:
 	static Light Lights[LightMaximum];
 	static int32_t AllocationIndex;
 
-	static ShaderStorageBuffer<Light> LightBuffer;
+	static CLightGrid Grid;
+	static bool GridDirty;
+
+	// Marks a single light as modified, or all of them when the index is negative.
+	static void Invalidate( const int32_t Index );
+
+	static CDynamicStorageBuffer LightBuffer;
 };
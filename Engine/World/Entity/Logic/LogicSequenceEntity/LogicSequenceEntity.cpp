@@ -57,7 +57,7 @@ void CLogicSequenceEntity::Tick()
 	if( StartedPlaying )
 	{
 		IsPlaying = true;
-		Send( "OnStart", this );
+		Send( EntityOutput::OnStart, this );
 		return;
 	}
 
@@ -65,7 +65,7 @@ void CLogicSequenceEntity::Tick()
 	if( StoppedPlaying )
 	{
 		IsPlaying = false;
-		Send( "OnFinish", this );
+		Send( EntityOutput::OnFinish, this );
 	}
 }
 
@@ -21,7 +21,7 @@ void CLogicStartEntity::Tick()
 	if( !HasStarted )
 	{
 		HasStarted = true;
-		Send( "OnStart" );
+		Send( EntityOutput::OnStart );
 	}
 }
 
@@ -47,7 +47,7 @@ void CLogicTimerEntity::Tick()
 		{
 			if( Frequency < 0 || TriggerCount < Frequency )
 			{
-				Send( "OnTrigger" );
+				Send( EntityOutput::OnTrigger );
 				Timer.Start();
 			}
 
@@ -60,7 +60,7 @@ CMeshEntity::CMeshEntity()
 	{
 		SetVisible( true );
 
-		Send( "OnEnable" );
+		Send( EntityOutput::OnEnable );
 		return true;
 	};
 
@@ -68,7 +68,7 @@ CMeshEntity::CMeshEntity()
 	{
 		SetVisible( false );
 
-		Send( "OnDisable" );
+		Send( EntityOutput::OnDisable );
 		return true;
 	};
 }
@@ -193,7 +193,7 @@ void PrintMatrix( const std::string& Name, const Matrix4D& Matrix )
 
 void CMeshEntity::TickAnimation()
 {
-	if( !Renderable->GetRenderData().ShouldRender )
+	if( !Renderable || !Renderable->GetRenderData().ShouldRender )
 		return; // Mesh is invisible.
 
 	// Profile( "Animation" );
@@ -261,6 +261,7 @@ void CMeshEntity::Destroy()
 	}
 
 	delete Renderable;
+	Renderable = nullptr;
 
 	CPointEntity::Destroy();
 }
@@ -270,7 +271,7 @@ void DebugLight( const Vector3D& Position, const int32_t& Index )
 	if( Index < 0 )
 		return;
 
-	const auto& Light = LightEntity::Get( Index );
+	const auto& Light = LightEntity::Read( Index );
 	const auto LightPosition = Vector3D( Light.Position.x, Light.Position.y, Light.Position.z );
 	UI::AddLine( Position, LightPosition, Color::Purple );
 
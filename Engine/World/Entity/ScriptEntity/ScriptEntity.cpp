@@ -28,7 +28,7 @@ void ScriptEntity::Construct()
 	NextTickTime = Interval;
 
 	Execute( "Construct" );
-	Send( "OnRun" );
+	Send( EntityOutput::OnRun );
 }
 
 void ScriptEntity::Destroy()
@@ -107,7 +107,7 @@ void ScriptEntity::Interact( Interactable* Caller )
 	InteractionEntity = dynamic_cast<CEntity*>( Caller );
 
 	Execute( InteractionFunction );
-	Send( "OnInteract" );
+	Send( EntityOutput::OnInteract );
 }
 
 bool ScriptEntity::CanInteract( Interactable* Caller ) const
@@ -9,7 +9,7 @@ CTriggerBoxEntity::CTriggerBoxEntity()
 {
 	Inputs["Trigger"] = [&] ( CEntity* Origin )
 	{
-		Send( "OnTrigger" );
+		Send( EntityOutput::OnTrigger );
 
 		return true;
 	};
@@ -76,7 +76,7 @@ void CTriggerBoxEntity::Tick()
 	if( !ShouldTrigger() )
 		return;
 
-	Send( "OnTrigger" );
+	Send( EntityOutput::OnTrigger );
 	Latched = true;
 
 	Count++;
@@ -211,7 +211,7 @@ void CTriggerBoxEntity::OnEnter( Interactable* Interactable )
 		Log::Event( "OnEnter\n" );
 	}
 
-	Send( "OnEnter", this );
+	Send( EntityOutput::OnEnter, this );
 }
 
 void CTriggerBoxEntity::OnLeave( Interactable* Interactable )
@@ -221,7 +221,7 @@ void CTriggerBoxEntity::OnLeave( Interactable* Interactable )
 		Log::Event( "OnLeave\n" );
 	}
 
-	Send( "OnLeave", this );
+	Send( EntityOutput::OnLeave, this );
 }
 
 const std::unordered_set<Interactable*>& CTriggerBoxEntity::Fetch() const
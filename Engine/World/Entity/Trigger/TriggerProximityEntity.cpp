@@ -10,7 +10,7 @@ CTriggerProximityEntity::CTriggerProximityEntity()
 {
 	Inputs["Trigger"] = [&] ( CEntity* Origin )
 	{
-		Send( "OnTrigger" );
+		Send( EntityOutput::OnTrigger );
 
 		return true;
 	};
@@ -74,7 +74,7 @@ void CTriggerProximityEntity::Tick()
 	{
 		if( !Latched && ( Frequency < 0 || Count < Frequency ) )
 		{
-			Send( "OnTrigger" );
+			Send( EntityOutput::OnTrigger );
 			Latched = true;
 
 			Count++;
@@ -182,7 +182,7 @@ void CTriggerProximityEntity::OnEnter( Interactable* Interactable )
 		Log::Event( "OnEnter\n" );
 	}
 
-	Send( "OnEnter", this );
+	Send( EntityOutput::OnEnter, this );
 }
 
 void CTriggerProximityEntity::OnLeave( Interactable* Interactable )
@@ -192,7 +192,7 @@ void CTriggerProximityEntity::OnLeave( Interactable* Interactable )
 		Log::Event( "OnLeave\n" );
 	}
 
-	Send( "OnLeave", this );
+	Send( EntityOutput::OnLeave, this );
 }
 
 const std::unordered_set<Interactable*>& CTriggerProximityEntity::Fetch() const
@@ -1,11 +1,18 @@
 // Copyright  2017, Christiaan Bakker, All rights reserved.
 #include "Level.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
 #include <Engine/Display/Rendering/Culling.h>
+#include <Engine/Display/Rendering/Renderer.h>
+#include <Engine/Display/Window.h>
 #include <Engine/Resource/Assets.h>
 #include <Engine/Physics/Body/Body.h>
 #include <Engine/World/Entity/Entity.h>
 #include <Engine/World/Entity/MeshEntity/MeshEntity.h>
+#include <Engine/World/Level/LevelReader.h>
 #include <Engine/World/World.h>
 #include <Engine/Utility/Chunk.h>
 #include <Engine/Utility/DataString.h>
@@ -71,6 +78,9 @@ void CLevel::Frame()
 		Entity->Frame();
 	}
 
+	UpdateHierarchy();
+	CWindow::Get().GetRenderer().QueueHierarchy( &Hierarchy );
+
 	if( !World )
 		return;
 
@@ -145,6 +155,7 @@ void CLevel::Destroy()
 	}
 
 	Entities.clear();
+	InvalidateHierarchy();
 	World = nullptr;
 }
 
@@ -164,255 +175,296 @@ void CLevel::Reload()
 	}
 
 	Entities.clear();
+	InvalidateHierarchy();
 
-	CFile File = CFile( Name );
-	File.Load();
-	Load( File, false );
+	Load( Name, false );
 
 	Construct();
 }
 
 void CLevel::Load( const CFile& File, const bool AssetsOnly )
+{
+	const std::string Updated = Parse( File, AssetsOnly );
+	if( !Updated.empty() )
+	{
+		CFile Save = CFile( File.Location() );
+		Save.Load( Updated );
+		Save.Save();
+	}
+}
+
+void CLevel::Load( const std::string& Location, const bool AssetsOnly )
+{
+	std::string Updated;
+
+	{
+		CFile File = CFile( Location );
+		if( !File.Map() && !File.Load() )
+		{
+			Log::Event( Log::Warning, "Failed to open level \"%s\".\n", Location.c_str() );
+			return;
+		}
+
+		Updated = Parse( File, AssetsOnly );
+	}
+
+	// The mapping has been released at this point, the file can't be written to while it is still mapped.
+	if( !Updated.empty() )
+	{
+		CFile Save = CFile( Location );
+		Save.Load( Updated );
+		Save.Save();
+	}
+}
+
+std::string CLevel::Parse( const CFile& File, const bool AssetsOnly )
 {
 	OptickEvent();
 
 	Log::Event( "Parsing level \"%s\".\n", File.Location().c_str() );
 
-	JSON::Container JSON = JSON::Tree( File );
-
 	SetName( File.Location() );
 
+	// Entities that didn't have an identifier yet, they're written back to the file afterwards.
 	struct EntityIdentifier
 	{
-		JSON::Object* Entity = nullptr;
+		// Position right after the opening brace of the entity.
+		size_t Offset = 0;
 		UniqueIdentifier Identifier;
 	};
 	std::vector<EntityIdentifier> Identifiers;
 
+	struct LevelStruct
+	{
+		std::string Path = "";
+
+		// Local identifier.
+		UniqueIdentifier Identifier;
+
+		Vector3D Position = { 0,0,0 };
+		Vector3D Orientation = { 0,0,0 };
+		Vector3D Size = { 1,1,1 };
+	};
+
+	std::vector<LevelStruct> SubLevels;
+
+	// Entities are linked once all of them have been spawned, only the data of entities with outputs is kept around until then.
+	struct EntityObjectLink
+	{
+		CEntity* Entity = nullptr;
+		std::unique_ptr<JSON::Container> Data;
+	};
+	std::vector<EntityObjectLink> EntityObjectLinks;
+
 	DisableSerialization = false;
 
-	size_t Pass = 0;
-	while( Pass < 2 )
+	// Spawns an entity as soon as its object has been read.
+	auto LoadEntity = [&] ( std::unique_ptr<JSON::Container> EntityData, const size_t Offset )
 	{
-		bool AssetsFound = false;
-		bool EntitiesFound = false;
-		for( auto* Object : JSON.Tree )
+		const auto& Properties = EntityData->Tree.front()->Objects;
+
+		bool FoundClass = false;
+		bool FoundName = false;
+		std::string ClassName = "";
+		std::string EntityName = "";
+		UniqueIdentifier EntityID;
+
+		std::string LevelPath = "";
+		std::string LevelPositionString = "";
+		std::string LevelOrientationString = "";
+		std::string LevelSizeString = "";
+		Vector3D LevelPosition = { 0,0,0 };
+		Vector3D LevelOrientation = { 0,0,0 };
+		Vector3D LevelSize = { 1,1,1 };
+
+		for( auto* Property : Properties )
 		{
-			if( Object )
+			if( Property->Key == "type" )
 			{
-				if( Object->Key == "save" && Object->Value == "0" )
-				{
-					DisableSerialization = true;
-				}
+				ClassName = Property->Value;
+				FoundClass = true;
+			}
+			else if( Property->Key == "name" )
+			{
+				EntityName = Property->Value;
+				FoundName = true;
+			}
+			else if( Property->Key == "uuid" )
+			{
+				EntityID.Set( Property->Value.c_str() );
+			}
+			else if( Property->Key == "path" )
+			{
+				LevelPath = Property->Value;
+			}
+			else if( Property->Key == "position" )
+			{
+				LevelPositionString = Property->Value;
+			}
+			else if( Property->Key == "rotation" )
+			{
+				LevelOrientationString = Property->Value;
+			}
+			else if( Property->Key == "scale" )
+			{
+				LevelSizeString = Property->Value;
+			}
+		}
 
-				if( Pass == 0 )
-				{
-					if( Object->Key == "uuid" )
-					{
-						// Found a unique identifier for this level.
-						Identifier.Set( Object->Value.c_str() );
-					}
-					else if( Object->Key == "assets" )
-					{
-						AssetsFound = !Object->Objects.empty();
-						CAssets::Load( *Object );
-						Pass++;
-					}
-				}
-				else if( Pass == 1 )
+		const bool IsLevel = ClassName == "level";
+
+		if( !EntityID.Valid() )
+		{
+			// Generate a random UUID.
+			EntityID.Random();
+
+			// Make sure it is added to the file afterwards.
+			EntityIdentifier NewIdentifier;
+			NewIdentifier.Offset = Offset;
+			NewIdentifier.Identifier = EntityID;
+
+			Identifiers.emplace_back( NewIdentifier );
+		}
+
+		if( !FoundClass )
+			return;
+
+		if( !IsLevel && !AssetsOnly )
+		{
+			ProfileMemory( "Entities" );
+
+			EntityObjectLink Link;
+			if( FoundName )
+			{
+				Link.Entity = Spawn( ClassName, EntityName );
+			}
+			else
+			{
+				Link.Entity = Spawn( ClassName );
+			}
+
+			if( Link.Entity )
+			{
+				Link.Entity->Identifier = EntityID;
+				Link.Entity->SetLevel( this );
+				Link.Entity->Load( Properties );
+
+				if( JSON::Find( Properties, "outputs" ) )
 				{
-					if( Object->Key == "entities" )
-					{
-						EntitiesFound = true;
-
-						struct EntityObjectLink
-						{
-							CEntity* Entity = nullptr;
-							JSON::Object* Object = nullptr;
-						};
-						std::vector<EntityObjectLink> EntityObjectLinks;
-						EntityObjectLinks.reserve( Object->Objects.size() );
-
-						struct LevelStruct
-						{
-							std::string Path = "";
-
-							// Local identifier.
-							UniqueIdentifier Identifier;
-
-							Vector3D Position = { 0,0,0 };
-							Vector3D Orientation = { 0,0,0 };
-							Vector3D Size = { 1,1,1 };
-						};
-
-						std::vector<LevelStruct> SubLevels;
-
-						// Pass 1: Determine type and spawn relevant entities.
-						for( auto EntityObject : Object->Objects )
-						{
-							EntityObjectLink Link;
-							Link.Object = EntityObject;
-
-							bool FoundClass = false;
-							bool FoundName = false;
-							std::string ClassName = "";
-							std::string EntityName = "";
-							UniqueIdentifier EntityID;
-
-							std::string LevelPath = "";
-							std::string LevelPositionString = "";
-							std::string LevelOrientationString = "";
-							std::string LevelSizeString = "";
-							Vector3D LevelPosition = { 0,0,0 };
-							Vector3D LevelOrientation = { 0,0,0 };
-							Vector3D LevelSize = { 1,1,1 };
-
-							for( auto* Property : EntityObject->Objects )
-							{
-								if( Property->Key == "type" )
-								{
-									ClassName = Property->Value;
-									FoundClass = true;
-								}
-								else if( Property->Key == "name" )
-								{
-									EntityName = Property->Value;
-									FoundName = true;
-								}
-								else if( Property->Key == "uuid" )
-								{
-									EntityID.Set( Property->Value.c_str() );
-								}
-								else if( Property->Key == "path" )
-								{
-									LevelPath = Property->Value;
-								}
-								else if( Property->Key == "position" )
-								{
-									LevelPositionString = Property->Value;
-								}
-								else if( Property->Key == "rotation" )
-								{
-									LevelOrientationString = Property->Value;
-								}
-								else if( Property->Key == "scale" )
-								{
-									LevelSizeString = Property->Value;
-								}
-							}
-
-							const bool IsLevel = ClassName == "level";
-
-							if( !EntityID.Valid() )
-							{
-								// Generate a random UUID.
-								EntityID.Random();
-
-								// Make sure it is added to the JSON tree afterwards.
-								EntityIdentifier NewIdentifier;
-								NewIdentifier.Entity = EntityObject;
-								NewIdentifier.Identifier = Identifier;
-								
-								Identifiers.emplace_back( NewIdentifier );
-							}
-
-							if( FoundClass )
-							{
-								if( !IsLevel && !AssetsOnly )
-								{
-									ProfileMemory( "Entities" );
-
-									if( FoundName )
-									{
-										Link.Entity = Spawn( ClassName, EntityName );
-									}
-									else
-									{
-										Link.Entity = Spawn( ClassName );
-									}
-
-									if( Link.Entity )
-									{
-										Link.Entity->Identifier = EntityID;
-										Link.Entity->SetLevel( this );
-										EntityObjectLinks.emplace_back( Link );
-									}
-								}
-								else if ( LevelPath.length() > 0 )
-								{
-									Extract( LevelPositionString.c_str(), LevelPosition );
-									Extract( LevelOrientationString.c_str(), LevelOrientation );
-									Extract(LevelSizeString.c_str(), LevelSize );
-
-									CFile SubLevelFile( LevelPath );
-									if( SubLevelFile.Exists() )
-									{
-										LevelStruct Level;
-										Level.Path = LevelPath;
-										Level.Identifier = EntityID;
-										Level.Position = LevelPosition;
-										Level.Orientation = LevelOrientation;
-										Level.Size = LevelSize;
-										SubLevels.emplace_back( Level );
-									}
-								}
-							}
-						}
-
-						for( auto& Level : SubLevels )
-						{
-							CFile SubLevelFile( Level.Path );
-							SubLevelFile.Load();
-
-							if( AssetsOnly )
-							{
-								CLevel Dummy;
-								Dummy.Load( SubLevelFile, AssetsOnly );
-							}
-							else
-							{
-								auto World = GetWorld();
-								if( World )
-								{
-									CLevel& SubLevel = World->Add();
-									SubLevel.Prefab = true;
-									SubLevel.Transform = FTransform( Level.Position, Level.Orientation, Level.Size );
-									SubLevel.Transform = GetTransform() * SubLevel.Transform;
-									SubLevel.Load( SubLevelFile );
-								}
-							}
-						}
-
-						if( !AssetsOnly )
-						{
-							// Pass 2: Load and configure entities.
-							for( auto Link : EntityObjectLinks )
-							{
-								if( Link.Entity && Link.Object )
-								{
-									Link.Entity->Load( Link.Object->Objects );
-									Link.Entity->Link( Link.Object->Objects );
-									Link.Entity->Relink();
-									Link.Entity->Reload();
-								}
-							}
-						}
-
-						Pass++;
-					}
+					Link.Data = std::move( EntityData );
 				}
+
+				EntityObjectLinks.emplace_back( std::move( Link ) );
 			}
 		}
+		else if( LevelPath.length() > 0 )
+		{
+			Extract( LevelPositionString.c_str(), LevelPosition );
+			Extract( LevelOrientationString.c_str(), LevelOrientation );
+			Extract( LevelSizeString.c_str(), LevelSize );
 
-		// In case the file doesn't contain any asset or entity references, increment the pass counter.
-		if( Pass == 0 && !AssetsFound )
+			CFile SubLevelFile( LevelPath );
+			if( SubLevelFile.Exists() )
+			{
+				LevelStruct Level;
+				Level.Path = LevelPath;
+				Level.Identifier = EntityID;
+				Level.Position = LevelPosition;
+				Level.Orientation = LevelOrientation;
+				Level.Size = LevelSize;
+				SubLevels.emplace_back( Level );
+			}
+		}
+	};
+
+	// Entities need their assets, the ones that are listed before the assets have to wait.
+	bool AssetsLoaded = false;
+	std::vector<std::pair<std::unique_ptr<JSON::Container>, size_t>> Pending;
+
+	CLevelReader Reader;
+	Reader.OnField = [this] ( const std::string& Key, const std::string& Value )
+	{
+		if( Key == "save" && Value == "0" )
+		{
+			DisableSerialization = true;
+		}
+		else if( Key == "uuid" )
+		{
+			// Found a unique identifier for this level.
+			Identifier.Set( Value.c_str() );
+		}
+	};
+
+	Reader.OnAssets = [&] ( const JSON::Object& Assets )
+	{
+		CAssets::Load( Assets );
+		AssetsLoaded = true;
+
+		for( auto& Entity : Pending )
+		{
+			LoadEntity( std::move( Entity.first ), Entity.second );
+		}
+
+		Pending.clear();
+	};
+
+	Reader.OnEntity = [&] ( std::unique_ptr<JSON::Container> Entity, const size_t Offset )
+	{
+		if( AssetsLoaded )
+		{
+			LoadEntity( std::move( Entity ), Offset );
+		}
+		else
+		{
+			Pending.emplace_back( std::move( Entity ), Offset );
+		}
+	};
+
+	if( !Reader.Read( File ) )
+	{
+		Log::Event( Log::Warning, "Failed to parse level \"%s\", line %zu (offset %zu).\n", File.Location().c_str(), Reader.GetReader().ErrorLine(), Reader.GetReader().ErrorOffset() );
+	}
+
+	// Levels without assets.
+	for( auto& Entity : Pending )
+	{
+		LoadEntity( std::move( Entity.first ), Entity.second );
+	}
+
+	Pending.clear();
+
+	for( auto& Level : SubLevels )
+	{
+		if( AssetsOnly )
+		{
+			CLevel Dummy;
+			Dummy.Load( Level.Path, AssetsOnly );
+		}
+		else
 		{
-			Pass++;
+			auto World = GetWorld();
+			if( World )
+			{
+				CLevel& SubLevel = World->Add();
+				SubLevel.Prefab = true;
+				SubLevel.Transform = FTransform( Level.Position, Level.Orientation, Level.Size );
+				SubLevel.Transform = GetTransform() * SubLevel.Transform;
+				SubLevel.Load( Level.Path );
+			}
 		}
-		else if( Pass == 1 && !EntitiesFound )
+	}
+
+	// Link the entities now that all of them exist.
+	for( auto& Link : EntityObjectLinks )
+	{
+		if( Link.Data )
 		{
-			Pass++;
+			Link.Entity->Link( Link.Data->Tree.front()->Objects );
+			Link.Data.reset();
 		}
+
+		Link.Entity->Relink();
+		Link.Entity->Reload();
 	}
 
 	if( !Identifier.Valid() )
@@ -420,27 +472,59 @@ void CLevel::Load( const CFile& File, const bool AssetsOnly )
 		Identifier.Random();
 	}
 
+	// Entities that didn't have an identifier are written back by the caller.
 	if( !Identifiers.empty() )
 	{
+		// Entities that were listed before the assets were loaded later, the identifiers have to be inserted front to back.
+		std::sort( Identifiers.begin(), Identifiers.end(), [] ( const EntityIdentifier& A, const EntityIdentifier& B )
+		{
+			return A.Offset < B.Offset;
+		} );
+
+		// Text files are terminated, everything after the terminator is left out.
+		const char* Data = File.Fetch<char>();
+		const auto* Terminator = static_cast<const char*>( std::memchr( Data, '\0', File.Size() ) );
+		const size_t Size = Terminator ? static_cast<size_t>( Terminator - Data ) : File.Size();
+
+		// The identifiers are inserted at the start of their entities, the rest of the file is kept as it is.
+		std::string Updated;
+		Updated.reserve( Size + Identifiers.size() * 64 );
+
+		size_t Copied = 0;
 		for( const auto& Identifier : Identifiers )
 		{
-			auto* IdentifierObject = JSON.Add( Identifier.Entity, "uuid" );
-			if( IdentifierObject )
+			if( Identifier.Offset < Copied || Identifier.Offset > Size )
+				continue;
+
+			Updated.append( Data + Copied, Identifier.Offset - Copied );
+			Copied = Identifier.Offset;
+
+			// Empty entities don't need a separator.
+			size_t Next = Copied;
+			while( Next < Size && std::isspace( static_cast<unsigned char>( Data[Next] ) ) )
 			{
-				IdentifierObject->Value = std::string( Identifier.Identifier.ID );
+				Next++;
 			}
+
+			const bool Empty = Next < Size && Data[Next] == '}';
+			Updated += "\n\"uuid\" : \"";
+			Updated += Identifier.Identifier.ID;
+			Updated += Empty ? "\"\n" : "\",";
 		}
-		
-		const std::string Data = JSON.Export();
-		CFile Save = CFile( File.Location() );
-		Save.Load( Data );
-		Save.Save();
+
+		Updated.append( Data + Copied, Size - Copied );
+		return Updated;
 	}
+
+	return std::string();
 }
 
 void CLevel::MarkForRemoval( CEntity* Entity )
 {
 	Removed.insert( Entity );
+
+	// Destroyed mesh entities have already released their renderables.
+	InvalidateHierarchy();
 }
 
 void CLevel::Remove( CEntity* MarkEntity )
@@ -473,6 +557,7 @@ void CLevel::Remove( CEntity* MarkEntity )
 
 	// Remove it from the vector.
 	Entities.pop_back();
+	InvalidateHierarchy();
 }
 
 bool CLevel::Transfer( CEntity* Entity )
@@ -499,9 +584,11 @@ bool CLevel::Transfer( CEntity* Entity )
 
 	// Remove it from the original level's vector.
 	Source->Entities.pop_back();
+	Source->InvalidateHierarchy();
 
 	// Add the entity to this level.
 	Entities.emplace_back( Entity );
+	HierarchyDirty = true;
 
 	// Update the entity's local level ID.
 	const auto NewID = Entities.size() - 1;
@@ -641,6 +728,7 @@ void CLevel::MigrateSpawned()
 	// Insert the spawned entities into the main list.
 	Entities.insert( Entities.end(), Spawned.begin(), Spawned.end() );
 	Spawned.clear();
+	HierarchyDirty = true;
 }
 
 void CLevel::MigrateRemoved()
@@ -679,6 +767,33 @@ void CLevel::CalculateBounds()
 	}
 }
 
+void CLevel::UpdateHierarchy()
+{
+	if( !HierarchyDirty )
+	{
+		Hierarchy.Refit();
+		return;
+	}
+
+	std::vector<CMeshEntity*> MeshEntities;
+	for( auto* Entity : Entities )
+	{
+		if( auto* MeshEntity = dynamic_cast<CMeshEntity*>( Entity ) )
+		{
+			MeshEntities.emplace_back( MeshEntity );
+		}
+	}
+
+	Hierarchy.Build( MeshEntities );
+	HierarchyDirty = false;
+}
+
+void CLevel::InvalidateHierarchy()
+{
+	Hierarchy.Clear();
+	HierarchyDirty = true;
+}
+
 bool IsSerializable( const CEntity* Entity )
 {
 	return Entity && Entity->Serialize;
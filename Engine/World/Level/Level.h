@@ -4,6 +4,7 @@
 #include <vector>
 #include <unordered_set>
 
+#include <Engine/Display/Rendering/RenderHierarchy.h>
 #include <Engine/World/Entity/Entity.h>
 #include <Engine/Utility/Data.h>
 #include <Engine/Utility/File.h>
@@ -88,6 +89,9 @@ public:
 	}
 
 	void Load( const CFile& File, const bool AssetsOnly = false );
+
+	// Maps the level file, generated identifiers are written back once the mapping has been released.
+	void Load( const std::string& Location, const bool AssetsOnly = false );
 	const std::vector<CEntity*>& GetEntities() const
 	{ 
 		return Entities;
@@ -170,6 +174,19 @@ private:
 	// Checks all the mesh entities, and calculates the level's bounds.
 	void CalculateBounds();
 
+	// Rebuilds the render hierarchy when entities were added or removed, refits it otherwise.
+	void UpdateHierarchy();
+
+	// The hierarchy stores raw entity pointers, it is cleared right away when entities are deleted or moved to another level.
+	void InvalidateHierarchy();
+
+	// Parses the level, returns the updated file contents when identifiers had to be generated for its entities.
+	std::string Parse( const CFile& File, const bool AssetsOnly );
+
+	// Mesh entities of the level, used by the renderer to cull them per subtree.
+	CRenderHierarchy Hierarchy;
+	bool HierarchyDirty = true;
+
 	bool DisableSerialization = false;
 
 public:
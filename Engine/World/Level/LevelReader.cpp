@@ -0,0 +1,154 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#include "LevelReader.h"
+
+bool CLevelReader::Read( const char* Data, const size_t Length )
+{
+	Subtree.reset();
+	Builder.reset();
+	Capture = ECapture::None;
+	Depth = 0;
+	EntitiesDepth = 0;
+	Key.clear();
+	EntityOffset = 0;
+
+	return Reader.Parse( Data, Length, *this );
+}
+
+bool CLevelReader::Read( const CFile& File )
+{
+	return Read( File.Fetch<char>(), File.Size() );
+}
+
+bool CLevelReader::Begin( const bool IsObject )
+{
+	if( Capture != ECapture::None )
+		return IsObject ? Builder->OnObjectBegin() : Builder->OnArrayBegin();
+
+	Depth++;
+
+	if( Depth == 2 && Key == "assets" )
+	{
+		Capture = ECapture::Assets;
+	}
+	else if( Depth == 2 && Key == "entities" && !IsObject )
+	{
+		EntitiesDepth = Depth;
+	}
+	else if( EntitiesDepth > 0 && Depth == EntitiesDepth + 1 && IsObject )
+	{
+		Capture = ECapture::Entity;
+		EntityOffset = Reader.Position();
+	}
+
+	if( Capture != ECapture::None )
+	{
+		// The captured container isn't counted.
+		Depth--;
+
+		Subtree.reset( new JSON::Container() );
+		Builder.reset( new JSON::Builder( *Subtree ) );
+
+		if( Capture == ECapture::Assets )
+		{
+			Builder->OnKey( Key.c_str(), Key.size() );
+		}
+
+		IsObject ? Builder->OnObjectBegin() : Builder->OnArrayBegin();
+	}
+
+	Key.clear();
+	return true;
+}
+
+bool CLevelReader::End()
+{
+	if( Capture == ECapture::None )
+	{
+		if( Depth == EntitiesDepth )
+		{
+			EntitiesDepth = 0;
+		}
+
+		Depth--;
+		return true;
+	}
+
+	// The builder doesn't care which kind of container is closed.
+	Builder->OnObjectEnd();
+	if( Builder->Depth() > 0 )
+		return true;
+
+	const auto Captured = Capture;
+	Capture = ECapture::None;
+	Builder.reset();
+
+	if( Subtree->Tree.empty() )
+		return true;
+
+	if( Captured == ECapture::Assets )
+	{
+		if( OnAssets )
+		{
+			OnAssets( *Subtree->Tree.front() );
+		}
+
+		Subtree.reset();
+	}
+	else if( OnEntity )
+	{
+		OnEntity( std::move( Subtree ), EntityOffset );
+	}
+
+	return true;
+}
+
+bool CLevelReader::OnObjectBegin()
+{
+	return Begin( true );
+}
+
+bool CLevelReader::OnObjectEnd()
+{
+	return End();
+}
+
+bool CLevelReader::OnArrayBegin()
+{
+	return Begin( false );
+}
+
+bool CLevelReader::OnArrayEnd()
+{
+	return End();
+}
+
+bool CLevelReader::OnKey( const char* Text, const size_t Length )
+{
+	if( Capture != ECapture::None )
+		return Builder->OnKey( Text, Length );
+
+	if( Depth == 1 )
+	{
+		Key.assign( Text, Length );
+	}
+
+	return true;
+}
+
+bool CLevelReader::OnValue( const char* Value, const size_t Length, const JSON::ENodeType::Type Type )
+{
+	if( Capture != ECapture::None )
+		return Builder->OnValue( Value, Length, Type );
+
+	if( Depth == 1 && !Key.empty() )
+	{
+		if( OnField )
+		{
+			OnField( Key, std::string( Value, Length ) );
+		}
+
+		Key.clear();
+	}
+
+	return true;
+}
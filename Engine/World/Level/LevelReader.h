@@ -0,0 +1,71 @@
+// Copyright  2017, Christiaan Bakker, All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <Engine/Utility/File.h>
+#include <Engine/Utility/Structures/JSON.h>
+#include <Engine/Utility/Structures/JSONReader.h>
+
+// Reads level files without building the full tree.
+// Only the asset list and one entity at a time are kept, entities are handed over as soon as their object has been read.
+class CLevelReader : public JSON::Handler
+{
+public:
+	// Top-level fields such as "uuid" and "save".
+	std::function<void( const std::string& Key, const std::string& Value )> OnField;
+
+	// Receives the asset list once it has been read.
+	std::function<void( const JSON::Object& Assets )> OnAssets;
+
+	// Receives the entities in the order they appear in, the container only holds the entity and can be kept.
+	// The offset points right after the opening brace of the entity in the file.
+	std::function<void( std::unique_ptr<JSON::Container> Entity, const size_t Offset )> OnEntity;
+
+	bool Read( const char* Data, const size_t Length );
+	bool Read( const CFile& File );
+
+	// Used to report errors.
+	const JSON::Reader& GetReader() const
+	{
+		return Reader;
+	}
+
+	bool OnObjectBegin() override;
+	bool OnObjectEnd() override;
+	bool OnArrayBegin() override;
+	bool OnArrayEnd() override;
+	bool OnKey( const char* Key, const size_t Length ) override;
+	bool OnValue( const char* Value, const size_t Length, const JSON::ENodeType::Type Type ) override;
+
+private:
+	enum class ECapture : uint8_t
+	{
+		None = 0,
+		Assets,
+		Entity
+	};
+
+	bool Begin( const bool IsObject );
+	bool End();
+
+	JSON::Reader Reader;
+
+	// Subtree that is being captured.
+	std::unique_ptr<JSON::Container> Subtree;
+	std::unique_ptr<JSON::Builder> Builder;
+	ECapture Capture = ECapture::None;
+
+	// Containers that have been opened outside of the captured subtree.
+	size_t Depth = 0;
+	size_t EntitiesDepth = 0;
+
+	// Last top-level key.
+	std::string Key;
+
+	// Offset of the entity that is being captured.
+	size_t EntityOffset = 0;
+};